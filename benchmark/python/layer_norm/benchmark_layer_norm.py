@@ -0,0 +1,63 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Compares the fused LayerNorm operator against the same computation written as a
+composite of reduce and broadcast operators, which is what LayerNorm used to run."""
+import argparse
+import mxnet as mx
+from mxnet.test_utils import check_speed
+
+
+def composite_layer_norm(data, gamma, beta, ndim, eps):
+    param_shape = (1,) * (ndim - 1) + (-1,)
+    mean = mx.sym.mean(data, axis=-1, keepdims=True)
+    centered = mx.sym.broadcast_sub(data, mean)
+    var = mx.sym.mean(mx.sym.square(centered), axis=-1, keepdims=True)
+    out = mx.sym.broadcast_div(centered, mx.sym.sqrt(var + eps))
+    out = mx.sym.broadcast_mul(out, mx.sym.reshape(gamma, shape=param_shape))
+    return mx.sym.broadcast_add(out, mx.sym.reshape(beta, shape=param_shape))
+
+
+def benchmark_layer_norm(shape, dtype, typ, ctx, repeats, eps=1e-5):
+    data = mx.sym.Variable('data')
+    gamma = mx.sym.Variable('gamma')
+    beta = mx.sym.Variable('beta')
+    location = {'data': mx.nd.random.normal(shape=shape, ctx=ctx).astype(dtype),
+                'gamma': mx.nd.random.normal(shape=(shape[-1],), ctx=ctx).astype(dtype),
+                'beta': mx.nd.random.normal(shape=(shape[-1],), ctx=ctx).astype(dtype)}
+    grad_req = 'null' if typ == 'forward' else 'write'
+    fused = mx.sym.LayerNorm(data, gamma, beta, axis=-1, eps=eps)
+    composite = composite_layer_norm(data, gamma, beta, len(shape), eps)
+    fused_time = check_speed(sym=fused, location=location, ctx=ctx, N=repeats,
+                             grad_req=grad_req, typ=typ) * 1000
+    composite_time = check_speed(sym=composite, location=location, ctx=ctx, N=repeats,
+                                 grad_req=grad_req, typ=typ) * 1000
+    print('shape=%s, dtype=%s, %s: fused %.3f ms, composite %.3f ms, speedup %.2fX'
+          % (shape, dtype, typ, fused_time, composite_time, composite_time / fused_time))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Benchmark the LayerNorm operator')
+    parser.add_argument('--gpu', action='store_true', help='run on gpu(0) instead of cpu')
+    parser.add_argument('--repeats', type=int, default=20)
+    args = parser.parse_args()
+    ctx = mx.gpu(0) if args.gpu else mx.cpu()
+    # shapes of Transformer activations: (batch, sequence length, hidden size)
+    for shape in [(32, 128, 768), (32, 128, 1024), (64, 64, 512), (128, 4096)]:
+        for dtype in ['float32', 'float16']:
+            for typ in ['forward', 'whole']:
+                benchmark_layer_norm(shape, dtype, typ, ctx, args.repeats)
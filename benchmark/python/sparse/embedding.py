@@ -0,0 +1,75 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Measures forward and backward of Embedding with sparse_grad=True on large tables, with
+uniform and with skewed (zipfian) lookups, for a float32 table and for a float16 table with
+float32 output."""
+import ctypes
+import time
+import argparse
+import numpy as np
+import mxnet as mx
+
+from mxnet.base import check_call, _LIB
+
+parser = argparse.ArgumentParser(description="Benchmark sparse embedding",
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+parser.add_argument('--num-omp-threads', type=int, default=1, help='number of omp threads to set in MXNet')
+parser.add_argument('--repeat', type=int, default=10)
+args = parser.parse_args()
+
+
+def measure_cost(repeat, exe, data):
+    exe.arg_dict['data'][:] = data
+    exe.forward(is_train=True)
+    exe.backward([mx.nd.ones(exe.outputs[0].shape)])
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        exe.forward(is_train=True)
+        exe.backward(exe.outputs)
+    mx.nd.waitall()
+    return (time.time() - start) / repeat
+
+
+def run_embedding(num_rows, output_dim, batch_size, distribution, dtype, out_dtype):
+    if distribution == 'zipf':
+        idx = np.minimum(np.random.zipf(1.2, size=batch_size), num_rows) - 1
+    else:
+        idx = np.random.randint(0, num_rows, size=batch_size)
+    data = mx.sym.Variable('data')
+    weight = mx.sym.Variable('weight', dtype=dtype)
+    kwargs = {} if out_dtype is None else {'out_dtype': out_dtype}
+    sym = mx.sym.Embedding(data, weight, input_dim=num_rows, output_dim=output_dim,
+                           dtype=dtype, sparse_grad=True, **kwargs)
+    exe = sym.simple_bind(mx.cpu(), data=(batch_size,),
+                          type_dict={'data': 'float32', 'weight': dtype},
+                          grad_req={'data': 'null', 'weight': 'write'})
+    cost = measure_cost(args.repeat, exe, mx.nd.array(idx))
+    print('{:>10d} {:>6d} {:>8d} {:>8} {:>8} {:>8} {:10.2f}'.format(
+        num_rows, output_dim, batch_size, distribution, dtype, str(out_dtype), cost * 1000))
+
+
+if __name__ == '__main__':
+    check_call(_LIB.MXSetNumOMPThreads(ctypes.c_int(args.num_omp_threads)))
+    print('{:>10} {:>6} {:>8} {:>8} {:>8} {:>8} {:>10}'.format(
+        'rows', 'dim', 'batch', 'indices', 'weight', 'output', 'time(ms)'))
+    for num_rows in [1000000, 10000000]:
+        for batch_size in [4096, 65536]:
+            for distribution in ['uniform', 'zipf']:
+                run_embedding(num_rows, 64, batch_size, distribution, 'float32', None)
+                run_embedding(num_rows, 64, batch_size, distribution, 'float16', 'float32')
@@ -601,6 +601,34 @@ MXNET_DLL int MXNDArrayLoad(const char* fname,
                             NDArrayHandle** out_arr,
                             mx_uint *out_name_size,
                             const char*** out_names);
+/*!
+ * \brief Save list of narray into the file, with the data of every narray aligned
+ *  so that the file can be loaded with MXNDArrayLoadMapped.
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveAligned(const char* fname,
+                                   mx_uint num_args,
+                                   NDArrayHandle* args,
+                                   const char** keys);
+/*!
+ * \brief Load list of narray from a local file by memory mapping it. Dense CPU narrays
+ *  saved by MXNDArraySaveAligned reference the copy-on-write mapping instead of being copied.
+ * \param fname name of the file.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadMapped(const char* fname,
+                                  mx_uint *out_size,
+                                  NDArrayHandle** out_arr,
+                                  mx_uint *out_name_size,
+                                  const char*** out_names);
 
 /*!
  * \brief Load list / dictionary of narrays from file content loaded into memory.
@@ -1136,6 +1164,18 @@ MXNET_DLL int MXInvokeCachedOp(CachedOpHandle handle,
                                NDArrayHandle *inputs,
                                int *num_outputs,
                                NDArrayHandle **outputs);
+/*!
+ * \brief get how often a cached op reused the plan of its input shapes
+ * \param handle the handle to the cached op
+ * \param hits number of calls that reused a plan
+ * \param misses number of calls that had to plan memory for their input shapes
+ * \param evictions number of plans dropped because the plan cache was full
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXGetCachedOpPlanStats(CachedOpHandle handle,
+                                     uint64_t *hits,
+                                     uint64_t *misses,
+                                     uint64_t *evictions);
 //--------------------------------------------
 // Part 3: symbolic configuration generation
 //--------------------------------------------
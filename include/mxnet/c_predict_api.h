@@ -49,6 +49,10 @@ typedef float mx_float;
 typedef void *PredictorHandle;
 /*! \brief handle to NDArray list */
 typedef void *NDListHandle;
+/*! \brief handle to a pool of predictors sharing their parameters */
+typedef void *PredictorPoolHandle;
+/*! \brief handle to a predictor batching requests of single samples */
+typedef void *PredictorBatcherHandle;
 
 /*!
  * \brief Get the last error happeneed.
@@ -240,6 +244,154 @@ MXNET_DLL int MXPredGetOutput(PredictorHandle handle,
  * \return 0 when success, -1 when failure.
  */
 MXNET_DLL int MXPredFree(PredictorHandle handle);
+/*!
+ * \brief create a pool of predictors that can be used from any number of threads with
+ *  any engine. The parameters are loaded once and shared, read only, by all the
+ *  predictors of the pool, each of which has its own inputs and intermediate memory.
+ * \param symbol_json_str The JSON string of the symbol.
+ * \param param_bytes The in-memory raw bytes of parameter ndarray file.
+ * \param param_size The size of parameter ndarray file.
+ * \param dev_type The device type, 1: cpu, 2:gpu
+ * \param dev_id The device id of the predictor.
+ * \param num_input_nodes Number of input nodes to the net,
+ *    For feedforward net, this is 1.
+ * \param input_keys The name of input argument.
+ *    For feedforward net, this is {"data"}
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ *    The length of this array = num_input_nodes + 1.
+ *    For feedforward net that takes 4 dimensional input, this is {0, 4}.
+ * \param input_shape_data A flattened data of shapes of each input node.
+ *    For feedforward net that takes 4 dimensional input, this is the shape data.
+ * \param pool_size The number of predictions that can run at the same time.
+ * \param out The created predictor pool.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredPoolCreate(const char* symbol_json_str,
+                               const void* param_bytes,
+                               int param_size,
+                               int dev_type, int dev_id,
+                               mx_uint num_input_nodes,
+                               const char** input_keys,
+                               const mx_uint* input_shape_indptr,
+                               const mx_uint* input_shape_data,
+                               mx_uint pool_size,
+                               PredictorPoolHandle* out);
+/*!
+ * \brief Get the shape of output node of the predictors of a pool.
+ *  The returned shape_data and shape_ndim is only valid before next call to this function.
+ * \param handle The handle of the predictor pool.
+ * \param index The index of output node, set to 0 if there is only one output.
+ * \param shape_data Used to hold pointer to the shape data
+ * \param shape_ndim Used to hold shape dimension.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredPoolGetOutputShape(PredictorPoolHandle handle,
+                                       mx_uint index,
+                                       mx_uint** shape_data,
+                                       mx_uint* shape_ndim);
+/*!
+ * \brief Run a prediction on a free predictor of the pool, waiting for one to be free.
+ *  This function is thread safe.
+ * \param handle The handle of the predictor pool.
+ * \param input_data The data of each input node, in the order of input_keys at creation.
+ * \param input_sizes The number of elements of each input node.
+ * \param num_outputs The number of outputs to copy, at most the number of output nodes.
+ * \param output_data The buffers the first num_outputs outputs are copied to.
+ * \param output_sizes The number of elements of each output buffer.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredPoolPredict(PredictorPoolHandle handle,
+                                const mx_float** input_data,
+                                const mx_uint* input_sizes,
+                                mx_uint num_outputs,
+                                mx_float** output_data,
+                                const mx_uint* output_sizes);
+/*!
+ * \brief Free a predictor pool. No prediction may be running on it.
+ * \param handle The handle of the predictor pool.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredPoolFree(PredictorPoolHandle handle);
+/*!
+ * \brief create a predictor that batches requests of single samples. Requests are queued
+ *  and coalesced until max_batch_size of them are waiting or the oldest one has waited
+ *  max_delay_us, then run as one forward pass on executors pre-bound for batch sizes
+ *  1, 2, 4, ... up to max_batch_size, padding to the next bound size.
+ *  The parameters are loaded once and shared by all the executors.
+ * \param symbol_json_str The JSON string of the symbol.
+ * \param param_bytes The in-memory raw bytes of parameter ndarray file.
+ * \param param_size The size of parameter ndarray file.
+ * \param dev_type The device type, 1: cpu, 2:gpu
+ * \param dev_id The device id of the predictor.
+ * \param num_input_nodes Number of input nodes to the net.
+ * \param input_keys The name of input argument.
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ * \param input_shape_data A flattened data of shapes of one sample of each input node,
+ *    without the batch dimension. For images, this is {3, 224, 224}.
+ * \param max_batch_size The largest number of requests run in one forward pass.
+ * \param max_delay_us The longest time a request waits for others to be batched with it.
+ * \param num_workers The number of batches that can run at the same time.
+ * \param out The created batcher.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredBatcherCreate(const char* symbol_json_str,
+                                  const void* param_bytes,
+                                  int param_size,
+                                  int dev_type, int dev_id,
+                                  mx_uint num_input_nodes,
+                                  const char** input_keys,
+                                  const mx_uint* input_shape_indptr,
+                                  const mx_uint* input_shape_data,
+                                  mx_uint max_batch_size,
+                                  mx_uint max_delay_us,
+                                  mx_uint num_workers,
+                                  PredictorBatcherHandle* out);
+/*!
+ * \brief Get the shape of one sample of an output node of the batcher,
+ *  without the batch dimension.
+ * \param handle The handle of the batcher.
+ * \param index The index of output node, set to 0 if there is only one output.
+ * \param shape_data Used to hold pointer to the shape data
+ * \param shape_ndim Used to hold shape dimension.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredBatcherGetOutputShape(PredictorBatcherHandle handle,
+                                          mx_uint index,
+                                          mx_uint** shape_data,
+                                          mx_uint* shape_ndim);
+/*!
+ * \brief Run the prediction of one sample, waiting until its batch has run.
+ *  This function is thread safe.
+ * \param handle The handle of the batcher.
+ * \param input_data The data of each input node, in the order of input_keys at creation.
+ * \param input_sizes The number of elements of each input node, those of one sample.
+ * \param num_outputs The number of outputs to copy, at most the number of output nodes.
+ * \param output_data The buffers the first num_outputs outputs are copied to.
+ * \param output_sizes The number of elements of each output buffer, those of one sample.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredBatcherPredict(PredictorBatcherHandle handle,
+                                   const mx_float** input_data,
+                                   const mx_uint* input_sizes,
+                                   mx_uint num_outputs,
+                                   mx_float** output_data,
+                                   const mx_uint* output_sizes);
+/*!
+ * \brief Get the statistics of a batcher: number of requests and batches, and histograms
+ *  of the batch sizes and of the queue depth seen by requests when they are queued.
+ * \param handle The handle of the batcher.
+ * \param out_str Used to hold the printable statistics, valid until the next call
+ *    from the same thread.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredBatcherGetStats(PredictorBatcherHandle handle,
+                                    const char** out_str);
+/*!
+ * \brief Free a batcher, after running the requests still queued.
+ * \param handle The handle of the batcher.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredBatcherFree(PredictorBatcherHandle handle);
 /*!
  * \brief Create a NDArray List by loading from ndarray file.
  *     This can be used to load mean image file.
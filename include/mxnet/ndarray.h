@@ -388,6 +388,16 @@ class NDArray {
   inline size_t version() const {
     return var()->version();
   }
+  /*!
+   * \brief the transpose of this csr array saved by SetCSRTranspose, or an empty NDArray
+   *  if none was saved for the current version of the array.
+   */
+  NDArray GetCSRTranspose() const;
+  /*!
+   * \brief save the transpose of this csr array for its current version, so that operators
+   *  can reuse it until the array is written to. It is released with the array's chunk.
+   */
+  void SetCSRTranspose(const NDArray &trans) const;
   /*!
    * \brief save the content into binary stream
    * \param strm the output stream
@@ -670,6 +680,25 @@ class NDArray {
     ptr_->CheckAndAlloc(shape.Size() * mshadow::mshadow_sizeof(dtype_));
   }
 
+  /*!
+   * \brief Enlarge a dense ndarray whose allocation is still delayed, without
+   * allocating it. Views created by AsArray share the chunk and see the larger
+   * memory once it is allocated. Operations already pushed on the chunk may
+   * allocate it while they run, so this waits for them first.
+   * \return false if the memory has already been allocated, in which case
+   * nothing is changed.
+   */
+  bool ReshapeDelayAlloc(const TShape& shape) {
+    CHECK_EQ(storage_type(), kDefaultStorage);
+    CHECK(!is_none());
+    WaitToWrite();
+    if (!ptr_->delay_alloc) return false;
+    shape_ = shape;
+    ptr_->shandle.size = std::max(ptr_->shandle.size,
+                                  shape.Size() * mshadow::mshadow_sizeof(dtype_));
+    return true;
+  }
+
   /* !
    * \brief Alloc memory for non-default storage
    * aux_shape is only known at run time
@@ -801,6 +830,29 @@ class NDArray {
   static void Load(dmlc::Stream* fi,
                    std::vector<NDArray>* data,
                    std::vector<std::string>* keys);
+  /*!
+   * \brief Save list of ndarray into the Stream, with the data of every array aligned
+   *  to 64 bytes from the beginning of the stream so that it can be memory mapped.
+   *  The file can be read by Load and LoadMapped.
+   * \param fo The stream of output, positioned at the beginning of the file.
+   * \param data the NDArrays to be saved.
+   * \param names the name of the NDArray, optional, can be zero length.
+   */
+  static void SaveAligned(dmlc::Stream* fo,
+                          const std::vector<NDArray>& data,
+                          const std::vector<std::string>& names);
+  /*!
+   * \brief Load list of ndarray from a local file by memory mapping it.
+   *  Dense arrays saved on CPU by SaveAligned reference the mapping directly instead
+   *  of being copied, and are copy-on-write: processes mapping the same file share
+   *  its pages until they modify them. Other arrays and formats are copied as by Load.
+   * \param fname The path of the file.
+   * \param data the NDArrays to be loaded
+   * \param keys the name of the NDArray, if saved in the file.
+   */
+  static void LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys);
 
  private:
   friend class Imperative;
@@ -825,6 +877,9 @@ class NDArray {
 #endif
     /*! \brief variable from engine */
     Engine::VarHandle var;
+    /*! \brief transpose of a csr chunk saved by SetCSRTranspose, and the var version it is for */
+    std::shared_ptr<NDArray> csr_trans;
+    size_t csr_trans_version = 0;
     /*!
      * \brief if this is true, this means the data do not come
      * from Storage, and do not need to be freed
@@ -294,6 +294,14 @@ using FInferStorageType = std::function<bool (const NodeAttrs& attrs,
  */
 using FQuantizedOp = std::function<nnvm::NodePtr (const NodeAttrs& attrs)>;
 
+/*!
+ * \brief Register a function to determine if a node of an operator with FQuantizedOp
+ * can be quantized, for the operators whose quantized version only supports some of
+ * their attrs, e.g. Activation. Nodes of operators without it are always quantized.
+ * \note Register under "FQuantizable" for non-quantized operators
+ */
+using FQuantizable = std::function<bool (const NodeAttrs& attrs)>;
+
 /*!
  * \brief Register a function to determine if the output of a quantized operator
  * needs to be requantized. This is usually used for the operators
@@ -118,6 +118,17 @@ class CachedOp(object):
     def __del__(self):
         check_call(_LIB.MXFreeCachedOp(self.handle))
 
+    def plan_stats(self):
+        """Returns how many calls reused the memory plan of their input shapes,
+        how many had to plan again and how many plans were dropped from the
+        plan cache, as a tuple (hits, misses, evictions)."""
+        hits = ctypes.c_uint64()
+        misses = ctypes.c_uint64()
+        evictions = ctypes.c_uint64()
+        check_call(_LIB.MXGetCachedOpPlanStats(
+            self.handle, ctypes.byref(hits), ctypes.byref(misses), ctypes.byref(evictions)))
+        return hits.value, misses.value, evictions.value
+
     def __call__(self, *args, **kwargs):
         """ctypes implementation of imperative invoke wrapper"""
         out = kwargs.pop('out', None)
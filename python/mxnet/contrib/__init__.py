@@ -33,3 +33,4 @@ from . import io
 from . import quantization
 from . import quantization as quant
 from . import tensorrt
+from . import mkldnn
@@ -0,0 +1,60 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""MKLDNN helpers."""
+
+from ..context import cpu
+from .. import ndarray as nd
+
+
+def prewarm_primitive_cache(symbol, input_shapes, arg_params=None, aux_params=None,
+                            ctx=None, type_dict=None):
+    """Create the MKLDNN primitives of a model for a list of input shapes.
+
+    MKLDNN primitives are created lazily on the first execution of an operator with a new
+    input shape and are kept in a process-wide cache shared by all engine threads
+    (its size can be bounded with ``MXNET_MKLDNN_CACHE_NUM``). Running one inference forward pass
+    per expected shape at model load time moves the primitive creation cost out of the
+    serving path.
+
+    Parameters
+    ----------
+    symbol : Symbol
+        The model to warm up.
+    input_shapes : list of dict of str to tuple
+        Each element maps input names to shapes, e.g. ``[{'data': (1, 3, 224, 224)},
+        {'data': (8, 3, 224, 224)}]``.
+    arg_params : dict of str to NDArray, optional
+        Model parameters. Primitives do not depend on the values, so parameters are only
+        copied to keep the forward pass numerically sane.
+    aux_params : dict of str to NDArray, optional
+        Auxiliary states.
+    ctx : Context, optional
+        Defaults to ``mx.cpu()``.
+    type_dict : dict of str to numpy.dtype, optional
+        Input data types, passed to ``simple_bind``.
+    """
+    ctx = cpu() if ctx is None else ctx
+    for shapes in input_shapes:
+        exe = symbol.simple_bind(ctx, grad_req='null', type_dict=type_dict, **shapes)
+        exe.copy_params_from(arg_params or {}, aux_params or {}, allow_extra_params=True)
+        exe.forward(is_train=False)
+        for out in exe.outputs:
+            out.wait_to_read()
+        del exe
+    nd.waitall()
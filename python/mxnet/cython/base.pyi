@@ -2,6 +2,7 @@ from ..base import MXNetError
 
 from libcpp.vector cimport vector
 from libcpp.string cimport string
+from libc.stdint cimport uint64_t
 from cpython.version cimport PY_MAJOR_VERSION
 
 ctypedef void* SymbolHandle
@@ -102,6 +103,10 @@ cdef extern from "mxnet/c_api.h":
     int MXCreateCachedOp(SymbolHandle handle,
                          CachedOpHandle *out);
     int MXFreeCachedOp(CachedOpHandle handle);
+    int MXGetCachedOpPlanStats(CachedOpHandle handle,
+                               uint64_t *hits,
+                               uint64_t *misses,
+                               uint64_t *evictions);
     int MXInvokeCachedOp(CachedOpHandle handle,
                        int num_inputs,
                        NDArrayHandle *inputs,
@@ -21,7 +21,7 @@ import sys as _sys
 import ctypes as _ctypes
 import numpy as np
 from ..ndarray_doc import _build_doc
-from libc.stdint cimport uint32_t, int64_t
+from libc.stdint cimport uint32_t, int64_t, uint64_t
 
 include "./base.pyi"
 
@@ -108,6 +108,16 @@ cdef class CachedOp:
     def __del__(self):
         CALL(MXFreeCachedOp(self.chandle))
 
+    def plan_stats(self):
+        """Returns how many calls reused the memory plan of their input shapes,
+        how many had to plan again and how many plans were dropped from the
+        plan cache, as a tuple (hits, misses, evictions)."""
+        cdef uint64_t hits
+        cdef uint64_t misses
+        cdef uint64_t evictions
+        CALL(MXGetCachedOpPlanStats(self.chandle, &hits, &misses, &evictions))
+        return hits, misses, evictions
+
     def __call__(self, *args, out=None):
         """ctypes implementation of imperative invoke wrapper"""
         cdef vector[NDArrayHandle] ndvars
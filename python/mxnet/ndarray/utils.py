@@ -146,7 +146,7 @@ def array(source_array, ctx=None, dtype=None):
         return _array(source_array, ctx=ctx, dtype=dtype)
 
 
-def load(fname):
+def load(fname, mmap=False):
     """Loads an array from file.
 
     See more details in ``save``.
@@ -155,6 +155,11 @@ def load(fname):
     ----------
     fname : str
         The filename.
+    mmap : bool, default False
+        Whether to memory map the file, which must be a local file. Dense arrays saved
+        on CPU with ``save(..., aligned=True)`` then reference the mapped file instead of
+        being copied, and are copy-on-write: processes loading the same file share one
+        copy of it in memory until they modify the arrays.
 
     Returns
     -------
@@ -168,11 +173,12 @@ def load(fname):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(fname),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    load_fn = _LIB.MXNDArrayLoadMapped if mmap else _LIB.MXNDArrayLoad
+    check_call(load_fn(c_str(fname),
+                       ctypes.byref(out_size),
+                       ctypes.byref(handles),
+                       ctypes.byref(out_name_size),
+                       ctypes.byref(names)))
     if out_name_size.value == 0:
         return [_ndarray_cls(NDArrayHandle(handles[i])) for i in range(out_size.value)]
     else:
@@ -219,7 +225,7 @@ def load_frombuffer(buf):
             for i in range(out_size.value))
 
 
-def save(fname, data):
+def save(fname, data, aligned=False):
     """Saves a list of arrays or a dict of str->array to file.
 
     Examples of filenames:
@@ -236,6 +242,9 @@ def save(fname, data):
            or list of NDArray, RowSparseNDArray or CSRNDArray, \
            or dict of str to NDArray, RowSparseNDArray or CSRNDArray
         The data to save.
+    aligned : bool, default False
+        Whether to align the data of every array in the file, so that it can be memory
+        mapped by ``load(fname, mmap=True)``. Such files cannot be read by older versions.
 
     Examples
     --------
@@ -267,7 +276,8 @@ def save(fname, data):
     else:
         raise ValueError("data needs to either be a NDArray, dict of str, NDArray pairs "
                          "or a list of NDarrays.")
-    check_call(_LIB.MXNDArraySave(c_str(fname),
-                                  mx_uint(len(handles)),
-                                  handles,
-                                  keys))
+    save_fn = _LIB.MXNDArraySaveAligned if aligned else _LIB.MXNDArraySave
+    check_call(save_fn(c_str(fname),
+                       mx_uint(len(handles)),
+                       handles,
+                       keys))
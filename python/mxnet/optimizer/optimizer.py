@@ -25,12 +25,14 @@ import warnings
 import os
 import numpy
 from ..base import py_str
-from ..ndarray import (NDArray, zeros, clip, sqrt, cast, maximum, abs as NDabs, array, multiply)
+from ..ndarray import (NDArray, zeros, clip, sqrt, cast, maximum, abs as NDabs, array, multiply,
+                       add_n)
 from ..ndarray import (sgd_update, sgd_mom_update, adam_update, rmsprop_update, rmspropalex_update,
                        mp_sgd_update, mp_sgd_mom_update, square, ftrl_update, ftml_update,
                        signsgd_update, signum_update,
                        multi_sgd_update, multi_sgd_mom_update, multi_mp_sgd_update,
-                       multi_mp_sgd_mom_update)
+                       multi_mp_sgd_mom_update, multi_adam_update, multi_mp_adam_update,
+                       multi_rmsprop_update, multi_mp_rmsprop_update)
 from ..ndarray import sparse
 from ..random import normal
 
@@ -43,6 +45,18 @@ __all__ = [
 def _flatten_list(nested_list):
     return [item for sublist in nested_list for item in sublist]
 
+def _global_norm_sq(grads):
+    """Returns the sum of squares of all gradients as a float32 NDArray of shape (1,),
+    on the context of the first one."""
+    ctx = grads[0].context
+    sums = [square(grad.astype(numpy.float32, copy=False)).sum().as_in_context(ctx)
+            for grad in grads]
+    return add_n(*sums) if len(sums) > 1 else sums[0]
+
+def _aggregation_size():
+    """Returns the number of parameters updated by one multi-tensor update."""
+    return int(os.getenv('MXNET_OPTIMIZER_AGGREGATION_SIZE', "4"))
+
 class Optimizer(object):
     """The base class inherited by all optimizers.
 
@@ -111,6 +125,10 @@ class Optimizer(object):
         self.clip_gradient = clip_gradient
         self.multi_precision = multi_precision
         self.aggregate_num = 0
+        # set by optimizers whose multi-tensor updates clip by the global norm, see
+        # _global_norm_inputs; _global_norm_sq is set by the Updater for one step
+        self.clip_global_norm = None
+        self._global_norm_sq = None
 
         if param_idx2name is None:
             param_idx2name = {}
@@ -480,6 +498,18 @@ class Optimizer(object):
         """
         return self._get_wds([index])[0]
 
+    def _global_norm_inputs(self, grads, aggregate, kwargs):
+        """Returns the extra inputs of the multi-tensor update for global norm clipping."""
+        if not self.clip_global_norm:
+            return []
+        if not aggregate:
+            raise ValueError("clip_global_norm is only supported for aggregated "
+                             "updates of dense parameters")
+        kwargs['clip_global_norm'] = self.clip_global_norm
+        if self._global_norm_sq is not None:
+            return [self._global_norm_sq]
+        return [_global_norm_sq(grads)]
+
     def __getstate__(self):
         ret = self.__dict__.copy()
         # do not include param_dict in the state
@@ -552,7 +582,7 @@ class SGD(Optimizer):
         super(SGD, self).__init__(**kwargs)
         self.momentum = momentum
         self.lazy_update = lazy_update
-        self.aggregate_num = int(os.getenv('MXNET_OPTIMIZER_AGGREGATION_SIZE', "4"))
+        self.aggregate_num = _aggregation_size()
 
     def create_state_multi_precision(self, index, weight):
         weight_master_copy = None
@@ -1142,6 +1172,10 @@ class Adam(Optimizer):
 
     For details of the update algorithm, see :class:`~mxnet.ndarray.adam_update`.
 
+    Like SGD, Adam performs aggregated updates of dense parameters with
+    :class:`~mxnet.ndarray.multi_adam_update` when ``update_on_kvstore`` is False.
+    The aggregation size is controlled by MXNET_OPTIMIZER_AGGREGATION_SIZE.
+
     Parameters
     ----------
     beta1 : float, optional
@@ -1153,14 +1187,22 @@ class Adam(Optimizer):
     lazy_update : bool, optional
        Default is True. If True, lazy updates are applied \
        if the storage types of weight and grad are both ``row_sparse``.
+    clip_global_norm : float, optional
+       If set, rescaled gradients are scaled by
+       ``clip_global_norm / max(norm, clip_global_norm)``, where ``norm`` is the L2 norm
+       of all gradients passed to one call of the :class:`Updater`, i.e. of the whole
+       model on one device. It requires dense parameters and ``update_on_kvstore=False``;
+       the kvstore updates one parameter at a time.
     """
     def __init__(self, learning_rate=0.001, beta1=0.9, beta2=0.999, epsilon=1e-8,
-                 lazy_update=True, **kwargs):
+                 lazy_update=True, clip_global_norm=None, **kwargs):
         super(Adam, self).__init__(learning_rate=learning_rate, **kwargs)
         self.beta1 = beta1
         self.beta2 = beta2
         self.epsilon = epsilon
         self.lazy_update = lazy_update
+        self.clip_global_norm = clip_global_norm
+        self.aggregate_num = _aggregation_size()
 
     def create_state(self, index, weight):
         stype = weight.stype if self.lazy_update else 'default'
@@ -1169,26 +1211,69 @@ class Adam(Optimizer):
                 zeros(weight.shape, weight.context, dtype=weight.dtype,
                       stype=stype))  # variance
 
-    def update(self, index, weight, grad, state):
-        assert(isinstance(weight, NDArray))
-        assert(isinstance(grad, NDArray))
-        self._update_count(index)
-        lr = self._get_lr(index)
-        wd = self._get_wd(index)
-
-        t = self._index_update_count[index]
-        coef1 = 1. - self.beta1**t
-        coef2 = 1. - self.beta2**t
-        lr *= math.sqrt(coef2)/coef1
+    def _update_impl(self, indices, weights, grads, states, multi_precision=False):
+        aggregate = True
+        if not isinstance(indices, (tuple, list)):
+            indices = [indices]
+            weights = [weights]
+            grads = [grads]
+            states = [states]
+        for weight, grad in zip(weights, grads):
+            assert(isinstance(weight, NDArray))
+            assert(isinstance(grad, NDArray))
+            aggregate = (aggregate and
+                         weight.stype == 'default' and
+                         grad.stype == 'default')
+        self._update_count(indices)
+        lrs = self._get_lrs(indices)
+        wds = self._get_wds(indices)
+        for i, index in enumerate(indices):
+            t = self._index_update_count[index]
+            coef1 = 1. - self.beta1**t
+            coef2 = 1. - self.beta2**t
+            lrs[i] *= math.sqrt(coef2)/coef1
 
         kwargs = {'beta1': self.beta1, 'beta2': self.beta2, 'epsilon': self.epsilon,
                   'rescale_grad': self.rescale_grad}
         if self.clip_gradient:
             kwargs['clip_gradient'] = self.clip_gradient
+        norm_inputs = self._global_norm_inputs(grads, aggregate, kwargs)
 
-        mean, var = state
-        adam_update(weight, grad, mean, var, out=weight,
-                    lazy_update=self.lazy_update, lr=lr, wd=wd, **kwargs)
+        if aggregate:
+            if not multi_precision:
+                multi_adam_update(*(_flatten_list(zip(weights, grads, *zip(*states))) +
+                                    norm_inputs),
+                                  out=weights, num_weights=len(weights),
+                                  lrs=lrs, wds=wds, **kwargs)
+            else:
+                weights32, moments = zip(*states)
+                means, variances = zip(*moments)
+                multi_mp_adam_update(*(_flatten_list(zip(weights, grads, means, variances,
+                                                         weights32)) + norm_inputs),
+                                     out=weights, num_weights=len(weights),
+                                     lrs=lrs, wds=wds, **kwargs)
+        else:
+            for weight, grad, state, lr, wd in zip(weights, grads, states, lrs, wds):
+                if not multi_precision:
+                    mean, var = state
+                    adam_update(weight, grad, mean, var, out=weight,
+                                lazy_update=self.lazy_update, lr=lr, wd=wd, **kwargs)
+                else:
+                    weight32, (mean, var) = state
+                    adam_update(weight32, grad.astype(numpy.float32), mean, var, out=weight32,
+                                lazy_update=self.lazy_update, lr=lr, wd=wd, **kwargs)
+                    cast(weight32, dtype=weight.dtype, out=weight)
+
+    def update(self, index, weight, grad, state):
+        self._update_impl(index, weight, grad, state, multi_precision=False)
+
+    def update_multi_precision(self, index, weight, grad, state):
+        if not isinstance(index, (tuple, list)):
+            use_multi_precision = self.multi_precision and weight.dtype == numpy.float16
+        else:
+            use_multi_precision = self.multi_precision and weight[0].dtype == numpy.float16
+        self._update_impl(index, weight, grad, state,
+                          multi_precision=use_multi_precision)
 
 @register
 class AdaGrad(Optimizer):
@@ -1283,15 +1368,28 @@ class RMSProp(Optimizer):
 
     clip_weights : float, optional
         Clips weights into range ``[-clip_weights, clip_weights]``.
+    clip_global_norm : float, optional
+        If set, rescaled gradients are scaled by
+        ``clip_global_norm / max(norm, clip_global_norm)``, where ``norm`` is the L2 norm
+        of all gradients passed to one call of the :class:`Updater`, i.e. of the whole
+        model on one device. It requires ``centered=False``, dense parameters and
+        ``update_on_kvstore=False``; the kvstore updates one parameter at a time.
+
+    With ``centered=False`` and ``update_on_kvstore`` set to False, dense parameters
+    are updated in aggregate with :class:`~mxnet.ndarray.multi_rmsprop_update`.
+    The aggregation size is controlled by MXNET_OPTIMIZER_AGGREGATION_SIZE.
     """
     def __init__(self, learning_rate=0.001, gamma1=0.9, gamma2=0.9,
-                 epsilon=1e-8, centered=False, clip_weights=None, **kwargs):
+                 epsilon=1e-8, centered=False, clip_weights=None, clip_global_norm=None,
+                 **kwargs):
         super(RMSProp, self).__init__(learning_rate=learning_rate, **kwargs)
         self.gamma1 = gamma1
         self.gamma2 = gamma2
         self.centered = centered
         self.epsilon = epsilon
         self.clip_weights = clip_weights
+        self.clip_global_norm = clip_global_norm
+        self.aggregate_num = _aggregation_size()
 
     def create_state(self, index, weight):
         if self.centered:
@@ -1302,22 +1400,58 @@ class RMSProp(Optimizer):
         else:
             return (zeros(weight.shape, weight.context, stype=weight.stype),)  # n
 
-    def update(self, index, weight, grad, state):
-        assert(isinstance(weight, NDArray))
-        assert(isinstance(grad, NDArray))
-        self._update_count(index)
-        lr = self._get_lr(index)
-        wd = self._get_wd(index)
+    def _update_impl(self, indices, weights, grads, states, multi_precision=False):
+        aggregate = not self.centered
+        if not isinstance(indices, (tuple, list)):
+            indices = [indices]
+            weights = [weights]
+            grads = [grads]
+            states = [states]
+        for weight, grad in zip(weights, grads):
+            assert(isinstance(weight, NDArray))
+            assert(isinstance(grad, NDArray))
+            aggregate = (aggregate and
+                         weight.stype == 'default' and
+                         grad.stype == 'default')
+        self._update_count(indices)
+        lrs = self._get_lrs(indices)
+        wds = self._get_wds(indices)
 
         kwargs = {'gamma1': self.gamma1, 'epsilon': self.epsilon,
                   'rescale_grad': self.rescale_grad}
-        if self.centered:
-            kwargs['gamma2'] = self.gamma2
         if self.clip_gradient:
             kwargs['clip_gradient'] = self.clip_gradient
         if self.clip_weights:
             kwargs['clip_weights'] = self.clip_weights
+        norm_inputs = self._global_norm_inputs(grads, aggregate, kwargs)
+
+        if aggregate:
+            if not multi_precision:
+                multi_rmsprop_update(*(_flatten_list(zip(weights, grads, *zip(*states))) +
+                                       norm_inputs),
+                                     out=weights, num_weights=len(weights),
+                                     lrs=lrs, wds=wds, **kwargs)
+            else:
+                weights32, ns = zip(*states)
+                multi_mp_rmsprop_update(*(_flatten_list(zip(weights, grads,
+                                                            [n for (n, ) in ns], weights32)) +
+                                          norm_inputs),
+                                        out=weights, num_weights=len(weights),
+                                        lrs=lrs, wds=wds, **kwargs)
+            return
+
+        if self.centered:
+            kwargs['gamma2'] = self.gamma2
+        for weight, grad, state, lr, wd in zip(weights, grads, states, lrs, wds):
+            if multi_precision:
+                weight32, state32 = state
+                self._update_single(weight32, grad.astype(numpy.float32), state32,
+                                    lr, wd, kwargs)
+                cast(weight32, dtype=weight.dtype, out=weight)
+            else:
+                self._update_single(weight, grad, state, lr, wd, kwargs)
 
+    def _update_single(self, weight, grad, state, lr, wd, kwargs):
         if not self.centered:
             (n, ) = state
             rmsprop_update(
@@ -1327,6 +1461,17 @@ class RMSProp(Optimizer):
             rmspropalex_update(weight, grad, n, g, delta, out=weight,
                                lr=lr, wd=wd, **kwargs)
 
+    def update(self, index, weight, grad, state):
+        self._update_impl(index, weight, grad, state, multi_precision=False)
+
+    def update_multi_precision(self, index, weight, grad, state):
+        if not isinstance(index, (tuple, list)):
+            use_multi_precision = self.multi_precision and weight.dtype == numpy.float16
+        else:
+            use_multi_precision = self.multi_precision and weight[0].dtype == numpy.float16
+        self._update_impl(index, weight, grad, state,
+                          multi_precision=use_multi_precision)
+
 @register
 class AdaDelta(Optimizer):
     """The AdaDelta optimizer.
@@ -1633,6 +1778,16 @@ class Updater(object):
                 self.states[idx] = \
                     self.sync_state_context(self.states[idx], weights[i].context)
                 self.states_synced[idx] = True
+        if getattr(self.optimizer, 'clip_global_norm', None):
+            # the norm covers all gradients of the step, not just one aggregated chunk
+            self.optimizer._global_norm_sq = _global_norm_sq(grads)
+        try:
+            self._update(indices, weights, grads)
+        finally:
+            if getattr(self.optimizer, 'clip_global_norm', None):
+                self.optimizer._global_norm_sq = None
+
+    def _update(self, indices, weights, grads):
         if self.aggregate_updates:
             # segregate values based on type
             type_map = {}
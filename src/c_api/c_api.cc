@@ -361,6 +361,57 @@ int MXNDArrayLoad(const char* fname,
   API_END();
 }
 
+int MXNDArraySaveAligned(const char* fname,
+                         mx_uint num_args,
+                         NDArrayHandle* args,
+                         const char** keys) {
+  API_BEGIN();
+  std::vector<NDArray> data(num_args);
+  std::vector<std::string> names;
+  for (mx_uint i = 0; i < num_args; ++i) {
+    data[i] = *static_cast<NDArray*>(args[i]);
+  }
+  if (keys != nullptr) {
+    names.resize(num_args);
+    for (mx_uint i = 0; i < num_args; ++i) {
+      names[i] = keys[i];
+    }
+  }
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname, "w"));
+    mxnet::NDArray::SaveAligned(fo.get(), data, names);
+  }
+  API_END();
+}
+
+int MXNDArrayLoadMapped(const char* fname,
+                        mx_uint *out_size,
+                        NDArrayHandle** out_arr,
+                        mx_uint *out_name_size,
+                        const char*** out_names) {
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  ret->ret_vec_str.clear();
+  API_BEGIN();
+  std::vector<NDArray> data;
+  std::vector<std::string> &names = ret->ret_vec_str;
+  mxnet::NDArray::LoadMapped(fname, &data, &names);
+  ret->ret_handles.resize(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    NDArray *ptr = new NDArray();
+    *ptr = data[i];
+    ret->ret_handles[i] = ptr;
+  }
+  ret->ret_vec_charp.resize(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ret->ret_vec_charp[i] = names[i].c_str();
+  }
+  *out_size = static_cast<mx_uint>(data.size());
+  *out_arr = dmlc::BeginPtr(ret->ret_handles);
+  *out_name_size = static_cast<mx_uint>(names.size());
+  *out_names = dmlc::BeginPtr(ret->ret_vec_charp);
+  API_END();
+}
+
 int MXNDArrayLoadFromBuffer(const void *ndarray_buffer,
                             size_t size,
                             mx_uint *out_size,
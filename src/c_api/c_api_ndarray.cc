@@ -252,6 +252,18 @@ int MXInvokeCachedOpEx(CachedOpHandle handle,
   API_END();
 }
 
+int MXGetCachedOpPlanStats(CachedOpHandle handle,
+                           uint64_t *hits,
+                           uint64_t *misses,
+                           uint64_t *evictions) {
+  API_BEGIN();
+  CachedOpPtr op = *static_cast<CachedOpPtr*>(handle);
+  *hits = op->plan_hits();
+  *misses = op->plan_misses();
+  *evictions = op->plan_evictions();
+  API_END();
+}
+
 int MXAutogradIsTraining(bool* curr) {
   API_BEGIN();
   *curr = Imperative::Get()->is_training();
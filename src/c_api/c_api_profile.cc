@@ -43,6 +43,9 @@
 
 
 #include "../profiler/profiler.h"
+#if MXNET_USE_NGRAPH == 1
+#include "../operator/contrib/ngraph_compile_cache.h"
+#endif
 
 namespace mxnet {
 
@@ -596,12 +599,14 @@ int MXDumpNGraphProfile(const char* file_name) {
       file_out.open(file_name);
       if (file_out.is_open()) {
         ngraph_bridge::NGraphStats::get_instance().dump(file_out);
+        op::NgraphCompileCache::Get()->Dump(file_out);
       } else {
         throw dmlc::Error("Unable to open file '" + std::string(file_name) +
                           "' to write nGraph profile data.");
       }
     } else {
       ngraph_bridge::NGraphStats::get_instance().dump(std::cout);
+      op::NgraphCompileCache::Get()->Dump(std::cout);
     }
 #else
     throw dmlc::Error("MXDumpNGraphProfile requires MXNet built with nGraph.");
@@ -28,7 +28,16 @@
 #include <mxnet/executor.h>
 #include <mxnet/ndarray.h>
 #include <nnvm/pass_functions.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <unordered_set>
 #include <unordered_map>
 #include "./c_api_common.h"
@@ -59,6 +68,163 @@ struct MXAPIPredictor {
   Context ctx;
 };
 
+// pool of predictors sharing their parameters
+struct MXAPIPredictorPool {
+  // predictors, with their own inputs, auxiliary states and executor
+  std::vector<std::unique_ptr<MXAPIPredictor>> preds;
+  // index in arg_arrays of each input, in the order given at creation
+  std::vector<size_t> input_args;
+  // shapes of outputs, converted once so that they can be returned to any thread
+  std::vector<std::vector<uint32_t>> out_shapes_buffer;
+  // predictors not running a prediction
+  std::vector<MXAPIPredictor*> free_preds;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+// predictor batching requests of single samples
+struct MXAPIPredictorBatcher {
+  typedef std::chrono::steady_clock Clock;
+  // a queued request, owned by the waiting caller
+  struct Request {
+    const mx_float** input_data;
+    mx_uint num_outputs;
+    mx_float** output_data;
+    Clock::time_point enqueued;
+    // empty on success, the error message otherwise
+    std::promise<std::string> done;
+  };
+  // executor bound for one batch size
+  struct Bucket {
+    mx_uint batch_size;
+    std::unique_ptr<Executor> exec;
+    std::vector<NDArray> inputs;
+    std::vector<NDArray> outputs;
+  };
+  // number of queue depth histogram bins, bin i > 0 holds depths in [2^(i-1), 2^i)
+  static const int kNumDepthBins = 16;
+
+  // buckets of each worker, by increasing batch size
+  std::vector<std::vector<Bucket>> buckets;
+  // number of elements of one sample of each input and output
+  std::vector<size_t> input_sizes;
+  std::vector<size_t> output_sizes;
+  std::vector<std::vector<uint32_t>> out_shapes_buffer;
+  mx_uint max_batch_size;
+  std::chrono::microseconds max_delay;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Request*> queue;
+  bool stop{false};
+  std::vector<std::thread> workers;
+
+  // statistics, protected by mutex
+  uint64_t num_requests{0};
+  uint64_t num_batches{0};
+  std::vector<uint64_t> batch_size_hist;
+  std::vector<uint64_t> queue_depth_hist;
+
+  ~MXAPIPredictorBatcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) worker.join();
+  }
+
+  void Worker(std::vector<Bucket>* worker_buckets) {
+    std::vector<Request*> batch;
+    while (true) {
+      batch.clear();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return stop || !queue.empty(); });
+        if (queue.empty()) return;
+        // wait for the batch to fill, at most until the oldest request is due
+        const Clock::time_point deadline = queue.front()->enqueued + max_delay;
+        cv.wait_until(lock, deadline, [this]() {
+          return stop || queue.size() >= max_batch_size;
+        });
+        // another worker may have taken the requests in the meantime
+        if (queue.empty()) continue;
+        const size_t n = std::min<size_t>(queue.size(), max_batch_size);
+        batch.assign(queue.begin(), queue.begin() + n);
+        queue.erase(queue.begin(), queue.begin() + n);
+        ++num_batches;
+        ++batch_size_hist[n];
+      }
+      std::string err;
+      try {
+        RunBatch(worker_buckets, batch);
+      } catch (const std::exception& e) {
+        err = e.what();
+      }
+      for (Request* req : batch) req->done.set_value(err);
+    }
+  }
+
+  void RunBatch(std::vector<Bucket>* worker_buckets, const std::vector<Request*>& batch) {
+    Bucket* bucket = nullptr;
+    for (auto& b : *worker_buckets) {
+      if (b.batch_size >= batch.size()) {
+        bucket = &b;
+        break;
+      }
+    }
+    CHECK(bucket != nullptr);
+    std::vector<mx_float> staging;
+    for (size_t i = 0; i < input_sizes.size(); ++i) {
+      // rows past the batch are padding
+      staging.assign(input_sizes[i] * bucket->batch_size, 0.f);
+      for (size_t r = 0; r < batch.size(); ++r) {
+        std::memcpy(staging.data() + r * input_sizes[i], batch[r]->input_data[i],
+                    input_sizes[i] * sizeof(mx_float));
+      }
+      bucket->inputs[i].SyncCopyFromCPU(staging.data(), staging.size());
+    }
+    bucket->exec->Forward(false);
+    for (size_t i = 0; i < output_sizes.size(); ++i) {
+      bool needed = false;
+      for (Request* req : batch) needed = needed || i < req->num_outputs;
+      if (!needed) continue;
+      staging.resize(output_sizes[i] * bucket->batch_size);
+      bucket->outputs[i].SyncCopyToCPU(staging.data(), staging.size());
+      for (size_t r = 0; r < batch.size(); ++r) {
+        if (i >= batch[r]->num_outputs) continue;
+        std::memcpy(batch[r]->output_data[i], staging.data() + r * output_sizes[i],
+                    output_sizes[i] * sizeof(mx_float));
+      }
+    }
+  }
+
+  std::string Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream os;
+    os << "Predictor batcher" << std::endl;
+    os << "  requests:      " << num_requests << std::endl;
+    os << "  batches:       " << num_batches << std::endl;
+    os << "  batch size histogram:" << std::endl;
+    for (size_t i = 1; i < batch_size_hist.size(); ++i) {
+      if (batch_size_hist[i]) os << "    " << i << ": " << batch_size_hist[i] << std::endl;
+    }
+    os << "  queue depth histogram:" << std::endl;
+    for (int i = 0; i < kNumDepthBins; ++i) {
+      if (!queue_depth_hist[i]) continue;
+      if (i == 0) {
+        os << "    0: ";
+      } else if (i == kNumDepthBins - 1) {
+        os << "    >=" << (1 << (i - 1)) << ": ";
+      } else {
+        os << "    " << (1 << (i - 1)) << "-" << (1 << i) - 1 << ": ";
+      }
+      os << queue_depth_hist[i] << std::endl;
+    }
+    return os.str();
+  }
+};
+
 struct MXAPINDList {
   std::vector<std::string> keys;
   std::vector<TShape> shapes;
@@ -317,7 +483,8 @@ int MXPredCreateMultiThread(const char* symbol_json_str,
   if (type)
     stype = type;
   CHECK(stype == "NaiveEngine") << "Multithread inference only works with NaiveEngine.\n"
-      << "Please set MXNET_ENGINE_TYPE to NaiveEngine"
+      << "Please set MXNET_ENGINE_TYPE to NaiveEngine, "
+      << "or use MXPredPoolCreate which works with any engine"
       << std::endl;
   return _CreatePartialOut(
       symbol_json_str,
@@ -493,6 +660,271 @@ int MXPredFree(PredictorHandle handle) {
   API_END();
 }
 
+int MXPredPoolCreate(const char* symbol_json_str,
+                     const void* param_bytes,
+                     int param_size,
+                     int dev_type, int dev_id,
+                     mx_uint num_input_nodes,
+                     const char** input_keys,
+                     const mx_uint* input_shape_indptr,
+                     const mx_uint* input_shape_data,
+                     mx_uint pool_size,
+                     PredictorPoolHandle* out) {
+  // The predictors are created with shared arg and aux arrays, and no executor.
+  std::vector<PredictorHandle> handles(pool_size);
+  int ret = _CreatePartialOut(symbol_json_str, param_bytes, param_size, dev_type, dev_id,
+                              num_input_nodes, input_keys, input_shape_indptr,
+                              input_shape_data, 0, NULL, pool_size, true, handles.data());
+  if (ret != 0) return ret;
+  std::unique_ptr<MXAPIPredictorPool> pool(new MXAPIPredictorPool());
+  for (auto handle : handles) {
+    pool->preds.emplace_back(static_cast<MXAPIPredictor*>(handle));
+  }
+  API_BEGIN();
+  CHECK_GT(pool_size, 0) << "a predictor pool needs at least one predictor";
+  const MXAPIPredictor* first = pool->preds[0].get();
+  for (mx_uint i = 0; i < num_input_nodes; ++i) {
+    auto it = first->key2arg.find(input_keys[i]);
+    CHECK(it != first->key2arg.end()) << "cannot find input key " << input_keys[i];
+    pool->input_args.push_back(it->second);
+  }
+  for (const TShape& s : first->out_shapes) {
+    pool->out_shapes_buffer.emplace_back(s.ndim());
+    nnvm::ShapeTypeCast(s.begin(), s.end(), pool->out_shapes_buffer.back().data());
+  }
+  for (auto& pred : pool->preds) {
+    // Parameters stay shared and are only read. Inputs are written by each prediction,
+    // and auxiliary states are declared as mutated by operators such as BatchNorm,
+    // which would serialize the predictors, so each predictor gets its own.
+    for (size_t idx : pool->input_args) {
+      const NDArray& shared = pred->arg_arrays[idx];
+      pred->arg_arrays[idx] = NDArray(shared.shape(), shared.ctx(), false, shared.dtype());
+    }
+    for (auto& aux : pred->aux_arrays) {
+      aux = aux.Copy(aux.ctx());
+    }
+    _CreateExecutor(pred.get());
+    pool->free_preds.push_back(pred.get());
+  }
+  *out = pool.release();
+  API_END();
+}
+
+int MXPredPoolGetOutputShape(PredictorPoolHandle handle,
+                             mx_uint index,
+                             mx_uint** shape_data,
+                             mx_uint* shape_ndim) {
+  MXAPIPredictorPool* pool = static_cast<MXAPIPredictorPool*>(handle);
+  API_BEGIN();
+  CHECK_LT(index, pool->out_shapes_buffer.size())
+      << "Index exceed number of outputs";
+  *shape_data = pool->out_shapes_buffer[index].data();
+  *shape_ndim = pool->out_shapes_buffer[index].size();
+  API_END();
+}
+
+int MXPredPoolPredict(PredictorPoolHandle handle,
+                      const mx_float** input_data,
+                      const mx_uint* input_sizes,
+                      mx_uint num_outputs,
+                      mx_float** output_data,
+                      const mx_uint* output_sizes) {
+  MXAPIPredictorPool* pool = static_cast<MXAPIPredictorPool*>(handle);
+  API_BEGIN();
+  MXAPIPredictor* pred;
+  {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    pool->cv.wait(lock, [pool]() { return !pool->free_preds.empty(); });
+    pred = pool->free_preds.back();
+    pool->free_preds.pop_back();
+  }
+  // give the predictor back even if the prediction fails
+  std::shared_ptr<void> release(nullptr, [pool, pred](void*) {
+    {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      pool->free_preds.push_back(pred);
+    }
+    pool->cv.notify_one();
+  });
+  CHECK_LE(num_outputs, pred->out_arrays.size())
+      << "Output index out of range";
+  for (size_t i = 0; i < pool->input_args.size(); ++i) {
+    pred->arg_arrays[pool->input_args[i]].SyncCopyFromCPU(input_data[i], input_sizes[i]);
+  }
+  pred->exec->Forward(false);
+  for (mx_uint i = 0; i < num_outputs; ++i) {
+    pred->out_arrays[i].SyncCopyToCPU(output_data[i], output_sizes[i]);
+  }
+  API_END();
+}
+
+int MXPredPoolFree(PredictorPoolHandle handle) {
+  API_BEGIN();
+  delete static_cast<MXAPIPredictorPool*>(handle);
+  API_END();
+}
+
+int MXPredBatcherCreate(const char* symbol_json_str,
+                        const void* param_bytes,
+                        int param_size,
+                        int dev_type, int dev_id,
+                        mx_uint num_input_nodes,
+                        const char** input_keys,
+                        const mx_uint* input_shape_indptr,
+                        const mx_uint* input_shape_data,
+                        mx_uint max_batch_size,
+                        mx_uint max_delay_us,
+                        mx_uint num_workers,
+                        PredictorBatcherHandle* out) {
+  // load the parameters and infer the shapes at the largest batch size
+  std::vector<mx_uint> indptr(1, 0), shape_data;
+  for (mx_uint i = 0; i < num_input_nodes; ++i) {
+    shape_data.push_back(max_batch_size);
+    shape_data.insert(shape_data.end(), input_shape_data + input_shape_indptr[i],
+                      input_shape_data + input_shape_indptr[i + 1]);
+    indptr.push_back(shape_data.size());
+  }
+  PredictorHandle handle;
+  int ret = _CreatePartialOut(symbol_json_str, param_bytes, param_size, dev_type, dev_id,
+                              num_input_nodes, input_keys, indptr.data(), shape_data.data(),
+                              0, NULL, 1, true, &handle);
+  if (ret != 0) return ret;
+  std::unique_ptr<MXAPIPredictor> base(static_cast<MXAPIPredictor*>(handle));
+  std::unique_ptr<MXAPIPredictorBatcher> batcher(new MXAPIPredictorBatcher());
+  API_BEGIN();
+  CHECK_GT(max_batch_size, 0) << "max_batch_size must be positive";
+  CHECK_GT(num_workers, 0) << "num_workers must be positive";
+  batcher->max_batch_size = max_batch_size;
+  batcher->max_delay = std::chrono::microseconds(max_delay_us);
+  batcher->batch_size_hist.resize(max_batch_size + 1);
+  batcher->queue_depth_hist.resize(MXAPIPredictorBatcher::kNumDepthBins);
+
+  std::vector<size_t> input_args;
+  for (mx_uint i = 0; i < num_input_nodes; ++i) {
+    auto it = base->key2arg.find(input_keys[i]);
+    CHECK(it != base->key2arg.end()) << "cannot find input key " << input_keys[i];
+    input_args.push_back(it->second);
+    batcher->input_sizes.push_back(
+        TShape(input_shape_data + input_shape_indptr[i],
+               input_shape_data + input_shape_indptr[i + 1]).Size());
+  }
+  for (const TShape& s : base->out_shapes) {
+    CHECK(s.ndim() > 0 && s[0] == max_batch_size)
+        << "every output must have the batch size as first dimension";
+    batcher->output_sizes.push_back(s.Size() / max_batch_size);
+    batcher->out_shapes_buffer.emplace_back(s.ndim() - 1);
+    nnvm::ShapeTypeCast(s.begin() + 1, s.end(), batcher->out_shapes_buffer.back().data());
+  }
+  std::vector<mx_uint> batch_sizes;
+  for (mx_uint b = 1; b < max_batch_size; b *= 2) batch_sizes.push_back(b);
+  batch_sizes.push_back(max_batch_size);
+
+  batcher->buckets.resize(num_workers);
+  for (auto& worker_buckets : batcher->buckets) {
+    // A worker runs one batch at a time, so its executors share the auxiliary states and
+    // the memory of the largest one. Parameters are shared by all the executors.
+    std::vector<NDArray> aux_arrays;
+    for (const auto& aux : base->aux_arrays) aux_arrays.push_back(aux.Copy(aux.ctx()));
+    for (auto it = batch_sizes.rbegin(); it != batch_sizes.rend(); ++it) {
+      MXAPIPredictorBatcher::Bucket bucket;
+      bucket.batch_size = *it;
+      std::vector<NDArray> arg_arrays = base->arg_arrays;
+      for (size_t idx : input_args) {
+        TShape shape = arg_arrays[idx].shape();
+        shape[0] = bucket.batch_size;
+        arg_arrays[idx] = NDArray(shape, base->ctx, false, arg_arrays[idx].dtype());
+        bucket.inputs.push_back(arg_arrays[idx]);
+      }
+      std::map<std::string, Context> ctx_map;
+      std::vector<NDArray> grad_store(arg_arrays.size());
+      std::vector<OpReqType> grad_req(arg_arrays.size(), kNullOp);
+      Executor* shared_exec = worker_buckets.empty() ? nullptr : worker_buckets[0].exec.get();
+      bucket.exec.reset(Executor::Bind(base->sym, base->ctx, ctx_map, arg_arrays,
+                                       grad_store, grad_req, aux_arrays, shared_exec));
+      bucket.outputs = bucket.exec->outputs();
+      worker_buckets.push_back(std::move(bucket));
+    }
+    // by increasing batch size
+    std::reverse(worker_buckets.begin(), worker_buckets.end());
+  }
+  for (auto& worker_buckets : batcher->buckets) {
+    batcher->workers.emplace_back(&MXAPIPredictorBatcher::Worker, batcher.get(),
+                                  &worker_buckets);
+  }
+  *out = batcher.release();
+  API_END();
+}
+
+int MXPredBatcherGetOutputShape(PredictorBatcherHandle handle,
+                                mx_uint index,
+                                mx_uint** shape_data,
+                                mx_uint* shape_ndim) {
+  MXAPIPredictorBatcher* batcher = static_cast<MXAPIPredictorBatcher*>(handle);
+  API_BEGIN();
+  CHECK_LT(index, batcher->out_shapes_buffer.size())
+      << "Index exceed number of outputs";
+  *shape_data = batcher->out_shapes_buffer[index].data();
+  *shape_ndim = batcher->out_shapes_buffer[index].size();
+  API_END();
+}
+
+int MXPredBatcherPredict(PredictorBatcherHandle handle,
+                         const mx_float** input_data,
+                         const mx_uint* input_sizes,
+                         mx_uint num_outputs,
+                         mx_float** output_data,
+                         const mx_uint* output_sizes) {
+  MXAPIPredictorBatcher* batcher = static_cast<MXAPIPredictorBatcher*>(handle);
+  API_BEGIN();
+  // requests are checked here, so that a bad one does not fail its whole batch
+  for (size_t i = 0; i < batcher->input_sizes.size(); ++i) {
+    CHECK_EQ(input_sizes[i], batcher->input_sizes[i])
+        << "input " << i << " must hold exactly one sample";
+  }
+  CHECK_LE(num_outputs, batcher->output_sizes.size())
+      << "Output index out of range";
+  for (mx_uint i = 0; i < num_outputs; ++i) {
+    CHECK_EQ(output_sizes[i], batcher->output_sizes[i])
+        << "output " << i << " must hold exactly one sample";
+  }
+  MXAPIPredictorBatcher::Request req;
+  req.input_data = input_data;
+  req.num_outputs = num_outputs;
+  req.output_data = output_data;
+  req.enqueued = MXAPIPredictorBatcher::Clock::now();
+  std::future<std::string> done = req.done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(batcher->mutex);
+    CHECK(!batcher->stop) << "the batcher is being freed";
+    const size_t depth = batcher->queue.size();
+    int bin = 0;
+    while (bin < MXAPIPredictorBatcher::kNumDepthBins - 1 && (size_t{1} << bin) <= depth) ++bin;
+    ++batcher->queue_depth_hist[bin];
+    ++batcher->num_requests;
+    batcher->queue.push_back(&req);
+  }
+  batcher->cv.notify_all();
+  const std::string err = done.get();
+  if (!err.empty()) LOG(FATAL) << err;
+  API_END();
+}
+
+int MXPredBatcherGetStats(PredictorBatcherHandle handle,
+                          const char** out_str) {
+  MXAPIPredictorBatcher* batcher = static_cast<MXAPIPredictorBatcher*>(handle);
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  API_BEGIN();
+  ret->ret_str = batcher->Stats();
+  *out_str = ret->ret_str.c_str();
+  API_END();
+}
+
+int MXPredBatcherFree(PredictorBatcherHandle handle) {
+  API_BEGIN();
+  delete static_cast<MXAPIPredictorBatcher*>(handle);
+  API_END();
+}
+
 int MXNDListCreate(const char* nd_file_bytes,
                    int nd_file_size,
                    NDListHandle *out,
@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * Copyright (c) 2019 by Contributors
+ * \file numa.cc
+ * \brief NUMA topology discovery, thread pinning and memory placement.
+ */
+#include "./numa.h"
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif  // defined(__linux__)
+
+namespace mxnet {
+namespace common {
+namespace numa {
+
+std::vector<int> ParseCPUList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    const size_t dash = range.find('-');
+    if (dash == std::string::npos) {
+      cpus.push_back(std::stoi(range));
+    } else {
+      const int begin = std::stoi(range.substr(0, dash));
+      const int end = std::stoi(range.substr(dash + 1));
+      for (int i = begin; i <= end; ++i) cpus.push_back(i);
+    }
+  }
+  return cpus;
+}
+
+const NUMATopology* NUMATopology::Get() {
+  static NUMATopology inst;
+  return &inst;
+}
+
+NUMATopology::NUMATopology() {
+#if defined(__linux__)
+  page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  for (int node = 0; ; ++node) {
+    std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!is.good()) break;
+    std::string list;
+    std::getline(is, list);
+    node_cpus_.push_back(ParseCPUList(list));
+  }
+#endif  // defined(__linux__)
+  if (node_cpus_.empty()) node_cpus_.emplace_back();
+  const bool requested = dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false);
+  enabled_ = requested && node_cpus_.size() > 1;
+  if (requested && !enabled_) {
+    LOG(INFO) << "MXNET_CPU_NUMA_AWARE is set, but only one NUMA node was found. "
+              << "NUMA-aware placement is disabled.";
+  }
+}
+
+bool NUMATopology::BindCurrentThread(int node) const {
+#if defined(__linux__)
+  if (!enabled_ || node < 0 || node >= num_nodes() || node_cpus_[node].empty()) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : node_cpus_[node]) CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+void NUMATopology::BindMemory(void* ptr, size_t size, int node) const {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (!enabled_ || node < 0 || node >= num_nodes() || size == 0) return;
+  // MPOL_PREFERRED and MPOL_MF_MOVE from <numaif.h>, kept local to avoid a dependency on libnuma
+  constexpr int kMPolPreferred = 1;
+  constexpr unsigned kMPolMFMove = 1U << 1;
+  constexpr size_t kMaskBits = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+  std::vector<unsigned long> mask(node / kMaskBits + 1, 0);  // NOLINT(runtime/int)
+  mask[node / kMaskBits] |= 1UL << (node % kMaskBits);
+  // the kernel expects maxnode to count one past the highest bit
+  const size_t maxnode = mask.size() * kMaskBits + 1;
+  // mbind works on whole pages; MPOL_MF_MOVE migrates pages a reused buffer already touched
+  const size_t len = RoundToPage(size);
+  if (syscall(SYS_mbind, ptr, len, kMPolPreferred, mask.data(), maxnode, kMPolMFMove) != 0) {
+    static std::atomic<bool> warned{false};
+    if (!warned.exchange(true)) {
+      LOG(WARNING) << "mbind to NUMA node " << node << " failed, falling back to first touch.";
+    }
+  }
+#endif  // defined(__linux__) && defined(SYS_mbind)
+}
+
+}  // namespace numa
+}  // namespace common
+}  // namespace mxnet
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * Copyright (c) 2019 by Contributors
+ * \file numa.h
+ * \brief NUMA topology discovery, thread pinning and memory placement for CPU contexts.
+ *
+ * NUMA mode is off by default and is enabled with MXNET_CPU_NUMA_AWARE=1 on Linux hosts
+ * with more than one memory node. When enabled, a cpu(dev_id) context maps to the
+ * node dev_id % num_nodes(): its engine workers and their OpenMP teams are pinned to
+ * the cores of that node and its memory is placed on that node.
+ */
+#ifndef MXNET_COMMON_NUMA_H_
+#define MXNET_COMMON_NUMA_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace common {
+namespace numa {
+
+/*!
+ * \brief Parse a sysfs cpu list such as "0-17,36-53"
+ */
+std::vector<int> ParseCPUList(const std::string& list);
+
+/*! \brief NUMA topology of the host, read once from sysfs */
+class NUMATopology {
+ public:
+  /*!
+   * \brief Get the topology singleton
+   */
+  static const NUMATopology* Get();
+  /*!
+   * \brief Whether NUMA-aware placement is enabled
+   */
+  bool enabled() const { return enabled_; }
+  /*!
+   * \brief Number of memory nodes found on the host (1 if unknown)
+   */
+  int num_nodes() const { return static_cast<int>(node_cpus_.size()); }
+  /*!
+   * \brief Node that a cpu(dev_id) context is placed on
+   */
+  int NodeOfDevice(int dev_id) const {
+    return dev_id < 0 ? 0 : dev_id % num_nodes();
+  }
+  /*!
+   * \brief Logical cpus of a node
+   */
+  const std::vector<int>& cpus(int node) const { return node_cpus_[node]; }
+  /*!
+   * \brief Restrict the calling thread to the cpus of a node
+   * \return whether the affinity could be set
+   */
+  bool BindCurrentThread(int node) const;
+  /*!
+   * \brief Ask the kernel to place the pages of [ptr, ptr + size) on a node.
+   *  ptr must be page aligned and size is rounded up to whole pages, so the caller
+   *  must own the rounded range. Pages already touched are migrated to the node.
+   */
+  void BindMemory(void* ptr, size_t size, int node) const;
+  /*!
+   * \brief System page size
+   */
+  size_t page_size() const { return page_size_; }
+  /*!
+   * \brief Round a size up to a multiple of the page size
+   */
+  size_t RoundToPage(size_t size) const {
+    return (size + page_size_ - 1) / page_size_ * page_size_;
+  }
+
+ private:
+  NUMATopology();
+  /*! \brief whether MXNET_CPU_NUMA_AWARE is set and the host has several nodes */
+  bool enabled_{false};
+  /*! \brief system page size */
+  size_t page_size_{4096};
+  /*! \brief logical cpus of each node */
+  std::vector<std::vector<int>> node_cpus_;
+};
+
+}  // namespace numa
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_NUMA_H_
@@ -24,6 +24,7 @@
 #define MXNET_COMMON_OBJECT_POOL_H_
 #include <dmlc/logging.h>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -32,6 +33,10 @@ namespace mxnet {
 namespace common {
 /*!
  * \brief Object pool for fast allocation and deallocation.
+ *
+ *  Each thread keeps a private free list, so New and Delete do not synchronize.
+ *  Objects move between the private lists and the shared free list in batches,
+ *  and a thread returns its private list to the shared one when it exits.
  */
 template <typename T>
 class ObjectPool {
@@ -87,7 +92,26 @@ class ObjectPool {
    * Currently defined to be 4KB.
    */
   constexpr static std::size_t kPageSize = 1 << 12;
-  /*! \brief internal mutex */
+  /*!
+   * \brief Number of objects moved at once between a thread cache and the free list.
+   */
+  constexpr static std::size_t kBatchSize =
+      kPageSize / sizeof(LinkedList) > 0 ? kPageSize / sizeof(LinkedList) : 1;
+  /*!
+   * \brief Free list private to a thread.
+   */
+  struct ThreadCache {
+    /*! \brief head of the private free list */
+    LinkedList* head{nullptr};
+    /*! \brief number of objects in the private free list */
+    std::size_t size{0};
+    /*! \brief keeps the pool alive until the cache is returned at thread exit */
+    std::shared_ptr<ObjectPool> pool;
+    ~ThreadCache() {
+      if (head != nullptr) pool->Flush(this, size);
+    }
+  };
+  /*! \brief internal mutex, protects head_ and allocated_ */
   std::mutex m_;
   /*!
    * \brief Head of free list.
@@ -107,6 +131,19 @@ class ObjectPool {
    * This function is not protected and must be called with caution.
    */
   void AllocateChunk();
+  /*!
+   * \brief Get the free list of the calling thread.
+   * \return The thread cache, or nullptr if thread local storage is not available.
+   */
+  static ThreadCache* LocalCache();
+  /*!
+   * \brief Move kBatchSize objects from the shared free list to a thread cache.
+   */
+  void Refill(ThreadCache* cache);
+  /*!
+   * \brief Move n objects from a thread cache to the shared free list.
+   */
+  void Flush(ThreadCache* cache, std::size_t n);
   DISALLOW_COPY_AND_ASSIGN(ObjectPool);
 };  // class ObjectPool
 
@@ -142,9 +179,17 @@ template <typename T>
 template <typename... Args>
 T* ObjectPool<T>::New(Args&&... args) {
   LinkedList* ret;
-  {
+  ThreadCache* cache = LocalCache();
+  if (cache != nullptr) {
+    if (cache->head == nullptr) {
+      Refill(cache);
+    }
+    ret = cache->head;
+    cache->head = ret->next;
+    --cache->size;
+  } else {
     std::lock_guard<std::mutex> lock{m_};
-    if (head_->next == nullptr) {
+    if (head_ == nullptr || head_->next == nullptr) {
       AllocateChunk();
     }
     ret = head_;
@@ -157,7 +202,14 @@ template <typename T>
 void ObjectPool<T>::Delete(T* ptr) {
   ptr->~T();
   auto linked_list_ptr = reinterpret_cast<LinkedList*>(ptr);
-  {
+  ThreadCache* cache = LocalCache();
+  if (cache != nullptr) {
+    linked_list_ptr->next = cache->head;
+    cache->head = linked_list_ptr;
+    if (++cache->size >= 2 * kBatchSize) {
+      Flush(cache, kBatchSize);
+    }
+  } else {
     std::lock_guard<std::mutex> lock{m_};
     linked_list_ptr->next = head_;
     head_ = linked_list_ptr;
@@ -166,7 +218,8 @@ void ObjectPool<T>::Delete(T* ptr) {
 
 template <typename T>
 ObjectPool<T>* ObjectPool<T>::Get() {
-  return _GetSharedRef().get();
+  static ObjectPool<T>* inst = _GetSharedRef().get();
+  return inst;
 }
 
 template <typename T>
@@ -204,6 +257,48 @@ void ObjectPool<T>::AllocateChunk() {
   head_ = new_chunk;
 }
 
+template <typename T>
+typename ObjectPool<T>::ThreadCache* ObjectPool<T>::LocalCache() {
+#if DMLC_CXX11_THREAD_LOCAL
+  static thread_local ThreadCache cache;
+  if (cache.pool == nullptr) {
+    cache.pool = _GetSharedRef();
+  }
+  return &cache;
+#else
+  return nullptr;
+#endif
+}
+
+template <typename T>
+void ObjectPool<T>::Refill(ThreadCache* cache) {
+  std::lock_guard<std::mutex> lock{m_};
+  for (std::size_t i = 0; i < kBatchSize; ++i) {
+    if (head_ == nullptr) {
+      AllocateChunk();
+    }
+    LinkedList* ptr = head_;
+    head_ = head_->next;
+    ptr->next = cache->head;
+    cache->head = ptr;
+  }
+  cache->size += kBatchSize;
+}
+
+template <typename T>
+void ObjectPool<T>::Flush(ThreadCache* cache, std::size_t n) {
+  LinkedList* first = cache->head;
+  LinkedList* last = first;
+  for (std::size_t i = 1; i < n; ++i) {
+    last = last->next;
+  }
+  cache->head = last->next;
+  cache->size -= n;
+  std::lock_guard<std::mutex> lock{m_};
+  last->next = head_;
+  head_ = first;
+}
+
 template <typename T>
 template <typename... Args>
 T* ObjectPoolAllocatable<T>::New(Args&&... args) {
@@ -19,8 +19,10 @@
 #include <dmlc/omp.h>
 #include <dmlc/base.h>
 #include <dmlc/parameter.h>
+#include <algorithm>
 #include <climits>
 #include "./openmp.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace engine {
@@ -61,14 +63,40 @@ OpenMP::OpenMP()
 #endif
 }
 
-void OpenMP::on_start_worker_thread(bool use_omp) {
+void OpenMP::on_start_worker_thread(bool use_omp, int numa_node) {
+  const common::numa::NUMATopology* numa = common::numa::NUMATopology::Get();
+  if (numa_node >= 0 && !numa->BindCurrentThread(numa_node)) {
+    numa_node = -1;
+  }
 #ifdef _OPENMP
+  if (numa_node >= 0 && use_omp) {
+    int nthreads = omp_get_max_threads();
+    if (!omp_num_threads_set_in_environment_) {
+      nthreads = std::max(1, GetRecommendedOMPThreadCount(true) / numa->num_nodes());
+      omp_set_num_threads(nthreads);
+    }
+    // pin the team owned by this thread, which some runtimes create before our affinity
+    // was set
+    #pragma omp parallel num_threads(nthreads)
+    {
+      numa->BindCurrentThread(numa_node);
+    }
+    return;
+  }
   if (!omp_num_threads_set_in_environment_) {
     omp_set_num_threads(use_omp ? GetRecommendedOMPThreadCount(true) : 1);
   }
 #endif
 }
 
+void OpenMP::set_worker_thread_count(int nthreads) {
+#ifdef _OPENMP
+  if (!omp_num_threads_set_in_environment_) {
+    omp_set_num_threads(std::max(1, nthreads));
+  }
+#endif
+}
+
 void OpenMP::set_reserve_cores(int cores) {
   CHECK_GE(cores, 0);
   reserve_cores_ = cores;
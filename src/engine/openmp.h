@@ -71,8 +71,17 @@ class OpenMP {
    * \brief Call at the beginning of a worker thread's life.  This will set the omp_num_threads
    *        for omp regions created by this thread
    * \param use_omp true if this thread plans to utilize parallel omp regions
+   * \param numa_node if not negative, pin this thread and its omp team to the cores of
+   *        this NUMA node and size the team to the node
    */
-  void on_start_worker_thread(bool use_omp);
+  void on_start_worker_thread(bool use_omp, int numa_node = -1);
+
+  /*!
+   * \brief Set the number of threads of omp regions created by this thread from now on.
+   *        Ignored if OMP_NUM_THREADS is set in the environment
+   * \param nthreads Number of threads, at least 1
+   */
+  void set_worker_thread_count(int nthreads);
 
   /*!
    * \brief Get the OpenMP object's singleton pointer
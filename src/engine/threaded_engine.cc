@@ -27,7 +27,10 @@
 #include <cassert>
 #include <algorithm>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include "./threaded_engine.h"
 #include "../common/cuda_utils.h"
@@ -49,29 +52,42 @@ ThreadedVar::ThreadedVar(VersionedVarBlock* head) : head_{head} {
 }
 
 inline void ThreadedVar::AppendReadDependency(OprBlock* opr_block) {
-  std::lock_guard<std::mutex> lock{mutex_};
-  if (pending_write_ == nullptr) {
+  // fast path: no pending write, only the read count changes.
+  uint64_t state = state_.load(std::memory_order_acquire);
+  while (!HasPendingWrite(state)) {
     // invariant: is_ready_to_read()
-    CHECK_GE(num_pending_reads_, 0);
+    CHECK_GE(NumPendingReads(state), 0);
     // STATE CHANGE
-    ++num_pending_reads_;
-    // decrease wait counter
-    opr_block->decr_wait();
-  } else {
-    auto&& new_var_block = VersionedVarBlock::New();
-    assert(head_->next == nullptr);
-    assert(head_->trigger == nullptr);
-    assert(head_->write == false);
-    // append things to next.
-    head_->next = new_var_block;
-    head_->trigger = opr_block;
-    head_ = new_var_block;
+    if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel)) {
+      // decrease wait counter
+      opr_block->decr_wait();
+      return;
+    }
   }
+  auto&& new_var_block = VersionedVarBlock::New();
+  std::lock_guard<dmlc::Spinlock> lock{lock_};
+  // the pending write bit is stable under the lock, but it may have been
+  // cleared by CompleteWriteDependency since it was read above.
+  state = state_.load(std::memory_order_acquire);
+  while (!HasPendingWrite(state)) {
+    if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel)) {
+      VersionedVarBlock::Delete(new_var_block);
+      opr_block->decr_wait();
+      return;
+    }
+  }
+  assert(head_->next == nullptr);
+  assert(head_->trigger == nullptr);
+  assert(head_->write == false);
+  // append things to next.
+  head_->next = new_var_block;
+  head_->trigger = opr_block;
+  head_ = new_var_block;
 }
 
 inline void ThreadedVar::AppendWriteDependency(OprBlock* opr_block) {
   auto&& new_var_block = VersionedVarBlock::New();
-  std::lock_guard<std::mutex> lock{mutex_};
+  std::lock_guard<dmlc::Spinlock> lock{lock_};
   // invariant.
   assert(head_->next == nullptr);
   assert(head_->trigger == nullptr);
@@ -85,32 +101,50 @@ inline void ThreadedVar::AppendWriteDependency(OprBlock* opr_block) {
   if (pending_write_ == nullptr) {
     // invariant: is_ready_to_read()
     pending_write_ = head_;
-    CHECK_GE(num_pending_reads_, 0);
-    if (num_pending_reads_ == 0) {
+    // reads may still be appended or completed concurrently until the bit is set.
+    uint64_t state = state_.load(std::memory_order_acquire);
+    uint64_t next;
+    do {
+      CHECK(!HasPendingWrite(state));
+      CHECK_GE(NumPendingReads(state), 0);
+      next = MakeState(NumPendingReads(state) == 0 ? kWriteTriggered : NumPendingReads(state),
+                       true);
+    } while (!state_.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+    if (NumPendingReads(state) == 0) {
       // STATE CHANGE
       opr_block->decr_wait();
-      num_pending_reads_ = kWriteTriggered;
     }
   } else {
-    CHECK_NE(num_pending_reads_, 0);
+    CHECK_NE(NumPendingReads(state_.load(std::memory_order_relaxed)), 0);
   }
   head_ = new_var_block;
 }
 
 template <typename Dispatcher>
 inline void ThreadedVar::CompleteReadDependency(Dispatcher dispatcher) {
+  // fast path: no pending write, only the read count changes.
+  uint64_t state = state_.load(std::memory_order_acquire);
+  while (!HasPendingWrite(state)) {
+    CHECK_GT(NumPendingReads(state), 0);
+    if (state_.compare_exchange_weak(state, state - 1, std::memory_order_acq_rel)) {
+      return;
+    }
+  }
   OprBlock *trigger = nullptr;
   {
     // this is lock scope
-    std::lock_guard<std::mutex> lock{mutex_};
-    CHECK_GT(num_pending_reads_, 0);
-
-    if (--num_pending_reads_ == 0) {
-      if (pending_write_ != nullptr) {
-        // STATE CHANGE
-        trigger = pending_write_->trigger;
-        num_pending_reads_ = kWriteTriggered;
-      }
+    // The pending write bit cannot be cleared before this read completes,
+    // so from here on the state word only changes under the lock.
+    std::lock_guard<dmlc::Spinlock> lock{lock_};
+    state = state_.load(std::memory_order_acquire);
+    CHECK_GT(NumPendingReads(state), 0);
+
+    if (NumPendingReads(state) == 1) {
+      // STATE CHANGE
+      trigger = pending_write_->trigger;
+      state_.store(MakeState(kWriteTriggered, true), std::memory_order_release);
+    } else {
+      state_.store(state - 1, std::memory_order_release);
     }
   }
   if (trigger != nullptr && trigger->decr_wait() == 0) {
@@ -124,11 +158,11 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
   VersionedVarBlock *old_pending_write, *end_of_read_chain;
   OprBlock* trigger_write = nullptr;
   {
-    std::lock_guard<std::mutex> lock{mutex_};
+    std::lock_guard<dmlc::Spinlock> lock{lock_};
     // invariants
     assert(head_->next == nullptr);
     assert(pending_write_ != nullptr);
-    CHECK_EQ(num_pending_reads_, kWriteTriggered);
+    CHECK_EQ(state_.load(std::memory_order_relaxed), MakeState(kWriteTriggered, true));
 
     // increment version number
     ++version_;
@@ -146,27 +180,29 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
     // search for chains to trigger
     end_of_read_chain = old_pending_write->next;
     // reset to 0 pending reads
-    num_pending_reads_ = 0;
+    int num_pending_reads = 0;
     while (end_of_read_chain != head_ &&
            end_of_read_chain->write == false) {
-      ++num_pending_reads_;
+      ++num_pending_reads;
       end_of_read_chain = end_of_read_chain->next;
     }
     if (end_of_read_chain == head_) {
       pending_write_ = nullptr;
+      state_.store(MakeState(num_pending_reads, false), std::memory_order_release);
     } else {
       // check if there is pending reads, if not trigger write
       assert(end_of_read_chain->write == true);
       pending_write_ = end_of_read_chain;
-      if (num_pending_reads_ == 0) {
+      if (num_pending_reads == 0) {
         // mark write as already activated in this var
-        num_pending_reads_ = kWriteTriggered;
+        num_pending_reads = kWriteTriggered;
         trigger_write = end_of_read_chain->trigger;
       }
+      state_.store(MakeState(num_pending_reads, true), std::memory_order_release);
     }
   }
   // This is outside of lock scope
-  // Be very carful, pending_write_ and num_pending_reads_
+  // Be very carful, pending_write_ and the state word
   // can change now, do not rely on these two variables.
   // The linked list \in [old_pending_write, end_of_read_chain)
   // is already detached from this Var.
@@ -190,17 +226,16 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
 }
 
 inline void ThreadedVar::SetToDelete() {
-  std::lock_guard<std::mutex> lock{mutex_};
+  std::lock_guard<dmlc::Spinlock> lock{lock_};
   to_delete_ = true;
 }
 
 inline bool ThreadedVar::ready_to_read() {
-  std::lock_guard<std::mutex> lock{mutex_};
   return this->is_ready_to_read();
 }
 
 inline size_t ThreadedVar::version() {
-  std::lock_guard<std::mutex> lock{mutex_};
+  std::lock_guard<dmlc::Spinlock> lock{lock_};
   return this->version_;
 }
 
@@ -355,7 +390,38 @@ void ThreadedEngine::PushSync(SyncFn exec_fn, Context exec_ctx,
 
   const BulkStatus& bulk_status = *BulkStatusStore::Get();
   if (bulk_status.count && exec_ctx != bulk_status.ctx) BulkFlush();
-  BulkAppend(exec_fn, exec_ctx, const_vars, mutable_vars);
+  BulkAppend(exec_fn, exec_ctx, const_vars, mutable_vars, opr_name);
+}
+
+ThreadedEngine::BulkOpCost* ThreadedEngine::GetBulkOpCost(const char* name) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::unique_ptr<BulkOpCost>> costs;
+  std::lock_guard<std::mutex> lock{mutex};
+  auto& cost = costs[name ? name : ""];
+  if (!cost) cost.reset(new BulkOpCost());
+  return cost.get();
+}
+
+void ThreadedEngine::BulkExecute(RunContext ctx, const std::vector<BulkOp>& functions) {
+  profiler::Profiler* profiler = profiler::Profiler::Get();
+  const bool profiling = profiler && profiler->IsProfiling(profiler::Profiler::kImperative);
+  for (const auto& op : functions) {
+    const uint64_t start = op.cost ? NowInNanosec() : 0;
+    if (profiling && op.name) {
+      profiler::ProfileOperator opr_profile(op.name, nullptr);
+      opr_profile.start(ctx.ctx.dev_type, ctx.ctx.dev_id);
+      op.fn(ctx);
+      opr_profile.stop();
+    } else {
+      op.fn(ctx);
+    }
+    if (op.cost) {
+      // exponential moving average, the first measurement is taken as is
+      const uint64_t elapsed = NowInNanosec() - start;
+      const uint64_t prev = op.cost->ns.load(std::memory_order_relaxed);
+      op.cost->ns.store(prev ? (3 * prev + elapsed) / 4 : elapsed, std::memory_order_relaxed);
+    }
+  }
 }
 
 void ThreadedEngine::DeleteVariable(SyncFn delete_fn,
@@ -28,16 +28,19 @@
 #define MXNET_ENGINE_THREADED_ENGINE_H_
 
 #include <dmlc/base.h>
+#include <dmlc/concurrency.h>
 #include <dmlc/logging.h>
 #include <dmlc/omp.h>
 #include <vector>
 #include <functional>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <utility>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include "./engine_impl.h"
 #include "../profiler/profiler.h"
 #include "./openmp.h"
@@ -111,6 +114,11 @@ struct VersionedVarBlock
 /*!
  * \brief Variable implementation.
  *  Each ThreadedVar is a linked list(queue) of operations to be performed.
+ *
+ *  The number of pending reads and whether a write is pending are packed in one
+ *  atomic word, so that reads scheduled and completed while no write is pending,
+ *  by far the most common case, only need a compare-and-swap. Everything touching
+ *  the queue itself is serialized by a spinlock.
  */
 class ThreadedVar final
     : public Var, public common::ObjectPoolAllocatable<ThreadedVar> {
@@ -180,15 +188,20 @@ class ThreadedVar final
   std::shared_ptr<std::exception_ptr> var_exception;
 
  private:
-  // TODO(hotpxl) change this to spinlock for faster runtime
   // TODO(hotpxl) consider rename head
-  /*! \brief internal mutex of the ThreadedVar */
-  std::mutex mutex_;
   /*!
-   * \brief number of pending reads operation in the variable.
-   *  will be marked as -1 when there is a already triggered pending write.
+   * \brief internal lock of the ThreadedVar, protects the queue, version_ and to_delete_.
+   *  Critical sections are a handful of pointer updates, so a spinlock is used.
+   */
+  dmlc::Spinlock lock_;
+  /*!
+   * \brief number of pending reads operation in the variable (low 32 bits),
+   *  and whether there is a pending write (bit kPendingWriteBit).
+   *  The read count will be marked as -1 when there is a already triggered pending write.
+   *  The pending write bit only changes while lock_ is held; when it is clear,
+   *  the read count can be changed by CAS without taking the lock.
    */
-  int num_pending_reads_{0};
+  std::atomic<uint64_t> state_{0};
   /*!
    * \brief Points to the last VersionedVarBlock in the queue.
    *  head_ always points to a empty VersionedVarBlock.
@@ -208,14 +221,28 @@ class ThreadedVar final
    * \brief If true, delete after operation completes.
    */
   bool to_delete_{false};
-  /*! \brief special const on num_pending_reads_ to mark write being triggered */
+  /*! \brief special const on the read count to mark write being triggered */
   static constexpr int kWriteTriggered = -1;
+  /*! \brief bit of state_ set when pending_write_ is not nullptr */
+  static constexpr uint64_t kPendingWriteBit = uint64_t{1} << 32;
+  /*! \return state word made of a read count and the pending write bit. */
+  static inline uint64_t MakeState(int num_pending_reads, bool pending_write) {
+    return static_cast<uint32_t>(num_pending_reads) | (pending_write ? kPendingWriteBit : 0);
+  }
+  /*! \return number of pending reads of a state word. */
+  static inline int NumPendingReads(uint64_t state) {
+    return static_cast<int32_t>(static_cast<uint32_t>(state));
+  }
+  /*! \return whether a state word has a pending write. */
+  static inline bool HasPendingWrite(uint64_t state) {
+    return (state & kPendingWriteBit) != 0;
+  }
   /*!
    * \brief derived invariant of ready to ready, without lock.
    * \return whether the current variable is ready to read.
    */
   inline bool is_ready_to_read() const {
-    return pending_write_ == nullptr;
+    return !HasPendingWrite(state_.load(std::memory_order_acquire));
   }
 };  // struct ThreadedVar
 
@@ -300,6 +327,7 @@ class ThreadedEngine : public Engine {
 
   ThreadedEngine() {
     engine_info_ = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    bulk_target_ns_ = dmlc::GetEnv("MXNET_ENGINE_BULK_TARGET_US", 0) * 1000;
 
     objpool_opr_ref_    = common::ObjectPool<ThreadedOpr>::_GetSharedRef();
     objpool_blk_ref_    = common::ObjectPool<OprBlock>::_GetSharedRef();
@@ -395,8 +423,7 @@ class ThreadedEngine : public Engine {
   }
 
   int bulk_size() const override {
-    const profiler::Profiler *prof = profiler::Profiler::Get();
-    return (prof && prof->AggregateRunning()) ? 0 :  BulkStatusStore::Get()->bulk_size;
+    return BulkStatusStore::Get()->bulk_size;
   }
 
   int set_bulk_size(int bulk_size) override {
@@ -404,27 +431,47 @@ class ThreadedEngine : public Engine {
     std::swap(bulk_status.bulk_size, bulk_size);
     if (bulk_status.count >= bulk_status.bulk_size) BulkFlush();
     if (!bulk_status.functions) {
-      bulk_status.functions.reset(new std::vector<SyncFn>());
+      bulk_status.functions.reset(new std::vector<BulkOp>());
     }
     bulk_status.functions->reserve(bulk_size);
     return bulk_size;
   }
 
  private:
+  /*! \brief running estimate of the duration of an operator executed in bulk */
+  struct BulkOpCost {
+    /*! \brief moving average of the duration, in nanoseconds */
+    std::atomic<uint64_t> ns{0};
+  };
+  /*! \brief an operator appended to a bulk */
+  struct BulkOp {
+    /*! \brief the function to run */
+    SyncFn fn;
+    /*! \brief name of the operator, used for profiling */
+    const char* name;
+    /*! \brief duration estimate to update, nullptr if bulk sizes are not adaptive */
+    BulkOpCost* cost;
+  };
   /*! \brief structure for holding bulk execution status */
   struct BulkStatus {
     /*! \brief maximum number of ops per bulk */
     int bulk_size = 0;
     /*! \brief current number of ops in bulk */
     int count = 0;
+    /*! \brief estimated duration of the ops in the current bulk, in nanoseconds */
+    uint64_t estimated_ns = 0;
+    /*! \brief time the first op of the current bulk was appended, in nanoseconds */
+    uint64_t start_ns = 0;
     /*! \brief context of current ops */
     Context ctx;
     /*! \brief current op functions */
-    std::shared_ptr<std::vector<SyncFn>> functions;
+    std::shared_ptr<std::vector<BulkOp>> functions;
     /*! \brief constant variables */
     std::vector<VarHandle> const_vars;
     /*! \brief mutable variables */
     std::vector<VarHandle> mutable_vars;
+    /*! \brief duration estimates already looked up by this thread */
+    std::unordered_map<const char*, BulkOpCost*> costs;
   };
   /*! thread local store for bulk */
   typedef dmlc::ThreadLocalStore<BulkStatus> BulkStatusStore;
@@ -471,17 +518,44 @@ class ThreadedEngine : public Engine {
 
   static void OnCompleteStatic(Engine *engine, void *threaded_opr,
                                const dmlc::Error* error);
-  /*! \brief append an operator to bulk */
+  /*! \brief current time in nanoseconds, for bulk segment sizing */
+  static inline uint64_t NowInNanosec() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  /*!
+   * \brief get the process wide duration estimate of an operator
+   * \param name name of the operator, may be nullptr
+   */
+  static BulkOpCost* GetBulkOpCost(const char* name);
+  /*!
+   * \brief append an operator to bulk
+   *
+   *  When MXNET_ENGINE_BULK_TARGET_US is set, the bulk is also flushed once the estimated
+   *  duration of its ops reaches the target, or once it has been open for that long.
+   */
   inline void BulkAppend(SyncFn exec_fn, Context exec_ctx,
                          std::vector<VarHandle> const& const_vars,
-                         std::vector<VarHandle> const& mutable_vars) {
+                         std::vector<VarHandle> const& mutable_vars,
+                         const char* opr_name) {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     if (!bulk_status.functions) {
-      bulk_status.functions.reset(new std::vector<SyncFn>());
+      bulk_status.functions.reset(new std::vector<BulkOp>());
     }
-    bulk_status.functions->push_back(exec_fn);
+    BulkOpCost* cost = nullptr;
+    uint64_t now = 0;
+    if (bulk_target_ns_) {
+      auto it = bulk_status.costs.find(opr_name);
+      if (it == bulk_status.costs.end()) {
+        it = bulk_status.costs.emplace(opr_name, GetBulkOpCost(opr_name)).first;
+      }
+      cost = it->second;
+      now = NowInNanosec();
+    }
+    bulk_status.functions->push_back(BulkOp{exec_fn, opr_name, cost});
     if (!bulk_status.count) {
       bulk_status.ctx = exec_ctx;
+      bulk_status.start_ns = now;
     }
 
     ++bulk_status.count;
@@ -490,20 +564,34 @@ class ThreadedEngine : public Engine {
     bulk_status.mutable_vars.insert(
         bulk_status.mutable_vars.end(), mutable_vars.begin(), mutable_vars.end());
 
+    if (cost) {
+      bulk_status.estimated_ns += cost->ns.load(std::memory_order_relaxed);
+      if (bulk_status.estimated_ns >= bulk_target_ns_ ||
+          now - bulk_status.start_ns >= bulk_target_ns_) {
+        BulkFlush();
+        return;
+      }
+    }
     if (bulk_status.count >= bulk_status.bulk_size) BulkFlush();
   }
+  /*!
+   * \brief run the ops of a bulk
+   *
+   *  Per-op profiling events are recorded when the profiler is running, and the duration
+   *  estimates are updated when bulk sizes are adaptive.
+   */
+  static void BulkExecute(RunContext ctx, const std::vector<BulkOp>& functions);
   /*! \brief flush current bulk to execution */
   inline void BulkFlush() {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     if (!bulk_status.count) return;
     bulk_status.count = 0;
     DeduplicateVarHandle(&bulk_status.const_vars, &bulk_status.mutable_vars);
+    bulk_status.estimated_ns = 0;
     auto functions = bulk_status.functions;
     this->PushAsync([functions](RunContext ctx, CallbackOnComplete on_complete) {
         ctx.is_bulk = true;
-        for (auto& fn : *functions) {
-          fn(ctx);
-        }
+        BulkExecute(ctx, *functions);
         ctx.is_bulk = false;
         bool is_gpu = ctx.ctx.dev_mask() == gpu::kDevMask;
         if (is_gpu) {
@@ -513,7 +601,7 @@ class ThreadedEngine : public Engine {
       }, bulk_status.ctx, bulk_status.const_vars, bulk_status.mutable_vars,
       FnProperty::kNormal, 0, "ImperativeBulk");
 
-    bulk_status.functions.reset(new std::vector<SyncFn>());
+    bulk_status.functions.reset(new std::vector<BulkOp>());
     bulk_status.functions->reserve(bulk_status.bulk_size);
     bulk_status.const_vars.clear();
     bulk_status.mutable_vars.clear();
@@ -528,6 +616,8 @@ class ThreadedEngine : public Engine {
   std::atomic<bool> shutdown_phase_{false};
   /*!\brief show more information from engine actions */
   bool engine_info_{false};
+  /*! \brief target duration of a bulk in nanoseconds, 0 if bulk sizes are not adaptive */
+  uint64_t bulk_target_ns_{0};
   /*! \brief debug information about wait for var. */
   std::atomic<ThreadedVar*> debug_wait_var_{nullptr};
   /*! \brief debug information about wait for var. */
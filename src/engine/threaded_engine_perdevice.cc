@@ -28,9 +28,18 @@
 #include <dmlc/parameter.h>
 #include <dmlc/concurrency.h>
 #include <dmlc/thread_group.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "./threaded_engine.h"
 #include "./thread_pool.h"
+#include "./work_stealing_deque.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -42,6 +51,8 @@ namespace engine {
  *  - Use fixed amount of threads for each device.
  *  - Use special threads for copy operations.
  *  - Each stream is allocated and bound to each of the thread.
+ *  - Optionally, CPU operations are scheduled on per-worker work-stealing deques, and
+ *    the OMP threads are shared among the operations running concurrently.
  */
 class ThreadedEnginePerDevice : public ThreadedEngine {
  public:
@@ -51,7 +62,8 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   static auto constexpr kPriorityQueue = kPriority;
   static auto constexpr kWorkerQueue = kFIFO;
 
-  ThreadedEnginePerDevice() noexcept(false) {
+  explicit ThreadedEnginePerDevice(bool cpu_work_stealing = false) noexcept(false)
+    : cpu_work_stealing_(cpu_work_stealing) {
     this->Start();
   }
   ~ThreadedEnginePerDevice() noexcept(false) {
@@ -64,6 +76,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     gpu_priority_workers_.Clear();
     gpu_copy_workers_.Clear();
     cpu_normal_workers_.Clear();
+    cpu_stealing_workers_.Clear();
     cpu_priority_worker_.reset(nullptr);
   }
 
@@ -76,7 +89,8 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   void Start() override {
     if (is_worker_) return;
     gpu_worker_nthreads_ = common::GetNumThreadsPerGPU();
-    cpu_worker_nthreads_ = dmlc::GetEnv("MXNET_CPU_WORKER_NTHREADS", 1);
+    // independent operations can only run concurrently with several workers
+    cpu_worker_nthreads_ = dmlc::GetEnv("MXNET_CPU_WORKER_NTHREADS", cpu_work_stealing_ ? 4 : 1);
     gpu_copy_nthreads_ = dmlc::GetEnv("MXNET_GPU_COPY_NTHREADS", 2);
     // create CPU task
     int cpu_priority_nthreads = dmlc::GetEnv("MXNET_CPU_PRIORITY_NTHREADS", 4);
@@ -84,7 +98,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     cpu_priority_worker_->pool.reset(new ThreadPool(
         cpu_priority_nthreads,
         [this](std::shared_ptr<dmlc::ManualEvent> ready_event) {
-          this->CPUWorker(Context(), cpu_priority_worker_.get(), ready_event);
+          this->CPUWorker(Context(), cpu_priority_worker_.get(), ready_event, -1);
         }, true));
     // GPU tasks will be created lazily
   }
@@ -105,15 +119,34 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
         // CPU execution.
         if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
           cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
+        } else if (cpu_work_stealing_) {
+          const int nthread = cpu_worker_nthreads_;
+          auto ptr = cpu_stealing_workers_.Get(ctx.dev_id, [this, ctx, nthread]() {
+              auto blk = new WorkStealingBlock(nthread);
+              const common::numa::NUMATopology* numa = common::numa::NUMATopology::Get();
+              const int numa_node = numa->enabled() ? numa->NodeOfDevice(ctx.dev_id) : -1;
+              auto next_index = std::make_shared<std::atomic<int>>(0);
+              blk->pool.reset(new ThreadPool(nthread,
+                  [this, ctx, blk, numa_node, next_index]
+                    (std::shared_ptr<dmlc::ManualEvent> ready_event) {
+                    this->CPUStealingWorker(ctx, blk, (*next_index)++, ready_event, numa_node);
+                  }, true));
+            return blk;
+          });
+          if (ptr) {
+            ptr->Push(opr_block);
+          }
         } else {
           int dev_id = ctx.dev_id;
           int nthread = cpu_worker_nthreads_;
           auto ptr =
           cpu_normal_workers_.Get(dev_id, [this, ctx, nthread]() {
               auto blk = new ThreadWorkerBlock<kWorkerQueue>();
+              const common::numa::NUMATopology* numa = common::numa::NUMATopology::Get();
+              const int numa_node = numa->enabled() ? numa->NodeOfDevice(ctx.dev_id) : -1;
               blk->pool.reset(new ThreadPool(nthread,
-                  [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
-                    this->CPUWorker(ctx, blk, ready_event);
+                  [this, ctx, blk, numa_node](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+                    this->CPUWorker(ctx, blk, ready_event, numa_node);
                   }, true));
             return blk;
           });
@@ -212,8 +245,101 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ~ThreadWorkerBlock() noexcept(false) {}
   };
 
+  /*!
+   * \brief Work-stealing task block of the CPU workers of one device. Each worker owns a
+   *  lock-free deque: operations pushed by a worker, typically the ones its last operation
+   *  made ready, go to the bottom of its own deque. Operations pushed from other threads
+   *  go to a shared injection queue. Idle workers take from their deque, then from the
+   *  injection queue, then steal from the top of the others' deques.
+   */
+  struct WorkStealingBlock {
+    explicit WorkStealingBlock(int nthreads) {
+      for (int i = 0; i < nthreads; ++i) {
+        deques.emplace_back(new WorkStealingDeque<OprBlock*>());
+      }
+    }
+    ~WorkStealingBlock() noexcept(false) {}
+
+    void Push(OprBlock *opr_block) {
+      if (current_stealing_block_ == this) {
+        deques[current_stealing_index_]->PushBottom(opr_block);
+      } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        injected.push_back(opr_block);
+      }
+      // pairs with the sleeping/pending check in Pop: either the worker going to sleep
+      // sees the new operation, or we see the sleeping worker and wake it up
+      pending.fetch_add(1, std::memory_order_seq_cst);
+      if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        cv.notify_one();
+      }
+    }
+
+    bool Pop(int index, OprBlock **opr_block) {
+      while (true) {
+        if (deques[index]->PopBottom(opr_block) || PopInjected(opr_block) ||
+            Steal(index, opr_block)) {
+          pending.fetch_sub(1, std::memory_order_seq_cst);
+          return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        while (!killed && pending.load(std::memory_order_seq_cst) == 0) {
+          cv.wait(lock);
+        }
+        sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        if (killed) return false;
+      }
+    }
+
+    bool PopInjected(OprBlock **opr_block) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (injected.empty()) return false;
+      *opr_block = injected.front();
+      injected.pop_front();
+      return true;
+    }
+
+    bool Steal(int index, OprBlock **opr_block) {
+      const int n = static_cast<int>(deques.size());
+      for (int i = 1; i < n; ++i) {
+        if (deques[(index + i) % n]->Steal(opr_block)) return true;
+      }
+      return false;
+    }
+
+    void SignalForKill() {
+      std::lock_guard<std::mutex> lock(mutex);
+      killed = true;
+      cv.notify_all();
+    }
+
+    // one deque per worker
+    std::vector<std::unique_ptr<WorkStealingDeque<OprBlock*>>> deques;
+    // operations pushed from threads that are not workers of this block
+    std::deque<OprBlock*> injected;
+    std::mutex mutex;
+    std::condition_variable cv;
+    // number of operations pushed and not taken yet
+    std::atomic<int> pending{0};
+    // number of workers waiting on cv
+    std::atomic<int> sleeping{0};
+    // number of operations running, to share the OMP threads among them
+    std::atomic<int> running{0};
+    bool killed{false};
+    // thread pool that works on this task
+    std::unique_ptr<ThreadPool> pool;
+  };
+
   /*! \brief whether this is a worker thread. */
   static MX_THREAD_LOCAL bool is_worker_;
+  /*! \brief work-stealing block of this worker thread, if any. */
+  static MX_THREAD_LOCAL WorkStealingBlock *current_stealing_block_;
+  /*! \brief index of this worker thread in its work-stealing block. */
+  static MX_THREAD_LOCAL int current_stealing_index_;
+  /*! \brief whether CPU operations use the work-stealing workers */
+  const bool cpu_work_stealing_;
   /*! \brief number of concurrent thread cpu worker uses */
   size_t cpu_worker_nthreads_;
   /*! \brief number of concurrent thread each gpu worker uses */
@@ -222,6 +348,8 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   size_t gpu_copy_nthreads_;
   // cpu worker
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue> > cpu_normal_workers_;
+  // cpu workers with work stealing
+  common::LazyAllocArray<WorkStealingBlock> cpu_stealing_workers_;
   // cpu priority worker
   std::unique_ptr<ThreadWorkerBlock<kPriorityQueue> > cpu_priority_worker_;
   // workers doing normal works on GPU
@@ -276,11 +404,13 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   /*!
    * \brief CPU worker that performs operations on CPU.
    * \param block The task block of the worker.
+   * \param numa_node The NUMA node to pin the worker to, or -1.
    */
   template<dmlc::ConcurrentQueueType type>
   inline void CPUWorker(Context ctx,
                         ThreadWorkerBlock<type> *block,
-                        const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+                        const std::shared_ptr<dmlc::ManualEvent>& ready_event,
+                        int numa_node) {
     this->is_worker_ = true;
     auto* task_queue = &(block->task_queue);
     RunContext run_ctx{ctx, nullptr};
@@ -290,12 +420,41 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ready_event->signal();
 
     // Set default number of threads for OMP parallel regions initiated by this thread
-    OpenMP::Get()->on_start_worker_thread(true);
+    OpenMP::Get()->on_start_worker_thread(true, numa_node);
 
     while (task_queue->Pop(&opr_block)) {
       this->ExecuteOprBlock(run_ctx, opr_block);
     }
   }
+  /*!
+   * \brief Work-stealing CPU worker that performs operations on CPU.
+   * \param block The task block of the worker.
+   * \param index The index of the worker's deque in the block.
+   * \param numa_node The NUMA node to pin the worker to, or -1.
+   */
+  inline void CPUStealingWorker(Context ctx,
+                                WorkStealingBlock *block,
+                                int index,
+                                const std::shared_ptr<dmlc::ManualEvent>& ready_event,
+                                int numa_node) {
+    this->is_worker_ = true;
+    current_stealing_block_ = block;
+    current_stealing_index_ = index;
+    RunContext run_ctx{ctx, nullptr};
+    OprBlock* opr_block;
+    ready_event->signal();
+
+    OpenMP::Get()->on_start_worker_thread(true, numa_node);
+    // OMP threads available to all the operations of this block together
+    const int omp_budget = OpenMP::Get()->GetRecommendedOMPThreadCount(true);
+
+    while (block->Pop(index, &opr_block)) {
+      const int running = ++block->running;
+      OpenMP::Get()->set_worker_thread_count(omp_budget / running);
+      this->ExecuteOprBlock(run_ctx, opr_block);
+      --block->running;
+    }
+  }
 
   /*!
    * \brief Get number of cores this engine should reserve for its own use
@@ -332,6 +491,9 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     SignalQueueForKill(&gpu_normal_workers_);
     SignalQueueForKill(&gpu_copy_workers_);
     SignalQueueForKill(&cpu_normal_workers_);
+    cpu_stealing_workers_.ForEach([](size_t i, WorkStealingBlock *block) {
+      block->SignalForKill();
+    });
     if (cpu_priority_worker_) {
       cpu_priority_worker_->task_queue.SignalForKill();
     }
@@ -342,7 +504,14 @@ Engine *CreateThreadedEnginePerDevice() {
   return new ThreadedEnginePerDevice();
 }
 
+Engine *CreateThreadedEngineWorkStealing() {
+  return new ThreadedEnginePerDevice(true);
+}
+
 MX_THREAD_LOCAL bool ThreadedEnginePerDevice::is_worker_ = false;
+MX_THREAD_LOCAL ThreadedEnginePerDevice::WorkStealingBlock *
+    ThreadedEnginePerDevice::current_stealing_block_ = nullptr;
+MX_THREAD_LOCAL int ThreadedEnginePerDevice::current_stealing_index_ = 0;
 
 }  // namespace engine
 }  // namespace mxnet
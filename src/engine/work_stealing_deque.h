@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_deque.h
+ * \brief Lock-free work-stealing deque (Chase-Lev).
+ */
+#ifndef MXNET_ENGINE_WORK_STEALING_DEQUE_H_
+#define MXNET_ENGINE_WORK_STEALING_DEQUE_H_
+
+#include <dmlc/base.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Lock-free deque of the Chase-Lev work-stealing algorithm, with the memory
+ *  orderings of Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+ *  The owner thread pushes and pops at the bottom, any other thread steals from the top.
+ * \tparam T trivially copyable element type, usually a pointer
+ */
+template<typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t log_capacity = 8)
+    : top_(0), bottom_(0), array_(new Array(log_capacity)) {
+    arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+
+  /*! \brief Push an element at the bottom. Owner thread only. */
+  void PushBottom(T item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    Array *a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity() - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /*! \brief Pop the most recently pushed element. Owner thread only. */
+  bool PopBottom(T *item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array *a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *item = a->Get(b);
+    if (t == b) {
+      // last element, race against thieves
+      const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  /*! \brief Steal the least recently pushed element. Any thread. */
+  bool Steal(T *item) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    Array *a = array_.load(std::memory_order_acquire);
+    T x = a->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    *item = x;
+    return true;
+  }
+
+  /*! \brief Approximate number of elements. */
+  int64_t size() const {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+ private:
+  /*! \brief Circular array of atomic slots. */
+  class Array {
+   public:
+    explicit Array(size_t log_capacity)
+      : log_capacity_(log_capacity), mask_((int64_t{1} << log_capacity) - 1),
+        slots_(new std::atomic<T>[int64_t{1} << log_capacity]) {}
+    int64_t capacity() const { return mask_ + 1; }
+    size_t log_capacity() const { return log_capacity_; }
+    T Get(int64_t i) const { return slots_[i & mask_].load(std::memory_order_relaxed); }
+    void Put(int64_t i, T x) { slots_[i & mask_].store(x, std::memory_order_relaxed); }
+
+   private:
+    size_t log_capacity_;
+    int64_t mask_;
+    std::unique_ptr<std::atomic<T>[]> slots_;
+  };
+
+  Array *Grow(Array *a, int64_t b, int64_t t) {
+    Array *bigger = new Array(a->log_capacity() + 1);
+    for (int64_t i = t; i < b; ++i) bigger->Put(i, a->Get(i));
+    // thieves may still read the old array, it is kept alive until destruction
+    arrays_.emplace_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<Array *> array_;
+  /*! \brief every array allocated by the owner */
+  std::vector<std::unique_ptr<Array>> arrays_;
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_WORK_STEALING_DEQUE_H_
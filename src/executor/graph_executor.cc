@@ -27,6 +27,7 @@
 #include <nnvm/pass_functions.h>
 #include <vector>
 #include <algorithm>
+#include <iterator>
 
 #include "./exec_pass.h"
 #include "./graph_executor.h"
@@ -1035,33 +1036,79 @@ void GraphExecutor::InitDataEntryMemory(std::vector<NDArray>* shared_pool) {
   };
   std::sort(sorted_pool_index.begin(), sorted_pool_index.end(), pool_comparator);
 
+  // In the arena mode the executors sharing the pool never run at the same time,
+  // but ops of the previous one may still be in flight while this one binds:
+  // the k-th largest entry of this executor takes the k-th largest free array of
+  // the pool on the same context, which is enlarged, after waiting for those ops,
+  // if its memory is still delayed. The pool ends up sized for the worst case of
+  // all executors rather than holding the arrays that happened not to fit.
+  const bool use_arena = shared_pool != nullptr &&
+                         dmlc::GetEnv("MXNET_EXEC_SHARED_POOL_ARENA", false);
+  size_t plan_bytes = 0, new_bytes = 0;
   for (size_t i : sorted_pool_index) {
     const Context& ctx = pool_info[i].ctx;
     size_t bytes = pool_info[i].bytes;
+    size_t nword = (bytes + 3) / 4;
+    CHECK_LE(nword, std::numeric_limits<nnvm::dim_t>::max());
+    plan_bytes += bytes;
     bool allocated = false;
-    for (auto it = free_pool.lower_bound(bytes); it != free_pool.end(); ++it) {
-      if (it->second.ctx() == ctx && it->first >= bytes) {
-        data_pool_[i] = it->second;
-        free_pool.erase(it);
-        allocated = true;
+    if (use_arena) {
+      for (auto it = free_pool.rbegin(); it != free_pool.rend(); ++it) {
+        if (it->second.ctx() != ctx) continue;
+        if (it->first < bytes) {
+          // the slot is shared by reference, grow the copy held by the pool
+          for (NDArray& nd : *shared_pool) {
+            if (!nd.IsSame(it->second)) continue;
+            if (nd.ReshapeDelayAlloc(TShape{static_cast<nnvm::dim_t>(nword)})) {
+              new_bytes += nword * 4 - it->first;
+              it->second = nd;
+            }
+            break;
+          }
+        }
+        if (it->second.shape().Size() * mshadow::mshadow_sizeof(it->second.dtype()) >= bytes) {
+          data_pool_[i] = it->second;
+          free_pool.erase(std::next(it).base());
+          allocated = true;
+        }
+        // the largest free array is too small, so is every other one
         break;
       }
+    } else {
+      for (auto it = free_pool.lower_bound(bytes); it != free_pool.end(); ++it) {
+        if (it->second.ctx() == ctx && it->first >= bytes) {
+          data_pool_[i] = it->second;
+          free_pool.erase(it);
+          allocated = true;
+          break;
+        }
+      }
     }
     if (!allocated) {
-      size_t nword = (bytes + 3) / 4;
-      CHECK_LE(nword, std::numeric_limits<nnvm::dim_t>::max());
       // allocate float arrays
       TShape shape{static_cast<nnvm::dim_t>(nword)};
       // TODO(junwu): adding delay_alloc=true to create nd
       // is a temporary solution.
       NDArray nd(shape, ctx, true);
       data_pool_[i] = nd;
+      new_bytes += nword * 4;
       // put the new allocated arrays to shared pool
       if (shared_pool != nullptr)  {
         shared_pool->push_back(nd);
       }
     }
   }
+  static bool mem_log_verbose = dmlc::GetEnv("MXNET_MEM_PLAN_VERBOSE_LOGGING", false);
+  if (mem_log_verbose && shared_pool != nullptr) {
+    size_t pool_bytes = 0;
+    for (const NDArray& nd : *shared_pool) {
+      pool_bytes += nd.shape().Size() * mshadow::mshadow_sizeof(nd.dtype());
+    }
+    LOG(INFO) << "shared memory pool" << (use_arena ? " (arena)" : "") << ": independent plan "
+              << plan_bytes / 1024 << " KB, added to the pool " << new_bytes / 1024
+              << " KB, saved " << (plan_bytes - std::min(plan_bytes, new_bytes)) / 1024
+              << " KB, pool size " << pool_bytes / 1024 << " KB";
+  }
   CHECK_EQ(data_pool_.size(), pool_info.size());
   // assign the data entries
   for (size_t i = 0; i < data_entry_.size(); ++i) {
@@ -18,6 +18,7 @@
  */
 #include <unordered_set>
 #include <iostream>
+#include <list>
 #include "./imperative_utils.h"
 #include "./cached_op.h"
 #include "../executor/exec_pass.h"
@@ -39,17 +40,43 @@ struct CachedOp::GraphInfo {
   std::vector<uint32_t> bwd_input_eid;
 };
 
+struct CachedOp::InputSignature {
+  nnvm::ShapeVector shapes;
+  nnvm::DTypeVector dtypes;
+  StorageTypeVector stypes;
+
+  explicit InputSignature(const std::vector<NDArray*>& inputs) {
+    shapes.reserve(inputs.size());
+    dtypes.reserve(inputs.size());
+    stypes.reserve(inputs.size());
+    for (const auto input : inputs) {
+      shapes.emplace_back(input->shape());
+      dtypes.emplace_back(input->dtype());
+      stypes.emplace_back(input->storage_type());
+    }
+  }
+  InputSignature() = default;
+
+  bool operator==(const InputSignature& other) const {
+    return shapes == other.shapes && dtypes == other.dtypes && stypes == other.stypes;
+  }
+};
+
 struct CachedOp::DynamicRuntime {
   GraphInfo info;
+  InputSignature signature;
   std::vector<NDArray> buff;
   std::vector<OpStatePtr> op_states;
 };
 
-struct CachedOp::CachedOpState {
-  CachedOpState(const Context& context_,
-                const nnvm::Graph& fwd_graph_,
-                const nnvm::Graph& full_graph_) {
-    context = context_;
+/*!
+ * \brief The graphs with inferred attributes and memory plans, and with static_alloc
+ *  the arrays and op executors, built for one input signature.
+ */
+struct CachedOp::ShapePlan {
+  ShapePlan(const Context& context,
+            const nnvm::Graph& fwd_graph_,
+            const nnvm::Graph& full_graph_) {
     info.fwd_graph = fwd_graph_;
     info.full_graph = full_graph_;
 
@@ -69,8 +96,7 @@ struct CachedOp::CachedOpState {
     opr_segs.resize(max_nodes);
   }
 
-  std::mutex mutex;
-  Context context;
+  InputSignature signature;
   GraphInfo info;
 
   bool recording = false;
@@ -92,6 +118,23 @@ struct CachedOp::CachedOpState {
   std::multimap<size_t, NDArray> bwd_reuse_pool;
 };
 
+/*!
+ * \brief Per-device state of a CachedOp. The members inherited from ShapePlan are
+ *  the plan of the current input signature; plans of the signatures seen before it
+ *  wait in plan_cache until their signature comes back.
+ */
+struct CachedOp::CachedOpState : public CachedOp::ShapePlan {
+  CachedOpState(const Context& context_,
+                const nnvm::Graph& fwd_graph_,
+                const nnvm::Graph& full_graph_)
+      : ShapePlan(context_, fwd_graph_, full_graph_), context(context_) {}
+
+  std::mutex mutex;
+  Context context;
+  /*! \brief plans of previous input signatures, most recently used first */
+  std::list<ShapePlan> plan_cache;
+};
+
 CachedOp::CachedOp(
     const nnvm::Symbol& sym,
     const std::vector<std::pair<std::string, std::string> >& flags) {
@@ -466,6 +509,31 @@ OpStatePtr CachedOp::GetCachedOpState(
   return state_ptr;
 }
 
+bool CachedOp::SelectShapePlan(CachedOpState* state, const InputSignature& signature) {
+  if (state->signature == signature) return true;
+  if (state->signature.shapes.empty() || config_.plan_cache_size == 0) {
+    // nothing planned yet, or no cache: replan the current plan in place
+    state->signature = signature;
+    return false;
+  }
+  ShapePlan& current = *state;
+  for (auto it = state->plan_cache.begin(); it != state->plan_cache.end(); ++it) {
+    if (it->signature == signature) {
+      std::swap(current, *it);
+      state->plan_cache.splice(state->plan_cache.begin(), state->plan_cache, it);
+      return true;
+    }
+  }
+  state->plan_cache.emplace_front(std::move(current));
+  if (state->plan_cache.size() > config_.plan_cache_size) {
+    state->plan_cache.pop_back();
+    ++plan_evictions_;
+  }
+  current = ShapePlan(state->context, fwd_graph_, full_graph_);
+  current.signature = signature;
+  return false;
+}
+
 void CachedOp::StaticAllocMemory(
     const OpStatePtr& state_ptr,
     bool recording,
@@ -691,6 +759,11 @@ OpStatePtr CachedOp::StaticForward(
   auto& state = state_ptr.get_state<CachedOpState>();
   std::lock_guard<std::mutex> lock(state.mutex);
 
+  if (SelectShapePlan(&state, InputSignature(inputs))) {
+    ++plan_hits_;
+  } else {
+    ++plan_misses_;
+  }
   bool match = SetForwardGraph(&state.info, recording, inputs);
   match = match && state.recording == recording;
 
@@ -766,6 +839,12 @@ OpStatePtr CachedOp::DynamicForward(
     auto state_ptr = GetCachedOpState(default_ctx);
     auto& state = state_ptr.get_state<CachedOpState>();
     std::lock_guard<std::mutex> lock(state.mutex);
+    runtime.signature = InputSignature(inputs);
+    if (SelectShapePlan(&state, runtime.signature)) {
+      ++plan_hits_;
+    } else {
+      ++plan_misses_;
+    }
     SetForwardGraph(&state.info, recording, inputs);
     runtime.info.fwd_graph = state.info.fwd_graph;
   }
@@ -895,6 +974,7 @@ void CachedOp::DynamicBackward(
     auto state_ptr = GetCachedOpState(default_ctx);
     auto& state = state_ptr.get_state<CachedOpState>();
     std::lock_guard<std::mutex> lock(state.mutex);
+    SelectShapePlan(&state, runtime.signature);
     state.info.fwd_graph = runtime.info.fwd_graph;
     SetBackwardGraph(&state.info, reqs, inputs);
     runtime.info.full_graph = state.info.full_graph;
@@ -35,6 +35,7 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   uint32_t backward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  uint32_t plan_cache_size;
   nnvm::Tuple<uint32_t> data_indices;
   nnvm::Tuple<uint32_t> param_indices;
   std::string subgraph;
@@ -48,6 +49,11 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
     .describe("Optimize for invariant input shapes between iterations. "
               "Must also set static_alloc to True. "
               "Change of input shapes is still allowed but slower.");
+    DMLC_DECLARE_FIELD(plan_cache_size)
+    .set_default(dmlc::GetEnv("MXNET_CACHEDOP_PLAN_CACHE_SIZE", 4))
+    .describe("Number of plans of previous input shapes kept per device, so that "
+              "returning to one of these shapes does not plan and allocate again. "
+              "Each plan kept with static_alloc holds on to its memory.");
     DMLC_DECLARE_FIELD(inline_limit)
     .set_default(2)
     .describe("Maximum number of operators that can be inlined.");
@@ -130,13 +136,32 @@ class CachedOp {
     sym.outputs = fwd_graph_.outputs;
     return sym;
   }
+  /*! \brief number of forward calls that reused the plan of their input shapes */
+  uint64_t plan_hits() const {
+    return plan_hits_;
+  }
+  /*! \brief number of forward calls that had to plan for their input shapes */
+  uint64_t plan_misses() const {
+    return plan_misses_;
+  }
+  /*! \brief number of plans dropped from the plan cache to make room for a new one */
+  uint64_t plan_evictions() const {
+    return plan_evictions_;
+  }
 
  private:
   struct GraphInfo;
+  struct InputSignature;
   struct DynamicRuntime;
+  struct ShapePlan;
   struct CachedOpState;
 
   OpStatePtr GetCachedOpState(const Context& ctx);
+  /*!
+   * \brief Makes the plan of signature the current plan of state, taking it from the
+   *  plan cache if it is there. Returns whether the plan was found.
+   */
+  bool SelectShapePlan(CachedOpState* state, const InputSignature& signature);
   bool SetForwardGraph(
       GraphInfo* info,
       const bool recording,
@@ -195,6 +220,9 @@ class CachedOp {
 
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr> > cached_op_states_;
+  std::atomic<uint64_t> plan_hits_{0};
+  std::atomic<uint64_t> plan_misses_{0};
+  std::atomic<uint64_t> plan_evictions_{0};
 };
 
 using CachedOpPtr = std::shared_ptr<CachedOp>;
@@ -348,6 +348,10 @@ struct ImageDetNormalizeParam :  public dmlc::Parameter<ImageDetNormalizeParam>
 struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
   /*! \brief number of prefetched batches */
   size_t prefetch_buffer;
+  /*! \brief maximum number of batches queued by the producer thread */
+  size_t max_prefetch_buffer;
+  /*! \brief whether the queue depth follows the speed of the consumer */
+  bool adaptive_prefetch;
   /*! \brief data type */
   dmlc::optional<int> dtype;
 
@@ -355,6 +359,12 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
   DMLC_DECLARE_PARAMETER(PrefetcherParam) {
     DMLC_DECLARE_FIELD(prefetch_buffer).set_default(4)
         .describe("Maximum number of batches to prefetch.");
+    DMLC_DECLARE_FIELD(max_prefetch_buffer).set_default(16).set_lower_bound(1)
+        .describe("Maximum number of batches queued by the producer thread.");
+    DMLC_DECLARE_FIELD(adaptive_prefetch).set_default(false)
+        .describe("If true, the producer queue starts with prefetch_buffer batches and "
+                  "grows up to max_prefetch_buffer whenever the consumer has to wait for "
+                  "a batch after the producer was held back by a full queue.");
     DMLC_DECLARE_FIELD(dtype)
       .add_enum("float32", mshadow::kFloat32)
       .add_enum("float64", mshadow::kFloat64)
@@ -88,10 +88,10 @@ class BatchLoader : public IIterator<TBlobBatch> {
       }
       for (size_t i = 0; i < d.data.size(); ++i) {
         CHECK_EQ(unit_size_[i], d.data[i].Size());
-        MSHADOW_TYPE_SWITCH(data_[i].type_flag_, DType, {
+        MSHADOW_TYPE_SWITCH(out_.data[i].type_flag_, DType, {
             mshadow::Copy(
-              data_[i].get<cpu, 1, DType>().Slice(top * unit_size_[i],
-                                                  (top + 1) * unit_size_[i]),
+              out_.data[i].FlatTo1D<cpu, DType>().Slice(top * unit_size_[i],
+                                                        (top + 1) * unit_size_[i]),
               d.data[i].get_with_shape<cpu, 1, DType>(mshadow::Shape1(unit_size_[i])));
           });
       }
@@ -110,10 +110,10 @@ class BatchLoader : public IIterator<TBlobBatch> {
           // copy data
           for (size_t i = 0; i < d.data.size(); ++i) {
             CHECK_EQ(unit_size_[i], d.data[i].Size());
-            MSHADOW_TYPE_SWITCH(data_[i].type_flag_, DType, {
+            MSHADOW_TYPE_SWITCH(out_.data[i].type_flag_, DType, {
                 mshadow::Copy(
-                  data_[i].get<cpu, 1, DType>().Slice(top * unit_size_[i],
-                                                      (top + 1) * unit_size_[i]),
+                  out_.data[i].FlatTo1D<cpu, DType>().Slice(top * unit_size_[i],
+                                                            (top + 1) * unit_size_[i]),
                   d.data[i].get_with_shape<cpu, 1, DType>(mshadow::Shape1(unit_size_[i])));
               });
           }
@@ -129,6 +129,27 @@ class BatchLoader : public IIterator<TBlobBatch> {
   virtual const TBlobBatch &Value(void) const {
     return out_;
   }
+  /*!
+   * \brief Makes the following batches be written into out, which must have the shapes
+   *  and types of Value().data, instead of into the internal buffers. An empty out goes
+   *  back to the internal buffers.
+   */
+  void SetOutput(const std::vector<TBlob> &out) {
+    CHECK_EQ(data_.size(), out_.data.size()) << "SetOutput is called before the first batch";
+    if (out.empty()) {
+      for (size_t i = 0; i < data_.size(); ++i) {
+        out_.data[i] = TBlob(data_[i].dptr_, shape_[i], cpu::kDevMask, data_[i].type_flag_, 0);
+      }
+      return;
+    }
+    CHECK_EQ(out.size(), data_.size());
+    for (size_t i = 0; i < data_.size(); ++i) {
+      CHECK_EQ(out[i].shape_, shape_[i]);
+      CHECK_EQ(out[i].type_flag_, data_[i].type_flag_);
+      CHECK_EQ(out[i].dev_mask(), cpu::kDevMask);
+      out_.data[i] = out[i];
+    }
+  }
 
  protected:
   /*! \brief batch parameters */
@@ -29,6 +29,7 @@
 #include <dmlc/data.h>
 #include "./iter_prefetcher.h"
 #include "./iter_batchloader.h"
+#include "./parallel_text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -42,6 +43,10 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   std::string label_csv;
   /*! \brief label shape */
   TShape label_shape;
+  /*! \brief number of threads parsing the text, 0 for the streaming parser */
+  int parse_threads;
+  /*! \brief binary cache of the parsed rows */
+  std::string cache_file;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CSVIterParam) {
     DMLC_DECLARE_FIELD(data_csv)
@@ -54,6 +59,14 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
     index_t shape1[] = {1};
     DMLC_DECLARE_FIELD(label_shape).set_default(TShape(shape1, shape1 + 1))
         .describe("The shape of one label.");
+    DMLC_DECLARE_FIELD(parse_threads).set_default(0).set_lower_bound(0)
+        .describe("If positive, the CSV files are memory mapped and parsed in chunks by "
+                  "this number of threads. Only single local files are supported.");
+    DMLC_DECLARE_FIELD(cache_file).set_default("NULL")
+        .describe("If set, the rows parsed in the first pass are stored in this binary "
+                  "file, which later passes and later runs read instead of the CSV. "
+                  "The rows of label_csv go to cache_file.label. Implies parsing in "
+                  "parallel, with parse_threads or the default number of threads.");
   }
 };
 
@@ -97,10 +110,13 @@ class CSVIterTyped: public CSVIterBase {
   // intialize iterator loads data in
   virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t, DType>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
+    const std::string cache = param_.cache_file == "NULL" ? "" : param_.cache_file;
+    data_parser_.reset(CreateTextParser<uint32_t, DType>(
+        param_.data_csv, 0, 1, TextFormat::kCSV, param_.parse_threads, cache));
     if (param_.label_csv != "NULL") {
-      label_parser_.reset(
-        dmlc::Parser<uint32_t, DType>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
+      label_parser_.reset(CreateTextParser<uint32_t, DType>(
+          param_.label_csv, 0, 1, TextFormat::kCSV, param_.parse_threads,
+          cache.empty() ? cache : cache + ".label"));
     } else {
       dummy_label.set_pad(false);
       dummy_label.Resize(mshadow::Shape1(1));
@@ -232,6 +248,12 @@ to set `round_batch` to False.
 
 If ``data_csv = 'data/'`` is set, then all the files in this directory will be read.
 
+When `parse_threads` is positive, the file is memory mapped and cut into chunks of lines
+that are parsed by `parse_threads` threads, which is faster than the default streaming
+parser for large files. When `cache_file` is set, the parsed rows are also written to that
+binary file during the first pass, and read back from it in later passes, even across runs,
+instead of parsing the text again. Remove the cache file when the CSV file changes.
+
 ``reset()`` is expected to be called only after a complete pass of data.
 
 By default, the CSVIter parses all entries in the data file as float32 data type,
@@ -693,9 +693,7 @@ class ImageRecordIter2 : public IIterator<DataBatch> {
       prefetch_param_.InitAllowUnknown(kwargs);
       parser_.Init(kwargs);
       // maximum prefetch threaded iter internal size
-      const int kMaxPrefetchBuffer = 16;
-      // init thread iter
-      iter_.set_max_capacity(kMaxPrefetchBuffer);
+      iter_.set_max_capacity(prefetch_param_.max_prefetch_buffer);
       // init thread iter
       iter_.Init([this](DataBatch **dptr) {
           if (*dptr == nullptr) {
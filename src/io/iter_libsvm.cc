@@ -28,6 +28,7 @@
 #include <dmlc/data.h>
 #include "./iter_sparse_prefetcher.h"
 #include "./iter_sparse_batchloader.h"
+#include "./parallel_text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -45,6 +46,10 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   int num_parts;
   /*! \brief the index of the part will read*/
   int part_index;
+  /*! \brief number of threads parsing the text, 0 for the streaming parser */
+  int parse_threads;
+  /*! \brief binary cache of the parsed rows */
+  std::string cache_file;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LibSVMIterParam) {
     DMLC_DECLARE_FIELD(data_libsvm)
@@ -61,6 +66,14 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
         .describe("partition the data into multiple parts");
     DMLC_DECLARE_FIELD(part_index).set_default(0)
         .describe("the index of the part will read");
+    DMLC_DECLARE_FIELD(parse_threads).set_default(0).set_lower_bound(0)
+        .describe("If positive, the LibSVM files are memory mapped and parsed in chunks by "
+                  "this number of threads. Only single local files are supported.");
+    DMLC_DECLARE_FIELD(cache_file).set_default("NULL")
+        .describe("If set, the rows parsed in the first pass are stored in this binary "
+                  "file, which later passes and later runs read instead of the text. "
+                  "The rows of label_libsvm go to cache_file.label. Implies parsing in "
+                  "parallel, with parse_threads or the default number of threads.");
   }
 };
 
@@ -75,13 +88,15 @@ class LibSVMIter: public SparseIIterator<DataInst> {
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.data_libsvm.c_str(),
-                                                      param_.part_index,
-                                                      param_.num_parts, "libsvm"));
+    const std::string cache = param_.cache_file == "NULL" ? "" : param_.cache_file;
+    data_parser_.reset(CreateTextParser<uint64_t, real_t>(param_.data_libsvm,
+                                                          param_.part_index,
+                                                          param_.num_parts, TextFormat::kLibSVM,
+                                                          param_.parse_threads, cache));
     if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.label_libsvm.c_str(),
-                                                         param_.part_index,
-                                                         param_.num_parts, "libsvm"));
+      label_parser_.reset(CreateTextParser<uint64_t, real_t>(
+          param_.label_libsvm, param_.part_index, param_.num_parts, TextFormat::kLibSVM,
+          param_.parse_threads, cache.empty() ? cache : cache + ".label"));
       CHECK_GT(param_.label_shape.Size(), 1)
         << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
@@ -224,6 +239,13 @@ When `num_parts` and `part_index` are provided, the data is split into `num_part
 and the iterator only reads the `part_index`-th partition. However, the partitions are not
 guaranteed to be even.
 
+When `parse_threads` is positive, the file is memory mapped and cut into chunks of lines
+that are parsed by `parse_threads` threads into CSR rows, which is faster than the default
+streaming parser for large files. When `cache_file` is set, the parsed rows are also written
+to that binary file during the first pass, and read back from it in later passes, even across
+runs, instead of parsing the text again. The cache is specific to `num_parts` and
+`part_index`. Remove the cache file when the LibSVM file changes.
+
 ``reset()`` is expected to be called only after a complete pass of data.
 
 Example::
@@ -32,7 +32,11 @@
 #include <dmlc/threadediter.h>
 #include <dmlc/optional.h>
 #include <mshadow/tensor.h>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <condition_variable>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <vector>
@@ -40,6 +44,8 @@
 #include <algorithm>
 #include "./inst_vector.h"
 #include "./image_iter_common.h"
+#include "./iter_batchloader.h"
+#include "../profiler/profiler.h"
 
 namespace mxnet {
 namespace io {
@@ -50,6 +56,7 @@ class PrefetcherIter : public IIterator<DataBatch> {
       : loader_(base), out_(nullptr) {}
 
   ~PrefetcherIter() {
+    ReleaseProducer();
     while (recycle_queue_.size() != 0) {
       DataBatch *batch = recycle_queue_.front();
       recycle_queue_.pop();
@@ -63,55 +70,77 @@ class PrefetcherIter : public IIterator<DataBatch> {
     std::vector<std::pair<std::string, std::string> > kwargs_left;
     // init image rec param
     kwargs_left = param_.InitAllowUnknown(kwargs);
-    // maximum prefetch threaded iter internal size
-    const int kMaxPrefetchBuffer = 16;
-    // init thread iter
-    iter.set_max_capacity(kMaxPrefetchBuffer);
+    // init thread iter; its capacity is only set before the producer thread starts,
+    // the adaptive depth below it is enforced by BeginProduce
+    depth_ = param_.adaptive_prefetch ?
+             std::min(std::max<size_t>(param_.prefetch_buffer, 1), param_.max_prefetch_buffer) :
+             param_.max_prefetch_buffer;
+    iter.set_max_capacity(param_.max_prefetch_buffer);
   }
 
   virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
     InitParams(kwargs);
     // use the kwarg to init batch loader
     loader_->Init(kwargs);
-    iter.Init([this](DataBatch **dptr) {
-        if (!loader_->Next()) return false;
+    BatchLoader *batch_loader = dynamic_cast<BatchLoader*>(loader_.get());
+    iter.Init([this, batch_loader](DataBatch **dptr) {
+        BeginProduce();
+        // once the shapes of the batches are known, a BatchLoader writes straight into
+        // the arrays of the batch instead of into its own buffers
+        const bool direct = batch_loader != nullptr && !direct_types_.empty();
+        if (direct) {
+          if (*dptr == nullptr) {
+            *dptr = AllocBatch(direct_shapes_, direct_types_, direct_shapes_[0][0]);
+          }
+          std::vector<TBlob> out;
+          for (NDArray& nd : (*dptr)->data) out.push_back(nd.data());
+          batch_loader->SetOutput(out);
+        }
+        if (!loader_->Next()) return EndProduce(false);
         const TBlobBatch& batch = loader_->Value();
         if (*dptr == nullptr) {
-          // allocate databatch
-          *dptr = new DataBatch();
-          (*dptr)->num_batch_padd = batch.num_batch_padd;
-          (*dptr)->data.resize(batch.data.size());
-          (*dptr)->index.resize(batch.batch_size);
+          std::vector<TShape> shapes;
+          std::vector<int> types;
           for (size_t i = 0; i < batch.data.size(); ++i) {
-            auto dtype = param_.dtype
-                             ? param_.dtype.value()
-                             : batch.data[i].type_flag_;
-            (*dptr)->data.at(i) = NDArray(batch.data[i].shape_,
-                                          Context::CPU(), false,
-                                          dtype);
+            shapes.push_back(batch.data[i].shape_);
+            types.push_back(param_.dtype ? param_.dtype.value() : batch.data[i].type_flag_);
+          }
+          *dptr = AllocBatch(shapes, types, batch.batch_size);
+          if (batch_loader != nullptr && direct_types_.empty() &&
+              (!param_.dtype || std::all_of(batch.data.begin(), batch.data.end(),
+                  [&](const TBlob& b) { return b.type_flag_ == param_.dtype.value(); }))) {
+            direct_shapes_ = shapes;
+            direct_types_ = types;
           }
         }
         CHECK(batch.data.size() == (*dptr)->data.size());
-        // copy data over
-        for (size_t i = 0; i < batch.data.size(); ++i) {
-          CHECK_EQ((*dptr)->data.at(i).shape(), batch.data[i].shape_);
-          MSHADOW_TYPE_SWITCH(batch.data[i].type_flag_, DType, {
-              mshadow::Copy(((*dptr)->data)[i].data().FlatTo2D<cpu, DType>(),
-                        batch.data[i].FlatTo2D<cpu, DType>());
-          });
-          (*dptr)->num_batch_padd = batch.num_batch_padd;
+        if (!direct) {
+          // copy data over
+          for (size_t i = 0; i < batch.data.size(); ++i) {
+            CHECK_EQ((*dptr)->data.at(i).shape(), batch.data[i].shape_);
+            MSHADOW_TYPE_SWITCH(batch.data[i].type_flag_, DType, {
+                mshadow::Copy(((*dptr)->data)[i].data().FlatTo2D<cpu, DType>(),
+                          batch.data[i].FlatTo2D<cpu, DType>());
+            });
+          }
         }
+        (*dptr)->num_batch_padd = batch.num_batch_padd;
         if (batch.inst_index) {
           std::copy(batch.inst_index,
                     batch.inst_index + batch.batch_size,
                     (*dptr)->index.begin());
         }
-       return true;
+        return EndProduce(true);
       },
-      [this]() { loader_->BeforeFirst(); });
+      [this]() {
+        loader_->BeforeFirst();
+        RestartProduce();
+      });
   }
 
   virtual void BeforeFirst(void) {
+    // the producer may wait in BeginProduce, which would keep it from handling the reset
+    ReleaseProducer();
     iter.BeforeFirst();
   }
 
@@ -129,13 +158,30 @@ class PrefetcherIter : public IIterator<DataBatch> {
       recycle_queue_.pop();
       iter.Recycle(&old_batch);
     }
-    return iter.Next(&out_);
+    const auto start = Clock::now();
+    const bool ret = iter.Next(&out_);
+    const uint64_t wait_us = ElapsedUs(start);
+    consumer_wait_us_ += wait_us;
+    if (ret) {
+      std::lock_guard<std::mutex> lock(depth_mutex_);
+      if (queued_ > 0) --queued_;
+      // waiting for a batch after the producer had been blocked by a full queue means the
+      // production rate varies, and a deeper queue absorbs it
+      if (param_.adaptive_prefetch && wait_us > kMinWaitUs &&
+          depth_ < param_.max_prefetch_buffer && producer_blocked_.exchange(false)) {
+        ++depth_;
+      }
+      depth_cond_.notify_one();
+    }
+    ReportStats();
+    return ret;
   }
   virtual const DataBatch &Value(void) const {
     return *out_;
   }
 
  protected:
+  typedef std::chrono::steady_clock Clock;
   /*! \brief prefetcher parameters */
   PrefetcherParam param_;
   /*! \brief backend thread */
@@ -143,11 +189,121 @@ class PrefetcherIter : public IIterator<DataBatch> {
   /*! \brief internal batch loader */
   std::unique_ptr<IIterator<TBlobBatch> > loader_;
 
+  static uint64_t ElapsedUs(const Clock::time_point& start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  }
+
+  /*!
+   * \brief called by the producer thread when it is asked for the next batch, waits
+   *  until fewer than depth_ batches are queued
+   */
+  void BeginProduce() {
+    {
+      std::unique_lock<std::mutex> lock(depth_mutex_);
+      depth_cond_.wait(lock, [this]() { return queued_ < depth_ || producer_released_; });
+    }
+    if (producer_idle_) {
+      producer_idle_ = false;
+      return;
+    }
+    // the producer thread only asks for a new batch once the queue has room
+    const uint64_t stall_us = ElapsedUs(last_produced_);
+    producer_stall_us_ += stall_us;
+    if (stall_us > kMinWaitUs) producer_blocked_ = true;
+  }
+  /*!
+   * \brief called by the producer thread after a batch, or when it stops until the
+   *  next BeforeFirst, in which case the time until it is asked again is not a stall
+   */
+  bool EndProduce(bool produced) {
+    if (produced) {
+      std::lock_guard<std::mutex> lock(depth_mutex_);
+      ++queued_;
+    }
+    last_produced_ = Clock::now();
+    producer_idle_ = !produced;
+    return produced;
+  }
+  /*! \brief called by the producer thread on BeforeFirst, after which the queue is empty */
+  void RestartProduce() {
+    {
+      std::lock_guard<std::mutex> lock(depth_mutex_);
+      queued_ = 0;
+      producer_released_ = false;
+    }
+    EndProduce(false);
+  }
+  /*! \brief lets the producer past BeginProduce until the next RestartProduce */
+  void ReleaseProducer() {
+    std::lock_guard<std::mutex> lock(depth_mutex_);
+    producer_released_ = true;
+    depth_cond_.notify_one();
+  }
+
  private:
+  /*! \brief waits shorter than this are ignored by the adaptive depth */
+  static const uint64_t kMinWaitUs = 100;
+
+  struct ProfilerCounters {
+    ProfilerCounters()
+      : producer_stall_us("Prefetcher producer stall (us)", Domain()),
+        consumer_wait_us("Prefetcher consumer wait (us)", Domain()),
+        depth("Prefetcher queue depth", Domain()) {}
+
+    static profiler::ProfileDomain *Domain() {
+      static profiler::ProfileDomain domain("Data Iterator");
+      return &domain;
+    }
+
+    profiler::ProfileCounter producer_stall_us;
+    profiler::ProfileCounter consumer_wait_us;
+    profiler::ProfileCounter depth;
+  };
+
+  /*! \brief publishes the total producer stall and consumer wait times to the profiler */
+  void ReportStats() {
+    if (profiler::Profiler::Get()->GetState() != profiler::Profiler::kRunning) return;
+    if (counters_ == nullptr) counters_.reset(new ProfilerCounters());
+    counters_->producer_stall_us = producer_stall_us_.load();
+    counters_->consumer_wait_us = consumer_wait_us_.load();
+    counters_->depth = depth_;
+  }
+
+  DataBatch *AllocBatch(const std::vector<TShape>& shapes, const std::vector<int>& types,
+                        size_t batch_size) {
+    DataBatch *batch = new DataBatch();
+    batch->data.resize(shapes.size());
+    batch->index.resize(batch_size);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+      batch->data[i] = NDArray(shapes[i], Context::CPU(), false, types[i]);
+    }
+    return batch;
+  }
+
   /*! \brief output data */
   DataBatch *out_;
   /*! \brief queue to be recycled */
   std::queue<DataBatch*> recycle_queue_;
+  /*! \brief shapes and types of the batches the loader writes into directly */
+  std::vector<TShape> direct_shapes_;
+  std::vector<int> direct_types_;
+  /*!
+   * \brief current capacity of the producer queue and number of batches in it, guarded
+   *  by depth_mutex_ as both threads use them
+   */
+  std::mutex depth_mutex_;
+  std::condition_variable depth_cond_;
+  size_t depth_{0};
+  size_t queued_{0};
+  bool producer_released_{false};
+  /*! \brief producer thread state, see BeginProduce */
+  Clock::time_point last_produced_;
+  bool producer_idle_{true};
+  std::atomic<bool> producer_blocked_{false};
+  /*! \brief time the producer spent blocked by a full queue, and the consumer waiting */
+  std::atomic<uint64_t> producer_stall_us_{0};
+  std::atomic<uint64_t> consumer_wait_us_{0};
+  std::unique_ptr<ProfilerCounters> counters_;
 };
 }  // namespace io
 }  // namespace mxnet
@@ -57,7 +57,8 @@ class SparsePrefetcherIter : public PrefetcherIter {
     // use the kwarg to init batch loader
     sparse_loader_->Init(kwargs);
     iter.Init([this](DataBatch **dptr) {
-        if (!sparse_loader_->Next()) return false;
+        BeginProduce();
+        if (!sparse_loader_->Next()) return EndProduce(false);
         const TBlobBatch& batch = sparse_loader_->Value();
         if (*dptr == nullptr) {
           // allocate databatch
@@ -114,9 +115,12 @@ class SparsePrefetcherIter : public PrefetcherIter {
                     batch.inst_index + batch.batch_size,
                     (*dptr)->index.begin());
         }
-       return true;
+        return EndProduce(true);
       },
-      [this]() { sparse_loader_->BeforeFirst(); });
+      [this]() {
+        sparse_loader_->BeforeFirst();
+        RestartProduce();
+      });
   }
 
   virtual void BeforeFirst(void) {
@@ -0,0 +1,567 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file parallel_text_parser.h
+ * \brief CSV and LibSVM parser reading a memory mapped file, parsing chunks of lines
+ *  on several threads and optionally caching the parsed rows in a binary file
+ */
+#ifndef MXNET_IO_PARALLEL_TEXT_PARSER_H_
+#define MXNET_IO_PARALLEL_TEXT_PARSER_H_
+
+#include <dmlc/base.h>
+#include <dmlc/data.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../engine/openmp.h"
+
+namespace mxnet {
+namespace io {
+
+/*! \brief text formats read by ParallelTextParser */
+enum class TextFormat : int { kCSV, kLibSVM };
+
+namespace text_parser {
+
+inline bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*!
+ * \brief Parses the number at the start of [begin, end).
+ * \return the first character after the number, begin if there is no number
+ */
+template<typename DType>
+inline const char *ParseNumber(
+    const char *begin, const char *end, DType *out,
+    typename std::enable_if<std::is_integral<DType>::value>::type* = 0) {
+  const char *p = begin;
+  bool neg = false;
+  if (p != end && (*p == '-' || *p == '+')) neg = *p++ == '-';
+  const char *digits = p;
+  uint64_t v = 0;
+  while (p != end && static_cast<unsigned>(*p - '0') < 10) v = v * 10 + (*p++ - '0');
+  if (p == digits) return begin;
+  // the fractional part of an integral column is dropped
+  if (p != end && *p == '.') {
+    ++p;
+    while (p != end && static_cast<unsigned>(*p - '0') < 10) ++p;
+  }
+  *out = static_cast<DType>(neg ? -static_cast<int64_t>(v) : static_cast<int64_t>(v));
+  return p;
+}
+
+template<typename DType>
+inline const char *ParseNumber(
+    const char *begin, const char *end, DType *out,
+    typename std::enable_if<!std::is_integral<DType>::value>::type* = 0) {
+  // exact powers of ten representable in a double
+  static const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const char *p = begin;
+  bool neg = false;
+  if (p != end && (*p == '-' || *p == '+')) neg = *p++ == '-';
+  // up to 19 significant digits go in the mantissa, the others only move the exponent
+  uint64_t mantissa = 0;
+  int ndigits = 0, exponent = 0;
+  const char *digits = p;
+  for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+    if (ndigits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa) ++ndigits;
+    } else {
+      ++exponent;
+    }
+  }
+  bool has_digits = p != digits;
+  if (p != end && *p == '.') {
+    const char *frac = ++p;
+    for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+      if (ndigits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) ++ndigits;
+        --exponent;
+      }
+    }
+    has_digits = has_digits || p != frac;
+  }
+  if (!has_digits) {
+    // nan, inf and other spellings strtod accepts
+    if (p != end && std::isalpha(static_cast<unsigned char>(*p))) {
+      std::string token(begin, std::find_if(begin, end, [](char c) {
+        return c == ',' || c == ':' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+      }));
+      char *token_end = nullptr;
+      const double v = std::strtod(token.c_str(), &token_end);
+      if (token_end != token.c_str()) {
+        *out = static_cast<DType>(v);
+        return begin + (token_end - token.c_str());
+      }
+    }
+    return begin;
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    const char *q = p + 1;
+    int e = 0;
+    const char *e_end = ParseNumber<int>(q, end, &e);
+    if (e_end != q) {
+      exponent += e;
+      p = e_end;
+    }
+  }
+  double v = static_cast<double>(mantissa);
+  if (mantissa != 0) {
+    if (exponent < 0 && exponent >= -22) {
+      v /= kPow10[-exponent];
+    } else if (exponent > 0 && exponent <= 22) {
+      v *= kPow10[exponent];
+    } else if (exponent != 0) {
+      v *= std::pow(10.0, exponent);
+    }
+  }
+  *out = static_cast<DType>(neg ? -v : v);
+  return p;
+}
+
+/*! \brief rows parsed from one range of lines, laid out as a dmlc::RowBlock */
+template<typename IndexType, typename DType>
+struct RowBlockContainer {
+  std::vector<size_t> offset{0};
+  std::vector<DType> label;
+  std::vector<IndexType> index;
+  std::vector<DType> value;
+
+  void Clear() {
+    offset.resize(1);
+    label.clear();
+    index.clear();
+    value.clear();
+  }
+  size_t Size() const {
+    return offset.size() - 1;
+  }
+  dmlc::RowBlock<IndexType, DType> GetBlock() const {
+    dmlc::RowBlock<IndexType, DType> out = dmlc::RowBlock<IndexType, DType>();
+    out.size = Size();
+    out.offset = offset.data();
+    out.label = label.data();
+    // dense rows have no column indices
+    out.index = index.empty() ? nullptr : index.data();
+    out.value = value.data();
+    return out;
+  }
+  void Save(dmlc::Stream *fo) const {
+    fo->Write(offset);
+    fo->Write(label);
+    fo->Write(index);
+    fo->Write(value);
+  }
+  bool Load(dmlc::Stream *fi) {
+    if (!fi->Read(&offset)) return false;
+    CHECK(fi->Read(&label) && fi->Read(&index) && fi->Read(&value))
+        << "Invalid parser cache file";
+    return true;
+  }
+};
+
+/*! \brief read-only view of a whole file, memory mapped where supported */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+    std::ifstream is(path, std::ios::binary);
+    CHECK(is.is_open()) << "Cannot open " << path;
+    buffer_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Cannot open " << path << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path;
+    CHECK(S_ISREG(st.st_mode)) << path << " is not a regular file, the parallel text parser "
+                               << "only reads single local files";
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      CHECK(addr != MAP_FAILED) << "Cannot map " << path << ": " << strerror(errno);
+      madvise(addr, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(addr);
+    }
+    close(fd);
+#endif
+  }
+  ~MappedFile() {
+#ifndef _WIN32
+    if (size_ > 0) munmap(const_cast<char *>(data_), size_);
+#endif
+  }
+  const char *data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  const char *data_{nullptr};
+  size_t size_{0};
+#ifdef _WIN32
+  std::string buffer_;
+#endif
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+}  // namespace text_parser
+
+/*!
+ * \brief dmlc::Parser over a single local text file. The file is memory mapped, the
+ *  part to read is cut into chunks at line boundaries and the lines of each chunk are
+ *  parsed by num_threads OpenMP threads, each into its own row block. Values are
+ *  stored contiguously per block: one dense row per CSV line, one CSR row per LibSVM
+ *  line.
+ *
+ *  When cache_file is given, the row blocks of the first pass are written to it and
+ *  every later pass, including later runs of the program, reads them back instead of
+ *  the text. The cache only becomes visible once a pass is complete.
+ */
+template<typename IndexType, typename DType = real_t>
+class ParallelTextParser : public dmlc::Parser<IndexType, DType> {
+ public:
+  ParallelTextParser(const std::string &path, unsigned part_index, unsigned num_parts,
+                     TextFormat format, int num_threads, const std::string &cache_file)
+      : path_(path), part_index_(part_index), num_parts_(num_parts), format_(format),
+        cache_file_(cache_file) {
+    CHECK_LT(part_index, num_parts);
+    num_threads_ = num_threads > 0 ? num_threads :
+                   engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    num_threads_ = std::max(num_threads_, 1);
+    blocks_.resize(num_threads_);
+    if (!cache_file_.empty() && OpenCache()) return;
+    OpenText();
+  }
+
+  ~ParallelTextParser() {
+    if (cache_out_ != nullptr) {
+      // an unfinished cache is dropped
+      cache_out_.reset();
+      std::remove((cache_file_ + ".tmp").c_str());
+    }
+  }
+
+  void BeforeFirst() override {
+    if (cache_out_ != nullptr) {
+      // the pass writing the cache was not complete, start over
+      cache_out_.reset();
+      std::remove((cache_file_ + ".tmp").c_str());
+      OpenCacheOut();
+    }
+    if (cache_in_ != nullptr) {
+      cache_in_->Seek(cache_data_begin_);
+    }
+    pos_ = begin_;
+    bytes_read_ = 0;
+    num_blocks_ = cur_block_ = 0;
+  }
+
+  bool Next() override {
+    while (++cur_block_ < num_blocks_) {
+      if (blocks_[cur_block_].Size() != 0) return SetValue(blocks_[cur_block_]);
+    }
+    if (cache_in_ != nullptr) {
+      num_blocks_ = cur_block_ = 0;
+      if (!blocks_[0].Load(cache_in_.get())) return false;
+      num_blocks_ = 1;
+      bytes_read_ = cache_in_->Tell() - cache_data_begin_;
+      return SetValue(blocks_[0]);
+    }
+    while (pos_ < end_) {
+      ParseChunk();
+      for (cur_block_ = 0; cur_block_ < num_blocks_; ++cur_block_) {
+        if (blocks_[cur_block_].Size() != 0) return SetValue(blocks_[cur_block_]);
+      }
+    }
+    if (cache_out_ != nullptr) CommitCache();
+    return false;
+  }
+
+  const dmlc::RowBlock<IndexType, DType> &Value() const override {
+    return value_;
+  }
+
+  size_t BytesRead() const override {
+    return bytes_read_;
+  }
+
+ private:
+  /*! \brief bytes of text parsed by each thread per chunk */
+  static const size_t kChunkBytesPerThread = 16UL << 20;
+  /*! \brief first bytes of a cache file */
+  static const uint64_t kCacheMagic = 0x4d58545843414348UL;
+
+  bool SetValue(const text_parser::RowBlockContainer<IndexType, DType> &block) {
+    value_ = block.GetBlock();
+    if (cache_out_ != nullptr) block.Save(cache_out_.get());
+    return true;
+  }
+
+  /*! \brief start of the line following the one p is in, or end */
+  const char *NextLine(const char *p, const char *end) const {
+    const void *nl = std::memchr(p, '\n', end - p);
+    return nl == nullptr ? end : static_cast<const char *>(nl) + 1;
+  }
+
+  /*! \brief start of the line that contains the byte at offset, or the end of the file */
+  const char *AlignToLine(size_t offset) const {
+    const char *data = text_->data();
+    if (offset == 0) return data;
+    if (offset >= text_->size()) return data + text_->size();
+    return NextLine(data + offset - 1, data + text_->size());
+  }
+
+  void OpenText() {
+    text_.reset(new text_parser::MappedFile(path_));
+    const size_t size = text_->size();
+    begin_ = AlignToLine(size / num_parts_ * part_index_);
+    end_ = part_index_ + 1 == num_parts_ ? text_->data() + size :
+           AlignToLine(size / num_parts_ * (part_index_ + 1));
+    pos_ = begin_;
+    if (!cache_file_.empty()) OpenCacheOut();
+  }
+
+  /*! \brief reads from the cache file if it exists */
+  bool OpenCache() {
+    cache_in_.reset(dmlc::SeekStream::CreateForRead(cache_file_.c_str(), true));
+    if (cache_in_ == nullptr) return false;
+    uint64_t magic = 0;
+    std::vector<uint32_t> header;
+    CHECK(cache_in_->Read(&magic, sizeof(magic)) == sizeof(magic) && magic == kCacheMagic)
+        << cache_file_ << " is not a parser cache file";
+    CHECK(cache_in_->Read(&header));
+    CHECK(header == CacheHeader())
+        << "The parser cache " << cache_file_ << " was written for another format, "
+        << "data type or partition of the data, remove it to parse the text again";
+    cache_data_begin_ = cache_in_->Tell();
+    LOG(INFO) << "Reading the rows of " << path_ << " from cache " << cache_file_;
+    return true;
+  }
+
+  void OpenCacheOut() {
+    const uint64_t magic = kCacheMagic;
+    cache_out_.reset(dmlc::Stream::Create((cache_file_ + ".tmp").c_str(), "w"));
+    cache_out_->Write(&magic, sizeof(magic));
+    cache_out_->Write(CacheHeader());
+  }
+
+  void CommitCache() {
+    cache_out_.reset();
+    CHECK_EQ(std::rename((cache_file_ + ".tmp").c_str(), cache_file_.c_str()), 0)
+        << "Cannot write the parser cache " << cache_file_;
+    // later passes read the cache, the text is not needed anymore
+    text_.reset();
+    cache_in_.reset(dmlc::SeekStream::CreateForRead(cache_file_.c_str()));
+    uint64_t magic;
+    std::vector<uint32_t> header;
+    cache_in_->Read(&magic, sizeof(magic));
+    cache_in_->Read(&header);
+    cache_data_begin_ = cache_in_->Tell();
+  }
+
+  std::vector<uint32_t> CacheHeader() const {
+    return {static_cast<uint32_t>(format_), static_cast<uint32_t>(sizeof(IndexType)),
+            static_cast<uint32_t>(sizeof(DType)),
+            static_cast<uint32_t>(std::is_integral<DType>::value),
+            part_index_, num_parts_};
+  }
+
+  /*! \brief parses the next chunk of lines, one range of lines per thread */
+  void ParseChunk() {
+    const char *chunk_end = pos_ + std::min<size_t>(end_ - pos_,
+                                                    kChunkBytesPerThread * num_threads_);
+    if (chunk_end != end_) chunk_end = NextLine(chunk_end - 1, end_);
+    std::vector<const char *> bounds(num_threads_ + 1, chunk_end);
+    bounds[0] = pos_;
+    const size_t step = (chunk_end - pos_) / num_threads_;
+    for (int i = 1; i < num_threads_; ++i) {
+      const char *cut = pos_ + step * i;
+      bounds[i] = cut == pos_ ? pos_ : std::max(bounds[i - 1], NextLine(cut - 1, chunk_end));
+    }
+    #pragma omp parallel for num_threads(num_threads_)
+    for (int i = 0; i < num_threads_; ++i) {
+      omp_exc_.Run([&] {
+        blocks_[i].Clear();
+        if (format_ == TextFormat::kCSV) {
+          ParseCSV(bounds[i], bounds[i + 1], &blocks_[i]);
+        } else {
+          ParseLibSVM(bounds[i], bounds[i + 1], &blocks_[i]);
+        }
+      });
+    }
+    omp_exc_.Rethrow();
+    bytes_read_ += chunk_end - pos_;
+    pos_ = chunk_end;
+    num_blocks_ = num_threads_;
+  }
+
+  static void ParseCSV(const char *begin, const char *end,
+                       text_parser::RowBlockContainer<IndexType, DType> *out) {
+    using text_parser::IsBlank;
+    using text_parser::ParseNumber;
+    for (const char *line = begin; line != end;) {
+      const char *line_end = static_cast<const char *>(std::memchr(line, '\n', end - line));
+      if (line_end == nullptr) line_end = end;
+      const char *p = line;
+      while (p != line_end && IsBlank(*p)) ++p;
+      if (p != line_end) {
+        while (true) {
+          while (p != line_end && IsBlank(*p)) ++p;
+          DType v = DType(0);
+          const char *q = ParseNumber(p, line_end, &v);
+          // an empty field reads as 0
+          CHECK(q != p || p == line_end || *p == ',')
+              << "Invalid CSV field: " << std::string(line, line_end);
+          out->value.push_back(v);
+          p = q;
+          while (p != line_end && IsBlank(*p)) ++p;
+          if (p == line_end) break;
+          CHECK_EQ(*p, ',') << "Invalid CSV line: " << std::string(line, line_end);
+          ++p;
+        }
+        out->label.push_back(DType(0));
+        out->offset.push_back(out->value.size());
+      }
+      line = line_end == end ? end : line_end + 1;
+    }
+  }
+
+  static void ParseLibSVM(const char *begin, const char *end,
+                          text_parser::RowBlockContainer<IndexType, DType> *out) {
+    using text_parser::IsBlank;
+    using text_parser::ParseNumber;
+    for (const char *line = begin; line != end;) {
+      const char *line_end = static_cast<const char *>(std::memchr(line, '\n', end - line));
+      if (line_end == nullptr) line_end = end;
+      const char *p = line;
+      // the rest of a line after '#' is a comment
+      const char *comment = static_cast<const char *>(std::memchr(line, '#', line_end - line));
+      const char *content_end = comment == nullptr ? line_end : comment;
+      while (p != content_end && IsBlank(*p)) ++p;
+      if (p != content_end) {
+        DType label;
+        const char *q = ParseNumber(p, content_end, &label);
+        CHECK(q != p) << "Invalid LibSVM label: " << std::string(line, line_end);
+        p = q;
+        // the instance weight is not used
+        if (p != content_end && *p == ':') {
+          real_t weight;
+          p = ParseNumber(p + 1, content_end, &weight);
+        }
+        while (true) {
+          while (p != content_end && IsBlank(*p)) ++p;
+          if (p == content_end) break;
+          if (content_end - p > 4 && std::strncmp(p, "qid:", 4) == 0) {
+            while (p != content_end && !IsBlank(*p)) ++p;
+            continue;
+          }
+          CHECK(*p != '-') << "Negative feature index: " << std::string(line, line_end);
+          IndexType idx;
+          q = ParseNumber(p, content_end, &idx);
+          CHECK(q != p) << "Invalid LibSVM feature: " << std::string(line, line_end);
+          p = q;
+          DType v = DType(1);
+          if (p != content_end && *p == ':') {
+            q = ParseNumber(p + 1, content_end, &v);
+            CHECK(q != p + 1) << "Invalid LibSVM feature: " << std::string(line, line_end);
+            p = q;
+          }
+          out->index.push_back(idx);
+          out->value.push_back(v);
+        }
+        out->label.push_back(label);
+        out->offset.push_back(out->value.size());
+      }
+      line = line_end == end ? end : line_end + 1;
+    }
+  }
+
+  std::string path_;
+  uint32_t part_index_, num_parts_;
+  TextFormat format_;
+  std::string cache_file_;
+  int num_threads_;
+  /*! \brief the text, null when reading from the cache */
+  std::unique_ptr<text_parser::MappedFile> text_;
+  /*! \brief range of the text to read and position of the next chunk */
+  const char *begin_{nullptr}, *end_{nullptr}, *pos_{nullptr};
+  size_t bytes_read_{0};
+  /*! \brief cache being read, or written during the first pass */
+  std::unique_ptr<dmlc::SeekStream> cache_in_;
+  std::unique_ptr<dmlc::Stream> cache_out_;
+  size_t cache_data_begin_{0};
+  /*! \brief row blocks of the current chunk, one per thread */
+  std::vector<text_parser::RowBlockContainer<IndexType, DType> > blocks_;
+  size_t num_blocks_{0}, cur_block_{0};
+  dmlc::RowBlock<IndexType, DType> value_;
+  dmlc::OMPException omp_exc_;
+};
+
+/*!
+ * \brief Creates the parser of a text iterator: the streaming dmlc parser, or a
+ *  ParallelTextParser when parse_threads > 0 or a cache file is given.
+ */
+template<typename IndexType, typename DType>
+dmlc::Parser<IndexType, DType> *CreateTextParser(const std::string &path, unsigned part_index,
+                                                 unsigned num_parts, TextFormat format,
+                                                 int parse_threads,
+                                                 const std::string &cache_file) {
+  if (parse_threads == 0 && cache_file.empty()) {
+    return dmlc::Parser<IndexType, DType>::Create(
+        path.c_str(), part_index, num_parts, format == TextFormat::kCSV ? "csv" : "libsvm");
+  }
+  return new ParallelTextParser<IndexType, DType>(path, part_index, num_parts, format,
+                                                  parse_threads, cache_file);
+}
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_PARALLEL_TEXT_PARSER_H_
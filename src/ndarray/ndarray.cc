@@ -34,6 +34,15 @@
 #if MXNET_USE_MKLDNN == 1
 #include <mkldnn.hpp>
 #endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+#include <cerrno>
+#include <cstring>
+#include <mutex>
 #include "./ndarray_function.h"
 #include "../common/utils.h"
 #include "../operator/tensor/matrix_op-inl.h"
@@ -160,6 +169,25 @@ NDArray NDArray::grad() const {
   return NDArray();
 }
 
+// guards csr_trans of all chunks, operators reading the same csr array can run concurrently
+static std::mutex csr_trans_mutex;
+
+NDArray NDArray::GetCSRTranspose() const {
+  CHECK_EQ(storage_type(), kCSRStorage);
+  std::lock_guard<std::mutex> lock(csr_trans_mutex);
+  if (ptr_->csr_trans == nullptr || ptr_->csr_trans_version != version()) return NDArray();
+  return *ptr_->csr_trans;
+}
+
+void NDArray::SetCSRTranspose(const NDArray &trans) const {
+  CHECK_EQ(storage_type(), kCSRStorage);
+  CHECK_EQ(trans.storage_type(), kCSRStorage);
+  CHECK_EQ(trans.shape(), TShape(mshadow::Shape2(shape()[1], shape()[0])));
+  std::lock_guard<std::mutex> lock(csr_trans_mutex);
+  ptr_->csr_trans = std::make_shared<NDArray>(trans);
+  ptr_->csr_trans_version = version();
+}
+
 nnvm::Symbol NDArray::get_autograd_symbol() const {
   CHECK(!Imperative::AGInfo::IsNone(*this))
     << "NDArray is not part of a computation graph. Did you forget to turn on recording?";
@@ -1575,37 +1603,72 @@ static const uint32_t NDARRAY_V1_MAGIC = 0xF993fac8;
 /* magic number for ndarray version 2, with storage type */
 static const uint32_t NDARRAY_V2_MAGIC = 0xF993fac9;
 
-void NDArray::Save(dmlc::Stream *strm) const {
+/* magic number for ndarray version 2 with the data aligned to kNDArrayAlignment bytes */
+static const uint32_t NDARRAY_V2_ALIGNED_MAGIC = 0xF993faca;
+
+/* alignment of the data in the aligned format, from the beginning of the file */
+static const size_t kNDArrayAlignment = 64;
+
+/*!
+ * \brief Stream counting the bytes written to another stream, so that the
+ *  data written by NDArray::SaveAligned can be aligned.
+ */
+class CountingStream : public dmlc::Stream {
+ public:
+  explicit CountingStream(dmlc::Stream *strm) : strm_(strm) {}
+  size_t Read(void *ptr, size_t size) override {
+    LOG(FATAL) << "CountingStream is write only";
+    return 0;
+  }
+  void Write(const void *ptr, size_t size) override {
+    strm_->Write(ptr, size);
+    bytes_written_ += size;
+  }
+  size_t bytes_written() const {
+    return bytes_written_;
+  }
+
+ private:
+  dmlc::Stream *strm_;
+  size_t bytes_written_{0};
+};
+
+/*!
+ * \brief save an ndarray in the V2 format
+ * \param aligned if not nullptr, the stream to write to, and the data is aligned
+ *  to kNDArrayAlignment bytes in the stream.
+ */
+static void SaveNDArray(const NDArray &arr, dmlc::Stream *strm, CountingStream *aligned) {
   // write magic number to mark this version
   // for storage type
-  strm->Write(NDARRAY_V2_MAGIC);
+  strm->Write(aligned ? NDARRAY_V2_ALIGNED_MAGIC : NDARRAY_V2_MAGIC);
 
   // save storage type
-  int32_t stype = storage_type();
+  int32_t stype = arr.storage_type();
   strm->Write(&stype, sizeof(stype));
 
-  const int32_t nad = num_aux_data(storage_type());
+  const int32_t nad = num_aux_data(arr.storage_type());
   // save storage shape if ndarray is sparse
   if (nad > 0) {
-    storage_shape().Save(strm);
+    arr.storage_shape().Save(strm);
   }
 
   // save shape
-  shape_.Save(strm);
-  if (is_none()) return;
+  arr.shape().Save(strm);
+  if (arr.is_none()) return;
 
   // save context
-  Context ctx = this->ctx();
+  Context ctx = arr.ctx();
   ctx.Save(strm);
   TBlob save_data;
-  NDArray nd_cpu;  // a copy of *this on cpu
+  NDArray nd_cpu;  // a copy of arr on cpu
   if (ctx.dev_mask() != cpu::kDevMask) {
-    nd_cpu = this->Copy(Context::CPU());
+    nd_cpu = arr.Copy(Context::CPU());
     nd_cpu.WaitToRead();
     save_data = nd_cpu.data();
   } else {
-    this->WaitToRead();
-    nd_cpu = *this;
+    arr.WaitToRead();
+    nd_cpu = arr;
 #if MXNET_USE_MKLDNN == 1
     if (nd_cpu.IsMKLDNNData())
       nd_cpu = nd_cpu.Reorder2Default();
@@ -1620,17 +1683,26 @@ void NDArray::Save(dmlc::Stream *strm) const {
   // save aux_types and aux_shapes
   if (nad > 0) {
     for (int i = 0; i < nad; ++i) {
-      int32_t aux_type_flag = aux_type(i);
+      int32_t aux_type_flag = arr.aux_type(i);
       strm->Write(&aux_type_flag, sizeof(aux_type_flag));
-      aux_shape(i).Save(strm);
+      arr.aux_shape(i).Save(strm);
     }
   }
 
+  // pad so that the data starts at an aligned offset
+  if (aligned) {
+    const size_t offset = aligned->bytes_written() + sizeof(uint32_t);
+    const uint32_t padding = (kNDArrayAlignment - offset % kNDArrayAlignment) % kNDArrayAlignment;
+    const char zeros[kNDArrayAlignment] = {0};
+    strm->Write(padding);
+    strm->Write(zeros, padding);
+  }
+
   // save data
   CHECK(save_data.CheckContiguous());
   size_t type_size = mshadow::mshadow_sizeof(type_flag);
   // save data could be values of sparse tensors
-  // must use save_data.shape_ instead of this->shape_
+  // must use save_data.shape_ instead of arr.shape()
   strm->Write(save_data.dptr_, type_size * save_data.shape_.Size());
 
   // save aux data
@@ -1639,12 +1711,16 @@ void NDArray::Save(dmlc::Stream *strm) const {
       TBlob save_data = nd_cpu.aux_data(i);
       // save aux_data
       CHECK(save_data.CheckContiguous());
-      size_t aux_type_size = mshadow::mshadow_sizeof(aux_type(i));
+      size_t aux_type_size = mshadow::mshadow_sizeof(arr.aux_type(i));
       strm->Write(save_data.dptr_, aux_type_size * save_data.Size());
     }
   }
 }
 
+void NDArray::Save(dmlc::Stream *strm) const {
+  SaveNDArray(*this, strm, nullptr);
+}
+
 bool LegacyTShapeLoad(dmlc::Stream *strm, TShape *shape, const uint32_t magic) {
   switch (magic) {
     case NDARRAY_V1_MAGIC:
@@ -1692,71 +1768,99 @@ bool NDArray::LegacyLoad(dmlc::Stream *strm, const uint32_t magic) {
   }
 }
 
-bool NDArray::Load(dmlc::Stream *strm) {
-  uint32_t magic;
-  if (strm->Read(&magic, sizeof(uint32_t)) != sizeof(uint32_t)) return false;
-  if (magic != NDARRAY_V2_MAGIC) {
-    return LegacyLoad(strm, magic);
-  }
+/*! \brief everything stored before the data of an ndarray in the V2 formats */
+struct NDArrayV2Header {
+  int32_t stype;
+  int32_t nad;
+  TShape sshape;
+  TShape shape;
+  Context ctx;
+  int32_t type_flag;
+  std::vector<int32_t> aux_types;
+  std::vector<TShape> aux_shapes;
+};
 
+/*!
+ * \brief load the header of an ndarray in the V2 formats, after its magic number.
+ *  Nothing is read past the shape if the ndarray is none.
+ */
+static bool LoadV2Header(dmlc::Stream *strm, const uint32_t magic, NDArrayV2Header *header) {
   // load storage type
-  int32_t stype;
-  if (strm->Read(&stype, sizeof(stype)) != sizeof(stype)) return false;
-  const int32_t nad = num_aux_data(static_cast<NDArrayStorageType>(stype));
+  if (strm->Read(&header->stype, sizeof(header->stype)) != sizeof(header->stype)) return false;
+  header->nad = num_aux_data(static_cast<NDArrayStorageType>(header->stype));
 
   // load storage shape
-  TShape sshape;
-  if (nad > 0) {
-    if (!sshape.Load(strm)) return false;
+  if (header->nad > 0) {
+    if (!header->sshape.Load(strm)) return false;
   }
 
   // load shape
-  TShape shape;
-  if (!shape.Load(strm)) return false;
-  if (shape.ndim() == 0) {
-    *this = NDArray(); return true;
-  }
+  if (!header->shape.Load(strm)) return false;
+  if (header->shape.ndim() == 0) return true;
 
   // load context
-  Context ctx;
-  if (!ctx.Load(strm)) return false;
+  if (!header->ctx.Load(strm)) return false;
 
   // load type flag
-  int32_t type_flag;
-  if (strm->Read(&type_flag, sizeof(type_flag)) != sizeof(type_flag)) return false;
+  if (strm->Read(&header->type_flag, sizeof(header->type_flag)) != sizeof(header->type_flag)) {
+    return false;
+  }
 
   // load aux_types and aux_shapes
-  std::vector<int32_t> aux_types;
-  std::vector<TShape> aux_shapes;
-  if (nad > 0) {
-    aux_types.resize(nad);
-    aux_shapes.resize(nad);
-    for (int i = 0; i < nad; ++i) {
+  if (header->nad > 0) {
+    header->aux_types.resize(header->nad);
+    header->aux_shapes.resize(header->nad);
+    for (int i = 0; i < header->nad; ++i) {
       // load aux_type(i)
-      if (strm->Read(&aux_types[i], sizeof(aux_types[i])) != sizeof(aux_types[i])) return false;
+      if (strm->Read(&header->aux_types[i], sizeof(header->aux_types[i])) !=
+          sizeof(header->aux_types[i])) return false;
       // load aux_shapes(i)
-      if (!aux_shapes[i].Load(strm)) return false;
+      if (!header->aux_shapes[i].Load(strm)) return false;
     }
   }
 
+  // skip the padding in front of aligned data
+  if (magic == NDARRAY_V2_ALIGNED_MAGIC) {
+    uint32_t padding;
+    if (strm->Read(&padding, sizeof(padding)) != sizeof(padding)) return false;
+    if (padding >= kNDArrayAlignment) return false;
+    char buf[kNDArrayAlignment];
+    if (strm->Read(buf, padding) != padding) return false;
+  }
+  return true;
+}
+
+bool NDArray::Load(dmlc::Stream *strm) {
+  uint32_t magic;
+  if (strm->Read(&magic, sizeof(uint32_t)) != sizeof(uint32_t)) return false;
+  if (magic != NDARRAY_V2_MAGIC && magic != NDARRAY_V2_ALIGNED_MAGIC) {
+    return LegacyLoad(strm, magic);
+  }
+
+  NDArrayV2Header header;
+  if (!LoadV2Header(strm, magic, &header)) return false;
+  if (header.shape.ndim() == 0) {
+    *this = NDArray(); return true;
+  }
+
   // load data into CPU
   NDArray temp;
-  if (0 == nad) {
-    temp = NDArray(shape, Context::CPU(), false, type_flag);
+  if (0 == header.nad) {
+    temp = NDArray(header.shape, Context::CPU(), false, header.type_flag);
   } else {
-    temp = NDArray(static_cast<NDArrayStorageType>(stype), shape,
-                   Context::CPU(), false, type_flag,
-                   aux_types, aux_shapes, sshape);
+    temp = NDArray(static_cast<NDArrayStorageType>(header.stype), header.shape,
+                   Context::CPU(), false, header.type_flag,
+                   header.aux_types, header.aux_shapes, header.sshape);
   }
   // load data
   TBlob load_data = temp.data();
-  size_t type_size = mshadow::mshadow_sizeof(type_flag);
+  size_t type_size = mshadow::mshadow_sizeof(header.type_flag);
   size_t nread = type_size * load_data.Size();
   if (strm->Read(load_data.dptr_, nread) != nread) return false;
 
   // load aux_data
-  if (nad > 0) {
-    for (int i = 0; i < nad; ++i) {
+  if (header.nad > 0) {
+    for (int i = 0; i < header.nad; ++i) {
       load_data = temp.aux_data(i);
       type_size = mshadow::mshadow_sizeof(load_data.type_flag_);
       nread = type_size * load_data.Size();
@@ -1764,11 +1868,11 @@ bool NDArray::Load(dmlc::Stream *strm) {
     }
   }
 
-  if (ctx.dev_mask() == cpu::kDevMask) {
+  if (header.ctx.dev_mask() == cpu::kDevMask) {
     *this = std::move(temp); return true;
   } else {
 #if MXNET_USE_CUDA
-    *this = temp.Copy(ctx); return true;
+    *this = temp.Copy(header.ctx); return true;
 #else
     *this = std::move(temp); return true;
 #endif
@@ -1776,6 +1880,8 @@ bool NDArray::Load(dmlc::Stream *strm) {
 }
 
 const uint64_t kMXAPINDArrayListMagic = 0x112;
+/* magic number of lists saved by SaveAligned */
+const uint64_t kMXAPINDArrayListAlignedMagic = 0x113;
 
 void NDArray::Save(dmlc::Stream* fo,
                    const std::vector<NDArray>& data,
@@ -1795,7 +1901,8 @@ void NDArray::Load(dmlc::Stream* fi,
       << "Invalid NDArray file format";
   CHECK(fi->Read(&reserved))
       << "Invalid NDArray file format";
-  CHECK(header == kMXAPINDArrayListMagic)
+  // the arrays of SaveAligned are serialized like a vector<NDArray>, with padding
+  CHECK(header == kMXAPINDArrayListMagic || header == kMXAPINDArrayListAlignedMagic)
       << "Invalid NDArray file format";
   CHECK(fi->Read(data))
       << "Invalid NDArray file format";
@@ -1805,6 +1912,131 @@ void NDArray::Load(dmlc::Stream* fi,
       << "Invalid NDArray file format";
 }
 
+void NDArray::SaveAligned(dmlc::Stream* fo,
+                          const std::vector<NDArray>& data,
+                          const std::vector<std::string>& names) {
+  CountingStream strm(fo);
+  uint64_t header = kMXAPINDArrayListAlignedMagic, reserved = 0;
+  strm.Write(&header, sizeof(header));
+  strm.Write(&reserved, sizeof(reserved));
+  // same layout as dmlc::Stream::Write of a vector
+  uint64_t size = data.size();
+  strm.Write(&size, sizeof(size));
+  for (const NDArray& arr : data) {
+    SaveNDArray(arr, &strm, &strm);
+  }
+  strm.Write(names);
+}
+
+#ifndef _WIN32
+/*! \brief read only, private mapping of a whole file */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& fname) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "Failed to open " << fname << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << fname << ": " << strerror(errno);
+    size_ = st.st_size;
+    if (size_ > 0) {
+      // Writable private mapping: the pages are shared with the page cache and other
+      // processes mapping the file until they are written to, then copied.
+      dptr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    CHECK_NE(dptr_, MAP_FAILED) << "Failed to map " << fname << ": " << strerror(errno);
+  }
+  ~MappedFile() {
+    if (size_ > 0) munmap(dptr_, size_);
+  }
+  char* data() const {
+    return static_cast<char*>(dptr_);
+  }
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  void* dptr_{nullptr};
+  size_t size_{0};
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+/*!
+ * \brief load an ndarray from a mapped file, referencing the mapping when it is dense,
+ *  aligned and saved on CPU.
+ */
+static bool LoadMappedNDArray(dmlc::MemoryFixedSizeStream *strm,
+                              const std::shared_ptr<MappedFile>& file,
+                              NDArray *arr) {
+  const size_t start = strm->Tell();
+  uint32_t magic;
+  if (strm->Read(&magic, sizeof(magic)) != sizeof(magic)) return false;
+  NDArrayV2Header header;
+  if (magic != NDARRAY_V2_ALIGNED_MAGIC ||
+      !LoadV2Header(strm, magic, &header) ||
+      header.shape.ndim() == 0 || header.nad > 0) {
+    strm->Seek(start);
+    return arr->Load(strm);
+  }
+  const size_t offset = strm->Tell();
+  const size_t nbytes = mshadow::mshadow_sizeof(header.type_flag) * header.shape.Size();
+  if (offset % kNDArrayAlignment != 0 || offset + nbytes > file->size()) return false;
+  strm->Seek(offset + nbytes);
+
+  TBlob blob(file->data() + offset, header.shape, cpu::kDevMask, header.type_flag, 0);
+  // the mapping lives as long as the arrays referencing it
+  NDArray mapped(blob, 0, [file]() {});
+  if (header.ctx.dev_mask() == cpu::kDevMask) {
+    *arr = std::move(mapped);
+  } else {
+#if MXNET_USE_CUDA
+    *arr = mapped.Copy(header.ctx);
+#else
+    *arr = std::move(mapped);
+#endif
+  }
+  return true;
+}
+#endif  // _WIN32
+
+void NDArray::LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys) {
+#ifdef _WIN32
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+  Load(fi.get(), data, keys);
+#else
+  auto file = std::make_shared<MappedFile>(fname);
+  dmlc::MemoryFixedSizeStream strm(file->data(), file->size());
+  uint64_t header, reserved;
+  CHECK(strm.Read(&header))
+      << "Invalid NDArray file format";
+  CHECK(strm.Read(&reserved))
+      << "Invalid NDArray file format";
+  if (header == kMXAPINDArrayListMagic) {
+    // not aligned, the arrays are copied out of the mapping
+    strm.Seek(0);
+    Load(&strm, data, keys);
+    return;
+  }
+  CHECK(header == kMXAPINDArrayListAlignedMagic)
+      << "Invalid NDArray file format";
+  uint64_t size;
+  CHECK(strm.Read(&size))
+      << "Invalid NDArray file format";
+  data->resize(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    CHECK(LoadMappedNDArray(&strm, file, &(*data)[i]))
+        << "Invalid NDArray file format";
+  }
+  CHECK(strm.Read(keys))
+      << "Invalid NDArray file format";
+  CHECK(keys->size() == 0 || keys->size() == data->size())
+      << "Invalid NDArray file format";
+#endif  // _WIN32
+}
+
 NDArray NDArray::Copy(Context ctx) const {
   NDArray ret;
   if (kDefaultStorage == storage_type()) {
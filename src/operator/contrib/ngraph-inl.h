@@ -32,10 +32,15 @@
 #include <ngraph_nnvm_ops.h>
 #include <ngraph_utils.h>
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include "../subgraph/common.h"
 #include "../subgraph/subgraph_property.h"
+#include "./ngraph_compile_cache.h"
 
 namespace mxnet {
 namespace op {
@@ -43,6 +48,33 @@ namespace op {
 // when built with NGRAPH we use this subgraph by default
 static int ngraph_backend = setenv("MXNET_SUBGRAPH_BACKEND", "ngraph", 0);
 
+/*!
+ * \brief Parsed attributes of _ngraph_subgraph_op: the partitioned subgraph and the
+ *  compiler bound to the current input shapes. Compilers come from NgraphCompileCache
+ *  and may be shared by several nodes, so they are replaced rather than reshaped in place.
+ */
+struct NgraphSubgraphParam {
+  typedef std::shared_ptr<ngraph_bridge::Compiler> CompilerPtr;
+
+  nnvm::Graph subgraph;
+  std::vector<mxnet::OpReqType> grad_reqs;
+  // input shapes the subgraph was partitioned with
+  nnvm::ShapeVector bind_shapes;
+  std::mutex mutex;
+  CompilerPtr compiler;
+  // compilers of the input shapes seen by this node, most recently used first,
+  // at most MXNET_NGRAPH_SHAPE_CACHE_SIZE entries
+  std::list<std::pair<nnvm::ShapeVector, CompilerPtr>> shape_cache;
+};
+
+/*!
+ * \brief Compiles a subgraph with nGraph. Everything derived from the compiled graph,
+ *  such as its zero_grad flag, is set here before the compiler can be shared through
+ *  NgraphCompileCache; nodes sharing it only read it afterwards.
+ */
+std::shared_ptr<ngraph_bridge::Compiler> CompileNgraphSubgraph(
+    const nnvm::Graph &sg, const std::vector<mxnet::OpReqType> &grad_reqs);
+
 class SgNgraphSelector : public SubgraphSelector {
  public:
   // Public methods to implement the subgraph selector API
@@ -123,17 +155,26 @@ class SgNgraphProperty : public SubgraphProperty {
     return n;
   }
   // Create a subgraph node based on a graph with inferred shapes, types
-  // and storage types, then compile it with nGraph and store the
-  // ngraph_bridge::Compiler object in NNVM's node attributes for execution.
+  // and storage types, then compile it with nGraph (or fetch it from the
+  // compile cache) and store the ngraph_bridge::Compiler object in NNVM's
+  // node attributes for execution.
   nnvm::NodePtr CreateSubgraphNode(
       const nnvm::Graph &sg, const int subgraph_id = 0) const override {
     nnvm::Symbol sym;
     sym.outputs = sg.outputs;
     auto n = CreateSubgraphNode(sym, subgraph_id);
-    auto grad_req_map = GetAttr<std::vector<mxnet::OpReqType>>("grad_reqs");
-    auto compiler = std::make_shared<ngraph_bridge::Compiler>(sg, grad_req_map);
-    compiler->GetNgraph();
-    n->attrs.parsed = compiler;
+    auto param = std::make_shared<NgraphSubgraphParam>();
+    param->subgraph = sg;
+    param->grad_reqs = GetAttr<std::vector<mxnet::OpReqType>>("grad_reqs");
+    param->compiler = NgraphCompileCache::Get()->GetOrCompile(
+        sg, param->grad_reqs, [&sg, &param]() {
+          return CompileNgraphSubgraph(sg, param->grad_reqs);
+        });
+    for (const auto &input : param->compiler->GetNgraph()->inputs_) {
+      param->bind_shapes.push_back(input->shape_);
+    }
+    param->shape_cache.emplace_front(param->bind_shapes, param->compiler);
+    n->attrs.parsed = param;
     return n;
   }
   // Create a Subgraph Selector with an embedded ngraph_bridge::Compiler for
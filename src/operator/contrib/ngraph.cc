@@ -31,17 +31,278 @@
 #include <ngraph_sgcompiler_utils.h>
 #include <ngraph_utils.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "../../executor/exec_pass.h"
 #include "../subgraph/common.h"
 #include "../subgraph/subgraph_property.h"
 #include "./ngraph-inl.h"
+#include "./ngraph_compile_cache.h"
 
 namespace mxnet {
 namespace op {
 
+std::shared_ptr<NgraphSubgraphParam> get_param(const NodeAttrs &attrs) {
+  return nnvm::get<std::shared_ptr<NgraphSubgraphParam>>(attrs.parsed);
+}
+
 std::shared_ptr<ngraph_bridge::Graph> get_ngraph(const NodeAttrs &attrs) {
-  auto compiler =
-      nnvm::get<std::shared_ptr<ngraph_bridge::Compiler>>(attrs.parsed);
-  return compiler->GetNgraph();
+  auto param = get_param(attrs);
+  std::lock_guard<std::mutex> lock(param->mutex);
+  return param->compiler->GetNgraph();
+}
+
+std::shared_ptr<ngraph_bridge::Compiler> CompileNgraphSubgraph(
+    const nnvm::Graph &sg, const std::vector<mxnet::OpReqType> &grad_reqs) {
+  auto compiler = std::make_shared<ngraph_bridge::Compiler>(sg, grad_reqs);
+  auto graph = compiler->GetNgraph();
+  graph->zero_grad = check_zero_grad(graph);
+  return compiler;
+}
+
+// Returns a copy of the subgraph with the shapes of all its entries inferred
+// from the given input shapes.
+nnvm::Graph InferSubgraphShapes(const nnvm::Graph &sg,
+                                const nnvm::ShapeVector &in_shapes) {
+  const auto &idx = sg.indexed_graph();
+  const auto &input_nids = idx.input_nodes();
+  ngraph_check(input_nids.size() == in_shapes.size());
+
+  nnvm::Graph g;
+  g.outputs = sg.outputs;
+  g.attrs = sg.attrs;
+  nnvm::ShapeVector shapes(idx.num_node_entries());
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    shapes[idx.entry_id(input_nids[i], 0)] = in_shapes[i];
+  }
+  g.attrs["shape"] = std::make_shared<dmlc::any>(std::move(shapes));
+  return exec::InferShape(std::move(g));
+}
+
+// Returns the compiler of the node's subgraph for new input shapes. The shapes
+// are propagated through a copy of the subgraph so that the result can be
+// looked up in and shared through the compile cache.
+std::shared_ptr<ngraph_bridge::Compiler> ReshapeNgraphSubgraph(
+    const NgraphSubgraphParam &param, const nnvm::ShapeVector &in_shapes) {
+  const auto &sg = param.subgraph;
+  nnvm::Graph g = InferSubgraphShapes(sg, in_shapes);
+
+  if (g.GetAttr<size_t>("shape_num_unknown_nodes") != 0) {
+    // The subgraph cannot be reshaped without nGraph's help; compile a
+    // private copy, it must not replace the shared entry of the old shapes.
+    auto compiler =
+        std::make_shared<ngraph_bridge::Compiler>(sg, param.grad_reqs);
+    compiler->ReshapeGraph(in_shapes);
+    auto graph = compiler->GetNgraph();
+    graph->zero_grad = check_zero_grad(graph);
+    return compiler;
+  }
+  return NgraphCompileCache::Get()->GetOrCompile(
+      g, param.grad_reqs, [&g, &param]() {
+        return CompileNgraphSubgraph(g, param.grad_reqs);
+      });
+}
+
+// Returns the compiler of the node for the given input shapes, reusing the
+// ones it has already compiled. Must be called with param->mutex held.
+std::shared_ptr<ngraph_bridge::Compiler> GetShapeCompiler(
+    NgraphSubgraphParam *param, const nnvm::ShapeVector &in_shapes) {
+  static const size_t capacity =
+      std::max(dmlc::GetEnv("MXNET_NGRAPH_SHAPE_CACHE_SIZE", 8), 1);
+  auto &cache = param->shape_cache;
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->first == in_shapes) {
+      cache.splice(cache.begin(), cache, it);
+      return it->second;
+    }
+  }
+  auto compiler = ReshapeNgraphSubgraph(*param, in_shapes);
+  cache.emplace_front(in_shapes, compiler);
+  while (cache.size() > capacity) cache.pop_back();
+  return compiler;
+}
+
+// Batch sizes inference subgraphs are compiled for, from
+// MXNET_NGRAPH_BATCH_BUCKETS: either "pow2" or an increasing list of sizes
+// such as "1,8,32". Returns 0 if the batch size is above the last bucket or
+// bucketing is disabled.
+nnvm::dim_t NgraphBatchBucket(nnvm::dim_t batch) {
+  // read on every call, shape inference is rare enough
+  const std::string spec =
+      dmlc::GetEnv("MXNET_NGRAPH_BATCH_BUCKETS", std::string());
+  if (spec == "pow2") {
+    nnvm::dim_t bucket = 1;
+    while (bucket < batch) bucket <<= 1;
+    return bucket;
+  }
+  std::vector<nnvm::dim_t> buckets;
+  std::istringstream is(spec);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty()) buckets.push_back(std::stoll(item));
+  }
+  std::sort(buckets.begin(), buckets.end());
+  for (const nnvm::dim_t bucket : buckets) {
+    if (bucket >= batch) return bucket;
+  }
+  return 0;
+}
+
+// Whether the axis attribute of a node, or default_axis if it is not set,
+// names the first of ndim axes. "None" stands for all axes.
+bool AxisAttrHasFirst(const nnvm::NodeAttrs &attrs, int default_axis,
+                      int ndim) {
+  auto it = attrs.dict.find("axis");
+  if (it == attrs.dict.end()) {
+    return default_axis == 0 || default_axis + ndim == 0;
+  }
+  if (it->second.find("None") != std::string::npos) return true;
+  // a single axis such as "-1", or a tuple such as "(0, 2)"
+  std::string axes(it->second);
+  for (char &c : axes) {
+    if (c != '-' && !std::isdigit(static_cast<unsigned char>(c))) c = ' ';
+  }
+  std::istringstream is(axes);
+  int axis;
+  while (is >> axis) {
+    if (axis == 0 || axis + ndim == 0) return true;
+  }
+  return false;
+}
+
+// Whether an operator that keeps the shape of its batched input combines
+// rows along the batch axis, by normalizing, sorting or reversing along it.
+bool MixesBatchRows(const nnvm::NodeAttrs &attrs, int ndim) {
+  static const std::unordered_map<std::string, int> axis_ops = {
+      {"softmax", -1}, {"log_softmax", -1}, {"softmin", -1},
+      {"LayerNorm", -1}, {"sort", -1},      {"argsort", -1},
+      {"topk", -1},      {"reverse", 0},    {"flip", 0}};
+  const std::string &name = attrs.op->name;
+  // the sequence operators and RNN use the first axis for time
+  if (name == "SequenceReverse" || name == "RNN") return true;
+  auto it = axis_ops.find(name);
+  return it != axis_ops.end() && AxisAttrHasFirst(attrs, it->second, ndim);
+}
+
+// Whether padding the batched inputs with more rows leaves the leading rows
+// of every output unchanged. The subgraph's shapes are inferred for the
+// partitioned batch size and for one more row; entries whose shapes differ
+// carry the batch. Every node reading such an entry must keep the batch on
+// the first axis of all its outputs, which rules out reductions over the
+// batch axis and reshapes that fold it into other axes, and must not mix
+// rows along it otherwise. Operators whose training mode computes batch
+// statistics, such as BatchNorm, are independent per row in inference,
+// which is all that bucketing applies to.
+bool BatchRowsIndependent(const NgraphSubgraphParam &param,
+                          const std::vector<size_t> &batched) {
+  nnvm::ShapeVector grown(param.bind_shapes);
+  for (const size_t i : batched) grown[i][0] += 1;
+  nnvm::Graph g, g_grown;
+  try {
+    g = InferSubgraphShapes(param.subgraph, param.bind_shapes);
+    g_grown = InferSubgraphShapes(param.subgraph, grown);
+  } catch (const dmlc::Error &) {
+    // e.g. a weight whose shape follows the batch size
+    return false;
+  }
+  if (g.GetAttr<size_t>("shape_num_unknown_nodes") != 0 ||
+      g_grown.GetAttr<size_t>("shape_num_unknown_nodes") != 0) {
+    return false;
+  }
+  const auto &shapes = g.GetAttr<nnvm::ShapeVector>("shape");
+  const auto &grown_shapes = g_grown.GetAttr<nnvm::ShapeVector>("shape");
+  const auto &idx = g.indexed_graph();
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto &node = idx[nid];
+    if (node.source->is_variable()) continue;
+    int ndim = -1;
+    for (const auto &e : node.inputs) {
+      const uint32_t eid = idx.entry_id(e);
+      if (shapes[eid] != grown_shapes[eid]) {
+        ndim = shapes[eid].ndim();
+        break;
+      }
+    }
+    if (ndim < 0) continue;
+    for (uint32_t i = 0; i < node.source->num_outputs(); ++i) {
+      const auto &shape = shapes[idx.entry_id(nid, i)];
+      const auto &grown_shape = grown_shapes[idx.entry_id(nid, i)];
+      if (shape.ndim() == 0 || shape.ndim() != grown_shape.ndim() ||
+          shape[0] + 1 != grown_shape[0] ||
+          !std::equal(shape.begin() + 1, shape.end(),
+                      grown_shape.begin() + 1)) {
+        return false;
+      }
+    }
+    if (MixesBatchRows(node.source->attrs, ndim)) return false;
+  }
+  return true;
+}
+
+// Rounds the batch dimension of the inputs up to its bucket. Inputs are
+// batched if they differ from the partitioned shapes in their first
+// dimension only; the others, e.g. weights, are left untouched. Only
+// inference subgraphs whose rows are independent are bucketed. Returns the
+// shapes to compile for and sets the batch size and its bucket.
+nnvm::ShapeVector BucketShapes(const NgraphSubgraphParam &param,
+                               const ngraph_bridge::Graph &graph,
+                               const nnvm::ShapeVector &in_shapes,
+                               nnvm::dim_t *batch, nnvm::dim_t *bucket) {
+  *batch = *bucket = 0;
+  if (graph.need_grad) return in_shapes;
+  std::vector<size_t> batched;
+  for (size_t i = 0; i < in_shapes.size(); ++i) {
+    const auto &shape = in_shapes[i];
+    const auto &bind_shape = param.bind_shapes[i];
+    if (shape == bind_shape) continue;
+    if (shape.ndim() == 0 || shape.ndim() != bind_shape.ndim() ||
+        !std::equal(shape.begin() + 1, shape.end(), bind_shape.begin() + 1) ||
+        (*batch != 0 && shape[0] != *batch)) {
+      return in_shapes;
+    }
+    *batch = shape[0];
+    batched.push_back(i);
+  }
+  if (batched.empty() || (*bucket = NgraphBatchBucket(*batch)) == 0 ||
+      !BatchRowsIndependent(param, batched)) {
+    *batch = *bucket = 0;
+    return in_shapes;
+  }
+  nnvm::ShapeVector ret(in_shapes);
+  for (const size_t i : batched) ret[i][0] = *bucket;
+  return ret;
+}
+
+// Copies the leading rows of src into dst. Rows of dst past the end of src
+// are zeroed when they are written.
+void CopyBatchRows(const NDArray &src, const NDArray &dst, OpReqType req) {
+  if (req == kNullOp) return;
+  CHECK_EQ(src.ctx().dev_mask(), cpu::kDevMask)
+      << "NGRAPH_BRIDGE: batch bucketing is only supported on CPU";
+  CHECK_EQ(src.dtype(), dst.dtype());
+  const TBlob &sblob = src.data();
+  const TBlob &dblob = dst.data();
+  const size_t row = sblob.shape_.ProdShape(1, sblob.shape_.ndim());
+  const size_t rows = std::min(sblob.shape_[0], dblob.shape_[0]);
+  MSHADOW_TYPE_SWITCH(src.dtype(), DType, {
+    const DType *sptr = sblob.dptr<DType>();
+    DType *dptr = dblob.dptr<DType>();
+    if (req == kAddTo) {
+      for (size_t i = 0; i < rows * row; ++i) dptr[i] += sptr[i];
+    } else {
+      std::memcpy(dptr, sptr, rows * row * sizeof(DType));
+      if (dblob.shape_[0] > rows) {
+        std::memset(dptr + rows * row, 0,
+                    (dblob.Size() - rows * row) * sizeof(DType));
+      }
+    }
+  });
 }
 
 class NgraphSubgraphOperator {
@@ -63,7 +324,48 @@ void NgraphSubgraphOperator::Forward(const OpContext &ctx,
                                      const std::vector<NDArray> &inputs,
                                      const std::vector<OpReqType> &req,
                                      const std::vector<NDArray> &outputs) {
-  compute_forward(ctx, ngraph_, inputs, req, outputs);
+  bool padded = false;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    padded = padded || inputs[i].shape() != ngraph_->inputs_[i]->shape_;
+  }
+  if (!padded) {
+    compute_forward(ctx, ngraph_, inputs, req, outputs);
+    return;
+  }
+  // The subgraph was compiled for the batch bucket of the inputs: run it on
+  // zero-padded copies and keep the leading rows of the results.
+  CHECK(!ctx.is_train)
+      << "NGRAPH_BRIDGE: batch bucketing is only supported for inference";
+  std::vector<NDArray> padded_inputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto &shape = ngraph_->inputs_[i]->shape_;
+    if (inputs[i].shape() == shape) {
+      padded_inputs.push_back(inputs[i]);
+    } else {
+      padded_inputs.emplace_back(shape, inputs[i].ctx(), false,
+                                 inputs[i].dtype());
+      CopyBatchRows(inputs[i], padded_inputs.back(), kWriteTo);
+    }
+  }
+  std::vector<NDArray> padded_outputs;
+  std::vector<OpReqType> padded_req(req);
+  const auto &results = ngraph_->get_results();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto shape = ngraph_bridge::NShape_to_TShape(results[i]->get_shape());
+    if (outputs[i].shape() == shape) {
+      padded_outputs.push_back(outputs[i]);
+    } else {
+      padded_outputs.emplace_back(shape, outputs[i].ctx(), false,
+                                  outputs[i].dtype());
+      padded_req[i] = req[i] == kNullOp ? kNullOp : kWriteTo;
+    }
+  }
+  compute_forward(ctx, ngraph_, padded_inputs, padded_req, padded_outputs);
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (!padded_outputs[i].IsSame(outputs[i])) {
+      CopyBatchRows(padded_outputs[i], outputs[i], req[i]);
+    }
+  }
 }
 
 void NgraphSubgraphOperator::Backward(const OpContext &ctx,
@@ -97,9 +399,9 @@ void NgraphSubgraphOpBackward(const OpStatePtr &state_ptr, const OpContext &ctx,
 
 std::vector<nnvm::NodeEntry> NgraphSubgraphGradient(
     const nnvm::NodePtr &n, const std::vector<nnvm::NodeEntry> &ograds) {
+  // zero_grad was set when the graph was compiled, it is only read here
   auto graph = get_ngraph(n->attrs);
-  const bool zero_grad = check_zero_grad(graph);
-  graph->zero_grad = zero_grad;
+  const bool zero_grad = graph->zero_grad;
   auto is_loss = graph->is_loss;
   auto p = nnvm::Node::Create();
   p->attrs.op = nnvm::Op::Get("_backward_ngraph_subgraph_op");
@@ -159,8 +461,7 @@ std::vector<std::string> NgraphSubgraphListOutputNames(
 bool NgraphSubgraphInferShape(const nnvm::NodeAttrs &attrs,
                               std::vector<nnvm::TShape> *in_attrs,
                               std::vector<nnvm::TShape> *out_attrs) {
-  auto compiler =
-      nnvm::get<std::shared_ptr<ngraph_bridge::Compiler>>(attrs.parsed);
+  auto param = get_param(attrs);
   auto graph = get_ngraph(attrs);
 
   ngraph_check(in_attrs != nullptr);
@@ -168,17 +469,33 @@ bool NgraphSubgraphInferShape(const nnvm::NodeAttrs &attrs,
   ngraph_check(in_attrs->size() == graph->inputs_.size());
   ngraph_check(out_attrs->size() == graph->get_results().size());
 
-  if ((graph->inputs_.size() > 0) &&
-      (*in_attrs)[0] != graph->inputs_[0]->shape_) {
-    compiler->ReshapeGraph(*in_attrs);
-    graph = compiler->GetNgraph();
+  // inputs that are not known yet keep the shapes they were compiled for
+  nnvm::ShapeVector in_shapes(*in_attrs);
+  for (size_t i = 0; i < in_shapes.size(); ++i) {
+    if (in_shapes[i].ndim() == 0) in_shapes[i] = graph->inputs_[i]->shape_;
   }
-  for (size_t i = 0; i < graph->inputs_.size(); ++i) {
-    (*in_attrs)[i] = graph->inputs_[i]->shape_;
+  nnvm::dim_t batch = 0, bucket = 0;
+  auto compile_shapes =
+      BucketShapes(*param, *graph, in_shapes, &batch, &bucket);
+  bool reshape = false;
+  for (size_t i = 0; i < compile_shapes.size(); ++i) {
+    reshape = reshape || compile_shapes[i] != graph->inputs_[i]->shape_;
+  }
+  if (reshape) {
+    std::lock_guard<std::mutex> lock(param->mutex);
+    param->compiler = GetShapeCompiler(param.get(), compile_shapes);
+    graph = param->compiler->GetNgraph();
+  }
+  for (size_t i = 0; i < in_shapes.size(); ++i) {
+    (*in_attrs)[i] = in_shapes[i];
   }
   size_t i = 0;
   for (const auto& output : graph->get_results()) {
     auto tmp_shape = ngraph_bridge::NShape_to_TShape(output->get_shape());
+    // batched outputs are sliced back from the bucket to the batch size
+    if (bucket != batch && tmp_shape.ndim() > 0 && tmp_shape[0] == bucket) {
+      tmp_shape[0] = batch;
+    }
     (*out_attrs)[i] = tmp_shape;
     i += 1;
   }
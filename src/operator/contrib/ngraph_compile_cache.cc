@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ngraph_compile_cache.cc
+ * \brief content-addressed cache of compiled nGraph subgraphs
+*/
+
+#if MXNET_USE_NGRAPH
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <nnvm/pass_functions.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "./ngraph_compile_cache.h"
+#include "../../executor/exec_pass.h"
+
+namespace mxnet {
+namespace op {
+
+NgraphCompileCache *NgraphCompileCache::Get() {
+  static NgraphCompileCache inst;
+  return &inst;
+}
+
+NgraphCompileCache::NgraphCompileCache()
+  : capacity_(dmlc::GetEnv("MXNET_NGRAPH_COMPILE_CACHE_SIZE", 64)) {}
+
+std::string NgraphCompileCache::Key(const nnvm::Graph &sg,
+                                    const std::vector<mxnet::OpReqType> &grad_reqs) {
+  nnvm::Graph structure;
+  structure.outputs = sg.outputs;
+  std::ostringstream os;
+  os << nnvm::pass::SaveJSON(structure) << ';';
+
+  const auto &idx = sg.indexed_graph();
+  const auto &shapes = sg.GetAttr<nnvm::ShapeVector>("shape");
+  const auto &dtypes = sg.GetAttr<nnvm::DTypeVector>("dtype");
+  for (const uint32_t nid : idx.input_nodes()) {
+    const uint32_t eid = idx.entry_id(nid, 0);
+    os << shapes[eid] << ':' << dtypes[eid];
+    if (sg.attrs.count("context")) {
+      const auto &ctx = sg.GetAttr<exec::ContextVector>("context")[nid];
+      os << ':' << ctx.dev_type << '/' << ctx.dev_id;
+    }
+    os << ';';
+  }
+  for (const auto req : grad_reqs) os << req << ',';
+  return os.str();
+}
+
+NgraphCompileCache::CompilerPtr NgraphCompileCache::GetOrCompile(
+    const nnvm::Graph &sg, const std::vector<mxnet::OpReqType> &grad_reqs,
+    const std::function<CompilerPtr()> &fcompile) {
+  // a graph compiled for training keeps the values of its last forward pass for the
+  // backward pass, so that every node needs a graph of its own
+  const bool shared = std::all_of(grad_reqs.begin(), grad_reqs.end(),
+                                  [](mxnet::OpReqType req) { return req == mxnet::kNullOp; });
+  std::string key;
+  if (shared) {
+    key = Key(sg, grad_reqs);
+    CompilerPtr compiler = Lookup(key);
+    if (compiler) {
+      ++hits_;
+      return compiler;
+    }
+  }
+  ++misses_;
+  const auto start = std::chrono::steady_clock::now();
+  CompilerPtr compiler = fcompile();
+  compile_us_ += std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  if (shared) Insert(key, compiler);
+  return compiler;
+}
+
+void NgraphCompileCache::Dump(std::ostream &out) const {
+  out << std::string(80, '-') << std::endl;
+  out << "nGraph compile cache" << std::endl;
+  out << "  hits:          " << hits_ << std::endl;
+  out << "  misses:        " << misses_ << std::endl;
+  out << "  compile time:  " << compile_us_ / 1000 << " ms" << std::endl;
+}
+
+NgraphCompileCache::CompilerPtr NgraphCompileCache::Lookup(const std::string &key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->second;
+}
+
+void NgraphCompileCache::Insert(const std::string &key, const CompilerPtr &compiler) {
+  if (capacity_ == 0) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Another thread compiled the same subgraph concurrently; keep the first one.
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+  lru_.emplace_front(key, compiler);
+  entries_[key] = lru_.begin();
+  while (lru_.size() > capacity_) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_NGRAPH
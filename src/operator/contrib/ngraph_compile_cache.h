@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ngraph_compile_cache.h
+ * \brief content-addressed cache of compiled nGraph subgraphs
+*/
+
+#ifndef MXNET_OPERATOR_CONTRIB_NGRAPH_COMPILE_CACHE_H_
+#define MXNET_OPERATOR_CONTRIB_NGRAPH_COMPILE_CACHE_H_
+
+#if MXNET_USE_NGRAPH
+#include <mxnet/op_attr_types.h>
+#include <ngraph_compiler.h>
+#include <nnvm/graph.h>
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Process-wide cache of ngraph_bridge::Compiler objects keyed by the content of
+ *  the subgraph: its JSON, the shapes and dtypes of its inputs, the gradient requests
+ *  and the device it is compiled for.
+ *
+ *  Compiled subgraphs are kept in memory (MXNET_NGRAPH_COMPILE_CACHE_SIZE entries, LRU)
+ *  and are not persisted: the bridge Compiler/Graph types have no serialization, so a
+ *  new process compiles its subgraphs again.
+ *
+ *  Only inference subgraphs, whose gradient requests are all null, are shared. Compilers
+ *  handed out by the cache must be treated as read-only.
+ */
+class NgraphCompileCache {
+ public:
+  typedef std::shared_ptr<ngraph_bridge::Compiler> CompilerPtr;
+
+  static NgraphCompileCache *Get();
+
+  /*!
+   * \brief Key material of a subgraph with inferred shapes, dtypes and contexts.
+   */
+  static std::string Key(const nnvm::Graph &sg,
+                         const std::vector<mxnet::OpReqType> &grad_reqs);
+  /*!
+   * \brief Returns the cached compiler of sg, or calls fcompile and caches the result.
+   *  Subgraphs that need gradients are always compiled for the caller alone.
+   */
+  CompilerPtr GetOrCompile(const nnvm::Graph &sg,
+                           const std::vector<mxnet::OpReqType> &grad_reqs,
+                           const std::function<CompilerPtr()> &fcompile);
+  /*!
+   * \brief Writes hit/miss statistics, in the format of NGraphStats::dump.
+   */
+  void Dump(std::ostream &out) const;
+
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  NgraphCompileCache();
+
+  CompilerPtr Lookup(const std::string &key);
+  void Insert(const std::string &key, const CompilerPtr &compiler);
+
+  typedef std::list<std::pair<std::string, CompilerPtr>> LRUList;
+  std::mutex mutex_;
+  LRUList lru_;
+  std::unordered_map<std::string, LRUList::iterator> entries_;
+  size_t capacity_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> compile_us_{0};
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_NGRAPH
+
+#endif  // MXNET_OPERATOR_CONTRIB_NGRAPH_COMPILE_CACHE_H_
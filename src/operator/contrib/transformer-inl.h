@@ -25,6 +25,8 @@
 #ifndef MXNET_OPERATOR_CONTRIB_TRANSFORMER_INL_H_
 #define MXNET_OPERATOR_CONTRIB_TRANSFORMER_INL_H_
 
+#include <dmlc/optional.h>
+#include <dmlc/parameter.h>
 #include <mxnet/operator_util.h>
 #include <vector>
 #include "../mxnet_op.h"
@@ -34,6 +36,27 @@
 namespace mxnet {
 namespace op {
 
+namespace attention {
+enum FusedAttentionOpInputs {kQuery, kKey, kValue, kMask};
+}  // namespace attention
+
+struct FusedAttentionParam : public dmlc::Parameter<FusedAttentionParam> {
+  int heads;
+  dmlc::optional<float> scale;
+  bool use_mask;
+  DMLC_DECLARE_PARAMETER(FusedAttentionParam) {
+    DMLC_DECLARE_FIELD(heads).set_lower_bound(1)
+    .describe("Number of attention heads. The last axis of query, key and value holds "
+              "the heads one after another.");
+    DMLC_DECLARE_FIELD(scale).set_default(dmlc::optional<float>())
+    .describe("Scale applied to the query-key products before the softmax. "
+              "Defaults to 1 / sqrt(dimension of a query head).");
+    DMLC_DECLARE_FIELD(use_mask).set_default(false)
+    .describe("Whether the last input is a mask of shape (batch, query_length, key_length). "
+              "Keys whose mask value is zero are excluded from the softmax.");
+  }
+};
+
 template<typename xpu>
 static void DivSqrtDimForward_(const nnvm::NodeAttrs& attrs,
                   const OpContext& ctx,
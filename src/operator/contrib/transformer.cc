@@ -22,13 +22,148 @@
  * \file transformer.cc
  * \brief CPU implementation of the operators used in Transformer
  */
+#include <dmlc/omp.h>
 #include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
 #include "./transformer-inl.h"
+#include "../linalg.h"
 #include "../tensor/elemwise_unary_op.h"
+#include "../../engine/openmp.h"
 
 namespace mxnet {
 namespace op {
 
+DMLC_REGISTER_PARAMETER(FusedAttentionParam);
+
+// Keys visited per step. A step keeps a (query_length, kAttentionBlockK) block of
+// scores for every batch element and head, so the full score matrix never exists.
+const index_t kAttentionBlockK = 128;
+
+/*!
+ * \brief online softmax step of one query over a block of nk scores: every row keeps
+ *        its running maximum and sum, and the partial output acc is rescaled whenever
+ *        the maximum grows. The scores are replaced by their exponentials, and masked
+ *        out keys by zeros.
+ */
+template<typename DType>
+void FusedAttentionSoftmaxStep(DType *score, const DType *mask, DType *acc,
+                               DType *row_max, DType *row_sum,
+                               const index_t nk, const index_t vdim) {
+  const DType neg_inf = -std::numeric_limits<DType>::infinity();
+  DType new_max = *row_max;
+  for (index_t j = 0; j < nk; ++j) {
+    if (mask && mask[j] == DType(0)) {
+      score[j] = neg_inf;
+    } else {
+      new_max = std::max(new_max, score[j]);
+    }
+  }
+  if (new_max == neg_inf) {
+    // every key seen so far is masked out
+    std::fill(score, score + nk, DType(0));
+    return;
+  }
+  DType sum = 0;
+  for (index_t j = 0; j < nk; ++j) {
+    score[j] = std::exp(score[j] - new_max);
+    sum += score[j];
+  }
+  const DType correction = std::exp(*row_max - new_max);
+  if (correction != DType(1)) {
+    for (index_t j = 0; j < vdim; ++j) acc[j] *= correction;
+  }
+  *row_sum = *row_sum * correction + sum;
+  *row_max = new_max;
+}
+
+static void FusedAttentionForwardCPU(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  const FusedAttentionParam& param = nnvm::get<FusedAttentionParam>(attrs.parsed);
+  if (req[0] == kNullOp) return;
+  CHECK_NE(req[0], kAddTo) << "_contrib_fused_attention does not support kAddTo";
+  const TBlob& query = inputs[attention::kQuery];
+  const TBlob& key = inputs[attention::kKey];
+  const TBlob& value = inputs[attention::kValue];
+  const index_t heads = param.heads;
+  const index_t batch = query.shape_[0];
+  const index_t qlen = query.shape_[1];
+  const index_t klen = key.shape_[1];
+  const index_t dim = query.shape_[2] / heads;
+  const index_t vdim = value.shape_[2] / heads;
+  if (outputs[0].Size() == 0) return;
+  const float scale = param.scale.has_value() ?
+                      param.scale.value() : 1.0f / std::sqrt(static_cast<float>(dim));
+  const index_t nheads = batch * heads;
+  const index_t rows = nheads * qlen;
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  Stream<cpu> *s = ctx.get_stream<cpu>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(query.type_flag_, DType, {
+    const index_t score_size = rows * std::min(kAttentionBlockK, klen);
+    DType *score = ctx.requested[0].get_space_typed<cpu, 1, DType>(
+        Shape1(score_size + 2 * rows), s).dptr_;
+    DType *row_max = score + score_size;
+    DType *row_sum = row_max + rows;
+    std::fill(row_max, row_max + rows, -std::numeric_limits<DType>::infinity());
+    std::fill(row_sum, row_sum + rows, DType(0));
+    const DType *q = query.dptr<DType>();
+    const DType *k = key.dptr<DType>();
+    const DType *v = value.dptr<DType>();
+    const DType *mask = param.use_mask ? inputs[attention::kMask].dptr<DType>() : nullptr;
+    // the output accumulates the products of the unnormalized softmax with the values
+    DType *out = outputs[0].dptr<DType>();
+    std::fill(out, out + outputs[0].Size(), DType(0));
+    // The GEMMs of every head run one after another outside of OpenMP regions, so that
+    // BLAS threads are never nested inside OpenMP threads; only the softmax is split
+    // across rows.
+    for (index_t k0 = 0; k0 < klen; k0 += kAttentionBlockK) {
+      const index_t nk = std::min(kAttentionBlockK, klen - k0);
+      for (index_t i = 0; i < nheads; ++i) {
+        const index_t b = i / heads, h = i % heads;
+        Tensor<cpu, 2, DType> q_t(const_cast<DType*>(q + b * qlen * heads * dim + h * dim),
+                                  Shape2(qlen, dim), heads * dim, nullptr);
+        Tensor<cpu, 2, DType> k_t(const_cast<DType*>(k + (b * klen + k0) * heads * dim + h * dim),
+                                  Shape2(nk, dim), heads * dim, nullptr);
+        Tensor<cpu, 2, DType> s_t(score + i * qlen * nk, Shape2(qlen, nk), nk, nullptr);
+        linalg_gemm(q_t, k_t, s_t, static_cast<DType>(scale), DType(0), false, true);
+      }
+      #pragma omp parallel for num_threads(nthreads)
+      for (index_t r = 0; r < rows; ++r) {
+        const index_t i = r / qlen, qi = r % qlen;
+        const index_t b = i / heads, h = i % heads;
+        FusedAttentionSoftmaxStep(score + r * nk,
+                                  mask ? mask + (b * qlen + qi) * klen + k0 : nullptr,
+                                  out + (b * qlen + qi) * heads * vdim + h * vdim,
+                                  row_max + r, row_sum + r, nk, vdim);
+      }
+      for (index_t i = 0; i < nheads; ++i) {
+        const index_t b = i / heads, h = i % heads;
+        Tensor<cpu, 2, DType> s_t(score + i * qlen * nk, Shape2(qlen, nk), nk, nullptr);
+        Tensor<cpu, 2, DType> v_t(const_cast<DType*>(v + (b * klen + k0) * heads * vdim + h * vdim),
+                                  Shape2(nk, vdim), heads * vdim, nullptr);
+        Tensor<cpu, 2, DType> acc_t(out + b * qlen * heads * vdim + h * vdim,
+                                    Shape2(qlen, vdim), heads * vdim, nullptr);
+        linalg_gemm(s_t, v_t, acc_t, DType(1), DType(1), false, false);
+      }
+    }
+    #pragma omp parallel for num_threads(nthreads)
+    for (index_t r = 0; r < rows; ++r) {
+      const index_t i = r / qlen, qi = r % qlen;
+      const index_t b = i / heads, h = i % heads;
+      DType *acc = out + (b * qlen + qi) * heads * vdim + h * vdim;
+      // a query with every key masked out gets a zero output
+      const DType norm = row_sum[r] > DType(0) ? DType(1) / row_sum[r] : DType(0);
+      for (index_t j = 0; j < vdim; ++j) acc[j] *= norm;
+    }
+  });
+}
+
 // relu
 MXNET_OPERATOR_REGISTER_UNARY(_contrib_div_sqrt_dim)
 .describe(R"code(Rescale the input by the square root of the channel dimension.
@@ -39,5 +174,54 @@ MXNET_OPERATOR_REGISTER_UNARY(_contrib_div_sqrt_dim)
 .set_attr<FCompute>("FCompute<cpu>", DivSqrtDimForward_<cpu>)
 .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_contrib_div_sqrt_dim"});
 
+NNVM_REGISTER_OP(_contrib_fused_attention)
+.describe(R"code(Scaled dot-product attention over several heads in one operator.
+
+For every batch element and head ``h``, with ``q``, ``k`` and ``v`` the slices of
+``query``, ``key`` and ``value`` that belong to ``h`` on the last axis:
+
+.. math::
+
+  out = softmax(scale * q k^T) v
+
+which replaces the sequence batch_dot, div_sqrt_dim, softmax, batch_dot. Inputs
+use the layout (batch, length, heads * dim), so no transposes are needed, and the
+output has shape (batch, query_length, heads * value_dim).
+
+With ``use_mask``, keys whose mask value is zero are excluded from the softmax,
+and a query with every key masked out produces zeros.
+
+The keys are processed in blocks with a running softmax, so the full
+query_length x key_length score matrix is never materialized. The operator is
+meant for inference: it runs on CPU only, supports float32 and float64, and
+has no gradient.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const NodeAttrs& attrs) {
+  const FusedAttentionParam& param = nnvm::get<FusedAttentionParam>(attrs.parsed);
+  return param.use_mask ? 4 : 3;
+})
+.set_num_outputs(1)
+.set_attr_parser(ParamParser<FusedAttentionParam>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+  const FusedAttentionParam& param = nnvm::get<FusedAttentionParam>(attrs.parsed);
+  if (param.use_mask) {
+    return std::vector<std::string>{"query", "key", "value", "mask"};
+  }
+  return std::vector<std::string>{"query", "key", "value"};
+})
+.set_attr<nnvm::FInferShape>("FInferShape", FusedAttentionShape)
+.set_attr<nnvm::FInferType>("FInferType", FusedAttentionType)
+.set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
+  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+})
+.set_attr<FCompute>("FCompute<cpu>", FusedAttentionForwardCPU)
+.add_argument("query", "NDArray-or-Symbol", "Queries, (batch, query_length, heads * dim)")
+.add_argument("key", "NDArray-or-Symbol", "Keys, (batch, key_length, heads * dim)")
+.add_argument("value", "NDArray-or-Symbol", "Values, (batch, key_length, heads * value_dim)")
+.add_argument("mask", "NDArray-or-Symbol", "Optional mask, (batch, query_length, key_length)")
+.add_arguments(FusedAttentionParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
@@ -27,10 +27,12 @@
 #define MXNET_OPERATOR_MXNET_OP_H_
 
 #include <dmlc/omp.h>
+#include <dmlc/parameter.h>
 #include <mxnet/base.h>
 #include <mxnet/engine.h>
 #include <mxnet/op_attr_types.h>
 #include <algorithm>
+#include <type_traits>
 #include "./operator_tune.h"
 #include "../engine/openmp.h"
 
@@ -424,6 +426,42 @@ struct backward_grad_tuned : public backward_grad<GRAD_OP>, public tunable {
   using backward_grad<GRAD_OP>::Map;
 };
 
+/*!
+ * \brief Marks a loop as free of loop-carried dependencies so that it is vectorized
+ *  regardless of the possible aliasing of its pointers.
+ */
+#if defined(__CUDACC__) || defined(_MSC_VER)
+#define MXNET_PRAGMA_SIMD
+#elif defined(_OPENMP)
+#define MXNET_PRAGMA_SIMD _Pragma("omp simd")
+#elif defined(__clang__)
+#define MXNET_PRAGMA_SIMD _Pragma("clang loop vectorize(assume_safety)")
+#else
+#define MXNET_PRAGMA_SIMD _Pragma("GCC ivdep")
+#endif
+
+/*!
+ * \brief Whether CPU kernels are additionally compiled for AVX2 and AVX-512 and
+ *  selected at runtime (GCC and clang on x86 only).
+ */
+#if !defined(__CUDACC__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MXNET_KERNEL_MULTIVERSION 1
+#else
+#define MXNET_KERNEL_MULTIVERSION 0
+#endif
+
+/*!
+ * \brief Whether the AVX-512 clone is built. AVX-512 implies FMA, and a clone that
+ *  contracted a * b + c would round differently from the other clones. GCC can turn
+ *  contraction off per function; clang decides it before the target is known, so it
+ *  only gets the AVX2 clone, which is compiled without FMA.
+ */
+#if MXNET_KERNEL_MULTIVERSION && !defined(__clang__)
+#define MXNET_KERNEL_AVX512 1
+#else
+#define MXNET_KERNEL_AVX512 0
+#endif
+
 /*! \brief Select assignment operation based upon the req value
  * Also useful for mapping mshadow Compute (F<OP>) to Kernel<OP>::Launch
  */
@@ -483,8 +521,92 @@ struct op_with_req {
                                   const DType *input_3) {
     KERNEL_ASSIGN(out[i], req, OP::Map(input_1[i], input_2[i], input_3[i]));
   }
+
+  /*!
+   * \brief Packet form of all the Map() overloads above: processes the contiguous
+   *  elements [i, i + n). The loop is annotated as free of loop-carried dependencies,
+   *  which holds because outputs are either distinct from or identical to the inputs,
+   *  so the compiler vectorizes it for the instruction set it is compiled for.
+   */
+  template<typename ...Args>
+  MSHADOW_CINLINE static void MapVec(index_t i, index_t n, Args... args) {
+    const index_t end = i + n;
+    MXNET_PRAGMA_SIMD
+    for (index_t j = i; j < end; ++j) {
+      Map(j, args...);
+    }
+  }
+};
+
+/*! \brief Instruction sets the packet (MapVec) form of CPU kernels is compiled for */
+enum class KernelISA {
+  /*! \brief vectorized kernels are disabled, one Map() call per element */
+  kNone,
+  /*! \brief baseline instruction set of the build */
+  kGeneric,
+  kAVX2,
+  kAVX512
 };
 
+/*!
+ * \brief Instruction set used by vectorized CPU kernels, detected once through CPUID.
+ *  MXNET_USE_VECTORIZED_KERNEL=0 disables vectorized kernels.
+ */
+inline KernelISA GetKernelISA() {
+  static const KernelISA isa = []() {
+    if (!dmlc::GetEnv("MXNET_USE_VECTORIZED_KERNEL", true)) {
+      return KernelISA::kNone;
+    }
+#if MXNET_KERNEL_MULTIVERSION
+    __builtin_cpu_init();
+#if MXNET_KERNEL_AVX512
+    if (__builtin_cpu_supports("avx512f")) {
+      return KernelISA::kAVX512;
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+      return KernelISA::kAVX2;
+    }
+#endif
+    return KernelISA::kGeneric;
+  }();
+  return isa;
+}
+
+/*! \brief Whether OP has a packet form for elements of type DType */
+template<typename OP, typename DType>
+struct is_vectorizable : std::false_type {};
+
+template<typename OP, int req, typename DType>
+struct is_vectorizable<op_with_req<OP, req>, DType>
+  : std::integral_constant<bool, std::is_arithmetic<DType>::value> {};
+
+/*!
+ * \brief Clones of OP::MapVec for each instruction set, all inlined from the same
+ *  source. Only the clone matching GetKernelISA() is ever called.
+ */
+template<typename OP, typename ...Args>
+void MapVecGeneric(index_t i, index_t n, Args... args) {
+  OP::MapVec(i, n, args...);
+}
+
+#if MXNET_KERNEL_MULTIVERSION
+// FMA is left out so that every clone rounds like the generic one
+template<typename OP, typename ...Args>
+__attribute__((target("avx2")))
+void MapVecAVX2(index_t i, index_t n, Args... args) {
+  OP::MapVec(i, n, args...);
+}
+#endif  // MXNET_KERNEL_MULTIVERSION
+
+#if MXNET_KERNEL_AVX512
+template<typename OP, typename ...Args>
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+void MapVecAVX512(index_t i, index_t n, Args... args) {
+  OP::MapVec(i, n, args...);
+}
+#endif  // MXNET_KERNEL_AVX512
+
 template<typename OP, typename xpu>
 struct Kernel;
 
@@ -568,12 +690,18 @@ struct Kernel<OP, cpu> {
    */
   template<typename PRIMITIVE_OP, typename DType, typename ...Args>
   static void LaunchTuned(mshadow::Stream<cpu> *, const size_t N, Args... args) {
+    const KernelISA isa = is_vectorizable<OP, DType>::value ? GetKernelISA() : KernelISA::kNone;
 #ifdef _OPENMP
     const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
     if (omp_threads < 2 || !tuned_op<PRIMITIVE_OP, DType>::UseOMP(
       N, static_cast<size_t>(omp_threads))) {
-      for (size_t i = 0; i < N; ++i) {
-        OP::Map(i, args...);
+      MapRange<DType>(isa, 0, static_cast<index_t>(N), args...);
+    } else if (isa != KernelISA::kNone) {
+      // One contiguous range per thread, rounded to whole cache lines
+      const index_t length = RoundUpToCacheLine<DType>((N + omp_threads - 1) / omp_threads);
+      #pragma omp parallel for num_threads(omp_threads)
+      for (index_t i = 0; i < static_cast<index_t>(N); i += length) {
+        MapRange<DType>(isa, i, std::min(length, static_cast<index_t>(N) - i), args...);
       }
     } else {
       #pragma omp parallel for num_threads(omp_threads)
@@ -582,12 +710,60 @@ struct Kernel<OP, cpu> {
       }
     }
 #else
-    for (size_t i = 0; i < N; ++i) {
-      OP::Map(i, args...);
-    }
+    MapRange<DType>(isa, 0, static_cast<index_t>(N), args...);
 #endif
   }
 
+  /*!
+   * \brief Run OP over the elements [i, i + n), through the OP::MapVec clone of the
+   *  given instruction set, or one OP::Map() call per element for KernelISA::kNone.
+   */
+  template<typename DType, typename ...Args>
+  static void MapRange(const KernelISA isa, const index_t i, const index_t n, Args... args) {
+    MapRangeImpl(std::integral_constant<bool, is_vectorizable<OP, DType>::value>(),
+                 isa, i, n, args...);
+  }
+
+ private:
+  template<typename ...Args>
+  static void MapRangeImpl(std::true_type, const KernelISA isa,
+                           const index_t i, const index_t n, Args... args) {
+    switch (isa) {
+#if MXNET_KERNEL_AVX512
+      case KernelISA::kAVX512:
+        MapVecAVX512<OP>(i, n, args...);
+        return;
+#endif
+#if MXNET_KERNEL_MULTIVERSION
+      case KernelISA::kAVX2:
+        MapVecAVX2<OP>(i, n, args...);
+        return;
+#endif
+      case KernelISA::kNone:
+        MapRangeImpl(std::false_type(), isa, i, n, args...);
+        return;
+      default:
+        MapVecGeneric<OP>(i, n, args...);
+        return;
+    }
+  }
+
+  template<typename ...Args>
+  static void MapRangeImpl(std::false_type, const KernelISA,
+                           const index_t i, const index_t n, Args... args) {
+    for (index_t j = i; j < i + n; ++j) {
+      OP::Map(j, args...);
+    }
+  }
+
+  template<typename DType>
+  static index_t RoundUpToCacheLine(const size_t length) {
+    const size_t line = std::max<size_t>(64 / sizeof(DType), 1);
+    return static_cast<index_t>((length + line - 1) / line * line);
+  }
+
+ public:
+
   /*!
    * \brief Launch custom-tuned kernel where each thread is set to
    *        operate on a contiguous partition
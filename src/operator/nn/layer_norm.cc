@@ -24,8 +24,10 @@
 */
 
 #include "layer_norm-inl.h"
+#include <dmlc/omp.h>
 #include <nnvm/op_attr_types.h>
 #include "../elemwise_op_common.h"
+#include "../../engine/openmp.h"
 
 namespace mxnet {
 namespace op {
@@ -64,6 +66,202 @@ static bool LayerNormShape(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+/*
+ * When the normalized axis is the last one every instance is a contiguous row, so the
+ * forward and backward passes below read each row twice instead of going through the
+ * generic broadcast/reduce path, which makes about six passes over the whole tensor and
+ * materializes temporaries. Statistics are accumulated in AType (float for half).
+ */
+namespace layernorm {
+
+const int kWelfordLanes = 8;
+
+/*!
+ * \brief mean and (biased) variance of a row in a single pass. Each of the kWelfordLanes
+ *        lanes runs Welford's update over a strided slice, which the compiler can
+ *        vectorize, and the lanes are then merged with Chan's formula.
+ */
+template<typename DType, typename AType>
+inline void RowMoments(const DType *x, const index_t n, AType *mean, AType *var) {
+  AType lane_mean[kWelfordLanes] = {0};
+  AType lane_m2[kWelfordLanes] = {0};
+  const index_t nvec = n / kWelfordLanes;
+  for (index_t k = 0; k < nvec; ++k) {
+    const AType scale = AType(1) / static_cast<AType>(k + 1);
+    const DType *xk = x + k * kWelfordLanes;
+    for (int l = 0; l < kWelfordLanes; ++l) {
+      const AType v = static_cast<AType>(xk[l]);
+      const AType delta = v - lane_mean[l];
+      lane_mean[l] += delta * scale;
+      lane_m2[l] += delta * (v - lane_mean[l]);
+    }
+  }
+  AType m = 0, m2 = 0;
+  index_t count = 0;
+  if (nvec > 0) {
+    for (int l = 0; l < kWelfordLanes; ++l) {
+      const index_t total = count + nvec;
+      const AType delta = lane_mean[l] - m;
+      m += delta * static_cast<AType>(nvec) / static_cast<AType>(total);
+      m2 += lane_m2[l] + delta * delta * static_cast<AType>(count) * static_cast<AType>(nvec)
+            / static_cast<AType>(total);
+      count = total;
+    }
+  }
+  for (index_t i = nvec * kWelfordLanes; i < n; ++i) {
+    const AType v = static_cast<AType>(x[i]);
+    ++count;
+    const AType delta = v - m;
+    m += delta / static_cast<AType>(count);
+    m2 += delta * (v - m);
+  }
+  *mean = m;
+  *var = m2 / static_cast<AType>(n);
+}
+
+template<typename DType, typename AType>
+void LayerNormLastAxisForward(const DType *in, const DType *gamma, const DType *beta,
+                              DType *out, DType *mean, DType *std, const index_t nrows,
+                              const index_t channel, const AType eps) {
+  #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  for (index_t r = 0; r < nrows; ++r) {
+    const DType *x = in + r * channel;
+    DType *y = out + r * channel;
+    AType row_mean, row_var;
+    RowMoments(x, channel, &row_mean, &row_var);
+    const AType row_std = std::sqrt(row_var + eps);
+    mean[r] = static_cast<DType>(row_mean);
+    std[r] = static_cast<DType>(row_std);
+    const AType rstd = AType(1) / row_std;
+    // y may alias x, each element is read before it is written
+    for (index_t i = 0; i < channel; ++i) {
+      y[i] = static_cast<DType>((static_cast<AType>(x[i]) - row_mean) * rstd
+                                * static_cast<AType>(gamma[i]) + static_cast<AType>(beta[i]));
+    }
+  }
+}
+
+/*!
+ * \brief backward pass, see LayerNormGradComputeGeneral for the formulas. Every thread
+ *        accumulates grad_gamma and grad_beta for its rows into its own slice of
+ *        workspace (2 * channel AType values per thread), and the slices are summed at
+ *        the end.
+ */
+template<typename DType, typename AType>
+void LayerNormLastAxisBackward(const DType *ograd, const DType *in, const DType *gamma,
+                               const DType *mean, const DType *std, DType *grad_in,
+                               DType *grad_gamma, DType *grad_beta,
+                               const std::vector<OpReqType>& req, AType *workspace,
+                               const int nthreads, const index_t nrows,
+                               const index_t channel) {
+  const bool need_params = req[1] != kNullOp || req[2] != kNullOp;
+  if (need_params) {
+    std::fill(workspace, workspace + 2 * channel * nthreads, AType(0));
+  }
+  #pragma omp parallel num_threads(nthreads)
+  {
+    AType *part_gamma = workspace + 2 * channel * omp_get_thread_num();
+    AType *part_beta = part_gamma + channel;
+    #pragma omp for
+    for (index_t r = 0; r < nrows; ++r) {
+      const DType *og = ograd + r * channel;
+      const DType *x = in + r * channel;
+      const AType row_mean = static_cast<AType>(mean[r]);
+      const AType rstd = AType(1) / static_cast<AType>(std[r]);
+      AType sum_w = 0, sum_w_xhat = 0;
+      for (index_t i = 0; i < channel; ++i) {
+        const AType xhat = (static_cast<AType>(x[i]) - row_mean) * rstd;
+        const AType g = static_cast<AType>(og[i]);
+        const AType w = g * static_cast<AType>(gamma[i]) * rstd;
+        sum_w += w;
+        sum_w_xhat += w * xhat;
+        if (need_params) {
+          part_gamma[i] += g * xhat;
+          part_beta[i] += g;
+        }
+      }
+      if (req[0] == kNullOp) continue;
+      const AType mean_w = sum_w / static_cast<AType>(channel);
+      const AType mean_w_xhat = sum_w_xhat / static_cast<AType>(channel);
+      DType *gx = grad_in + r * channel;
+      for (index_t i = 0; i < channel; ++i) {
+        const AType xhat = (static_cast<AType>(x[i]) - row_mean) * rstd;
+        const AType w = static_cast<AType>(og[i]) * static_cast<AType>(gamma[i]) * rstd;
+        KERNEL_ASSIGN(gx[i], req[0], static_cast<DType>(w - mean_w - xhat * mean_w_xhat));
+      }
+    }
+  }
+  if (!need_params) return;
+  #pragma omp parallel for num_threads(nthreads)
+  for (index_t i = 0; i < channel; ++i) {
+    AType sum_gamma = 0, sum_beta = 0;
+    for (int t = 0; t < nthreads; ++t) {
+      sum_gamma += workspace[2 * channel * t + i];
+      sum_beta += workspace[2 * channel * t + channel + i];
+    }
+    KERNEL_ASSIGN(grad_gamma[i], req[1], static_cast<DType>(sum_gamma));
+    KERNEL_ASSIGN(grad_beta[i], req[2], static_cast<DType>(sum_beta));
+  }
+}
+
+}  // namespace layernorm
+
+template<>
+void LayerNormCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx, const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  const LayerNormParam& param = nnvm::get<LayerNormParam>(attrs.parsed);
+  if (req[0] == kNullOp) return;
+  CHECK_NE(req[0], kAddTo);
+  CHECK_EQ(inputs.size(), 3U);
+  const int ndim = inputs[0].ndim();
+  const int axis = param.axis < 0 ? param.axis + ndim : param.axis;
+  if (axis != ndim - 1 || inputs[0].Size() == 0) {
+    LayerNormComputeGeneral<cpu>(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  const index_t channel = inputs[0].shape_[axis];
+  const index_t nrows = inputs[0].Size() / channel;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    layernorm::LayerNormLastAxisForward<DType, AType>(
+      inputs[layernorm::kData].dptr<DType>(), inputs[layernorm::kGamma].dptr<DType>(),
+      inputs[layernorm::kBeta].dptr<DType>(), outputs[layernorm::kOut].dptr<DType>(),
+      outputs[layernorm::kMean].dptr<DType>(), outputs[layernorm::kStd].dptr<DType>(),
+      nrows, channel, static_cast<AType>(param.eps));
+  });
+}
+
+template<>
+void LayerNormGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx, const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  const LayerNormParam& param = nnvm::get<LayerNormParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 5U);
+  const int ndim = inputs[0].ndim();
+  const int axis = param.axis < 0 ? param.axis + ndim : param.axis;
+  if (axis != ndim - 1 || inputs[0].Size() == 0) {
+    LayerNormGradComputeGeneral<cpu>(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  const index_t channel = inputs[0].shape_[axis];
+  const index_t nrows = inputs[0].Size() / channel;
+  const int nthreads = static_cast<int>(std::max<index_t>(1, std::min<index_t>(
+      engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), nrows)));
+  mshadow::Stream<cpu> *s = ctx.get_stream<cpu>();
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AType, {
+    AType *workspace = ctx.requested[0].get_space_typed<cpu, 1, AType>(
+        mshadow::Shape1(2 * channel * nthreads), s).dptr_;
+    layernorm::LayerNormLastAxisBackward<DType, AType>(
+      inputs[0].dptr<DType>(), inputs[1].dptr<DType>(), inputs[2].dptr<DType>(),
+      inputs[3].dptr<DType>(), inputs[4].dptr<DType>(), outputs[0].dptr<DType>(),
+      outputs[1].dptr<DType>(), outputs[2].dptr<DType>(), req, workspace, nthreads,
+      nrows, channel);
+  });
+}
+
+
 
 NNVM_REGISTER_OP(LayerNorm)
 .describe(R"code(Layer normalization.
@@ -34,6 +34,7 @@
 #include "../../operator_common.h"
 #include "../activation-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 #if MXNET_USE_MKLDNN == 1
 
@@ -140,25 +141,20 @@ class MKLDNNActForward {
   }
 };
 
-static MKLDNNActForward &GetActForward(const ActivationParam& param,
-                                       const OpContext &ctx, const NDArray &in_data,
-                                       const mkldnn::memory &in_mem) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
-#endif
+static std::shared_ptr<MKLDNNActForward> GetActForward(const ActivationParam& param,
+                                                       const OpContext &ctx,
+                                                       const NDArray &in_data,
+                                                       const mkldnn::memory &in_mem) {
+  static MKLDNNPrimitiveCache<MKLDNNActSignature, MKLDNNActForward, OpHash>
+      fwds("Activation forward");
   MKLDNNActSignature key(param);
   key.AddSign(ctx.is_train);
   key.AddSign(param.act_type);
   key.AddSign(in_data);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
-    MKLDNNActForward fwd(param, ctx.is_train, in_data, in_mem);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+  return fwds.Get(key, [&]() {
+    return MKLDNNActForward(param, ctx.is_train, in_data, in_mem);
+  });
 }
 
 void MKLDNNActivationForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
@@ -173,7 +169,8 @@ void MKLDNNActivationForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
     in_buffer = in_data.Reorder2Default();
 
   auto input_mem = in_buffer.GetMKLDNNData();
-  MKLDNNActForward &fwd = GetActForward(param, ctx, in_buffer, *input_mem);
+  auto fwd_ptr = GetActForward(param, ctx, in_buffer, *input_mem);
+  MKLDNNActForward &fwd = *fwd_ptr;
   auto out_mem_t = CreateMKLDNNMem(out_data, fwd.fwd_pd.dst_primitive_desc(), req, &in_buffer);
   fwd.SetNewMem(*input_mem, *out_mem_t.second);
   stream->RegisterPrim(fwd.GetFwd());
@@ -250,26 +247,20 @@ class MKLDNNActBackward {
   const inline mkldnn::eltwise_backward &GetBwd() const { return *bwd; }
 };
 
-static inline MKLDNNActBackward &GetActBackward(const ActivationParam &param,
-                                                const OpContext &ctx,
-                                                const NDArray &in_data,
-                                                const NDArray &out_grad,
-                                                const mkldnn::memory &in_mem) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
-#endif
+static inline std::shared_ptr<MKLDNNActBackward> GetActBackward(const ActivationParam &param,
+                                                                const OpContext &ctx,
+                                                                const NDArray &in_data,
+                                                                const NDArray &out_grad,
+                                                                const mkldnn::memory &in_mem) {
+  static MKLDNNPrimitiveCache<MKLDNNActSignature, MKLDNNActBackward, OpHash>
+      bwds("Activation backward");
   MKLDNNActSignature key(param);
   key.AddSign(in_data);
   key.AddSign(out_grad);
 
-  auto it = bwds.find(key);
-  if (it == bwds.end()) {
-    MKLDNNActBackward bwd(param, in_data, in_mem, *out_grad.GetMKLDNNData());
-    it = AddToCache(&bwds, key, bwd);
-  }
-  return it->second;
+  return bwds.Get(key, [&]() {
+    return MKLDNNActBackward(param, in_data, in_mem, *out_grad.GetMKLDNNData());
+  });
 }
 
 // For backward relu activation, it's okay to pass "out_data" as "in_data" to this
@@ -297,8 +288,8 @@ void MKLDNNActivationBackward(const nnvm::NodeAttrs& attrs, const OpContext &ctx
   // descriptor. Otherwise, the perf will suffer.
   if (input_mem->get_primitive_desc() != diff_dst_memory->get_primitive_desc())
     input_mem = in_buffer.GetMKLDNNDataReorder(diff_dst_memory->get_primitive_desc());
-  MKLDNNActBackward &bwd =
-      GetActBackward(param, ctx, in_buffer, out_buffer, *input_mem);
+  auto bwd_ptr = GetActBackward(param, ctx, in_buffer, out_buffer, *input_mem);
+  MKLDNNActBackward &bwd = *bwd_ptr;
   MKLDNNStream *stream = MKLDNNStream::Get();
   mkldnn_output_t diff_src_memory =
       CreateMKLDNNMem(in_grad, bwd.pd.diff_src_primitive_desc(), req);
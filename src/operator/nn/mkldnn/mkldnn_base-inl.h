@@ -147,23 +147,15 @@ static inline bool MKLDNNEnvSet() {
   return is_mkldnn_enabled;
 }
 
+/*!
+ * \brief Number of primitives each MKLDNN operator cache keeps, -1 (the default) for
+ *  unbounded caches.
+ */
 static inline int GetMKLDNNCacheSize() {
   static int mkldnn_cache_size = dmlc::GetEnv("MXNET_MKLDNN_CACHE_NUM", -1);
   return mkldnn_cache_size;
 }
 
-// TODO(alex): (MXNET-1075) Will remove env variable and calculate cache size during runtime
-template<typename S, typename I, typename H>
-static typename std::unordered_map<S, I, H>::iterator AddToCache(
-    std::unordered_map<S, I, H>* cache, const S &key, const I &item) {
-  int mkldnn_cache_size = GetMKLDNNCacheSize();
-  if (mkldnn_cache_size != -1 && static_cast<int>(cache->size()) > mkldnn_cache_size)
-    cache->erase(cache->begin());
-  auto ins_return = cache->insert(std::pair<S, I>(key, item));
-  CHECK(ins_return.second);
-  return ins_return.first;
-}
-
 /*
  * This is to align address to a certain alignment.
  */
@@ -22,11 +22,56 @@
 #include <atomic>
 #include "./mkldnn_base-inl.h"
 #include "./mkldnn_ops-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 #include "../../../common/exec_utils.h"
+#include "../../../profiler/profiler.h"
 #include "../../operator_common.h"
 
 namespace mxnet {
 
+namespace op {
+struct MKLDNNPrimitiveCacheStats::ProfilerCounters {
+  explicit ProfilerCounters(const std::string &name)
+    : hits((name + " hits").c_str(), Domain()),
+      misses((name + " misses").c_str(), Domain()),
+      evictions((name + " evictions").c_str(), Domain()) {}
+
+  static profiler::ProfileDomain *Domain() {
+    static profiler::ProfileDomain domain("MKLDNN Primitive Cache");
+    return &domain;
+  }
+
+  profiler::ProfileCounter hits;
+  profiler::ProfileCounter misses;
+  profiler::ProfileCounter evictions;
+};
+
+MKLDNNPrimitiveCacheStats::MKLDNNPrimitiveCacheStats(const char *name) : name_(name) {}
+
+MKLDNNPrimitiveCacheStats::~MKLDNNPrimitiveCacheStats() = default;
+
+MKLDNNPrimitiveCacheStats::ProfilerCounters *MKLDNNPrimitiveCacheStats::Counters() {
+  if (profiler::Profiler::Get()->GetState() != profiler::Profiler::kRunning) return nullptr;
+  std::call_once(counters_init_, [this]() { counters_.reset(new ProfilerCounters(name_)); });
+  return counters_.get();
+}
+
+void MKLDNNPrimitiveCacheStats::ReportHit(uint64_t value) {
+  ProfilerCounters *counters = Counters();
+  if (counters) counters->hits = value;
+}
+
+void MKLDNNPrimitiveCacheStats::ReportMiss(uint64_t value) {
+  ProfilerCounters *counters = Counters();
+  if (counters) counters->misses = value;
+}
+
+void MKLDNNPrimitiveCacheStats::ReportEviction(uint64_t value) {
+  ProfilerCounters *counters = Counters();
+  if (counters) counters->evictions = value;
+}
+}  // namespace op
+
 MKLDNNStream *MKLDNNStream::Get() {
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local MKLDNNStream stream;
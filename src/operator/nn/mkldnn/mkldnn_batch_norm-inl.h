@@ -33,6 +33,7 @@
 #include "../batch_norm-inl.h"
 #include "./mkldnn_ops-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 #define VARIANCE_TO_INVSTD(__var$,    __eps$)   (1.0/std::sqrt((__var$) + DType(__eps$)))
 #define INVSTD_TO_VARIANCE(__invstd$, __eps$)   ((1.0 / ((__invstd$) * (__invstd$))) - (__eps$))
@@ -181,26 +182,21 @@ class MKLDNNBNForward {
 };
 
 template<typename DType>
-static MKLDNNBNForward &GetBNForward(const BatchNormParam& param,
-                                     const OpContext &ctx, const NDArray &in_data,
-                                     unsigned flags) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
-#endif
+static std::shared_ptr<MKLDNNBNForward> GetBNForward(const BatchNormParam& param,
+                                                     const OpContext &ctx,
+                                                     const NDArray &in_data,
+                                                     unsigned flags) {
+  static MKLDNNPrimitiveCache<MKLDNNBNSignature, MKLDNNBNForward, OpHash>
+      fwds("BatchNorm forward");
   MKLDNNBNSignature key(param);
   key.AddSign(ctx.is_train);
   key.AddSign(in_data);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
+  return fwds.Get(key, [&]() {
     auto fwd_pd = _GetFwd(*in_data.GetMKLDNNData(), ctx.is_train,
                           (DType) param.eps, flags);
-    MKLDNNBNForward fwd(fwd_pd, ctx.is_train);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+    return MKLDNNBNForward(fwd_pd, ctx.is_train);
+  });
 }
 
 template <typename DType>
@@ -213,7 +209,8 @@ void MKLDNNBatchNormForward(const OpContext &ctx, const BatchNormParam &param,
   unsigned flags      = _GetFlags(in_data, aux_states, param, ctx.is_train);
   const NDArray &data = in_data[batchnorm::kData];
 
-  auto &fwd = GetBNForward<DType>(param, ctx, data, flags);
+  auto fwd_ptr = GetBNForward<DType>(param, ctx, data, flags);
+  MKLDNNBNForward &fwd = *fwd_ptr;
   const NDArray &out  = out_data[batchnorm::kOut];
 
   // for output memory
@@ -340,26 +337,20 @@ class MKLDNNBNBackward {
 };
 
 template <typename DType>
-static MKLDNNBNBackward &GetBNBackward(
+static std::shared_ptr<MKLDNNBNBackward> GetBNBackward(
     const BatchNormParam &param, const OpContext &ctx, const NDArray &in_data,
     const mkldnn::memory &in_mem, const NDArray &diff_data,
     const mkldnn::memory &diff_mem, unsigned flags) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
-#endif
+  static MKLDNNPrimitiveCache<MKLDNNBNSignature, MKLDNNBNBackward, OpHash>
+      bwds("BatchNorm backward");
   MKLDNNBNSignature key(param);
   key.AddSign(in_data);
   key.AddSign(diff_data);
 
-  auto it = bwds.find(key);
-  if (it == bwds.end()) {
+  return bwds.Get(key, [&]() {
     auto bwd_pd = _GetBwd(in_mem, diff_mem, param.eps, flags);
-    MKLDNNBNBackward bwd(bwd_pd);
-    it = AddToCache(&bwds, key, bwd);
-  }
-  return it->second;
+    return MKLDNNBNBackward(bwd_pd);
+  });
 }
 
 template <typename DType>
@@ -398,7 +389,8 @@ void MKLDNNBatchNormBackward(const OpContext &ctx, const BatchNormParam &param,
     data_mem = data.GetMKLDNNDataReorder(diff_mem->get_primitive_desc());
   else if (diff.IsDefaultData())
     diff_mem = diff.GetMKLDNNDataReorder(data_mem->get_primitive_desc());
-  auto &bwd = GetBNBackward<DType>(param, ctx, data, *data_mem, diff, *diff_mem, flags);
+  auto bwd_ptr = GetBNBackward<DType>(param, ctx, data, *data_mem, diff, *diff_mem, flags);
+  MKLDNNBNBackward &bwd = *bwd_ptr;
   auto gradi_mem = const_cast<NDArray &>(gradIn).CreateMKLDNNData(data_mem->get_primitive_desc());
 
   if (flags & use_scale_shift) {
@@ -32,6 +32,7 @@
 #include "../concat-inl.h"
 #include "./mkldnn_ops-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -56,24 +57,15 @@ class MKLDNNConcatFwd {
   std::shared_ptr<mkldnn::memory> out;
 };
 
-static MKLDNNConcatFwd &GetConcatForward(
+static std::shared_ptr<MKLDNNConcatFwd> GetConcatForward(
     int concat_dim, const std::vector<NDArray> &in_data,
     const std::vector<mkldnn::memory::primitive_desc> &data_md) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
-#endif
+  static MKLDNNPrimitiveCache<OpSignature, MKLDNNConcatFwd, OpHash> fwds("Concat forward");
   OpSignature key;
   key.AddSign(concat_dim);
   key.AddSign(in_data);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
-    MKLDNNConcatFwd fwd(concat_dim, data_md);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+  return fwds.Get(key, [&]() { return MKLDNNConcatFwd(concat_dim, data_md); });
 }
 
 }  // namespace op
@@ -70,7 +70,8 @@ void MKLDNNConcatForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
     data_md.push_back(tmp_pd);
     data_mem.push_back(tmp_mem);
   }
-  MKLDNNConcatFwd &fwd = GetConcatForward(concat_dim, in_data, data_md);
+  auto fwd_ptr = GetConcatForward(concat_dim, in_data, data_md);
+  MKLDNNConcatFwd &fwd = *fwd_ptr;
   mxnet::mkldnn_output_t out_mem = CreateMKLDNNMem(out_data[concat_enum::kOut],
                                                    fwd.fwd_pd.dst_primitive_desc(),
                                                    req[concat_enum::kOut]);
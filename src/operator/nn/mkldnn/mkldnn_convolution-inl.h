@@ -118,10 +118,10 @@ class MKLDNNConvForward {
 
 typedef ParamOpSign<ConvolutionParam> MKLDNNConvSignature;
 
-MKLDNNConvForward &GetConvFwd(const ConvolutionParam &param,
-                              const bool is_train, const NDArray &data,
-                              const NDArray &weights, const NDArray *bias,
-                              const NDArray &output);
+std::shared_ptr<MKLDNNConvForward> GetConvFwd(const ConvolutionParam &param,
+                                              const bool is_train, const NDArray &data,
+                                              const NDArray &weights, const NDArray *bias,
+                                              const NDArray &output);
 
 void MKLDNNConvolutionForwardFullFeature(const MKLDNNConvFullParam &param,
                                          const OpContext &ctx,
@@ -30,6 +30,7 @@
 #include "./mkldnn_ops-inl.h"
 #include "./mkldnn_base-inl.h"
 #include "./mkldnn_convolution-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -350,15 +351,12 @@ void MKLDNNConvForward::SetNewMem(const mkldnn::memory &data, const mkldnn::memo
   if (bias != nullptr) bias_->set_data_handle(bias->get_data_handle());
 }
 
-MKLDNNConvForward &GetConvFwd(const ConvolutionParam &param,
-                              const bool is_train, const NDArray &data,
-                              const NDArray &weights, const NDArray *bias,
-                              const NDArray &output) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNConvSignature, MKLDNNConvForward, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNConvSignature, MKLDNNConvForward, OpHash> fwds;
-#endif
+std::shared_ptr<MKLDNNConvForward> GetConvFwd(const ConvolutionParam &param,
+                                              const bool is_train, const NDArray &data,
+                                              const NDArray &weights, const NDArray *bias,
+                                              const NDArray &output) {
+  static MKLDNNPrimitiveCache<MKLDNNConvSignature, MKLDNNConvForward, OpHash>
+      fwds("Convolution forward");
   MKLDNNConvSignature key(param);
   key.AddSign(is_train);
   // Here we can sign the conv op with NDArray because conv primitive will
@@ -370,15 +368,12 @@ MKLDNNConvForward &GetConvFwd(const ConvolutionParam &param,
   if (bias)
     key.AddSign(*bias);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
+  return fwds.Get(key, [&]() {
     MKLDNNConvFullParam full_param;
     full_param.conv_param = param;
     full_param.mkldnn_param.Init(std::unordered_map<std::string, std::string>());
-    MKLDNNConvForward fwd(full_param, is_train, data, weights, bias, output);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+    return MKLDNNConvForward(full_param, is_train, data, weights, bias, output);
+  });
 }
 
 void MKLDNNConvolutionForwardFullFeature(const MKLDNNConvFullParam &param,
@@ -454,11 +449,11 @@ void MKLDNNConvolutionForward(const nnvm::NodeAttrs &attrs,
   MKLDNNConvFullParam param;
   param.conv_param = nnvm::get<ConvolutionParam>(attrs.parsed);
   param.mkldnn_param.Init(std::unordered_map<std::string, std::string>());
-  auto &fwd = GetConvFwd(
+  auto fwd = GetConvFwd(
       param.conv_param, ctx.is_train, in_data[conv::kData], in_data[conv::kWeight],
       param.conv_param.no_bias ? nullptr : &in_data[conv::kBias],
       out_data[conv::kOut]);
-  MKLDNNConvolutionForwardFullFeature(param, ctx, &fwd, in_data, req, out_data);
+  MKLDNNConvolutionForwardFullFeature(param, ctx, fwd.get(), in_data, req, out_data);
 }
 
 class MKLDNNConvBackward {
@@ -581,15 +576,12 @@ void SetWeightNewMem(const mkldnn::memory &data,
   }
 };
 
-static inline MKLDNNConvBackward &GetConvBwd(
+static inline std::shared_ptr<MKLDNNConvBackward> GetConvBwd(
     const nnvm::NodeAttrs &attrs, const NDArray &data, const NDArray &weights,
     const NDArray *bias, const NDArray &output,
     const mkldnn::convolution_forward::primitive_desc &fwd_pd) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNConvSignature, MKLDNNConvBackward, OpHash> bwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNConvSignature, MKLDNNConvBackward, OpHash> bwds;
-#endif
+  static MKLDNNPrimitiveCache<MKLDNNConvSignature, MKLDNNConvBackward, OpHash>
+      bwds("Convolution backward");
   const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
   MKLDNNConvSignature key(param);
   // Here we can sign the conv op with NDArray because conv primitive will
@@ -601,13 +593,9 @@ static inline MKLDNNConvBackward &GetConvBwd(
   if (bias)
     key.AddSign(*bias);
 
-
-  auto it = bwds.find(key);
-  if (it == bwds.end()) {
-    MKLDNNConvBackward bwd(param, data, weights, bias, output, fwd_pd);
-    it = AddToCache(&bwds, key, bwd);
-  }
-  return it->second;
+  return bwds.Get(key, [&]() {
+    return MKLDNNConvBackward(param, data, weights, bias, output, fwd_pd);
+  });
 }
 
 void MKLDNNConvolutionBackward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
@@ -639,8 +627,8 @@ void MKLDNNConvolutionBackward(const nnvm::NodeAttrs& attrs, const OpContext &ct
   const ConvolutionParam &param = full_param.conv_param;
 
   CHECK_NE(req[conv::kWeight], kWriteInplace) << "cannot write weight inplace";
-  MKLDNNConvBackward &convBwd = GetConvBwd(attrs, data,
-      weight, bias, out_grad, fwd_pd);
+  auto bwd = GetConvBwd(attrs, data, weight, bias, out_grad, fwd_pd);
+  MKLDNNConvBackward &convBwd = *bwd;
   auto out_grad_mem = out_grad.GetMKLDNNDataReorder(
       convBwd.bwdData_pd.diff_dst_primitive_desc());
   if (req[conv::kData]) {
@@ -653,8 +641,7 @@ void MKLDNNConvolutionBackward(const nnvm::NodeAttrs& attrs, const OpContext &ct
     CommitOutput(in_grad[conv::kData], in_grad_mem);
   }
   if (req[conv::kWeight]) {
-    MKLDNNConvBackward &convBwdWeight = GetConvBwd(attrs, data,
-        weight, bias, out_grad, fwd_pd);
+    MKLDNNConvBackward &convBwdWeight = *bwd;
     if (convBwdWeight.bwdData_pd.diff_dst_primitive_desc() !=
         convBwdWeight.bwdWeights_pd.diff_dst_primitive_desc())
       out_grad_mem = out_grad.GetMKLDNNDataReorder(
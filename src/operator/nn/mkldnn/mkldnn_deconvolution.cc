@@ -28,6 +28,7 @@
 #include "../deconvolution-inl.h"
 #include "./mkldnn_ops-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -304,17 +305,12 @@ static void MKLDNNDeconvFwdBiasPostProcess(const DeconvolutionParam& param,
   }
 }
 
-static inline MKLDNNDeconvForward &GetDeconvFwd(
+static inline std::shared_ptr<MKLDNNDeconvForward> GetDeconvFwd(
     const nnvm::NodeAttrs& attrs, const NDArray &data,
     const NDArray &weights, const NDArray *bias,
     const NDArray &output) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local
-        std::unordered_map<DeconvSignature, MKLDNNDeconvForward, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL
-        std::unordered_map<DeconvSignature, MKLDNNDeconvForward, OpHash> fwds;
-#endif
+  static MKLDNNPrimitiveCache<DeconvSignature, MKLDNNDeconvForward, OpHash>
+      fwds("Deconvolution forward");
   const DeconvolutionParam& param = nnvm::get<DeconvolutionParam>(attrs.parsed);
   DeconvSignature key(param);
   // Here we can sign the conv op with NDArray because conv primitive will
@@ -326,13 +322,10 @@ static inline MKLDNNDeconvForward &GetDeconvFwd(
   if (bias)
     key.AddSign(*bias);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
+  return fwds.Get(key, [&]() {
     bool has_bias = (bias != nullptr);
-    MKLDNNDeconvForward fwd(param, data, weights, has_bias, output);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+    return MKLDNNDeconvForward(param, data, weights, has_bias, output);
+  });
 }
 
 void MKLDNNDeconvolutionForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
@@ -352,8 +345,8 @@ void MKLDNNDeconvolutionForward(const nnvm::NodeAttrs& attrs, const OpContext &c
 
   const NDArray* bias = param.no_bias ? nullptr : &in_data[deconv::kBias];
 
-  MKLDNNDeconvForward &deconvFwd = GetDeconvFwd(
-      attrs, data, weight, bias, out_data[deconv::kOut]);
+  auto fwd_ptr = GetDeconvFwd(attrs, data, weight, bias, out_data[deconv::kOut]);
+  MKLDNNDeconvForward &deconvFwd = *fwd_ptr;
 
   deconvFwd.SetDataHandle(param, ctx, data, weight, req, out_data);
 
@@ -401,18 +394,11 @@ class MKLDNNDeconvBackwardData {
 
 typedef ParamOpSign<DeconvolutionParam> MKLDNNDeconvSignature;
 
-static inline MKLDNNDeconvBackwardData &GetDeconvBwdData(
+static inline std::shared_ptr<MKLDNNDeconvBackwardData> GetDeconvBwdData(
     const DeconvolutionParam &param, const NDArray &data,
     const NDArray &weights, const NDArray &output) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNDeconvSignature,
-                                         MKLDNNDeconvBackwardData, OpHash>
-      bwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNDeconvSignature,
-                                            MKLDNNDeconvBackwardData, OpHash>
-      bwds;
-#endif
+  static MKLDNNPrimitiveCache<MKLDNNDeconvSignature, MKLDNNDeconvBackwardData, OpHash>
+      bwds("Deconvolution backward data");
   MKLDNNDeconvSignature key(param);
   // Here we can sign the conv op with NDArray because conv primitive will
   // decide the right layout for the, so we only need to get the shape and the
@@ -421,12 +407,9 @@ static inline MKLDNNDeconvBackwardData &GetDeconvBwdData(
   key.AddSign(weights);
   key.AddSign(output);
 
-  auto it = bwds.find(key);
-  if (it == bwds.end()) {
-    MKLDNNDeconvBackwardData bwd(param, data, weights, output);
-    it = AddToCache(&bwds, key, bwd);
-  }
-  return it->second;
+  return bwds.Get(key, [&]() {
+    return MKLDNNDeconvBackwardData(param, data, weights, output);
+  });
 }
 
 class MKLDNNDeconvBackwardWeights {
@@ -469,19 +452,12 @@ class MKLDNNDeconvBackwardWeights {
   const mkldnn::convolution_backward_weights &GetBwd() const { return *bwd; }
 };
 
-static inline MKLDNNDeconvBackwardWeights &GetDeconvBwdWeights(
+static inline std::shared_ptr<MKLDNNDeconvBackwardWeights> GetDeconvBwdWeights(
     const DeconvolutionParam &param, const NDArray &data,
     const NDArray &weights, const NDArray &output,
     const mkldnn::convolution_forward::primitive_desc &bwd_data_pd) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNDeconvSignature,
-                                         MKLDNNDeconvBackwardWeights, OpHash>
-      bwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNDeconvSignature,
-                                            MKLDNNDeconvBackwardWeights, OpHash>
-      bwds;
-#endif
+  static MKLDNNPrimitiveCache<MKLDNNDeconvSignature, MKLDNNDeconvBackwardWeights, OpHash>
+      bwds("Deconvolution backward weights");
   MKLDNNDeconvSignature key(param);
   // Here we can sign the conv op with NDArray because conv primitive will
   // decide the right layout for the, so we only need to get the shape and the
@@ -490,16 +466,9 @@ static inline MKLDNNDeconvBackwardWeights &GetDeconvBwdWeights(
   key.AddSign(weights);
   key.AddSign(output);
 
-  auto it = bwds.find(key);
-  if (it == bwds.end()) {
-    MKLDNNDeconvBackwardWeights bwd(param, data, weights, output, bwd_data_pd);
-    auto ins_ret = bwds.insert(
-        std::pair<MKLDNNDeconvSignature, MKLDNNDeconvBackwardWeights>(key,
-                                                                      bwd));
-    CHECK(ins_ret.second);
-    it = ins_ret.first;
-  }
-  return it->second;
+  return bwds.Get(key, [&]() {
+    return MKLDNNDeconvBackwardWeights(param, data, weights, output, bwd_data_pd);
+  });
 }
 
 void MKLDNNDeconvolutionBackward(const nnvm::NodeAttrs &attrs,
@@ -521,8 +490,8 @@ void MKLDNNDeconvolutionBackward(const nnvm::NodeAttrs &attrs,
 
   CHECK_NE(req[deconv::kWeight], kWriteInplace)
       << "cannot write weight inplace";
-  MKLDNNDeconvBackwardData &bwd_data =
-      GetDeconvBwdData(param, data, weight, inputs[deconv::kOut]);
+  auto bwd_data_ptr = GetDeconvBwdData(param, data, weight, inputs[deconv::kOut]);
+  MKLDNNDeconvBackwardData &bwd_data = *bwd_data_ptr;
   auto out_grad_mem = inputs[deconv::kOut].GetMKLDNNDataReorder(
       bwd_data.pd.src_primitive_desc());
   if (req[deconv::kData]) {
@@ -536,9 +505,10 @@ void MKLDNNDeconvolutionBackward(const nnvm::NodeAttrs &attrs,
     CommitOutput(in_grad[deconv::kData], in_grad_mem);
   }
   if (req[deconv::kWeight]) {
-    MKLDNNDeconvBackwardWeights &bwd_weights = GetDeconvBwdWeights(
+    auto bwd_weights_ptr = GetDeconvBwdWeights(
         param, data, weight,
         inputs[deconv::kOut], bwd_data.pd);
+    MKLDNNDeconvBackwardWeights &bwd_weights = *bwd_weights_ptr;
     if (bwd_data.pd.src_primitive_desc() != bwd_weights.pd.src_primitive_desc())
       out_grad_mem = inputs[deconv::kOut].GetMKLDNNDataReorder(
           bwd_weights.pd.src_primitive_desc());
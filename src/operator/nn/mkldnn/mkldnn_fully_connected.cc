@@ -25,6 +25,7 @@
 
 #include "../fully_connected-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 #if MXNET_USE_MKLDNN == 1
 namespace mxnet {
@@ -144,17 +145,12 @@ class MKLDNNFullyConnectForward {
 
 typedef ParamOpSign<FullyConnectedParam> MKLDNNFullyconSignature;
 
-static inline MKLDNNFullyConnectForward &GetFCFwd(
+static inline std::shared_ptr<MKLDNNFullyConnectForward> GetFCFwd(
     const nnvm::NodeAttrs &attrs, const NDArray &data, const NDArray &weight,
     const NDArray *bias, const mkldnn::memory::desc &output,
     const bool is_train) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNFullyconSignature,
-              MKLDNNFullyConnectForward, OpHash> fcFwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNFullyconSignature,
-              MKLDNNFullyConnectForward, OpHash> fcFwds;
-#endif
+  static MKLDNNPrimitiveCache<MKLDNNFullyconSignature, MKLDNNFullyConnectForward, OpHash>
+      fcFwds("FullyConnected forward");
   const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
   MKLDNNFullyconSignature key(param);
   key.AddSign(data);
@@ -164,16 +160,9 @@ static inline MKLDNNFullyConnectForward &GetFCFwd(
   if (bias)
     key.AddSign(*bias);
 
-  auto it = fcFwds.find(key);
-  if (it == fcFwds.end()) {
-    MKLDNNFullyConnectForward fcFwd(param, is_train, data, weight, bias,
-                                    output);
-    auto ins_ret = fcFwds.insert(
-        std::pair<MKLDNNFullyconSignature, MKLDNNFullyConnectForward>(key, fcFwd));
-    CHECK(ins_ret.second);
-    it = ins_ret.first;
-  }
-  return it->second;
+  return fcFwds.Get(key, [&]() {
+    return MKLDNNFullyConnectForward(param, is_train, data, weight, bias, output);
+  });
 }
 
 void MKLDNNFCForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
@@ -206,9 +195,10 @@ void MKLDNNFCForward(const nnvm::NodeAttrs& attrs, const OpContext &ctx,
     out_md = mkldnn::memory::desc(out_dims, get_mkldnn_type(out_data[fullc::kOut].dtype()),
       mkldnn::memory::format::any);
   }
-  MKLDNNFullyConnectForward &FCFwd =
-      GetFCFwd(attrs, data, weight, param.no_bias ? nullptr : &in_data[fullc::kBias],
-               out_md, ctx.is_train);
+  auto fwd_ptr = GetFCFwd(attrs, data, weight,
+                          param.no_bias ? nullptr : &in_data[fullc::kBias],
+                          out_md, ctx.is_train);
+  MKLDNNFullyConnectForward &FCFwd = *fwd_ptr;
   auto data_mem = data.GetMKLDNNDataReorder(FCFwd.ipFwd_pd.src_primitive_desc());
   auto weight_mem = weight.GetMKLDNNDataReorder(FCFwd.ipFwd_pd.weights_primitive_desc());
   auto out_mem = CreateMKLDNNMem(out_data[fullc::kOut],
@@ -30,6 +30,7 @@
 #include <mkldnn.hpp>
 #include "../lrn-inl.h"
 #include "./mkldnn_base-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -167,18 +168,10 @@ mkldnn::lrn_forward &MKLDNNLRNFwd::GetFwd() { return *this->fwd; }
 const mkldnn::memory *MKLDNNLRNFwd::GetWs() { return this->ws_mem.get(); }
 // End of LRN Class and its functions
 
-static MKLDNNLRNFwd &GetLRNFwd(const LRNParam& param,
-                               const OpContext &ctx,
-                               const NDArray &in_data) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNLRNSignature,
-                                         MKLDNNLRNFwd,
-                                         OpHash> lrn_fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNLRNSignature,
-                                            MKLDNNLRNFwd,
-                                            OpHash> lrn_fwds;
-#endif
+static std::shared_ptr<MKLDNNLRNFwd> GetLRNFwd(const LRNParam& param,
+                                               const OpContext &ctx,
+                                               const NDArray &in_data) {
+  static MKLDNNPrimitiveCache<MKLDNNLRNSignature, MKLDNNLRNFwd, OpHash> lrn_fwds("LRN forward");
   auto kind_ =
       ctx.is_train ? prop_kind::forward_training : prop_kind::forward_scoring;
 
@@ -186,12 +179,7 @@ static MKLDNNLRNFwd &GetLRNFwd(const LRNParam& param,
   key.AddSign(kind_);
   key.AddSign(in_data);
 
-  auto it = lrn_fwds.find(key);
-  if (it == lrn_fwds.end()) {
-    MKLDNNLRNFwd fwd(param, ctx.is_train, in_data);
-    it = AddToCache(&lrn_fwds, key, fwd);
-  }
-  return it->second;
+  return lrn_fwds.Get(key, [&]() { return MKLDNNLRNFwd(param, ctx.is_train, in_data); });
 }
 
 void MKLDNNLRNForward(const OpContext &ctx, const LRNParam &param,
@@ -200,9 +188,9 @@ void MKLDNNLRNForward(const OpContext &ctx, const LRNParam &param,
   auto in_buffer = in_data;
   if (in_buffer.IsView() && in_buffer.IsMKLDNNData())
     in_buffer = in_buffer.Reorder2Default();
-  MKLDNNLRNFwd fwd = GetLRNFwd(param, ctx, in_buffer);
-  fwd.SetNewMem(in_buffer, out_data, req);
-  fwd.Execute(out_data);
+  auto fwd = GetLRNFwd(param, ctx, in_buffer);
+  fwd->SetNewMem(in_buffer, out_data, req);
+  fwd->Execute(out_data);
 }
 
 // LRN Backward Class
@@ -260,30 +248,21 @@ class MKLDNNLRNBwd {
   }
 };  // End of LRN Class
 
-static MKLDNNLRNBwd &GetLRNBwd(const LRNParam &param, const NDArray &in_data,
-                               const NDArray &in_grad, const NDArray &out_grad) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local
-      std::unordered_map<MKLDNNLRNSignature, MKLDNNLRNBwd, OpHash> lrn_bwds;
-#else
-  static MX_THREAD_LOCAL
-      std::unordered_map<MKLDNNLRNSignature, MKLDNNLRNBwd, OpHash> lrn_bwds;
-#endif
+static std::shared_ptr<MKLDNNLRNBwd> GetLRNBwd(const LRNParam &param, const NDArray &in_data,
+                                               const NDArray &in_grad, const NDArray &out_grad) {
+  static MKLDNNPrimitiveCache<MKLDNNLRNSignature, MKLDNNLRNBwd, OpHash> lrn_bwds("LRN backward");
   MKLDNNLRNSignature key(param);
   key.AddSign(in_data);
   key.AddSign(in_grad);
   key.AddSign(out_grad);
 
-  auto it = lrn_bwds.find(key);
-  if (it == lrn_bwds.end()) {
+  return lrn_bwds.Get(key, [&]() {
     const mkldnn::memory::desc in_data_md =
         in_data.GetMKLDNNData()->get_primitive_desc().desc();
     const mkldnn::memory::desc diff_md =
         out_grad.GetMKLDNNData()->get_primitive_desc().desc();
-    MKLDNNLRNBwd bwd(param, in_data_md, diff_md);
-    it = AddToCache(&lrn_bwds, key, bwd);
-  }
-  return it->second;
+    return MKLDNNLRNBwd(param, in_data_md, diff_md);
+  });
 }
 
 void MKLDNNLRNBackward(const OpContext &ctx, const LRNParam &param,
@@ -299,13 +278,15 @@ void MKLDNNLRNBackward(const OpContext &ctx, const LRNParam &param,
   if (in_buffer.IsMKLDNNData()) {
     in_buffer = in_data.Reorder2Default();
   }
-  MKLDNNLRNBwd &bwd = GetLRNBwd(param, in_buffer, in_grad, out_grad);
+  auto bwd_ptr = GetLRNBwd(param, in_buffer, in_grad, out_grad);
+  MKLDNNLRNBwd &bwd = *bwd_ptr;
   // Repeat FW for getting workspace
   // TODO(Patric): To keep the function stateless, we can't pass workspace
   //               from LRN forward to backward. We have to re-compute
   //               LRN forward to get the workspace.
   //               Will refine this code later.
-  MKLDNNLRNFwd fwd = GetLRNFwd(param, ctx, in_buffer);
+  auto fwd_ptr = GetLRNFwd(param, ctx, in_buffer);
+  MKLDNNLRNFwd &fwd = *fwd_ptr;
   std::shared_ptr<const mkldnn::memory> dst_temp(
       new mkldnn::memory(bwd.fwd_pd.dst_primitive_desc()));
   fwd.SetNewMem(in_buffer, dst_temp.get());
@@ -26,6 +26,7 @@
 #if MXNET_USE_MKLDNN == 1
 
 #include "./mkldnn_pooling-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -199,19 +200,12 @@ mkldnn::pooling_forward::primitive_desc GetPoolingFwdPdesc(
   return mkldnn::pooling_forward::primitive_desc(poolingFwd_desc, engine);
 }
 
-MKLDNNPoolingFwd &GetPoolingFwd(const PoolingParam &param,
-                                const bool is_train,
-                                const NDArray &data,
-                                const NDArray &output) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNPoolingSignature,
-                                         MKLDNNPoolingFwd,
-                                         OpHash> pooling_fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNPoolingSignature,
-                                            MKLDNNPoolingFwd,
-                                            OpHash> pooling_fwds;
-#endif
+std::shared_ptr<MKLDNNPoolingFwd> GetPoolingFwd(const PoolingParam &param,
+                                                const bool is_train,
+                                                const NDArray &data,
+                                                const NDArray &output) {
+  static MKLDNNPrimitiveCache<MKLDNNPoolingSignature, MKLDNNPoolingFwd, OpHash>
+      pooling_fwds("Pooling forward");
 
   bool with_workspace = is_train && MKLDNNRequireWorkspace(param);
   MKLDNNPoolingSignature key(param);
@@ -220,8 +214,7 @@ MKLDNNPoolingFwd &GetPoolingFwd(const PoolingParam &param,
   key.AddSign(data);
   key.AddSign(output);
 
-  auto it = pooling_fwds.find(key);
-  if (it == pooling_fwds.end()) {
+  return pooling_fwds.Get(key, [&]() {
     CHECK_EQ(param.kernel.ndim(), 2) << "Not Implemented";
     auto data_md = data.GetMKLDNNData()->get_primitive_desc().desc();
     int kernel_h_, kernel_w_;
@@ -259,19 +252,17 @@ MKLDNNPoolingFwd &GetPoolingFwd(const PoolingParam &param,
     }
 
     const mkldnn::algorithm alg = GetMKLDNNPoolAlgo(param);
-    MKLDNNPoolingFwd fwd(data, output, kernel_h_, kernel_w_, stride_h_, stride_w_,
-                         pad_t_, pad_b_, pad_l_, pad_r_, alg, with_workspace, is_train);
-    it = AddToCache(&pooling_fwds, key, fwd);
-  }
-  return it->second;
+    return MKLDNNPoolingFwd(data, output, kernel_h_, kernel_w_, stride_h_, stride_w_,
+                            pad_t_, pad_b_, pad_l_, pad_r_, alg, with_workspace, is_train);
+  });
 }
 
 void MKLDNNPoolingCompute(const OpContext &ctx, const PoolingParam &param,
                           const NDArray &in_data, const OpReqType req,
                           const NDArray &out_data, const NDArray *workspace) {
-  auto &fwd = GetPoolingFwd(param, ctx.is_train, in_data, out_data);
-  fwd.SetNewMem(in_data, out_data, req, workspace);
-  fwd.Execute(out_data);
+  auto fwd = GetPoolingFwd(param, ctx.is_train, in_data, out_data);
+  fwd->SetNewMem(in_data, out_data, req, workspace);
+  fwd->Execute(out_data);
 }
 
 MKLDNNPoolingBwd::MKLDNNPoolingBwd(
@@ -311,19 +302,12 @@ const mkldnn::pooling_backward &MKLDNNPoolingBwd::GetBwd() {
   return *this->bwd;
 }
 
-MKLDNNPoolingBwd &GetPoolingBwd(const PoolingParam &param,
-                                const NDArray &in_data,
-                                const NDArray &in_grad,
-                                const NDArray &out_grad) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local
-      std::unordered_map<MKLDNNPoolingSignature,
-                         MKLDNNPoolingBwd, OpHash> pooling_bwds;
-#else
-  static MX_THREAD_LOCAL
-      std::unordered_map<MKLDNNPoolingSignature,
-                         MKLDNNPoolingBwd, OpHash> pooling_bwds;
-#endif
+std::shared_ptr<MKLDNNPoolingBwd> GetPoolingBwd(const PoolingParam &param,
+                                                const NDArray &in_data,
+                                                const NDArray &in_grad,
+                                                const NDArray &out_grad) {
+  static MKLDNNPrimitiveCache<MKLDNNPoolingSignature, MKLDNNPoolingBwd, OpHash>
+      pooling_bwds("Pooling backward");
 
   bool with_workspace = MKLDNNRequireWorkspace(param);
   MKLDNNPoolingSignature key(param);
@@ -331,8 +315,7 @@ MKLDNNPoolingBwd &GetPoolingBwd(const PoolingParam &param,
   key.AddSign(in_grad);
   key.AddSign(out_grad);
 
-  auto it = pooling_bwds.find(key);
-  if (it == pooling_bwds.end()) {
+  return pooling_bwds.Get(key, [&]() {
     auto diff_dst_mem = out_grad.GetMKLDNNData();
     auto input_mem = in_data.GetMKLDNNData();
     mkldnn::memory::primitive_desc data_mpd = input_mem->get_primitive_desc();
@@ -384,10 +367,8 @@ MKLDNNPoolingBwd &GetPoolingBwd(const PoolingParam &param,
         {kernel_h_, kernel_w_}, {pad_t_, pad_l_}, {pad_b_, pad_r_},
         mkldnn::padding_kind::zero);
     const auto pdesc = pooling_backward::primitive_desc(desc, cpu_engine, fwd_pd);
-    MKLDNNPoolingBwd bwd(pdesc, with_workspace);
-    it = AddToCache(&pooling_bwds, key, bwd);
-  }
-  return it->second;
+    return MKLDNNPoolingBwd(pdesc, with_workspace);
+  });
 }
 
 void MKLDNNPoolingGradCompute(const OpContext &ctx, const PoolingParam &param,
@@ -399,7 +380,8 @@ void MKLDNNPoolingGradCompute(const OpContext &ctx, const PoolingParam &param,
   }
   TmpMemMgr::Get()->Init(ctx.requested[0]);
 
-  auto &bwd = GetPoolingBwd(param, in_data, in_grad, out_grad);
+  auto bwd_ptr = GetPoolingBwd(param, in_data, in_grad, out_grad);
+  MKLDNNPoolingBwd &bwd = *bwd_ptr;
   auto diff_src_mem =
       CreateMKLDNNMem(in_grad, bwd.pd.diff_src_primitive_desc(), req);
 
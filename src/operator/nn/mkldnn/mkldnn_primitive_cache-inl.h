@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file mkldnn_primitive_cache-inl.h
+ * \brief Process-wide LRU cache of MKLDNN forward/backward primitives.
+*/
+#ifndef MXNET_OPERATOR_NN_MKLDNN_MKLDNN_PRIMITIVE_CACHE_INL_H_
+#define MXNET_OPERATOR_NN_MKLDNN_MKLDNN_PRIMITIVE_CACHE_INL_H_
+
+#if MXNET_USE_MKLDNN == 1
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./mkldnn_base-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Hit/miss/eviction counters of a primitive cache. The counters are also exported
+ *  as profiler counters in the "MKLDNN Primitive Cache" domain while the profiler runs.
+ */
+class MKLDNNPrimitiveCacheStats {
+ public:
+  explicit MKLDNNPrimitiveCacheStats(const char *name);
+  virtual ~MKLDNNPrimitiveCacheStats();
+
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+  uint64_t evictions() const { return evictions_; }
+
+ protected:
+  void OnHit() { ReportHit(++hits_); }
+  void OnMiss() { ReportMiss(++misses_); }
+  void OnEvict() { ReportEviction(++evictions_); }
+
+ private:
+  void ReportHit(uint64_t value);
+  void ReportMiss(uint64_t value);
+  void ReportEviction(uint64_t value);
+  struct ProfilerCounters;
+  ProfilerCounters *Counters();
+
+  std::string name_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::once_flag counters_init_;
+  std::unique_ptr<ProfilerCounters> counters_;
+};
+
+/*!
+ * \brief Cache of MKLDNN primitive wrappers (e.g. MKLDNNConvForward) shared by all threads.
+ *
+ * The wrappers keep the memory handles of the last execution, so an instance must not be
+ * used by two threads at the same time. Get() therefore hands out an instance exclusively:
+ * it stays checked out until the returned shared_ptr is destroyed, and a concurrent request
+ * for the same signature creates another instance. Idle instances are kept per signature
+ * and the least recently used ones are dropped once the cache holds more than
+ * capacity() instances.
+ */
+template<typename Key, typename Value, typename Hash>
+class MKLDNNPrimitiveCache : public MKLDNNPrimitiveCacheStats {
+ public:
+  /*!
+   * \param name Name of the profiler counters.
+   * \param capacity Maximum number of instances, -1 for unbounded. Defaults to
+   *  MXNET_MKLDNN_CACHE_NUM.
+   */
+  explicit MKLDNNPrimitiveCache(const char *name, int capacity = GetMKLDNNCacheSize())
+    : MKLDNNPrimitiveCacheStats(name), capacity_(capacity) {}
+
+  /*!
+   * \brief Maximum number of instances the cache holds, -1 for unbounded.
+   */
+  int capacity() const { return capacity_; }
+
+  /*!
+   * \brief Check out the primitive of a signature, creating it with fcreate on a miss.
+   * \param key The signature of the primitive.
+   * \param fcreate Function returning a new Value, called without holding the cache lock.
+   * \return The primitive, returned to the cache when released.
+   */
+  template<typename FCreate>
+  std::shared_ptr<Value> Get(const Key &key, FCreate fcreate) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+        if (!it->second.idle.empty()) {
+          Value *ret = it->second.idle.back().release();
+          it->second.idle.pop_back();
+          ++it->second.in_use;
+          OnHit();
+          return Wrap(key, ret);
+        }
+      }
+    }
+    OnMiss();
+    std::unique_ptr<Value> created(new Value(fcreate()));
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry &entry = GetOrCreateEntry(key);
+    ++entry.in_use;
+    ++num_instances_;
+    Evict();
+    return Wrap(key, created.release());
+  }
+
+  /*!
+   * \brief Number of instances held by the cache, checked out or idle.
+   */
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_instances_;
+  }
+
+ private:
+  struct Entry {
+    // instances waiting for reuse
+    std::vector<std::unique_ptr<Value>> idle;
+    // number of instances currently checked out
+    size_t in_use = 0;
+    // position in lru_
+    typename std::list<Key>::iterator lru_pos;
+  };
+
+  Entry &GetOrCreateEntry(const Key &key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      lru_.push_front(key);
+      it = entries_.emplace(key, Entry()).first;
+      it->second.lru_pos = lru_.begin();
+    } else {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    }
+    return it->second;
+  }
+
+  std::shared_ptr<Value> Wrap(const Key &key, Value *value) {
+    return std::shared_ptr<Value>(value, [this, key](Value *v) { this->Release(key, v); });
+  }
+
+  void Release(const Key &key, Value *value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    CHECK(it != entries_.end());
+    --it->second.in_use;
+    it->second.idle.emplace_back(value);
+    Evict();
+  }
+
+  /*! \brief drop idle instances, least recently used signature first */
+  void Evict() {
+    const int capacity = capacity_;
+    if (capacity < 0) return;
+    auto pos = lru_.end();
+    while (num_instances_ > static_cast<size_t>(capacity) && pos != lru_.begin()) {
+      --pos;
+      auto it = entries_.find(*pos);
+      Entry &entry = it->second;
+      while (!entry.idle.empty() && num_instances_ > static_cast<size_t>(capacity)) {
+        entry.idle.pop_back();
+        --num_instances_;
+        OnEvict();
+      }
+      if (entry.idle.empty() && entry.in_use == 0) {
+        pos = lru_.erase(pos);
+        entries_.erase(it);
+      }
+    }
+  }
+
+  const int capacity_;
+  std::mutex mutex_;
+  std::unordered_map<Key, Entry, Hash> entries_;
+  // signatures, most recently used first
+  std::list<Key> lru_;
+  // instances held by the cache, checked out or idle
+  size_t num_instances_ = 0;
+};
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_USE_MKLDNN == 1
+#endif  // MXNET_OPERATOR_NN_MKLDNN_MKLDNN_PRIMITIVE_CACHE_INL_H_
@@ -54,8 +54,8 @@ class MKLDNNSliceFwd {
 };
 
 typedef ParamOpSign<SliceParam> MKLDNNSliceSignature;
-MKLDNNSliceFwd &GetSliceForward(const SliceParam &param, const bool is_train,
-                 const NDArray &in_data, const NDArray &out_data);
+std::shared_ptr<MKLDNNSliceFwd> GetSliceForward(const SliceParam &param, const bool is_train,
+                                                const NDArray &in_data, const NDArray &out_data);
 
 void MKLDNNSlice(const SliceParam &param, const OpContext& ctx,
                  const NDArray &in, OpReqType req, const NDArray &out);
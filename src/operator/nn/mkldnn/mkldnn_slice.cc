@@ -28,6 +28,7 @@
 #include "./mkldnn_ops-inl.h"
 #include "./mkldnn_base-inl.h"
 #include "./mkldnn_slice-inl.h"
+#include "./mkldnn_primitive_cache-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -67,29 +68,21 @@ const mkldnn::reorder &MKLDNNSliceFwd::GetPd() const {
   return *fwd_;
 }
 
-MKLDNNSliceFwd &GetSliceForward(const SliceParam &param, const bool is_train,
-                                const NDArray &in_data, const NDArray &out_data) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
-#else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
-#endif
+std::shared_ptr<MKLDNNSliceFwd> GetSliceForward(const SliceParam &param, const bool is_train,
+                                                const NDArray &in_data, const NDArray &out_data) {
+  static MKLDNNPrimitiveCache<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds("Slice forward");
   MKLDNNSliceSignature key(param);
   key.AddSign(is_train);
   key.AddSign(in_data);
   key.AddSign(out_data);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
-    MKLDNNSliceFwd fwd(param, in_data, out_data);
-    it = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+  return fwds.Get(key, [&]() { return MKLDNNSliceFwd(param, in_data, out_data); });
 }
 
 void MKLDNNSlice(const SliceParam &param, const OpContext& ctx,
                  const NDArray &in, OpReqType req, const NDArray &out) {
-  MKLDNNSliceFwd &fwd = GetSliceForward(param, ctx.is_train, in, out);
+  auto fwd_ptr = GetSliceForward(param, ctx.is_train, in, out);
+  MKLDNNSliceFwd &fwd = *fwd_ptr;
   auto in_mem = in.GetMKLDNNData();
   auto out_mem_pd = out.GetMKLDNNData()->get_primitive_desc();
   auto out_mem = CreateMKLDNNMem(out, out_mem_pd, req);
@@ -32,6 +32,7 @@
 #include <mshadow/base.h>
 #include <nnvm/op.h>
 #include <nnvm/op_attr_types.h>
+#include <type_traits>
 #include <vector>
 #include "./operator_common.h"
 #include "./mshadow_op.h"
@@ -203,6 +204,45 @@ inline bool MP_MultiSGD_InferType(const nnvm::NodeAttrs& attrs,
   return all_inferred;
 }
 
+/*!
+ * \brief Whether a multi-tensor adaptive update takes the squared global gradient norm
+ *  as its last input.
+ */
+template<typename ParamType>
+inline bool MultiHasGlobalNormInput(const nnvm::NodeAttrs& attrs) {
+  return dmlc::get<ParamType>(attrs.parsed).clip_global_norm > 0.0f;
+}
+
+template <typename ParamType, int input_stride>
+inline bool MultiAdaptiveShape(const nnvm::NodeAttrs& attrs,
+                               std::vector<TShape> *in_attrs,
+                               std::vector<TShape> *out_attrs) {
+  if (!MultiHasGlobalNormInput<ParamType>(attrs)) {
+    return MultiSGDShape<ParamType, input_stride>(attrs, in_attrs, out_attrs);
+  }
+  std::vector<TShape> tensor_attrs(in_attrs->begin(), in_attrs->end() - 1);
+  const bool all_inferred = MultiSGDShape<ParamType, input_stride>(attrs, &tensor_attrs,
+                                                                   out_attrs);
+  std::copy(tensor_attrs.begin(), tensor_attrs.end(), in_attrs->begin());
+  SHAPE_ASSIGN_CHECK(*in_attrs, in_attrs->size() - 1, mshadow::Shape1(1));
+  return all_inferred;
+}
+
+template <typename ParamType,
+          bool (*TensorType)(const nnvm::NodeAttrs&, std::vector<int>*, std::vector<int>*)>
+inline bool MultiAdaptiveType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int> *in_attrs,
+                              std::vector<int> *out_attrs) {
+  if (!MultiHasGlobalNormInput<ParamType>(attrs)) {
+    return TensorType(attrs, in_attrs, out_attrs);
+  }
+  std::vector<int> tensor_attrs(in_attrs->begin(), in_attrs->end() - 1);
+  const bool all_inferred = TensorType(attrs, &tensor_attrs, out_attrs);
+  std::copy(tensor_attrs.begin(), tensor_attrs.end(), in_attrs->begin());
+  TYPE_ASSIGN_CHECK(*in_attrs, in_attrs->size() - 1, mshadow::kFloat32);
+  return all_inferred;
+}
+
 template<typename DType, typename MPDType>
 struct MultiSGDKernelParam {
   static const int N = 60;
@@ -378,6 +418,310 @@ inline void MultiSGDMomUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+struct MultiAdamParam : public dmlc::Parameter<MultiAdamParam> {
+  nnvm::Tuple<float> lrs;
+  nnvm::Tuple<float> wds;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  float clip_global_norm;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiAdamParam) {
+    DMLC_DECLARE_FIELD(lrs)
+    .describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds)
+    .describe("Weight decay augments the objective function with a "
+              "regularization term that penalizes large weights. "
+              "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(beta1)
+    .set_default(0.9f)
+    .describe("The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2)
+    .set_default(0.999f)
+    .describe("The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon)
+    .set_default(1e-8f)
+    .describe("A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+    .set_default(1.0f)
+    .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+    .set_default(-1.0f)
+    .describe("Clip gradient to the range of [-clip_gradient, clip_gradient] "
+              "If clip_gradient <= 0, gradient clipping is turned off. "
+              "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(clip_global_norm)
+    .set_default(-1.0f)
+    .describe("Scale all rescaled gradients by clip_global_norm / max(norm, clip_global_norm), "
+              "where norm is rescale_grad times the square root of the last input, "
+              "global_norm_sq, the sum of squares of every gradient of the model. "
+              "If clip_global_norm <= 0, global norm clipping is turned off and "
+              "there is no global_norm_sq input.");
+    DMLC_DECLARE_FIELD(num_weights)
+    .set_default(1)
+    .describe("Number of updated weights.");
+  }
+};
+
+struct MultiRMSPropParam : public dmlc::Parameter<MultiRMSPropParam> {
+  nnvm::Tuple<float> lrs;
+  nnvm::Tuple<float> wds;
+  float gamma1;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  float clip_weights;
+  float clip_global_norm;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiRMSPropParam) {
+    DMLC_DECLARE_FIELD(lrs)
+    .describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds)
+    .describe("Weight decay augments the objective function with a "
+              "regularization term that penalizes large weights. "
+              "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(gamma1).set_default(0.95f)
+    .describe("The decay rate of momentum estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f)
+    .describe("A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+    .set_default(1.0f)
+    .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+    .set_default(-1.0f)
+    .describe("Clip gradient to the range of [-clip_gradient, clip_gradient] "
+              "If clip_gradient <= 0, gradient clipping is turned off. "
+              "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(clip_weights)
+    .set_default(-1.0f)
+    .describe("Clip weights to the range of [-clip_weights, clip_weights] "
+              "If clip_weights <= 0, weight clipping is turned off. "
+              "weights = max(min(weights, clip_weights), -clip_weights).");
+    DMLC_DECLARE_FIELD(clip_global_norm)
+    .set_default(-1.0f)
+    .describe("Scale all rescaled gradients by clip_global_norm / max(norm, clip_global_norm), "
+              "where norm is rescale_grad times the square root of the last input, "
+              "global_norm_sq, the sum of squares of every gradient of the model. "
+              "If clip_global_norm <= 0, global norm clipping is turned off and "
+              "there is no global_norm_sq input.");
+    DMLC_DECLARE_FIELD(num_weights)
+    .set_default(1)
+    .describe("Number of updated weights.");
+  }
+};
+
+/*!
+ * \brief Arguments of the multi-tensor Adam and RMSProp kernels. RMSProp keeps its
+ *  running average of the squared gradients in var and does not use mean.
+ *  Learning rates, weight decays and hyperparameters are kept in float so that the
+ *  struct stays within the 4KB limit of CUDA kernel arguments.
+ */
+template<typename DType, typename MPDType>
+struct MultiAdaptiveKernelParam {
+  static const int N = 60;
+  int count;
+  size_t max_size;
+  size_t sizes[N];
+  DType * weights[N];
+  DType * grads[N];
+  MPDType * mean[N];
+  MPDType * var[N];
+  MPDType * weights32[N];
+  DType * out_data[N];
+  float lrs[N];
+  float wds[N];
+  float rescale_grad;
+  float clip_gradient;
+  float clip_weights;
+  float clip_global_norm;
+  float beta1;
+  float beta2;
+  float epsilon;
+  /*! \brief sum of squares of all gradients of the model, nullptr without global norm clipping */
+  const float * sum_sq;
+};
+
+/*! \brief rescale_grad, shrunk further if the global gradient norm exceeds clip_global_norm */
+template<typename DType, typename MPDType>
+MSHADOW_XINLINE MPDType MultiGradScale(const MultiAdaptiveKernelParam<DType, MPDType>& param) {
+  if (param.sum_sq == nullptr) return MPDType(param.rescale_grad);
+  const float norm = param.rescale_grad * mshadow_op::square_root::Map(*param.sum_sq);
+  if (norm <= param.clip_global_norm) return MPDType(param.rescale_grad);
+  return MPDType(param.rescale_grad * param.clip_global_norm / norm);
+}
+
+template <typename MPDType, bool has_mixed_precision>
+struct MultiAdamKernel {
+  template<typename DType>
+  MSHADOW_XINLINE static void Map(int i, const MultiAdaptiveKernelParam<DType, MPDType>& param,
+    const OpReqType req) {
+    const MPDType scale = MultiGradScale(param);
+    const MPDType beta1 = param.beta1;
+    const MPDType beta2 = param.beta2;
+    for (int index = 0; index < param.count; ++index) {
+      if ((size_t)i < param.sizes[index]) {
+        MPDType w = has_mixed_precision ? param.weights32[index][i] :
+                                          MPDType(param.weights[index][i]);
+        MPDType grad = scale * static_cast<MPDType>(param.grads[index][i])
+                       + MPDType(param.wds[index]) * w;
+        if (param.clip_gradient >= 0.0f) {
+          grad = mshadow_op::clip::Map(grad, MPDType(param.clip_gradient));
+        }
+        const MPDType mean = beta1 * param.mean[index][i] + (MPDType(1) - beta1) * grad;
+        const MPDType var = beta2 * param.var[index][i] + (MPDType(1) - beta2) * grad * grad;
+        param.mean[index][i] = mean;
+        param.var[index][i] = var;
+        w = w - MPDType(param.lrs[index]) * mean /
+                (mshadow_op::square_root::Map(var) + MPDType(param.epsilon));
+        if (has_mixed_precision) {
+          param.weights32[index][i] = w;
+        }
+        KERNEL_ASSIGN(param.out_data[index][i], req, w);
+      }
+    }
+  }
+};
+
+template <typename MPDType, bool has_mixed_precision>
+struct MultiRMSPropKernel {
+  template<typename DType>
+  MSHADOW_XINLINE static void Map(int i, const MultiAdaptiveKernelParam<DType, MPDType>& param,
+    const OpReqType req) {
+    const MPDType scale = MultiGradScale(param);
+    const MPDType gamma1 = param.beta1;
+    for (int index = 0; index < param.count; ++index) {
+      if ((size_t)i < param.sizes[index]) {
+        MPDType w = has_mixed_precision ? param.weights32[index][i] :
+                                          MPDType(param.weights[index][i]);
+        MPDType grad = scale * static_cast<MPDType>(param.grads[index][i])
+                       + MPDType(param.wds[index]) * w;
+        if (param.clip_gradient >= 0.0f) {
+          grad = mshadow_op::clip::Map(grad, MPDType(param.clip_gradient));
+        }
+        const MPDType n = (MPDType(1) - gamma1) * grad * grad + gamma1 * param.var[index][i];
+        param.var[index][i] = n;
+        w = w - MPDType(param.lrs[index]) * grad /
+                mshadow_op::square_root::Map(n + MPDType(param.epsilon));
+        if (param.clip_weights >= 0.0f) {
+          w = mshadow_op::clip::Map(w, MPDType(param.clip_weights));
+        }
+        if (has_mixed_precision) {
+          param.weights32[index][i] = w;
+        }
+        KERNEL_ASSIGN(param.out_data[index][i], req, w);
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Fills the kernel arguments of a multi-tensor adaptive update. Each weight
+ *  comes with input_stride inputs: weight, gradient, num_states optimizer states and,
+ *  with mixed precision, the 32-bit master copy of the weight. With global norm clipping,
+ *  the squared global norm follows as the last input.
+ */
+template<typename xpu,
+         typename DType,
+         typename MPDType,
+         typename ParamType,
+         int input_stride,
+         int num_states>
+MultiAdaptiveKernelParam<DType, MPDType>
+FillMultiAdaptiveKernelParam(const nnvm::NodeAttrs& attrs,
+                             const OpContext &ctx,
+                             const std::vector<TBlob> &inputs,
+                             const std::vector<TBlob> &outputs) {
+  const ParamType& p = nnvm::get<ParamType>(attrs.parsed);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MultiAdaptiveKernelParam<DType, MPDType> param;
+  const int max_weights = MultiAdaptiveKernelParam<DType, MPDType>::N;
+  CHECK_LE(p.num_weights, max_weights)
+    << "Multi-tensor updates support at most " << max_weights << " weights per call";
+  param.rescale_grad = p.rescale_grad;
+  param.clip_gradient = p.clip_gradient;
+  param.clip_weights = -1.0f;
+  param.clip_global_norm = p.clip_global_norm;
+  param.sum_sq = p.clip_global_norm > 0.0f ? inputs.back().dptr<float>() : nullptr;
+  param.count = p.num_weights;
+  param.max_size = 0;
+  for (int i = 0; i < param.count; ++i) {
+    param.sizes[i] = inputs[i * input_stride].shape_.Size();
+    if (param.max_size < param.sizes[i]) {
+      param.max_size = param.sizes[i];
+    }
+    param.weights[i] = inputs[i * input_stride].FlatTo2D<xpu, DType>(s).dptr_;
+    param.grads[i] = inputs[i * input_stride + 1].FlatTo2D<xpu, DType>(s).dptr_;
+    param.mean[i] = num_states > 1 ?
+                    inputs[i * input_stride + 2].FlatTo2D<xpu, MPDType>(s).dptr_ : nullptr;
+    param.var[i] = inputs[i * input_stride + 1 + num_states].FlatTo2D<xpu, MPDType>(s).dptr_;
+    if (!std::is_same<DType, MPDType>::value) {
+      param.weights32[i] = inputs[i * input_stride + input_stride - 1]
+                           .FlatTo2D<xpu, MPDType>(s).dptr_;
+    }
+    param.out_data[i] = outputs[i].FlatTo2D<xpu, DType>(s).dptr_;
+    param.lrs[i] = p.lrs[i];
+    param.wds[i] = p.wds[i];
+  }
+  return param;
+}
+
+template<typename xpu, template<typename> class MPTypeChooser, int input_stride>
+inline void MultiAdamUpdate(const nnvm::NodeAttrs& attrs,
+                            const OpContext &ctx,
+                            const std::vector<TBlob> &inputs,
+                            const std::vector<OpReqType> &req,
+                            const std::vector<TBlob> &outputs) {
+  using namespace mxnet_op;
+  const MultiAdamParam& p = nnvm::get<MultiAdamParam>(attrs.parsed);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    using MPDType = typename MPTypeChooser<DType>::type;
+    MultiAdaptiveKernelParam<DType, MPDType> param =
+      FillMultiAdaptiveKernelParam<xpu,
+                                   DType,
+                                   MPDType,
+                                   MultiAdamParam,
+                                   input_stride,
+                                   2>(attrs, ctx, inputs, outputs);
+    param.beta1 = p.beta1;
+    param.beta2 = p.beta2;
+    param.epsilon = p.epsilon;
+    Kernel<MultiAdamKernel<MPDType,
+                           !std::is_same<DType, MPDType>::value>,
+                           xpu>::Launch(s, param.max_size, param, req[0]);
+  });
+}
+
+template<typename xpu, template<typename> class MPTypeChooser, int input_stride>
+inline void MultiRMSPropUpdate(const nnvm::NodeAttrs& attrs,
+                               const OpContext &ctx,
+                               const std::vector<TBlob> &inputs,
+                               const std::vector<OpReqType> &req,
+                               const std::vector<TBlob> &outputs) {
+  using namespace mxnet_op;
+  const MultiRMSPropParam& p = nnvm::get<MultiRMSPropParam>(attrs.parsed);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    using MPDType = typename MPTypeChooser<DType>::type;
+    MultiAdaptiveKernelParam<DType, MPDType> param =
+      FillMultiAdaptiveKernelParam<xpu,
+                                   DType,
+                                   MPDType,
+                                   MultiRMSPropParam,
+                                   input_stride,
+                                   1>(attrs, ctx, inputs, outputs);
+    param.beta1 = p.gamma1;
+    param.beta2 = 0.0f;
+    param.epsilon = p.epsilon;
+    param.clip_weights = p.clip_weights;
+    Kernel<MultiRMSPropKernel<MPDType,
+                              !std::is_same<DType, MPDType>::value>,
+                              xpu>::Launch(s, param.max_size, param, req[0]);
+  });
+}
+
 struct SGDKernel {
   template<typename DType>
   MSHADOW_XINLINE static void Map(int i, DType* out_data, const DType* weight_data,
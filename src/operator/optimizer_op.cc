@@ -33,6 +33,8 @@ DMLC_REGISTER_PARAMETER(SGDParam);
 DMLC_REGISTER_PARAMETER(SGDMomParam);
 DMLC_REGISTER_PARAMETER(MultiSGDParam);
 DMLC_REGISTER_PARAMETER(MultiSGDMomParam);
+DMLC_REGISTER_PARAMETER(MultiAdamParam);
+DMLC_REGISTER_PARAMETER(MultiRMSPropParam);
 DMLC_REGISTER_PARAMETER(FTMLParam);
 DMLC_REGISTER_PARAMETER(AdamParam);
 DMLC_REGISTER_PARAMETER(RMSPropParam);
@@ -503,6 +505,230 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
 .add_argument("data", "NDArray-or-Symbol[]", "Weights")
 .add_arguments(MultiSGDMomParam::__FIELDS__());
 
+NNVM_REGISTER_OP(multi_adam_update)
+.describe(R"code(Update function for Adam optimizer applied to several weights at once.
+
+For each weight, gradient, mean and var it computes::
+
+ grad = clip(grad * scale * rescale_grad + wd * weight, clip_gradient)
+ mean = beta1 * mean + (1 - beta1) * grad
+ var = beta2 * var + (1 - beta2) * grad^2
+ weight = weight - learning_rate * mean / (sqrt(var) + epsilon)
+
+where ``scale`` is 1, or, if ``clip_global_norm`` is positive,
+``clip_global_norm / max(norm, clip_global_norm)`` with
+``norm = rescale_grad * sqrt(global_norm_sq)``. ``global_norm_sq`` is an extra
+float32 input of shape (1,), after all the others, holding the sum of squares
+of every gradient of the model, not only of the ones passed to this call. The
+caller computes it once per step, so that weights updated in different calls
+are scaled by the same factor. Learning rates are expected to
+already include the bias correction, as for ``adam_update``.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights * 4 +
+                                 MultiHasGlobalNormInput<MultiAdamParam>(attrs));
+  })
+.set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights);
+  })
+.set_attr_parser(ParamParser<MultiAdamParam>)
+.set_attr<nnvm::FInferShape>("FInferShape", MultiAdaptiveShape<MultiAdamParam, 4>)
+.set_attr<nnvm::FInferType>("FInferType",
+                             MultiAdaptiveType<MultiAdamParam, ElemwiseType<-1, -1>>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    uint32_t num_args = dmlc::get<MultiAdamParam>(attrs.parsed).num_weights;
+    std::vector<std::string> ret;
+    for (uint32_t i = 0; i < num_args; ++i) {
+      ret.push_back(std::string("weight_") + std::to_string(i));
+      ret.push_back(std::string("grad_") + std::to_string(i));
+      ret.push_back(std::string("mean_") + std::to_string(i));
+      ret.push_back(std::string("var_") + std::to_string(i));
+    }
+    if (MultiHasGlobalNormInput<MultiAdamParam>(attrs)) {
+      ret.push_back("global_norm_sq");
+    }
+    return ret;
+  })
+.set_attr<nnvm::FMutateInputs>("FMutateInputs",
+  [](const nnvm::NodeAttrs& attrs) {
+    std::vector<uint32_t> ret;
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    for (int i = 0; i < param.num_weights; ++i) {
+      ret.push_back(i * 4 + 2);
+      ret.push_back(i * 4 + 3);
+    }
+    return ret;
+  })
+.set_attr<FCompute>("FCompute<cpu>", MultiAdamUpdate<cpu, type_identity, 4>)
+.add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, means and vars")
+.add_arguments(MultiAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_mp_adam_update)
+.describe(R"code(Multi-precision update function for Adam optimizer applied to several weights.
+
+Same as ``multi_adam_update``, except that every weight comes with a 32-bit
+master copy, and mean and var are 32-bit as well. The update is computed on the
+master copy, which is then cast into the weight.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights * 5 +
+                                 MultiHasGlobalNormInput<MultiAdamParam>(attrs));
+  })
+.set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights);
+  })
+.set_attr_parser(ParamParser<MultiAdamParam>)
+.set_attr<nnvm::FInferShape>("FInferShape", MultiAdaptiveShape<MultiAdamParam, 5>)
+.set_attr<nnvm::FInferType>("FInferType",
+                             MultiAdaptiveType<MultiAdamParam,
+                                               MP_MultiSGD_InferType<MultiAdamParam, 5, 3>>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    uint32_t num_args = dmlc::get<MultiAdamParam>(attrs.parsed).num_weights;
+    std::vector<std::string> ret;
+    for (uint32_t i = 0; i < num_args; ++i) {
+      ret.push_back(std::string("weight_") + std::to_string(i));
+      ret.push_back(std::string("grad_") + std::to_string(i));
+      ret.push_back(std::string("mean_") + std::to_string(i));
+      ret.push_back(std::string("var_") + std::to_string(i));
+      ret.push_back(std::string("weight32_") + std::to_string(i));
+    }
+    if (MultiHasGlobalNormInput<MultiAdamParam>(attrs)) {
+      ret.push_back("global_norm_sq");
+    }
+    return ret;
+  })
+.set_attr<nnvm::FMutateInputs>("FMutateInputs",
+  [](const nnvm::NodeAttrs& attrs) {
+    std::vector<uint32_t> ret;
+    const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+    for (int i = 0; i < param.num_weights; ++i) {
+      ret.push_back(i * 5 + 2);
+      ret.push_back(i * 5 + 3);
+      ret.push_back(i * 5 + 4);
+    }
+    return ret;
+  })
+.set_attr<FCompute>("FCompute<cpu>", MultiAdamUpdate<cpu, single_precision, 5>)
+.add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, means, vars and master copies")
+.add_arguments(MultiAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_rmsprop_update)
+.describe(R"code(Update function for RMSProp optimizer applied to several weights at once.
+
+For each weight, gradient and n it computes::
+
+ grad = clip(grad * scale * rescale_grad + wd * weight, clip_gradient)
+ n = (1 - gamma1) * grad^2 + gamma1 * n
+ weight = clip(weight - learning_rate * grad / sqrt(n + epsilon), clip_weights)
+
+where ``scale`` is 1, or, if ``clip_global_norm`` is positive,
+``clip_global_norm / max(norm, clip_global_norm)`` with
+``norm = rescale_grad * sqrt(global_norm_sq)``. ``global_norm_sq`` is an extra
+float32 input of shape (1,), after all the others, holding the sum of squares
+of every gradient of the model, not only of the ones passed to this call. The
+caller computes it once per step, so that weights updated in different calls
+are scaled by the same factor.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights * 3 +
+                                 MultiHasGlobalNormInput<MultiRMSPropParam>(attrs));
+  })
+.set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights);
+  })
+.set_attr_parser(ParamParser<MultiRMSPropParam>)
+.set_attr<nnvm::FInferShape>("FInferShape", MultiAdaptiveShape<MultiRMSPropParam, 3>)
+.set_attr<nnvm::FInferType>("FInferType",
+                             MultiAdaptiveType<MultiRMSPropParam, ElemwiseType<-1, -1>>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    uint32_t num_args = dmlc::get<MultiRMSPropParam>(attrs.parsed).num_weights;
+    std::vector<std::string> ret;
+    for (uint32_t i = 0; i < num_args; ++i) {
+      ret.push_back(std::string("weight_") + std::to_string(i));
+      ret.push_back(std::string("grad_") + std::to_string(i));
+      ret.push_back(std::string("n_") + std::to_string(i));
+    }
+    if (MultiHasGlobalNormInput<MultiRMSPropParam>(attrs)) {
+      ret.push_back("global_norm_sq");
+    }
+    return ret;
+  })
+.set_attr<nnvm::FMutateInputs>("FMutateInputs",
+  [](const nnvm::NodeAttrs& attrs) {
+    std::vector<uint32_t> ret;
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    for (int i = 0; i < param.num_weights; ++i) {
+      ret.push_back(i * 3 + 2);
+    }
+    return ret;
+  })
+.set_attr<FCompute>("FCompute<cpu>", MultiRMSPropUpdate<cpu, type_identity, 3>)
+.add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and n")
+.add_arguments(MultiRMSPropParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_mp_rmsprop_update)
+.describe(R"code(Multi-precision update function for RMSProp optimizer applied to several weights.
+
+Same as ``multi_rmsprop_update``, except that every weight comes with a 32-bit
+master copy, and n is 32-bit as well. The update is computed on the master copy,
+which is then cast into the weight.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights * 4 +
+                                 MultiHasGlobalNormInput<MultiRMSPropParam>(attrs));
+  })
+.set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    return static_cast<uint32_t>(param.num_weights);
+  })
+.set_attr_parser(ParamParser<MultiRMSPropParam>)
+.set_attr<nnvm::FInferShape>("FInferShape", MultiAdaptiveShape<MultiRMSPropParam, 4>)
+.set_attr<nnvm::FInferType>("FInferType",
+                             MultiAdaptiveType<MultiRMSPropParam,
+                                               MP_MultiSGD_InferType<MultiRMSPropParam, 4, 2>>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    uint32_t num_args = dmlc::get<MultiRMSPropParam>(attrs.parsed).num_weights;
+    std::vector<std::string> ret;
+    for (uint32_t i = 0; i < num_args; ++i) {
+      ret.push_back(std::string("weight_") + std::to_string(i));
+      ret.push_back(std::string("grad_") + std::to_string(i));
+      ret.push_back(std::string("n_") + std::to_string(i));
+      ret.push_back(std::string("weight32_") + std::to_string(i));
+    }
+    if (MultiHasGlobalNormInput<MultiRMSPropParam>(attrs)) {
+      ret.push_back("global_norm_sq");
+    }
+    return ret;
+  })
+.set_attr<nnvm::FMutateInputs>("FMutateInputs",
+  [](const nnvm::NodeAttrs& attrs) {
+    std::vector<uint32_t> ret;
+    const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+    for (int i = 0; i < param.num_weights; ++i) {
+      ret.push_back(i * 4 + 2);
+      ret.push_back(i * 4 + 3);
+    }
+    return ret;
+  })
+.set_attr<FCompute>("FCompute<cpu>", MultiRMSPropUpdate<cpu, single_precision, 4>)
+.add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, n and master copies")
+.add_arguments(MultiRMSPropParam::__FIELDS__());
+
 NNVM_REGISTER_OP(sgd_update)
 MXNET_ADD_SPARSE_OP_ALIAS(sgd_update)
 .describe(R"code(Update function for Stochastic Gradient Descent (SGD) optimizer.
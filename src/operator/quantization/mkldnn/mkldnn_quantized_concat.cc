@@ -85,7 +85,8 @@ static void MKLDNNQuantizedConcatForward(const nnvm::NodeAttrs& attrs, const OpC
       data_md.push_back(pd);
     }
   }
-  MKLDNNConcatFwd& fwd = GetConcatForward(param_.dim, in_data, data_md);
+  auto fwd_ptr = GetConcatForward(param_.dim, in_data, data_md);
+  MKLDNNConcatFwd& fwd = *fwd_ptr;
   mxnet::mkldnn_output_t out_mem =
       CreateMKLDNNMem(out_data[quantized_concat_enum::kOut], fwd.fwd_pd.dst_primitive_desc(),
                       req[concat_enum::kOut]);
@@ -35,6 +35,26 @@ namespace op {
 static const size_t kUint8Range = 255;
 static const size_t kInt8Range = 127;
 
+/*! \brief type switch over the 8 bit types of quantized data */
+#define MXNET_QUANTIZED_TYPE_SWITCH(type, DType, ...)       \
+  switch (type) {                                          \
+  case mshadow::kInt8:                                     \
+    {                                                      \
+      typedef int8_t DType;                                \
+      {__VA_ARGS__}                                        \
+    }                                                      \
+    break;                                                 \
+  case mshadow::kUint8:                                    \
+    {                                                      \
+      typedef uint8_t DType;                               \
+      {__VA_ARGS__}                                        \
+    }                                                      \
+    break;                                                 \
+  default:                                                 \
+    LOG(FATAL) << "Quantized data must be int8 or uint8, " \
+               << "got type enum " << type;                \
+  }
+
 template<typename T>
 MSHADOW_XINLINE int Sign(T val) {
   return (val > T(0)) - (val < T(0));
@@ -105,6 +125,23 @@ struct QuantizedToFloatStruct {
   }
 };
 
+/*!
+ * \brief Get the real value of one quantized level and the quantized value of real zero, so
+ *  that a quantized value q stands for scale * (q + zero). int8 data is zero centered like
+ *  quantize_v2 and dequantize make it, uint8 data spans [range_min, range_max].
+ */
+template<typename T>
+MSHADOW_XINLINE void QuantizedScaleAndZero(float range_min, float range_max,
+                                           float* scale, float* zero) {
+  if (mshadow::red::limits::MinValue<T>() == 0) {
+    *scale = (range_max - range_min) / kUint8Range;
+    *zero = *scale != 0 ? range_min / *scale : 0;
+  } else {
+    *scale = MaxAbs(range_min, range_max) / kInt8Range;
+    *zero = 0;
+  }
+}
+
 template <class T1, class T2>
 MSHADOW_XINLINE T2 RequantizeInNewRange(T1 input, float min_input, float max_input,
                                         float min_new, float max_new) {
@@ -92,12 +92,15 @@ std::vector<NodeEntry> OfflineParams(std::vector<NodeEntry>&& outputs,
 inline bool NeedQuantize(const NodePtr node,
                          const std::unordered_set<std::string>& excluded_nodes) {
   static auto& quantized_op_map = Op::GetAttr<mxnet::FQuantizedOp>("FQuantizedOp");
+  static auto& quantizable_map = Op::GetAttr<mxnet::FQuantizable>("FQuantizable");
   static auto& fexec_type = nnvm::Op::GetAttr<FExecType>("FExecType");
   const auto& op = node->op();
   if (op && quantized_op_map.count(op)) {
     bool need = true;
     if (excluded_nodes.count(node->attrs.name)) {
       need = false;
+    } else if (quantizable_map.count(op) && !quantizable_map[op](node->attrs)) {
+      need = false;
     } else if (!node->attrs.subgraphs.empty()) {
       ExecType exec_type = fexec_type.count(op) ? fexec_type[op](node->attrs) : ExecType::kSync;
       if (exec_type != ExecType::kSubgraphExec) {
@@ -296,10 +299,16 @@ Graph QuantizeGraph(Graph &&src) {
     if (NeedQuantize(e.node, excluded_nodes)) {
       // Only insert dequantize for those Ops supports quantize and not excluded.
       NodePtr mirror_node = mirror_map.at(e.node.get());
+      if (mirror_node->op() == Op::Get("_contrib_dequantize")) {
+        // the output is also read by a non-quantized node, which already dequantized it
+        outputs.emplace_back(NodeEntry{mirror_node, 0, 0});
+        continue;
+      }
       NodeEntry mirror_entry = NodeEntry{mirror_node, e.index, e.version};
-      size_t num_inputs = e.node->num_inputs();
-      uint32_t min_index = num_inputs + 2 * e.index;
-      uint32_t max_index = num_inputs + 2 * e.index + 1;
+      // same assumption of a single min and max output as above
+      size_t num_outputs = mirror_node->num_outputs() - 2;
+      uint32_t min_index = num_outputs + 2 * e.index;
+      uint32_t max_index = num_outputs + 2 * e.index + 1;
 
       NodePtr dequantize_node = CreateNode("_contrib_dequantize",
           e.node->attrs.name + "_dequantize");
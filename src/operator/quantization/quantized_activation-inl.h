@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_activation-inl.h
+ * \brief relu of int8 and uint8 data
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ACTIVATION_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ACTIVATION_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../nn/activation-inl.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace quantized_act {
+enum QuantizedActOpResource {kTempSpace};
+}
+
+// find the quantized value closest to real zero, the range of the output is the input's
+template<typename DType>
+struct QuantizedReluRangeKernel {
+  MSHADOW_XINLINE static void Map(int i, float *lower, float *omin_range, float *omax_range,
+                                  const float *imin_range, const float *imax_range) {
+    using mshadow::red::limits::MinValue;
+    using mshadow::red::limits::MaxValue;
+    float scale, zero;
+    QuantizedScaleAndZero<DType>(*imin_range, *imax_range, &scale, &zero);
+    *lower = Min(Max(floorf(0.5f - zero), static_cast<float>(MinValue<DType>())),
+                 static_cast<float>(MaxValue<DType>()));
+    *omin_range = *imin_range;
+    *omax_range = *imax_range;
+  }
+};
+
+struct QuantizedReluKernel {
+  template<typename DType>
+  MSHADOW_XINLINE static void Map(int i, DType *out, const DType *in, const float *lower) {
+    const DType zero = static_cast<DType>(*lower);
+    out[i] = in[i] > zero ? in[i] : zero;
+  }
+};
+
+template<typename xpu>
+void QuantizedActivationForward(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 3U);
+  const ActivationParam& param = nnvm::get<ActivationParam>(attrs.parsed);
+  CHECK_EQ(param.act_type, activation::kReLU)
+    << "quantized_act only supports act_type=relu for now";
+  Stream<xpu> *s = ctx.get_stream<xpu>();
+  Tensor<xpu, 1, float> lower =
+    ctx.requested[quantized_act::kTempSpace].get_space_typed<xpu, 1, float>(Shape1(1), s);
+  MXNET_QUANTIZED_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<QuantizedReluRangeKernel<DType>, xpu>::Launch(s, 1, lower.dptr_,
+        outputs[1].dptr<float>(), outputs[2].dptr<float>(),
+        inputs[1].dptr<float>(), inputs[2].dptr<float>());
+    Kernel<QuantizedReluKernel, xpu>::Launch(s, outputs[0].Size(), outputs[0].dptr<DType>(),
+                                             inputs[0].dptr<DType>(), lower.dptr_);
+  });
+}
+
+inline bool QuantizedActivationShape(const nnvm::NodeAttrs& attrs,
+                                     std::vector<TShape> *in_attrs,
+                                     std::vector<TShape> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, (*in_attrs)[0]);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, (*out_attrs)[0]);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*in_attrs, 2, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 2, TShape{1});
+  return !shape_is_none((*in_attrs)[0]);
+}
+
+inline bool QuantizedActivationType(const nnvm::NodeAttrs& attrs,
+                                    std::vector<int> *in_attrs,
+                                    std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  const int dtype = (*in_attrs)[0];
+  CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+    << "quantized_act only supports int8 and uint8 as input type";
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, dtype);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return dtype != -1;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ACTIVATION_INL_H_
@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_batch_dot-inl.h
+ * \brief batch_dot of int8 and uint8 data, accumulating in int32
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_BATCH_DOT_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_BATCH_DOT_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../tensor/dot-inl.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace quantized_batch_dot {
+enum QuantizedBatchDotOpInputs {kLhs, kRhs, kLhsMin, kLhsMax, kRhsMin, kRhsMax};
+enum QuantizedBatchDotOpResource {kTempSpace};
+}
+
+/*! \brief quantized zeros of both inputs and the output shift, kept in temporary space */
+struct QuantizedBatchDotParams {
+  int64_t lhs_zero;
+  int64_t rhs_zero;
+  int64_t shift;
+};
+
+/*!
+ * \brief Rounds the quantized zero of each input. The int32 output takes the product of the
+ *  input scales as its level, like quantized_fully_connected, times the smallest power of
+ *  two 2^shift for which the largest possible sum of k products, (q + zero) for every
+ *  input, still fits into int32. The shift is only nonzero for uint8 data whose range
+ *  lies far from zero.
+ */
+template<typename LType, typename RType>
+struct QuantizedBatchDotRangeKernel {
+  MSHADOW_XINLINE static void Map(int i, QuantizedBatchDotParams *params,
+                                  float *omin_range, float *omax_range,
+                                  const float *lhs_min, const float *lhs_max,
+                                  const float *rhs_min, const float *rhs_max, const int k) {
+    using mshadow::red::limits::MinValue;
+    using mshadow::red::limits::MaxValue;
+    float lhs_scale, rhs_scale, lhs_zero, rhs_zero;
+    QuantizedScaleAndZero<LType>(*lhs_min, *lhs_max, &lhs_scale, &lhs_zero);
+    QuantizedScaleAndZero<RType>(*rhs_min, *rhs_max, &rhs_scale, &rhs_zero);
+    params->lhs_zero = static_cast<int64_t>(floorf(lhs_zero + 0.5f));
+    params->rhs_zero = static_cast<int64_t>(floorf(rhs_zero + 0.5f));
+    const double lhs_low = static_cast<double>(MinValue<LType>() + params->lhs_zero);
+    const double lhs_high = static_cast<double>(MaxValue<LType>() + params->lhs_zero);
+    const double rhs_low = static_cast<double>(MinValue<RType>() + params->rhs_zero);
+    const double rhs_high = static_cast<double>(MaxValue<RType>() + params->rhs_zero);
+    double bound = fmax(fabs(lhs_low), fabs(lhs_high)) * fmax(fabs(rhs_low), fabs(rhs_high)) * k;
+    float level = lhs_scale * rhs_scale;
+    params->shift = 0;
+    while (bound > MaxValue<int32_t>()) {
+      bound /= 2;
+      level *= 2;
+      ++params->shift;
+    }
+    *omax_range = level * MaxValue<int32_t>();
+    *omin_range = -*omax_range;
+  }
+};
+
+/*!
+ * \brief Copies every matrix of src into row major (rows, cols) matrices of dst, and sums
+ *  each row of dst into row_sums. The matrices of src are stored as (cols, rows) if
+ *  transposed.
+ */
+struct QuantizedBatchDotPackKernel {
+  template<typename DType>
+  MSHADOW_XINLINE static void Map(int br, DType *dst, int32_t *row_sums, const DType *src,
+                                  const int rows, const int cols, const bool transposed) {
+    const int r = br % rows;
+    const int offset = (br - r) * cols;
+    int32_t sum = 0;
+    for (int c = 0; c < cols; ++c) {
+      const DType value = transposed ? src[offset + c * rows + r] : src[offset + r * cols + c];
+      dst[static_cast<size_t>(br) * cols + c] = value;
+      sum += value;
+    }
+    row_sums[br] = sum;
+  }
+};
+
+/*!
+ * \brief Sums the products of the raw 8-bit values in int32, in blocks short enough not to
+ *  overflow, and then adds the terms of the zeros:
+ *  sum (l + zl) (r + zr) = sum l r + zr sum l + zl sum r + k zl zr
+ */
+struct QuantizedBatchDotKernel {
+  /*! \brief number of products of two 8-bit values that always fit into int32 */
+  static const int kBlock = 32768;
+
+  template<typename LType, typename RType>
+  MSHADOW_XINLINE static void Map(int i, int32_t *out, const LType *lhs, const RType *rhs,
+                                  const int32_t *lhs_sums, const int32_t *rhs_sums,
+                                  const QuantizedBatchDotParams *params,
+                                  const int m, const int n, const int k) {
+    using mshadow::red::limits::MaxValue;
+    const int j = i % n;
+    const int bi = i / n;
+    const int bj = (bi / m) * n + j;
+    const LType *lhs_row = lhs + static_cast<size_t>(bi) * k;
+    const RType *rhs_row = rhs + static_cast<size_t>(bj) * k;
+    int64_t total = 0;
+    for (int p0 = 0; p0 < k; p0 += kBlock) {
+      const int p1 = p0 + kBlock < k ? p0 + kBlock : k;
+      int32_t sum = 0;
+      for (int p = p0; p < p1; ++p) {
+        sum += static_cast<int32_t>(lhs_row[p]) * static_cast<int32_t>(rhs_row[p]);
+      }
+      total += sum;
+    }
+    total += params->rhs_zero * lhs_sums[bi] + params->lhs_zero * rhs_sums[bj] +
+             params->lhs_zero * params->rhs_zero * k;
+    if (params->shift > 0) {
+      total = (total + (int64_t(1) << (params->shift - 1))) >> params->shift;
+    }
+    total = total < MaxValue<int32_t>() ? total : MaxValue<int32_t>();
+    total = total > -MaxValue<int32_t>() ? total : -MaxValue<int32_t>();
+    out[i] = static_cast<int32_t>(total);
+  }
+};
+
+/*!
+ * The inputs are packed into lhs (M, K) and the transpose of rhs (N, K) in their own 8-bit
+ * type, so that every output is a contiguous dot product over K, which vectorizes. The
+ * zeros of uint8 data are applied to the int32 sums through the row sums of the packed
+ * inputs, instead of to every element.
+ */
+template<typename xpu>
+void QuantizedBatchDotForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace quantized_batch_dot;
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 3U);
+  const DotParam& param = nnvm::get<DotParam>(attrs.parsed);
+  Stream<xpu> *s = ctx.get_stream<xpu>();
+  const TShape& oshape = outputs[0].shape_;
+  const int batch_size = oshape[0], m = oshape[1], n = oshape[2];
+  const int k = param.transpose_a ? inputs[kLhs].shape_[1] : inputs[kLhs].shape_[2];
+  const size_t lhs_rows = static_cast<size_t>(batch_size) * m;
+  const size_t rhs_rows = static_cast<size_t>(batch_size) * n;
+  const size_t sums_bytes = (lhs_rows + rhs_rows) * sizeof(int32_t);
+  Tensor<xpu, 1, char> workspace = ctx.requested[kTempSpace].get_space_typed<xpu, 1, char>(
+      Shape1(sizeof(QuantizedBatchDotParams) + sums_bytes + (lhs_rows + rhs_rows) * k), s);
+  QuantizedBatchDotParams *params = reinterpret_cast<QuantizedBatchDotParams*>(workspace.dptr_);
+  int32_t *lhs_sums = reinterpret_cast<int32_t*>(params + 1);
+  int32_t *rhs_sums = lhs_sums + lhs_rows;
+  char *packed = workspace.dptr_ + sizeof(QuantizedBatchDotParams) + sums_bytes;
+  MXNET_QUANTIZED_TYPE_SWITCH(inputs[kLhs].type_flag_, LType, {
+    MXNET_QUANTIZED_TYPE_SWITCH(inputs[kRhs].type_flag_, RType, {
+      LType *packed_lhs = reinterpret_cast<LType*>(packed);
+      RType *packed_rhs = reinterpret_cast<RType*>(packed + lhs_rows * k);
+      Kernel<QuantizedBatchDotRangeKernel<LType, RType>, xpu>::Launch(s, 1, params,
+          outputs[1].dptr<float>(), outputs[2].dptr<float>(),
+          inputs[kLhsMin].dptr<float>(), inputs[kLhsMax].dptr<float>(),
+          inputs[kRhsMin].dptr<float>(), inputs[kRhsMax].dptr<float>(), k);
+      Kernel<QuantizedBatchDotPackKernel, xpu>::Launch(s, lhs_rows, packed_lhs, lhs_sums,
+          inputs[kLhs].dptr<LType>(), m, k, param.transpose_a);
+      Kernel<QuantizedBatchDotPackKernel, xpu>::Launch(s, rhs_rows, packed_rhs, rhs_sums,
+          inputs[kRhs].dptr<RType>(), n, k, !param.transpose_b);
+      Kernel<QuantizedBatchDotKernel, xpu>::Launch(s, outputs[0].Size(),
+          outputs[0].dptr<int32_t>(), packed_lhs, packed_rhs, lhs_sums, rhs_sums, params,
+          m, n, k);
+    });
+  });
+}
+
+inline bool QuantizedBatchDotShape(const nnvm::NodeAttrs& attrs,
+                                   std::vector<TShape> *in_attrs,
+                                   std::vector<TShape> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  if (shape_is_none((*in_attrs)[0]) || shape_is_none((*in_attrs)[1])) return false;
+  std::vector<TShape> data_shapes(in_attrs->begin(), in_attrs->begin() + 2);
+  std::vector<TShape> out_shapes(1, (*out_attrs)[0]);
+  BatchDotShape(attrs, &data_shapes, &out_shapes);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, out_shapes[0]);
+  for (size_t i = 2; i < 6; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, i, TShape{1});
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 2, TShape{1});
+  return true;
+}
+
+inline bool QuantizedBatchDotType(const nnvm::NodeAttrs& attrs,
+                                  std::vector<int> *in_attrs,
+                                  std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  for (size_t i = 0; i < 2; ++i) {
+    const int dtype = (*in_attrs)[i];
+    CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+      << "quantized_batch_dot only supports int8 and uint8 as input type";
+  }
+  for (size_t i = 2; i < 6; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return (*in_attrs)[0] != -1 && (*in_attrs)[1] != -1;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_BATCH_DOT_INL_H_
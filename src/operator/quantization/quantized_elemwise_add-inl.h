@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_elemwise_add-inl.h
+ * \brief elemwise_add of int8 and uint8 data, accumulating in int32
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ELEMWISE_ADD_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ELEMWISE_ADD_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+namespace quantized_elemwise_add {
+enum QuantizedElemwiseAddOpInputs {kLhs, kRhs, kLhsMin, kLhsMax, kRhsMin, kRhsMax};
+enum QuantizedElemwiseAddOpResource {kTempSpace};
+}
+
+/*!
+ * \brief The int32 output spans the sum of the real ranges of the inputs, which holds
+ *  every sum. params receives the scale of each input in levels of the output and the
+ *  shift of their zeros.
+ */
+template<typename LType, typename RType>
+struct QuantizedElemwiseAddRangeKernel {
+  MSHADOW_XINLINE static void Map(int i, float *params, float *omin_range, float *omax_range,
+                                  const float *lhs_min, const float *lhs_max,
+                                  const float *rhs_min, const float *rhs_max) {
+    using mshadow::red::limits::MaxValue;
+    const float out_range = MaxAbs(*lhs_min, *lhs_max) + MaxAbs(*rhs_min, *rhs_max);
+    const float out_scale = out_range / MaxValue<int32_t>();
+    float lhs_scale, lhs_zero, rhs_scale, rhs_zero;
+    QuantizedScaleAndZero<LType>(*lhs_min, *lhs_max, &lhs_scale, &lhs_zero);
+    QuantizedScaleAndZero<RType>(*rhs_min, *rhs_max, &rhs_scale, &rhs_zero);
+    if (out_scale != 0) {
+      lhs_scale /= out_scale;
+      rhs_scale /= out_scale;
+    }
+    params[0] = lhs_scale;
+    params[1] = rhs_scale;
+    params[2] = lhs_zero * lhs_scale + rhs_zero * rhs_scale;
+    *omin_range = -out_range;
+    *omax_range = out_range;
+  }
+};
+
+struct QuantizedElemwiseAddKernel {
+  template<typename LType, typename RType>
+  MSHADOW_XINLINE static void Map(int i, int32_t *out, const LType *lhs, const RType *rhs,
+                                  const float *params) {
+    // largest float below 2^31, so that rounding can not overflow int32
+    const float bound = 2147483520.0f;
+    float sum = lhs[i] * params[0] + rhs[i] * params[1] + params[2];
+    sum = sum < 0 ? sum - 0.5f : sum + 0.5f;
+    out[i] = static_cast<int32_t>(Max(Min(sum, bound), -bound));
+  }
+};
+
+template<typename xpu>
+void QuantizedElemwiseAddForward(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace quantized_elemwise_add;
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 3U);
+  Stream<xpu> *s = ctx.get_stream<xpu>();
+  Tensor<xpu, 1, float> params =
+    ctx.requested[kTempSpace].get_space_typed<xpu, 1, float>(Shape1(3), s);
+  MXNET_QUANTIZED_TYPE_SWITCH(inputs[kLhs].type_flag_, LType, {
+    MXNET_QUANTIZED_TYPE_SWITCH(inputs[kRhs].type_flag_, RType, {
+      Kernel<QuantizedElemwiseAddRangeKernel<LType, RType>, xpu>::Launch(s, 1, params.dptr_,
+          outputs[1].dptr<float>(), outputs[2].dptr<float>(),
+          inputs[kLhsMin].dptr<float>(), inputs[kLhsMax].dptr<float>(),
+          inputs[kRhsMin].dptr<float>(), inputs[kRhsMax].dptr<float>());
+      Kernel<QuantizedElemwiseAddKernel, xpu>::Launch(s, outputs[0].Size(),
+          outputs[0].dptr<int32_t>(), inputs[kLhs].dptr<LType>(), inputs[kRhs].dptr<RType>(),
+          params.dptr_);
+    });
+  });
+}
+
+inline bool QuantizedElemwiseAddShape(const nnvm::NodeAttrs& attrs,
+                                      std::vector<TShape> *in_attrs,
+                                      std::vector<TShape> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  for (size_t i = 0; i < 2; ++i) {
+    SHAPE_ASSIGN_CHECK(*out_attrs, 0, (*in_attrs)[i]);
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, i, (*out_attrs)[0]);
+  }
+  for (size_t i = 2; i < 6; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, i, TShape{1});
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 2, TShape{1});
+  return !shape_is_none((*out_attrs)[0]);
+}
+
+inline bool QuantizedElemwiseAddType(const nnvm::NodeAttrs& attrs,
+                                     std::vector<int> *in_attrs,
+                                     std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  for (size_t i = 0; i < 2; ++i) {
+    const int dtype = (*in_attrs)[i];
+    CHECK(dtype == -1 || dtype == mshadow::kInt8 || dtype == mshadow::kUint8)
+      << "quantized_elemwise_add only supports int8 and uint8 as input type";
+  }
+  for (size_t i = 2; i < 6; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return (*in_attrs)[0] != -1 && (*in_attrs)[1] != -1;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_QUANTIZATION_QUANTIZED_ELEMWISE_ADD_INL_H_
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pointwise_fusion-inl.h
+ * \brief subgraph of elementwise and broadcast operators executed as one fused CPU loop
+ */
+#ifndef MXNET_OPERATOR_SUBGRAPH_POINTWISE_POINTWISE_FUSION_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_POINTWISE_POINTWISE_FUSION_INL_H_
+
+#include <mshadow/base.h>
+#include <nnvm/node.h>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+/*! \brief Operations a fused pointwise subgraph is made of */
+enum class PointwiseOp : int {
+  // tensor, tensor
+  kAdd, kSub, kMul, kDiv, kMaximum, kMinimum, kPower,
+  // tensor, scalar
+  kAddScalar, kSubScalar, kRSubScalar, kMulScalar, kDivScalar, kRDivScalar,
+  kMaximumScalar, kMinimumScalar, kPowerScalar, kRPowerScalar,
+  // tensor
+  kIdentity, kNegative, kReLU, kSigmoid, kTanh, kSoftReLU, kSoftSign,
+  kExp, kLog, kSqrt, kRSqrt, kSquare, kAbs, kErf, kReciprocal
+};
+
+inline bool IsBinaryPointwiseOp(const PointwiseOp op) {
+  return op <= PointwiseOp::kPower;
+}
+
+/*! \brief One operator of the subgraph, reading and writing registers */
+struct PointwiseInstr {
+  PointwiseOp op;
+  /*! \brief register of the first operand */
+  int lhs;
+  /*! \brief register of the second operand, -1 for unary and scalar operations */
+  int rhs;
+  /*! \brief scalar operand of scalar operations */
+  double scalar;
+  /*! \brief attributes of the original operator, to run it unfused */
+  nnvm::NodeAttrs attrs;
+};
+
+/*!
+ * \brief Straight-line program of a fused pointwise subgraph. Registers
+ *  [0, num_inputs) hold the inputs of the subgraph, register num_inputs + k holds
+ *  the result of instrs[k].
+ */
+struct PointwiseProgram {
+  uint32_t num_inputs;
+  std::vector<PointwiseInstr> instrs;
+  /*! \brief register of each output of the subgraph */
+  std::vector<int> outputs;
+};
+
+/*!
+ * \brief Returns whether the operator of attrs can be part of a fused pointwise
+ *  subgraph, and if so its operation and scalar operand.
+ */
+bool GetPointwiseOp(const nnvm::NodeAttrs &attrs, PointwiseOp *op, double *scalar);
+
+/*!
+ * \brief Whether the fused loop supports elements of type dtype. Subgraphs of other types
+ *  run their operators one after the other.
+ */
+inline bool IsPointwiseFusionType(const int dtype) {
+  return dtype == mshadow::kFloat32 || dtype == mshadow::kFloat64 ||
+         dtype == mshadow::kFloat16;
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_POINTWISE_POINTWISE_FUSION_INL_H_
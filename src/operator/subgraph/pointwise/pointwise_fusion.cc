@@ -0,0 +1,514 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pointwise_fusion.cc
+ * \brief subgraph of elementwise and broadcast operators executed as one fused CPU loop
+ *
+ *  The subgraph is compiled into a straight-line program when the node is created. The
+ *  iteration space of the outputs is cut into blocks of kPointwiseBlock elements, and every
+ *  instruction of the program runs over a whole block before the next one, so that all
+ *  intermediate results of a block stay in a per-thread scratch buffer that fits in L1
+ *  and only the inputs and outputs of the subgraph go through memory.
+ */
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./pointwise_fusion-inl.h"
+#include "../common.h"
+#include "../../mshadow_op.h"
+#include "../../mxnet_op.h"
+#include "../../nn/activation-inl.h"
+#include "../../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+namespace {
+
+/*! \brief number of elements each instruction processes at once */
+const index_t kPointwiseBlock = 512;
+
+template<typename OP, typename DType>
+inline void ApplyBinary(DType *out, const DType *lhs, const DType *rhs, const index_t n) {
+  MXNET_PRAGMA_SIMD
+  for (index_t j = 0; j < n; ++j) {
+    out[j] = OP::Map(lhs[j], rhs[j]);
+  }
+}
+
+template<typename OP, typename DType>
+inline void ApplyScalar(DType *out, const DType *in, const DType scalar, const index_t n) {
+  MXNET_PRAGMA_SIMD
+  for (index_t j = 0; j < n; ++j) {
+    out[j] = OP::Map(in[j], scalar);
+  }
+}
+
+template<typename OP, typename DType>
+inline void ApplyUnary(DType *out, const DType *in, const index_t n) {
+  MXNET_PRAGMA_SIMD
+  for (index_t j = 0; j < n; ++j) {
+    out[j] = OP::Map(in[j]);
+  }
+}
+
+template<typename DType>
+void Execute(const PointwiseInstr &instr, DType *out, const DType *lhs, const DType *rhs,
+             const index_t n) {
+  const DType s = static_cast<DType>(instr.scalar);
+  switch (instr.op) {
+    case PointwiseOp::kAdd:           ApplyBinary<mshadow_op::plus>(out, lhs, rhs, n); break;
+    case PointwiseOp::kSub:           ApplyBinary<mshadow_op::minus>(out, lhs, rhs, n); break;
+    case PointwiseOp::kMul:           ApplyBinary<mshadow_op::mul>(out, lhs, rhs, n); break;
+    case PointwiseOp::kDiv:           ApplyBinary<mshadow_op::div>(out, lhs, rhs, n); break;
+    case PointwiseOp::kMaximum:       ApplyBinary<mshadow_op::maximum>(out, lhs, rhs, n); break;
+    case PointwiseOp::kMinimum:       ApplyBinary<mshadow_op::minimum>(out, lhs, rhs, n); break;
+    case PointwiseOp::kPower:         ApplyBinary<mshadow_op::power>(out, lhs, rhs, n); break;
+    case PointwiseOp::kAddScalar:     ApplyScalar<mshadow_op::plus>(out, lhs, s, n); break;
+    case PointwiseOp::kSubScalar:     ApplyScalar<mshadow_op::minus>(out, lhs, s, n); break;
+    case PointwiseOp::kRSubScalar:    ApplyScalar<mshadow_op::rminus>(out, lhs, s, n); break;
+    case PointwiseOp::kMulScalar:     ApplyScalar<mshadow_op::mul>(out, lhs, s, n); break;
+    case PointwiseOp::kDivScalar:     ApplyScalar<mshadow_op::div>(out, lhs, s, n); break;
+    case PointwiseOp::kRDivScalar:    ApplyScalar<mshadow_op::rdiv>(out, lhs, s, n); break;
+    case PointwiseOp::kMaximumScalar: ApplyScalar<mshadow_op::maximum>(out, lhs, s, n); break;
+    case PointwiseOp::kMinimumScalar: ApplyScalar<mshadow_op::minimum>(out, lhs, s, n); break;
+    case PointwiseOp::kPowerScalar:   ApplyScalar<mshadow_op::power>(out, lhs, s, n); break;
+    case PointwiseOp::kRPowerScalar:  ApplyScalar<mshadow_op::rpower>(out, lhs, s, n); break;
+    case PointwiseOp::kIdentity:      ApplyUnary<mshadow_op::identity>(out, lhs, n); break;
+    case PointwiseOp::kNegative:      ApplyUnary<mshadow_op::negation>(out, lhs, n); break;
+    case PointwiseOp::kReLU:          ApplyUnary<mshadow_op::relu>(out, lhs, n); break;
+    case PointwiseOp::kSigmoid:       ApplyUnary<mshadow_op::sigmoid>(out, lhs, n); break;
+    case PointwiseOp::kTanh:          ApplyUnary<mshadow_op::tanh>(out, lhs, n); break;
+    case PointwiseOp::kSoftReLU:      ApplyUnary<mshadow_op::softrelu>(out, lhs, n); break;
+    case PointwiseOp::kSoftSign:      ApplyUnary<mshadow_op::softsign>(out, lhs, n); break;
+    case PointwiseOp::kExp:           ApplyUnary<mshadow_op::exp>(out, lhs, n); break;
+    case PointwiseOp::kLog:           ApplyUnary<mshadow_op::log>(out, lhs, n); break;
+    case PointwiseOp::kSqrt:          ApplyUnary<mshadow_op::square_root>(out, lhs, n); break;
+    case PointwiseOp::kRSqrt:
+      ApplyUnary<mshadow_op::reciprocal_square_root>(out, lhs, n);
+      break;
+    case PointwiseOp::kSquare:        ApplyUnary<mshadow_op::square>(out, lhs, n); break;
+    case PointwiseOp::kAbs:           ApplyUnary<mshadow_op::abs>(out, lhs, n); break;
+    case PointwiseOp::kErf:           ApplyUnary<mshadow_op::erf>(out, lhs, n); break;
+    case PointwiseOp::kReciprocal:    ApplyUnary<mshadow_op::reciprocal>(out, lhs, n); break;
+    default:
+      LOG(FATAL) << "Unknown pointwise operation " << static_cast<int>(instr.op);
+  }
+}
+
+/*!
+ * \brief Reads the elements of an input that correspond to a block of the flat
+ *  iteration space of an output, following the broadcasting rules.
+ */
+class InputIndexer {
+ public:
+  InputIndexer(const TShape &ishape, const TShape &oshape) {
+    if (ishape.Size() == oshape.Size()) {
+      mode_ = kContiguous;
+      return;
+    }
+    if (ishape.Size() == 1) {
+      mode_ = kScalar;
+      return;
+    }
+    CHECK_LE(ishape.ndim(), oshape.ndim()) << "Input of shape " << ishape
+      << " cannot be broadcast to " << oshape;
+    // right-align the input shape to the output shape
+    const int ndim = oshape.ndim();
+    const int offset = ndim - ishape.ndim();
+    std::vector<index_t> ipad(ndim, 1);
+    int first = ndim, last = -1;
+    for (int d = 0; d < ndim; ++d) {
+      if (d >= offset) ipad[d] = ishape[d - offset];
+      CHECK(ipad[d] == oshape[d] || ipad[d] == 1) << "Input of shape " << ishape
+        << " cannot be broadcast to " << oshape;
+      if (ipad[d] != 1) {
+        first = std::min(first, d);
+        last = d;
+      }
+    }
+    bool dense_span = true;
+    for (int d = first; d <= last; ++d) dense_span = dense_span && ipad[d] == oshape[d];
+    if (dense_span) {
+      // the input is a contiguous slab repeated along leading and trailing dimensions,
+      // ie a bias of shape (C,) or (1, C, 1, 1), or a per-row statistic of shape (N, 1)
+      mode_ = kInnerOuter;
+      inner_ = 1;
+      mid_ = 1;
+      for (int d = last + 1; d < ndim; ++d) inner_ *= oshape[d];
+      for (int d = first; d <= last; ++d) mid_ *= oshape[d];
+      return;
+    }
+    mode_ = kGeneral;
+    oshape_.assign(oshape.begin(), oshape.end());
+    istride_.assign(ndim, 0);
+    index_t stride = 1;
+    for (int d = ndim - 1; d >= 0; --d) {
+      if (ipad[d] != 1) istride_[d] = stride;
+      stride *= ipad[d];
+    }
+  }
+
+  /*!
+   * \brief Elements [begin, begin + n) of the iteration space, either read in place
+   *  or gathered into buf.
+   */
+  template<typename DType>
+  const DType *Read(const DType *in, const index_t begin, const index_t n, DType *buf) const {
+    switch (mode_) {
+      case kContiguous:
+        return in + begin;
+      case kScalar:
+        std::fill(buf, buf + n, in[0]);
+        return buf;
+      case kInnerOuter: {
+        index_t pos = (begin / inner_) % mid_;
+        index_t r = begin % inner_;
+        for (index_t j = 0; j < n; ++j) {
+          buf[j] = in[pos];
+          if (++r == inner_) {
+            r = 0;
+            if (++pos == mid_) pos = 0;
+          }
+        }
+        return buf;
+      }
+      default: {
+        for (index_t j = 0; j < n; ++j) {
+          index_t idx = begin + j, offset = 0;
+          for (int d = static_cast<int>(oshape_.size()) - 1; d >= 0; --d) {
+            offset += (idx % oshape_[d]) * istride_[d];
+            idx /= oshape_[d];
+          }
+          buf[j] = in[offset];
+        }
+        return buf;
+      }
+    }
+  }
+
+ private:
+  enum Mode {kContiguous, kScalar, kInnerOuter, kGeneral};
+  Mode mode_;
+  index_t inner_;
+  index_t mid_;
+  std::vector<index_t> oshape_;
+  std::vector<index_t> istride_;
+};
+
+/*!
+ * \brief Runs the instructions needed by the outputs in group over the iteration space of
+ *  shape, which is the shape of all these outputs.
+ */
+template<typename DType>
+void RunPointwiseGroup(const PointwiseProgram &prog, const OpContext &ctx,
+                       const std::vector<TBlob> &inputs, const std::vector<OpReqType> &req,
+                       const std::vector<TBlob> &outputs, const std::vector<size_t> &group,
+                       const TShape &shape) {
+  const size_t num_regs = prog.num_inputs + prog.instrs.size();
+  std::vector<bool> needed(num_regs, false);
+  for (const size_t o : group) needed[prog.outputs[o]] = true;
+  for (size_t k = prog.instrs.size(); k-- > 0;) {
+    if (!needed[prog.num_inputs + k]) continue;
+    needed[prog.instrs[k].lhs] = true;
+    if (prog.instrs[k].rhs >= 0) needed[prog.instrs[k].rhs] = true;
+  }
+  // inputs the group does not read may not broadcast to its shape
+  std::vector<std::unique_ptr<InputIndexer> > indexers(prog.num_inputs);
+  for (uint32_t i = 0; i < prog.num_inputs; ++i) {
+    if (needed[i]) indexers[i].reset(new InputIndexer(inputs[i].shape_, shape));
+  }
+
+  const index_t size = shape.Size();
+  const index_t num_blocks = (size + kPointwiseBlock - 1) / kPointwiseBlock;
+  const int omp_threads = std::max(1, std::min<int>(
+      engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), num_blocks));
+  mshadow::Stream<cpu> *s = ctx.get_stream<cpu>();
+  const index_t scratch_size = static_cast<index_t>(num_regs) * kPointwiseBlock;
+  DType *scratch = ctx.requested[0].get_space_typed<cpu, 1, DType>(
+      mshadow::Shape1(scratch_size * omp_threads), s).dptr_;
+
+  #pragma omp parallel num_threads(omp_threads)
+  {
+    DType *buf = scratch + scratch_size * omp_get_thread_num();
+    std::vector<const DType *> regs(num_regs, nullptr);
+    #pragma omp for
+    for (index_t b = 0; b < num_blocks; ++b) {
+      const index_t begin = b * kPointwiseBlock;
+      const index_t n = std::min(kPointwiseBlock, size - begin);
+      for (uint32_t i = 0; i < prog.num_inputs; ++i) {
+        if (!needed[i]) continue;
+        regs[i] = indexers[i]->Read(inputs[i].dptr<DType>(), begin, n,
+                                   buf + i * kPointwiseBlock);
+      }
+      for (size_t k = 0; k < prog.instrs.size(); ++k) {
+        const size_t r = prog.num_inputs + k;
+        if (!needed[r]) continue;
+        const PointwiseInstr &instr = prog.instrs[k];
+        DType *out = buf + r * kPointwiseBlock;
+        Execute(instr, out, regs[instr.lhs], instr.rhs >= 0 ? regs[instr.rhs] : nullptr, n);
+        regs[r] = out;
+      }
+      for (const size_t o : group) {
+        const DType *src = regs[prog.outputs[o]];
+        DType *dst = outputs[o].dptr<DType>() + begin;
+        switch (req[o]) {
+          case kNullOp:
+            break;
+          case kWriteTo:
+          case kWriteInplace:
+            std::copy(src, src + n, dst);
+            break;
+          case kAddTo:
+            MXNET_PRAGMA_SIMD
+            for (index_t j = 0; j < n; ++j) {
+              dst[j] += src[j];
+            }
+            break;
+          default:
+            LOG(FATAL) << "Unsupported req " << req[o];
+        }
+      }
+    }
+  }
+}
+
+/*! \brief Shape of the result of a broadcast binary operation */
+TShape BroadcastShape(const TShape &lhs, const TShape &rhs) {
+  if (lhs == rhs) return lhs;
+  const int ndim = std::max(lhs.ndim(), rhs.ndim());
+  TShape ret(ndim);
+  for (int d = 0; d < ndim; ++d) {
+    const int l = d - (ndim - static_cast<int>(lhs.ndim()));
+    const int r = d - (ndim - static_cast<int>(rhs.ndim()));
+    const index_t ld = l >= 0 ? lhs[l] : 1;
+    const index_t rd = r >= 0 ? rhs[r] : 1;
+    ret[d] = ld == 1 ? rd : ld;
+  }
+  return ret;
+}
+
+/*!
+ * \brief Runs the operators of the subgraph one after the other through their own
+ *  FCompute, for element types the fused loop does not handle. Only the intermediate
+ *  results are allocated here.
+ */
+template<typename DType>
+void RunPointwiseUnfused(const PointwiseProgram &prog, const OpContext &ctx,
+                         const std::vector<TBlob> &inputs, const std::vector<OpReqType> &req,
+                         const std::vector<TBlob> &outputs) {
+  static const auto &fcompute = Op::GetAttr<FCompute>("FCompute<cpu>");
+  const size_t num_regs = prog.num_inputs + prog.instrs.size();
+  std::vector<TShape> shapes(num_regs);
+  for (uint32_t i = 0; i < prog.num_inputs; ++i) shapes[i] = inputs[i].shape_;
+  size_t total = 0;
+  for (size_t k = 0; k < prog.instrs.size(); ++k) {
+    const PointwiseInstr &instr = prog.instrs[k];
+    TShape &shape = shapes[prog.num_inputs + k];
+    shape = instr.rhs >= 0 ? BroadcastShape(shapes[instr.lhs], shapes[instr.rhs])
+                           : shapes[instr.lhs];
+    total += shape.Size();
+  }
+  std::vector<DType> storage(total);
+  std::vector<TBlob> regs(inputs.begin(), inputs.end());
+  DType *next = storage.data();
+  for (size_t k = 0; k < prog.instrs.size(); ++k) {
+    const PointwiseInstr &instr = prog.instrs[k];
+    const TShape &shape = shapes[prog.num_inputs + k];
+    regs.emplace_back(next, shape, cpu::kDevMask);
+    next += shape.Size();
+    std::vector<TBlob> in{regs[instr.lhs]};
+    if (instr.rhs >= 0) in.push_back(regs[instr.rhs]);
+    const FCompute fn = fcompute.get(instr.attrs.op, nullptr);
+    CHECK(fn != nullptr) << "Operator " << instr.attrs.op->name
+      << " has no FCompute<cpu> to run it outside of a fused pointwise subgraph";
+    fn(instr.attrs, ctx, in, {kWriteTo}, {regs.back()});
+  }
+  for (size_t o = 0; o < outputs.size(); ++o) {
+    const DType *src = regs[prog.outputs[o]].dptr<DType>();
+    DType *dst = outputs[o].dptr<DType>();
+    const index_t n = outputs[o].Size();
+    switch (req[o]) {
+      case kNullOp:
+        break;
+      case kWriteTo:
+      case kWriteInplace:
+        if (dst != src) std::copy(src, src + n, dst);
+        break;
+      case kAddTo:
+        for (index_t j = 0; j < n; ++j) dst[j] += src[j];
+        break;
+      default:
+        LOG(FATAL) << "Unsupported req " << req[o];
+    }
+  }
+}
+
+void PointwiseFusionForward(const nnvm::NodeAttrs &attrs, const OpContext &ctx,
+                            const std::vector<TBlob> &inputs,
+                            const std::vector<OpReqType> &req,
+                            const std::vector<TBlob> &outputs) {
+  const PointwiseProgram &prog = nnvm::get<PointwiseProgram>(attrs.parsed);
+  CHECK_EQ(inputs.size(), prog.num_inputs);
+  CHECK_EQ(outputs.size(), prog.outputs.size());
+  // The selector keeps integer operators out when the types are known at partition time,
+  // but a symbol partitioned without them may still be bound with integer inputs.
+  if (!outputs.empty() && !IsPointwiseFusionType(outputs[0].type_flag_)) {
+    MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+      RunPointwiseUnfused<DType>(prog, ctx, inputs, req, outputs);
+    });
+    return;
+  }
+  // Outputs of different shapes, ie an intermediate result that is not broadcast yet and
+  // is also used outside of the subgraph, are computed over their own iteration space.
+  std::vector<bool> done(outputs.size(), false);
+  for (size_t o = 0; o < outputs.size(); ++o) {
+    if (done[o]) continue;
+    std::vector<size_t> group;
+    for (size_t p = o; p < outputs.size(); ++p) {
+      if (!done[p] && outputs[p].shape_ == outputs[o].shape_) {
+        group.push_back(p);
+        done[p] = true;
+      }
+    }
+    if (outputs[o].shape_.Size() == 0) continue;
+    MSHADOW_REAL_TYPE_SWITCH(outputs[o].type_flag_, DType, {
+      RunPointwiseGroup<DType>(prog, ctx, inputs, req, outputs, group, outputs[o].shape_);
+    });
+  }
+}
+
+void PointwiseFusionParamParser(nnvm::NodeAttrs *attrs) {
+  CHECK_EQ(attrs->subgraphs.size(), 1U);
+  nnvm::Graph g;
+  g.outputs = attrs->subgraphs[0]->outputs;
+  const auto &idx = g.indexed_graph();
+  PointwiseProgram prog;
+  prog.num_inputs = idx.input_nodes().size();
+  std::vector<int> node_reg(idx.num_nodes(), -1);
+  for (size_t i = 0; i < idx.input_nodes().size(); ++i) {
+    node_reg[idx.input_nodes()[i]] = static_cast<int>(i);
+  }
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto &inode = idx[nid];
+    if (inode.source->is_variable()) continue;
+    PointwiseInstr instr;
+    instr.attrs = inode.source->attrs;
+    CHECK(GetPointwiseOp(inode.source->attrs, &instr.op, &instr.scalar))
+      << "Operator " << inode.source->op()->name << " of node " << inode.source->attrs.name
+      << " cannot be part of a fused pointwise subgraph";
+    const bool binary = IsBinaryPointwiseOp(instr.op);
+    CHECK_EQ(inode.inputs.size(), binary ? 2U : 1U);
+    instr.lhs = node_reg[inode.inputs[0].node_id];
+    instr.rhs = binary ? node_reg[inode.inputs[1].node_id] : -1;
+    node_reg[nid] = static_cast<int>(prog.num_inputs + prog.instrs.size());
+    prog.instrs.push_back(instr);
+  }
+  for (const auto &e : idx.outputs()) {
+    prog.outputs.push_back(node_reg[e.node_id]);
+  }
+  attrs->parsed = std::move(prog);
+}
+
+}  // namespace
+
+bool GetPointwiseOp(const nnvm::NodeAttrs &attrs, PointwiseOp *op, double *scalar) {
+  static const std::unordered_map<std::string, PointwiseOp> ops = {
+    {"elemwise_add", PointwiseOp::kAdd},
+    {"broadcast_add", PointwiseOp::kAdd},
+    {"elemwise_sub", PointwiseOp::kSub},
+    {"broadcast_sub", PointwiseOp::kSub},
+    {"elemwise_mul", PointwiseOp::kMul},
+    {"broadcast_mul", PointwiseOp::kMul},
+    {"elemwise_div", PointwiseOp::kDiv},
+    {"broadcast_div", PointwiseOp::kDiv},
+    {"_maximum", PointwiseOp::kMaximum},
+    {"broadcast_maximum", PointwiseOp::kMaximum},
+    {"_minimum", PointwiseOp::kMinimum},
+    {"broadcast_minimum", PointwiseOp::kMinimum},
+    {"_power", PointwiseOp::kPower},
+    {"broadcast_power", PointwiseOp::kPower},
+    {"_plus_scalar", PointwiseOp::kAddScalar},
+    {"_minus_scalar", PointwiseOp::kSubScalar},
+    {"_rminus_scalar", PointwiseOp::kRSubScalar},
+    {"_mul_scalar", PointwiseOp::kMulScalar},
+    {"_div_scalar", PointwiseOp::kDivScalar},
+    {"_rdiv_scalar", PointwiseOp::kRDivScalar},
+    {"_maximum_scalar", PointwiseOp::kMaximumScalar},
+    {"_minimum_scalar", PointwiseOp::kMinimumScalar},
+    {"_power_scalar", PointwiseOp::kPowerScalar},
+    {"_rpower_scalar", PointwiseOp::kRPowerScalar},
+    {"_copy", PointwiseOp::kIdentity},
+    {"negative", PointwiseOp::kNegative},
+    {"relu", PointwiseOp::kReLU},
+    {"sigmoid", PointwiseOp::kSigmoid},
+    {"tanh", PointwiseOp::kTanh},
+    {"softsign", PointwiseOp::kSoftSign},
+    {"exp", PointwiseOp::kExp},
+    {"log", PointwiseOp::kLog},
+    {"sqrt", PointwiseOp::kSqrt},
+    {"rsqrt", PointwiseOp::kRSqrt},
+    {"square", PointwiseOp::kSquare},
+    {"abs", PointwiseOp::kAbs},
+    {"erf", PointwiseOp::kErf},
+    {"reciprocal", PointwiseOp::kReciprocal},
+  };
+  if (attrs.op == nullptr) return false;
+  const std::string &name = attrs.op->name;
+  if (name == "Activation") {
+    switch (nnvm::get<ActivationParam>(attrs.parsed).act_type) {
+      case activation::kReLU:     *op = PointwiseOp::kReLU; break;
+      case activation::kSigmoid:  *op = PointwiseOp::kSigmoid; break;
+      case activation::kTanh:     *op = PointwiseOp::kTanh; break;
+      case activation::kSoftReLU: *op = PointwiseOp::kSoftReLU; break;
+      case activation::kSoftSign: *op = PointwiseOp::kSoftSign; break;
+      default: return false;
+    }
+    *scalar = 0;
+    return true;
+  }
+  auto it = ops.find(name);
+  if (it == ops.end()) return false;
+  *op = it->second;
+  *scalar = (*op >= PointwiseOp::kAddScalar && *op <= PointwiseOp::kRPowerScalar) ?
+            nnvm::get<double>(attrs.parsed) : 0;
+  return true;
+}
+
+NNVM_REGISTER_OP(_sg_pointwise)
+.describe(R"code(_sg_pointwise)code" ADD_FILELINE)
+.set_num_inputs(DefaultSubgraphOpNumInputs)
+.set_num_outputs(DefaultSubgraphOpNumOutputs)
+.set_attr_parser(PointwiseFusionParamParser)
+.set_attr<nnvm::FListInputNames>("FListInputNames", DefaultSubgraphOpListInputs)
+.set_attr<nnvm::FListOutputNames>("FListOutputNames", DefaultSubgraphOpListOutputs)
+.set_attr<nnvm::FInferShape>("FInferShape", DefaultSubgraphOpShape)
+.set_attr<nnvm::FInferType>("FInferType", DefaultSubgraphOpType)
+.set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
+  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+})
+.set_attr<FCompute>("FCompute<cpu>", PointwiseFusionForward);
+
+}  // namespace op
+}  // namespace mxnet
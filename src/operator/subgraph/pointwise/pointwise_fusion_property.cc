@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pointwise_fusion_property.cc
+ * \brief groups connected elementwise and broadcast operators into _sg_pointwise nodes
+ */
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "./pointwise_fusion-inl.h"
+#include "../common.h"
+#include "../subgraph_property.h"
+
+namespace mxnet {
+namespace op {
+
+typedef std::unordered_set<const nnvm::Node *> NodeSet;
+
+/*
+ * This selects every connected set of operators that GetPointwiseOp accepts, visiting
+ * nodes via both input and output links. Operators whose outputs are known to have a
+ * type the fused loop does not handle are left out.
+ */
+class SgPointwiseSelector : public SubgraphSelector {
+ public:
+  explicit SgPointwiseSelector(std::shared_ptr<const NodeSet> excluded)
+    : excluded_(excluded) {}
+
+  bool Select(const nnvm::Node &seed_node) override {
+    return IsPointwise(seed_node);
+  }
+
+  bool SelectInput(const nnvm::Node &cur_node, const nnvm::Node &input_node) override {
+    return IsPointwise(input_node);
+  }
+
+  bool SelectOutput(const nnvm::Node &cur_node, const nnvm::Node &output_node) override {
+    return IsPointwise(output_node);
+  }
+
+  std::vector<nnvm::Node *> Filter(const std::vector<nnvm::Node *> &candidates) override {
+    // a single operator gains nothing from running through the fused loop
+    if (candidates.size() < 2) return std::vector<nnvm::Node *>();
+    return candidates;
+  }
+
+ private:
+  bool IsPointwise(const nnvm::Node &n) const {
+    PointwiseOp op;
+    double scalar;
+    return !n.is_variable() && !excluded_->count(&n) && GetPointwiseOp(n.attrs, &op, &scalar);
+  }
+
+  std::shared_ptr<const NodeSet> excluded_;
+};
+
+/*
+ * This subgraph property replaces chains of elementwise and broadcast operators, such
+ * as the tail of a LayerNorm or a GELU, with a _sg_pointwise node that runs them as a
+ * single loop on CPU, without materializing the intermediate results.
+ */
+class SgPointwiseProperty : public SubgraphProperty {
+ public:
+  SgPointwiseProperty() {
+    LOG(INFO) << "Start to execute pointwise fusion pass.";
+  }
+  static SubgraphPropertyPtr Create() {
+    return std::make_shared<SgPointwiseProperty>();
+  }
+  nnvm::NodePtr CreateSubgraphNode(const nnvm::Symbol &sym,
+                                   const int subgraph_id = 0) const override {
+    nnvm::NodePtr n = nnvm::Node::Create();
+    n->attrs.op = Op::Get("_sg_pointwise");
+    CHECK(n->attrs.op);
+    n->attrs.name = "sg_pointwise_" + std::to_string(subgraph_id);
+    n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(sym));
+    n->op()->attr_parser(&(n->attrs));
+    return n;
+  }
+  SubgraphSelectorPtr CreateSubgraphSelector() const override {
+    if (!excluded_) excluded_ = ExcludedNodes();
+    return std::make_shared<SgPointwiseSelector>(excluded_);
+  }
+
+ private:
+  // Nodes with outputs of a type the fused loop does not handle. The executor passes the
+  // graph with inferred types; get_backend_symbol does not, and the fused node then runs
+  // non-float types unfused.
+  std::shared_ptr<const NodeSet> ExcludedNodes() const {
+    auto excluded = std::make_shared<NodeSet>();
+    if (!HasAttr("graph")) return excluded;
+    const nnvm::Graph &g = GetAttr<nnvm::Graph>("graph");
+    if (!g.attrs.count("dtype")) return excluded;
+    const auto &idx = g.indexed_graph();
+    const auto &dtypes = g.GetAttr<nnvm::DTypeVector>("dtype");
+    for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+      const nnvm::Node *node = idx[nid].source;
+      for (uint32_t i = 0; i < node->num_outputs(); ++i) {
+        const int dtype = dtypes[idx.entry_id(nid, i)];
+        if (dtype != -1 && !IsPointwiseFusionType(dtype)) excluded->insert(node);
+      }
+    }
+    return excluded;
+  }
+
+  mutable std::shared_ptr<const NodeSet> excluded_;
+};
+
+MXNET_REGISTER_SUBGRAPH_PROPERTY(pointwise, SgPointwiseProperty);
+
+}  // namespace op
+}  // namespace mxnet
@@ -154,6 +154,12 @@ class SubgraphProperty {
     attrs_[name] = std::make_shared<dmlc::any>(value);
     return *this;
   }
+  /*!
+   * \brief Whether an attr with the name has been set.
+   */
+  bool HasAttr(const std::string& name) const {
+    return attrs_.count(name) != 0;
+  }
   /*!
    * \brief Get the attr with the name.
    */
@@ -194,15 +194,147 @@ void BinaryBroadcastComputeImpl(Stream<cpu> *s, const OpReqType req,
                            out.shape_.get<ndim>());
 }
 
+/*! \brief number of independent accumulators of a contiguous reduction */
+const int kReduceLanes = 8;
+/*! \brief minimum number of reduced elements per thread when one output is split */
+const size_t kReduceMinChunk = 16384;
+
+/*!
+ * \brief Reduction step on plain (non-volatile) accumulators. Sum and nansum are spelled
+ *  out with the same compensated summation as their Reducer so that the lanes of a
+ *  contiguous reduction are kept in vector registers.
+ */
+template<typename Reducer>
+struct LaneReducer {
+  template<typename DType>
+  MSHADOW_XINLINE static void Reduce(DType& dst, const DType src, DType& residual) { // NOLINT(*)
+    Reducer::Reduce(dst, src, residual);
+  }
+};
+
+template<>
+struct LaneReducer<red::sum> {
+  template<typename DType>
+  MSHADOW_XINLINE static void Reduce(DType& dst, const DType src, DType& residual) { // NOLINT(*)
+    const DType y = src - residual;
+    const DType t = dst + y;
+    residual = (t - dst) - y;
+    dst = t;
+  }
+};
+
+template<>
+struct LaneReducer<mshadow_op::nansum> {
+  template<typename DType>
+  MSHADOW_XINLINE static void Reduce(DType& dst, const DType src, DType& residual) { // NOLINT(*)
+    if (mshadow_op::isnan_typed::IsNan(src)) return;
+    LaneReducer<red::sum>::Reduce(dst, src, residual);
+  }
+};
+
+/*!
+ * \brief Reduces the elements [begin, end) of the reduced space of the output whose first
+ *  element is big[j] into val and residual, which are initialized by the caller.
+ *  A contiguous reduced space is reduced into kReduceLanes accumulators merged at the end.
+ */
+template<typename Reducer, int ndim, typename DType, typename OP>
+inline void seq_reduce_range(const DType* __restrict big, const index_t j,
+                             const size_t begin, const size_t end, const bool contiguous,
+                             const Shape<ndim>& rshape, const Shape<ndim>& rstride,
+                             DType* val, DType* residual) {
+  if (!contiguous) {
+    for (size_t k = begin; k < end; ++k) {
+      const Shape<ndim> coord = unravel(k, rshape);
+      Reducer::Reduce(*val, OP::Map(big[j + dot(coord, rstride)]), *residual);
+    }
+    return;
+  }
+  const DType* __restrict p = big + j;
+  DType lval[kReduceLanes], lres[kReduceLanes];
+  for (int l = 0; l < kReduceLanes; ++l) {
+    Reducer::SetInitValue(lval[l], lres[l]);
+  }
+  size_t k = begin;
+  for (; k + kReduceLanes <= end; k += kReduceLanes) {
+    for (int l = 0; l < kReduceLanes; ++l) {
+      LaneReducer<Reducer>::Reduce(lval[l], OP::Map(p[k + l]), lres[l]);
+    }
+  }
+  for (int l = 0; k < end; ++k, ++l) {
+    LaneReducer<Reducer>::Reduce(lval[l], OP::Map(p[k]), lres[l]);
+  }
+  for (int l = 0; l < kReduceLanes; ++l) {
+    Reducer::Merge(*val, *residual, lval[l], lres[l]);
+  }
+}
+
+/*!
+ * \brief Whether the reduced elements of each output are contiguous in big, ie the reduced
+ *  axes are the innermost non-trivial axes.
+ */
+template<int ndim>
+inline bool is_contiguous_reduce(const Shape<ndim>& rshape, const Shape<ndim>& rstride) {
+  index_t stride = 1;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (rshape[i] > 1) {
+      if (rstride[i] != stride) return false;
+      stride *= rshape[i];
+    }
+  }
+  return true;
+}
+
 template<typename Reducer, int ndim, typename DType, typename OP>
 void seq_reduce_compute(const size_t N, const size_t M, const bool addto,
                         const DType *big, DType *small, const Shape<ndim> bshape,
                         const Shape<ndim> sshape, const Shape<ndim> rshape,
                         const Shape<ndim> rstride) {
-  #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const bool contiguous = is_contiguous_reduce(rshape, rstride);
+  // Fewer outputs than threads: split the reduced space of each output into parts
+  // reduced in parallel, then combine the parts of each output pairwise.
+  const size_t parts = std::min<size_t>(omp_threads / std::max<size_t>(N, 1),
+                                        M / kReduceMinChunk);
+  if (parts > 1) {
+    const size_t chunk = (M + parts - 1) / parts;
+    std::vector<DType> vals(N * parts), residuals(N * parts);
+    #pragma omp parallel for num_threads(omp_threads)
+    for (index_t t = 0; t < static_cast<index_t>(N * parts); ++t) {
+      const index_t idx = t / parts;
+      const size_t begin = (t % parts) * chunk;
+      const index_t j = ravel(unravel(idx, sshape), bshape);
+      Reducer::SetInitValue(vals[t], residuals[t]);
+      seq_reduce_range<Reducer, ndim, DType, OP>(big, j, begin, std::min(begin + chunk, M),
+                                                 contiguous, rshape, rstride,
+                                                 &vals[t], &residuals[t]);
+    }
+    for (size_t idx = 0; idx < N; ++idx) {
+      DType* val = &vals[idx * parts];
+      DType* residual = &residuals[idx * parts];
+      for (size_t step = 1; step < parts; step *= 2) {
+        for (size_t i = 0; i + step < parts; i += 2 * step) {
+          Reducer::Merge(val[i], residual[i], val[i + step], residual[i + step]);
+        }
+      }
+      Reducer::Finalize(val[0], residual[0]);
+      assign(&small[idx], addto, val[0]);
+    }
+    return;
+  }
+  #pragma omp parallel for num_threads(omp_threads)
   for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
-    seq_reduce_assign<Reducer, ndim, DType, OP>(idx, M, addto, big, small, bshape, sshape, rshape,
-      rstride);
+    if (contiguous) {
+      const index_t j = ravel(unravel(idx, sshape), bshape);
+      DType val, residual;
+      Reducer::SetInitValue(val, residual);
+      seq_reduce_range<Reducer, ndim, DType, OP>(big, j, 0, M, true, rshape, rstride,
+                                                 &val, &residual);
+      Reducer::Finalize(val, residual);
+      assign(&small[idx], addto, val);
+    } else {
+      seq_reduce_assign<Reducer, ndim, DType, OP>(idx, M, addto, big, small, bshape, sshape,
+                                                  rshape, rstride);
+    }
   }
 }
 
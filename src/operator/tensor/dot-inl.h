@@ -25,7 +25,10 @@
 #ifndef MXNET_OPERATOR_TENSOR_DOT_INL_H_
 #define MXNET_OPERATOR_TENSOR_DOT_INL_H_
 
+#include <dmlc/parameter.h>
 #include <mxnet/operator_util.h>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include <utility>
@@ -384,50 +387,10 @@ struct DotCsrDnsDnsByRowBlocks {
 };
 
 /*!
- * \brief CPU Kernel of dot(csr.T(), dns1) = dns2
- * Parallelization by row blocks
+ * \brief CPU Kernel of dot(csr, dns) = rsp, whose rows are the non-zero rows of csr
+ * Parallelization by row blocks of the output
  */
-struct DotCsrTransDnsDnsByRowBlocks {
-  /*!
-   * \brief
-   * \param i the i-th thread
-   */
-  template<typename DType, typename IType, typename CType>
-  MSHADOW_CINLINE static void Map(int i,
-                                  DType* out,
-                                  const DType* data_l,
-                                  const IType* indptr_l,
-                                  const CType* col_idx_l,
-                                  const DType* data_r,
-                                  const nnvm::dim_t seg_len,
-                                  const nnvm::dim_t num_rows_l,
-                                  const nnvm::dim_t num_rows,
-                                  const nnvm::dim_t num_cols) {
-    using nnvm::dim_t;
-    const dim_t seg_start = i * seg_len;
-    if (seg_start >= num_rows) return;
-    const dim_t seg_end = (i + 1) * seg_len;
-    for (dim_t j = 0; j < num_rows_l; ++j) {
-      if (indptr_l[j] == indptr_l[j+1]) continue;
-      const dim_t offset_r = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j+1]; ++k) {
-        const CType col_idx = col_idx_l[k];
-        if (col_idx < seg_start || col_idx >= seg_end) continue;
-        const dim_t offset_out = col_idx * num_cols;
-        const DType val = data_l[k];
-        for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out+l] += data_r[offset_r+l] * val;
-        }
-      }
-    }
-  }
-};
-
-/*!
- * \brief CPU Kernel of dot(csr.T(), dns) = rsp
- * Parallelization by row blocks which evenly partition the non-zero rows.
- */
-struct DotCsrTransDnsRspByRowBlocks {
+struct DotCsrDnsRspByRowBlocks {
   /*!
    * \brief
    * \param i the i-th thread
@@ -435,33 +398,24 @@ struct DotCsrTransDnsRspByRowBlocks {
   template<typename DType, typename IType, typename CType, typename RType>
   MSHADOW_CINLINE static void Map(int i,
                                   DType* out,
-                                  nnvm::dim_t* row_flg_sum,
-                                  RType* row_idx,
+                                  const RType* row_idx,
                                   const DType* data_l,
                                   const IType* indptr_l,
                                   const CType* col_idx_l,
                                   const DType* data_r,
                                   const nnvm::dim_t seg_len,
-                                  const nnvm::dim_t num_rows_l,
                                   const nnvm::dim_t nnr,
                                   const nnvm::dim_t num_cols) {
     using nnvm::dim_t;
     const dim_t seg_start = i * seg_len;
     if (seg_start >= nnr) return;
-    const dim_t seg_end = (i + 1) * seg_len;
-    const dim_t col_start = row_idx[seg_start];
-    const dim_t col_end = seg_end >= nnr ? (row_idx[nnr-1] + 1) : row_idx[seg_end];
-    for (dim_t j = 0; j < num_rows_l; ++j) {
-      if (indptr_l[j] == indptr_l[j+1]) continue;
-      const dim_t offset_r = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j+1]; ++k) {
-        const CType col_idx = col_idx_l[k];
-        if (col_idx < col_start || col_idx >= col_end) continue;
-
-        const nnvm::dim_t rsp_row = row_flg_sum[col_idx] - 1;
-        const nnvm::dim_t offset_out = rsp_row * num_cols;
+    const dim_t seg_end = std::min(seg_start + seg_len, nnr);
+    for (dim_t j = seg_start; j < seg_end; ++j) {
+      const dim_t row = row_idx[j];
+      const dim_t offset_out = j * num_cols;
+      for (IType k = indptr_l[row]; k < indptr_l[row+1]; ++k) {
         const DType val = data_l[k];
-
+        const dim_t offset_r = col_idx_l[k] * num_cols;
         for (dim_t l = 0; l < num_cols; ++l) {
           out[offset_out+l] += data_r[offset_r+l] * val;
         }
@@ -755,6 +709,105 @@ struct DotDnsCsrTransDnsByRowBlocks {
   }
 };
 
+/*!
+ * \brief CPU Impl of the transpose of a csr matrix, i.e. its CSC structure stored as csr.
+ * The non-zeros are counted per column and scattered in parallel with atomic cursors, then
+ * every row of the result is sorted by column index so that the result does not depend on
+ * the order in which threads ran.
+ */
+inline NDArray CsrTransposeImpl(const NDArray& src) {
+  using nnvm::dim_t;
+  CHECK_EQ(src.storage_type(), kCSRStorage);
+  CHECK_EQ(src.shape().ndim(), 2U);
+  const dim_t num_rows = src.shape()[0];
+  const dim_t num_cols = src.shape()[1];
+  const dim_t nnz = src.storage_initialized() ? src.aux_shape(csr::kIdx)[0] : 0;
+  NDArray ret(kCSRStorage, mshadow::Shape2(num_cols, num_rows), src.ctx(), true, src.dtype(),
+              {src.aux_type(csr::kIndPtr), src.aux_type(csr::kIdx)});
+  ret.CheckAndAllocAuxData(csr::kIndPtr, mshadow::Shape1(num_cols + 1));
+  ret.CheckAndAllocAuxData(csr::kIdx, mshadow::Shape1(nnz));
+  ret.CheckAndAllocData(mshadow::Shape1(nnz));
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_TYPE_SWITCH(src.dtype(), DType, {  // data type
+    MSHADOW_IDX_TYPE_SWITCH(src.aux_type(csr::kIndPtr), IType, {  // indptr type
+      MSHADOW_IDX_TYPE_SWITCH(src.aux_type(csr::kIdx), CType, {  // col idx type
+        IType* indptr_t = ret.aux_data(csr::kIndPtr).dptr<IType>();
+        if (nnz == 0) {
+          std::fill(indptr_t, indptr_t + num_cols + 1, IType(0));
+          return ret;
+        }
+        const IType* indptr = src.aux_data(csr::kIndPtr).dptr<IType>();
+        const CType* col_idx = src.aux_data(csr::kIdx).dptr<CType>();
+        const DType* data = src.data().dptr<DType>();
+        CType* row_idx_t = ret.aux_data(csr::kIdx).dptr<CType>();
+        DType* data_t = ret.data().dptr<DType>();
+        std::unique_ptr<std::atomic<IType>[]> cursor(new std::atomic<IType>[num_cols]);
+        #pragma omp parallel for num_threads(omp_threads)
+        for (dim_t c = 0; c < num_cols; ++c) {
+          cursor[c].store(0, std::memory_order_relaxed);
+        }
+        #pragma omp parallel for num_threads(omp_threads)
+        for (dim_t k = 0; k < nnz; ++k) {
+          cursor[col_idx[k]].fetch_add(1, std::memory_order_relaxed);
+        }
+        indptr_t[0] = 0;
+        for (dim_t c = 0; c < num_cols; ++c) {
+          indptr_t[c + 1] = indptr_t[c] + cursor[c].load(std::memory_order_relaxed);
+          cursor[c].store(indptr_t[c], std::memory_order_relaxed);
+        }
+        #pragma omp parallel for num_threads(omp_threads)
+        for (dim_t i = 0; i < num_rows; ++i) {
+          for (IType k = indptr[i]; k < indptr[i + 1]; ++k) {
+            const IType pos = cursor[col_idx[k]].fetch_add(1, std::memory_order_relaxed);
+            row_idx_t[pos] = static_cast<CType>(i);
+            data_t[pos] = data[k];
+          }
+        }
+        #pragma omp parallel num_threads(omp_threads)
+        {
+          std::vector<std::pair<CType, DType>> entries;
+          #pragma omp for schedule(dynamic, 256)
+          for (dim_t c = 0; c < num_cols; ++c) {
+            CType* begin = row_idx_t + indptr_t[c];
+            CType* end = row_idx_t + indptr_t[c + 1];
+            if (std::is_sorted(begin, end)) continue;
+            DType* values = data_t + indptr_t[c];
+            entries.clear();
+            for (CType* it = begin; it != end; ++it) {
+              entries.emplace_back(*it, values[it - begin]);
+            }
+            std::sort(entries.begin(), entries.end(),
+                      [](const std::pair<CType, DType>& a, const std::pair<CType, DType>& b) {
+                        return a.first < b.first;
+                      });
+            for (size_t e = 0; e < entries.size(); ++e) {
+              begin[e] = entries[e].first;
+              values[e] = entries[e].second;
+            }
+          }
+        }
+      });
+    });
+  });
+  return ret;
+}
+
+/*!
+ * \brief the transpose of a csr array for dot(csr.T, x). With MXNET_CACHE_CSR_TRANSPOSE
+ * it is saved on the array and reused until the array is written to.
+ */
+inline NDArray GetCsrTranspose(const NDArray& src) {
+  if (!dmlc::GetEnv("MXNET_CACHE_CSR_TRANSPOSE", false)) {
+    return CsrTransposeImpl(src);
+  }
+  NDArray trans = src.GetCSRTranspose();
+  if (trans.is_none()) {
+    trans = CsrTransposeImpl(src);
+    src.SetCSRTranspose(trans);
+  }
+  return trans;
+}
+
 /*!
  * \brief CPU Impl of dot(csr, dns1) = dns2 and dot(csr.T, dns1) = dns2
  */
@@ -772,6 +825,11 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
     Fill(s, *ret, req, 0);
     return;
   }
+  if (trans_lhs) {
+    // the rows of csr.T are independent, unlike its columns
+    DotCsrDnsDnsImpl(ctx, cpu_dev, GetCsrTranspose(lhs), rhs, req, false, ret);
+    return;
+  }
 
   using nnvm::dim_t;
 
@@ -800,23 +858,16 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
           num_threads = data_out.Size() / unit_work_per_thread;
         }
         dim_t seg_len = (data_out.shape_[0] + num_threads - 1) / num_threads;
-        if (trans_lhs) {
-          mxnet_op::Kernel<DotCsrTransDnsDnsByRowBlocks, cpu>::Launch(s, num_threads,
+        if (dynamic) {
+          mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::LaunchDynamic(s, num_threads,
               data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
               col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
-              lhs.shape()[0], data_out.shape_[0], data_out.shape_[1]);
+              data_out.shape_[0], data_out.shape_[1]);
         } else {
-          if (dynamic) {
-            mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::LaunchDynamic(s, num_threads,
-                data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
-                col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
-                data_out.shape_[0], data_out.shape_[1]);
-          } else {
-            mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::Launch(s, num_threads,
-                data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
-                col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
-                data_out.shape_[0], data_out.shape_[1]);
-          }
+          mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::Launch(s, num_threads,
+              data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
+              col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
+              data_out.shape_[0], data_out.shape_[1]);
         }
       });
     });
@@ -824,7 +875,7 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
 }
 
 /*!
- * \brief CPU Impl of dot(csr.T, dns) = rsp
+ * \brief CPU Impl of dot(csr, dns) = rsp and dot(csr.T, dns) = rsp
  */
 inline void DotCsrDnsRspImpl(const OpContext& ctx,
                              const cpu& cpu_dev,
@@ -842,6 +893,11 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
     return;
   }
   CHECK_EQ(req, kWriteTo);
+  if (trans_lhs) {
+    // the rows of csr.T are independent, unlike its columns
+    DotCsrDnsRspImpl(ctx, cpu_dev, GetCsrTranspose(lhs), rhs, req, false, ret);
+    return;
+  }
 
   using namespace mxnet_op;
   using nnvm::dim_t;
@@ -855,21 +911,17 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
     MSHADOW_IDX_TYPE_SWITCH(indptr_l.type_flag_, IType, {  // indptr type
       MSHADOW_IDX_TYPE_SWITCH(col_idx_l.type_flag_, CType, {  // col idx type
         MSHADOW_IDX_TYPE_SWITCH(ret->aux_type(rowsparse::kIdx), RType, {  // row idx type
-          const dim_t num_rows = lhs.shape()[1];
+          const dim_t num_rows = lhs.shape()[0];
           size_t workspace_size = num_rows * sizeof(dim_t);
           mshadow::Tensor<cpu, 1, char> workspace =
             ctx.requested[0].get_space_typed<cpu, 1, char>(
             mshadow::Shape1(workspace_size), s);
-          dim_t* row_flg = reinterpret_cast<dim_t*>(workspace.dptr_);
-          // prefix sum array re-uses the row_flg array temp space
-          dim_t* prefix_sum = row_flg;
-          Kernel<set_zero, cpu>::Launch(s, num_rows, row_flg);
-          Kernel<MarkRowFlgKernel, cpu>::Launch(s, lhs.aux_shape(csr::kIdx)[0], row_flg,
-            col_idx_l.dptr<CType>());
-
-          prefix_sum[0] = row_flg[0];
-          for (nnvm::dim_t i = 1; i < num_rows; i++) {
-            prefix_sum[i] = prefix_sum[i - 1] + row_flg[i];
+          // prefix sum over the flags of the non-empty rows of lhs
+          dim_t* prefix_sum = reinterpret_cast<dim_t*>(workspace.dptr_);
+          const IType* indptr = indptr_l.dptr<IType>();
+          prefix_sum[0] = indptr[1] > indptr[0];
+          for (dim_t i = 1; i < num_rows; i++) {
+            prefix_sum[i] = prefix_sum[i - 1] + (indptr[i + 1] > indptr[i]);
           }
           dim_t nnr = prefix_sum[num_rows - 1];
 
@@ -891,14 +943,10 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
 
           num_threads = mxnet_op::get_num_threads<cpu>(nnr);
           dim_t seg_len = (nnr + num_threads - 1) / num_threads;
-          if (trans_lhs) {
-            mxnet_op::Kernel<DotCsrTransDnsRspByRowBlocks, cpu>::Launch(s, num_threads,
-              data_out.dptr<DType>(), prefix_sum, row_idx_out, data_l.dptr<DType>(),
-              indptr_l.dptr<IType>(), col_idx_l.dptr<CType>(), data_r.dptr<DType>(),
-              seg_len, lhs.shape()[0], nnr, ret->shape()[1]);
-          } else {
-            LOG(FATAL) << "DotCsrDnsRspImpl has not implemented dot(csr, dns)=rsp yet.";
-          }
+          mxnet_op::Kernel<DotCsrDnsRspByRowBlocks, cpu>::Launch(s, num_threads,
+            data_out.dptr<DType>(), row_idx_out, data_l.dptr<DType>(),
+            indptr, col_idx_l.dptr<CType>(), data_r.dptr<DType>(),
+            seg_len, nnr, ret->shape()[1]);
         });
       });
     });
@@ -24,6 +24,10 @@
  * \author Siyi Li, Chi Zhang
 */
 
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "./indexing_op.h"
 namespace mxnet {
 namespace op {
@@ -48,6 +52,24 @@ struct TakeCPU {
     }
     std::memcpy(out_data + i * M, in_data + j * M, M * sizeof(DType));
   }
+  // same as above, converting every element from DType to OType
+  template<typename OType, typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i, OType* out_data, const DType* in_data,
+                                  const IType* idx, const size_t M, const int64_t K) {
+    int64_t j = static_cast<int64_t>(idx[i]);
+    if (clip) {
+      if (j <= 0) j = 0;
+      else if (j >= K) j = K - 1;
+    } else {
+      j = j % K;
+      j += (j < 0) ? K : 0;
+    }
+    OType* out = out_data + i * M;
+    const DType* in = in_data + j * M;
+    for (size_t m = 0; m < M; ++m) {
+      out[m] = static_cast<OType>(in[m]);
+    }
+  }
 };
 
 /*
@@ -81,6 +103,18 @@ void EmbeddingOpForwardDnsImpl<cpu>(mshadow::Stream<cpu>* s,
   const TShape& ishape = data.shape_;
   const TShape& oshape = output.shape_;
 
+  if (output.type_flag_ != weight.type_flag_) {
+    // float16 table with float32 output, see EmbeddingParam::out_dtype
+    CHECK_EQ(output.type_flag_, mshadow::kFloat32);
+    CHECK_EQ(weight.type_flag_, mshadow::kFloat16);
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      const index_t row_length = weight.shape_[1];
+      Kernel<TakeCPU<true>, cpu>::Launch(s, oshape.Size() / row_length, output.dptr<float>(),
+                                         weight.dptr<mshadow::half::half_t>(),
+                                         data.dptr<IType>(), row_length, weight.shape_[0]);
+    });
+    return;
+  }
   MSHADOW_TYPE_SWITCH(output.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
       Tensor<cpu, 1, IType> idx = data.get_with_shape<cpu, 1, IType>(
@@ -340,6 +374,128 @@ void TakeOpForward<cpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*!
+ * \brief Groups the lookups of an embedding by the row they read. unique_rows receives the
+ *  distinct rows in increasing order, and order[offsets[r], offsets[r+1]) the positions in
+ *  data that read unique_rows[r], in increasing order. The rows are deduplicated with one
+ *  hash table per shard of row ids, one shard per thread, so that the cost grows with the
+ *  number of lookups instead of the number of rows of the table.
+ */
+template<typename IType>
+void GroupEmbeddingLookups(const IType* data, const nnvm::dim_t data_size, const int nthreads,
+                           std::vector<nnvm::dim_t>* unique_rows,
+                           std::vector<nnvm::dim_t>* offsets,
+                           std::vector<nnvm::dim_t>* order) {
+  using nnvm::dim_t;
+  auto shard_of = [nthreads](const IType row) {
+    return static_cast<int>(((static_cast<uint64_t>(row) * 0x9E3779B97F4A7C15ULL) >> 32)
+                            % static_cast<uint64_t>(nthreads));
+  };
+  // every thread sorts a contiguous range of lookups into the shards
+  std::vector<std::vector<std::vector<dim_t>>> buckets(
+      nthreads, std::vector<std::vector<dim_t>>(nthreads));
+  #pragma omp parallel for num_threads(nthreads)
+  for (int t = 0; t < nthreads; ++t) {
+    const dim_t begin = data_size * t / nthreads;
+    const dim_t end = data_size * (t + 1) / nthreads;
+    for (dim_t i = begin; i < end; ++i) {
+      buckets[t][shard_of(data[i])].push_back(i);
+    }
+  }
+  // deduplicate every shard, slot[i] is the position of data[i] among the rows of its shard
+  std::vector<dim_t> slot(data_size);
+  std::vector<std::vector<dim_t>> shard_rows(nthreads);
+  #pragma omp parallel for num_threads(nthreads)
+  for (int shard = 0; shard < nthreads; ++shard) {
+    size_t shard_size = 0;
+    for (int t = 0; t < nthreads; ++t) shard_size += buckets[t][shard].size();
+    std::unordered_map<dim_t, dim_t> table(shard_size);
+    std::vector<dim_t>& rows = shard_rows[shard];
+    for (int t = 0; t < nthreads; ++t) {
+      for (const dim_t i : buckets[t][shard]) {
+        const dim_t row = static_cast<dim_t>(data[i]);
+        auto it = table.emplace(row, static_cast<dim_t>(rows.size()));
+        if (it.second) rows.push_back(row);
+        slot[i] = it.first->second;
+      }
+    }
+  }
+  // sort the distinct rows, rank[shard_begin[shard] + slot] is the position of a row in them
+  std::vector<dim_t> shard_begin(nthreads + 1, 0);
+  for (int shard = 0; shard < nthreads; ++shard) {
+    shard_begin[shard + 1] = shard_begin[shard] + shard_rows[shard].size();
+  }
+  const dim_t num_unique = shard_begin[nthreads];
+  std::vector<std::pair<dim_t, dim_t>> sorted;
+  sorted.reserve(num_unique);
+  for (int shard = 0; shard < nthreads; ++shard) {
+    for (size_t k = 0; k < shard_rows[shard].size(); ++k) {
+      sorted.emplace_back(shard_rows[shard][k], shard_begin[shard] + k);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<dim_t> rank(num_unique);
+  unique_rows->resize(num_unique);
+  for (dim_t r = 0; r < num_unique; ++r) {
+    (*unique_rows)[r] = sorted[r].first;
+    rank[sorted[r].second] = r;
+  }
+  // counting sort of the lookups by the rank of their row
+  offsets->assign(num_unique + 1, 0);
+  for (dim_t i = 0; i < data_size; ++i) {
+    slot[i] = rank[shard_begin[shard_of(data[i])] + slot[i]];
+    ++(*offsets)[slot[i] + 1];
+  }
+  for (dim_t r = 0; r < num_unique; ++r) {
+    (*offsets)[r + 1] += (*offsets)[r];
+  }
+  order->resize(data_size);
+  std::vector<dim_t> cursor(offsets->begin(), offsets->end() - 1);
+  for (dim_t i = 0; i < data_size; ++i) {
+    (*order)[cursor[slot[i]]++] = i;
+  }
+}
+
+/*!
+ * \brief row sparse gradient of an embedding: every distinct row read by data is summed
+ *  from the rows of ograd that read it, in the order of data, accumulating in DType.
+ */
+template<typename IType, typename DType, typename GType, typename RType>
+void EmbeddingBackwardRspCPU(const IType* data, const nnvm::dim_t data_size,
+                             const DType* ograd, const nnvm::dim_t row_length,
+                             const NDArray& output) {
+  using nnvm::dim_t;
+  const int nthreads = static_cast<int>(std::max<dim_t>(1, std::min<dim_t>(
+      engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), data_size / 1024)));
+  std::vector<dim_t> unique_rows, offsets, order;
+  GroupEmbeddingLookups(data, data_size, nthreads, &unique_rows, &offsets, &order);
+  const dim_t nnr = unique_rows.size();
+  output.CheckAndAlloc({mshadow::Shape1(nnr)});
+  RType* grad_row_idx = output.aux_data(rowsparse::kIdx).dptr<RType>();
+  GType* grad_data = output.data().dptr<GType>();
+  #pragma omp parallel num_threads(nthreads)
+  {
+    std::vector<DType> acc(row_length);
+    // hot rows have many more lookups than others
+    #pragma omp for schedule(dynamic, 16)
+    for (dim_t r = 0; r < nnr; ++r) {
+      grad_row_idx[r] = static_cast<RType>(unique_rows[r]);
+      const DType* first = ograd + order[offsets[r]] * row_length;
+      std::copy(first, first + row_length, acc.begin());
+      for (dim_t k = offsets[r] + 1; k < offsets[r + 1]; ++k) {
+        const DType* src = ograd + order[k] * row_length;
+        for (dim_t j = 0; j < row_length; ++j) {
+          acc[j] += src[j];
+        }
+      }
+      GType* dst = grad_data + r * row_length;
+      for (dim_t j = 0; j < row_length; ++j) {
+        dst[j] = static_cast<GType>(acc[j]);
+      }
+    }
+  }
+}
+
 template<>
 inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
                                                   const OpContext& ctx,
@@ -348,27 +504,25 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
                                                   const OpReqType req,
                                                   const NDArray& output) {
   using namespace mshadow;
-  using namespace mxnet_op;
-  using namespace mshadow::expr;
   using namespace rowsparse;
   using nnvm::dim_t;
   if (req == kNullOp) return;
   CHECK_EQ(req, kWriteTo) << "SparseEmbedding layer doesn't support "
                           << "weight gradient calculation with req != write";
-
-  // Request temporary storage for marking non-zero rows and prefix sum
+  // the result is deterministic in any case
   Stream<cpu> *s = ctx.get_stream<cpu>();
-  dim_t num_rows = output.shape()[0];
-  dim_t row_length = output.shape()[1];
-  size_t workspace_size = num_rows * sizeof(dim_t);
-  Tensor<cpu, 1, char> workspace =
-    ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(
-      Shape1(workspace_size), s);
-  dim_t* row_flg = reinterpret_cast<dim_t*>(workspace.dptr_);
-  // prefix sum array re-uses the row_flg array temp space
-  dim_t* prefix_sum = row_flg;
-  dim_t data_size = static_cast<dim_t>(data.shape_.Size());
-
+  const dim_t row_length = output.shape()[1];
+  const dim_t data_size = static_cast<dim_t>(data.shape_.Size());
+  if (data_size == 0) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  const bool mixed = output.dtype() != ograd.type_flag_;
+  if (mixed) {
+    CHECK_EQ(ograd.type_flag_, kFloat32);
+    CHECK_EQ(output.dtype(), kFloat16)
+      << "The gradient of an Embedding with out_dtype=float32 must be float16";
+  }
   MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
     MSHADOW_SGL_DBL_TYPE_SWITCH(ograd.type_flag_, DType, {
       MSHADOW_IDX_TYPE_SWITCH(output.aux_type(kIdx), RType, {
@@ -381,37 +535,13 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
           bool is_valid = CheckIndexOutOfBound(data_ptr, data.shape_.Size(), min, max);
           CHECK(is_valid) << "Embedding input contains data out of bound";
         }
-        // mark row flags
-        Fill<false>(s, TBlob(row_flg, Shape1(num_rows), cpu::kDevMask), kWriteTo, 0);
-        Kernel<MarkRowFlgKernel, cpu>::Launch(s, data_size, row_flg, data.dptr<IType>());
-        // calculate inclusive prefix sum
-        // TODO(haibin) ideally this is should be done in parallel
-        prefix_sum[0] = row_flg[0];
-        for (dim_t i = 1; i < num_rows; i++) {
-          prefix_sum[i] = prefix_sum[i - 1] + row_flg[i];
-        }
-        // total number of non-zero rows
-        dim_t nnr = prefix_sum[num_rows - 1];
-        if (nnr == 0) {
-          FillZerosRspImpl(s, output);
-          return;
+        if (mixed) {
+          EmbeddingBackwardRspCPU<IType, DType, half::half_t, RType>(
+              data.dptr<IType>(), data_size, ograd.dptr<DType>(), row_length, output);
+        } else {
+          EmbeddingBackwardRspCPU<IType, DType, DType, RType>(
+              data.dptr<IType>(), data_size, ograd.dptr<DType>(), row_length, output);
         }
-        output.CheckAndAlloc({Shape1(nnr)});
-        RType* grad_row_idx = output.aux_data(kIdx).dptr<RType>();
-        // fill row_idx array of output matrix, using the row_flg values
-        Kernel<FillRspRowIdxKernel, cpu>::Launch(s, num_rows,
-            grad_row_idx, prefix_sum, num_rows);
-        // prefill with zeros
-        DType* grad_data = output.data().dptr<DType>();
-        Fill<false>(s, TBlob(grad_data, Shape1(nnr * row_length),
-            cpu::kDevMask), kWriteTo, 0);
-        // add the final gradients
-        const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-        dim_t segment_len = (nnr + num_threads - 1) / num_threads;
-        Kernel<AddTakeGradRspKernel, cpu>::Launch(s, num_threads, grad_data, prefix_sum,
-                                                  ograd.dptr<DType>(), row_length,
-                                                  data.dptr<IType>(), data_size, segment_len,
-                                                  num_rows);
       });
     });
   });
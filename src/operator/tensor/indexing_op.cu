@@ -172,6 +172,8 @@ void EmbeddingOpForwardDnsImpl<gpu>(mshadow::Stream<gpu>* s,
   using namespace mxnet_op;
   const TShape& ishape = data.shape_;
   const TShape& oshape = output.shape_;
+  CHECK_EQ(weight.type_flag_, output.type_flag_)
+    << "Embedding with out_dtype is only supported on CPU";
 
   MSHADOW_TYPE_SWITCH(output.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
@@ -365,6 +367,8 @@ inline void SparseEmbeddingOpBackwardRspImpl<gpu>(const bool deterministic,
                                                   const TBlob& data,
                                                   const OpReqType req,
                                                   const NDArray& output) {
+  CHECK_EQ(ograd.type_flag_, output.dtype())
+    << "Embedding with out_dtype is only supported on CPU";
   if (deterministic) {
     SparseEmbeddingOpBackwardDeterministicRspImpl(ctx, ograd, data, req, output);
     return;
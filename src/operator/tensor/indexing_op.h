@@ -87,6 +87,7 @@ struct EmbeddingParam: public dmlc::Parameter<EmbeddingParam> {
   int output_dim;
   int dtype;
   bool sparse_grad;
+  int out_dtype;
   DMLC_DECLARE_PARAMETER(EmbeddingParam) {
     DMLC_DECLARE_FIELD(input_dim).set_lower_bound(1)
     .describe("Vocabulary size of the input indices.");
@@ -98,6 +99,12 @@ struct EmbeddingParam: public dmlc::Parameter<EmbeddingParam> {
     DMLC_DECLARE_FIELD(sparse_grad).set_default(false)
     .describe("Compute row sparse gradient in the backward calculation. If set to True, "
               "the grad's storage type is row_sparse.");
+    DMLC_DECLARE_FIELD(out_dtype).set_default(-1)
+    .add_enum("None", -1)
+    .add_enum("float32", mshadow::kFloat32)
+    .describe("Data type of the output, if different from the weight. Only float32 output "
+              "of a float16 weight is supported, on CPU and with sparse_grad=True. The table "
+              "then takes half the memory, and the gradient is accumulated in float32.");
   }
 };
 
@@ -161,6 +168,14 @@ inline bool EmbeddingOpShape(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+inline int EmbeddingOutDType(const EmbeddingParam& param) {
+  return param.out_dtype;
+}
+
+inline int EmbeddingOutDType(const SparseEmbeddingParam& param) {
+  return -1;
+}
+
 template<typename ParamType>
 inline bool EmbeddingOpType(const nnvm::NodeAttrs& attrs,
                             std::vector<int> *in_type,
@@ -170,6 +185,16 @@ inline bool EmbeddingOpType(const nnvm::NodeAttrs& attrs,
   CHECK_GE(out_type->size(), 1U);
   int itype = (*in_type)[0];
   CHECK_NE(itype, -1) << "First input must have specified type";
+  const int out_dtype = EmbeddingOutDType(param);
+  if (out_dtype != -1) {
+    // the weight is stored in a narrower type than the output
+    if ((*in_type)[1] == -1) (*in_type)[1] = param.dtype;
+    CHECK_EQ((*in_type)[1], mshadow::kFloat16)
+      << "Embedding with out_dtype=float32 expects a float16 weight";
+    out_type->clear();
+    out_type->push_back(out_dtype);
+    return true;
+  }
   int dtype_in = (*in_type)[1];
   int dtype_out = (*out_type)[0];
   int dtype = param.dtype;
@@ -357,16 +382,16 @@ struct TakeRspKernel {
    * \param data        input data
    * \param out         output
    * \param weight_idx  indices of rsp weight
-   * \param weight_data data of rsp weight
+   * \param weight_data data of rsp weight, converted to the output type
    * \param row_length  number of elements per row
    * \param nnr         number of non-zero rows
    */
-  template<typename DType, typename IType, typename RType>
+  template<typename DType, typename IType, typename RType, typename WType>
   MSHADOW_XINLINE static void Map(index_t i,
                                   const IType* data,
                                   DType* out,
                                   const RType* weight_idx,
-                                  const DType* weight_data,
+                                  const WType* weight_data,
                                   const nnvm::dim_t row_length,
                                   const nnvm::dim_t nnr) {
     using nnvm::dim_t;
@@ -403,7 +428,8 @@ struct TakeRspKernel {
       }
     } else {
       for (int j = 0; j < row_length; j++) {
-        KERNEL_ASSIGN(out[out_offset + j], req, weight_data[weight_offset + j]);
+        KERNEL_ASSIGN(out[out_offset + j], req,
+                      static_cast<DType>(weight_data[weight_offset + j]));
       }
     }
   }
@@ -417,6 +443,23 @@ inline void EmbeddingOpForwardRspImpl(mshadow::Stream<xpu>* s,
                                       const TBlob& output) {
   using namespace mxnet_op;
   using namespace rowsparse;
+  if (output.type_flag_ != weight.dtype()) {
+    // float16 table with float32 output, see EmbeddingParam::out_dtype
+    CHECK_EQ(output.type_flag_, mshadow::kFloat32);
+    CHECK_EQ(weight.dtype(), mshadow::kFloat16);
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      MSHADOW_TYPE_SWITCH(weight.aux_type(kIdx), RType, {
+        MXNET_ASSIGN_REQ_SWITCH(req, req_t, {
+          Kernel<TakeRspKernel<req_t>, xpu>::Launch(s, data.shape_.Size(), data.dptr<IType>(),
+                                                    output.dptr<float>(),
+                                                    weight.aux_data(kIdx).dptr<RType>(),
+                                                    weight.data().dptr<mshadow::half::half_t>(),
+                                                    weight.shape()[1], weight.aux_shape(kIdx)[0]);
+        });
+      });
+    });
+    return;
+  }
   MSHADOW_TYPE_SWITCH(output.type_flag_, DType, {
     MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
       MSHADOW_TYPE_SWITCH(weight.aux_type(kIdx), RType, {
@@ -519,7 +562,8 @@ void EmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
   CHECK_EQ(outputs.size(), 2U);
   CHECK_EQ(req[embedding::kData], kNullOp)
           << "Embedding layer doesn't support calculate data gradient";
-  CHECK_EQ(outputs[1].type_flag_, inputs[0].type_flag_);
+  CHECK_EQ(outputs[1].type_flag_, inputs[0].type_flag_)
+          << "Embedding with out_dtype requires sparse_grad=True";
 
   const TShape& ishape = inputs[1].shape_;
   const TShape& oshape = inputs[0].shape_;
@@ -608,7 +652,10 @@ void EmbeddingOpBackwardEx(const nnvm::NodeAttrs& attrs,
   const NDArray& ograd = inputs[0];
   const NDArray& data = inputs[1];
   // check dtype
-  CHECK_EQ(weight_grad.dtype(), ograd.dtype());
+  const EmbeddingParam& param = nnvm::get<EmbeddingParam>(attrs.parsed);
+  if (param.out_dtype == -1) {
+    CHECK_EQ(weight_grad.dtype(), ograd.dtype());
+  }
   // check req
   CHECK_EQ(req[embedding::kData], kNullOp)
           << "Embedding layer doesn't support calculate data gradient";
@@ -29,6 +29,7 @@
 #include <cstdlib>
 #include <new>
 #include "mxnet/base.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace storage {
@@ -73,6 +74,16 @@ inline void* CPUDeviceStorage::Alloc(Storage::Handle* handle) {
   ptr = _aligned_malloc(size, alignment_);
   if (ptr == NULL) LOG(FATAL) << "Failed to allocate CPU Memory";
 #else
+  const common::numa::NUMATopology* numa = common::numa::NUMATopology::Get();
+  if (numa->enabled() && size >= numa->page_size()) {
+    // page aligned and padded to whole pages so that the placement policy covers
+    // only this allocation
+    const size_t rounded = numa->RoundToPage(size);
+    int ret = posix_memalign(&ptr, numa->page_size(), rounded);
+    if (ret != 0) LOG(FATAL) << "Failed to allocate CPU Memory";
+    numa->BindMemory(ptr, rounded, numa->NodeOfDevice(handle->ctx.dev_id));
+    return ptr;
+  }
   int ret = posix_memalign(&ptr, alignment_, size);
   if (ret != 0) LOG(FATAL) << "Failed to allocate CPU Memory";
 #endif
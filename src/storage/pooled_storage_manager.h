@@ -35,8 +35,15 @@
 #include <algorithm>
 #include <vector>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <limits>
 #include <new>
+#ifndef _WIN32
+#include <unistd.h>
+#endif  // _WIN32
 #include "./storage_manager.h"
+#include "./cpu_device_storage.h"
 #include "../common/cuda_utils.h"
 #include "../common/utils.h"
 
@@ -333,6 +340,251 @@ void GPUPooledRoundedStorageManager::ReleaseAll() {
 
 #endif  // MXNET_USE_CUDA
 
+/*!
+ * \brief Storage manager with a memory pool, with rounded size, on cpu.
+ *
+ * Sizes are rounded the same way as GPUPooledRoundedStorageManager: exp2 buckets up to
+ * the cutoff, then linear multiples of exp2(cutoff). Freed chunks first go to a small
+ * per-thread cache so that the common alloc/free pairs made by one engine worker never
+ * touch the shared pool lock. Chunks that do not fit into the thread cache are returned
+ * to the shared pool.
+ *
+ * \param cutoff set through MXNET_CPU_MEM_POOL_ROUND_LINEAR_CUTOFF, between 20 (1 MB)
+ * and 34 (16 GB).
+ * \param reserve set through MXNET_CPU_MEM_POOL_RESERVE, the percentage of physical memory
+ * that the pool leaves to the rest of the process. Once the memory held by the pool reaches
+ * this high-water mark, all cached chunks are released before allocating more.
+ * \param thread_cache set through MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE, the number of bytes
+ * each thread may keep in its private cache. 0 disables thread caching.
+ */
+class CPUPooledRoundedStorageManager final : public StorageManager {
+ public:
+  /*!
+   * \brief Default constructor.
+   */
+  CPUPooledRoundedStorageManager() : id_(NextId()) {
+    reserve_ = dmlc::GetEnv("MXNET_CPU_MEM_POOL_RESERVE", 5);
+    page_size_ = dmlc::GetEnv("MXNET_CPU_MEM_POOL_PAGE_SIZE", 64);
+    cut_off_ = dmlc::GetEnv("MXNET_CPU_MEM_POOL_ROUND_LINEAR_CUTOFF", 24);
+    thread_cache_size_ = dmlc::GetEnv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE",
+                                      static_cast<size_t>(4 * 1024 * 1024));
+    if (page_size_ < 16) {
+      LOG(FATAL) << "MXNET_CPU_MEM_POOL_PAGE_SIZE cannot be set to a value smaller than 16. " \
+                 << "Got: " << page_size_ << ".";
+    }
+    if (page_size_ != 1ul << common::ilog2ul(page_size_ - 1)) {
+      LOG(FATAL) << "MXNET_CPU_MEM_POOL_PAGE_SIZE must be a power of 2. Got: " << page_size_ << ".";
+    }
+    page_size_ = common::ilog2ul(page_size_ - 1);
+    if (cut_off_ < 20 || cut_off_ > LOG2_MAX_MEM) {
+      LOG(FATAL) << "MXNET_CPU_MEM_POOL_ROUND_LINEAR_CUTOFF cannot be set to a value " \
+                 << "smaller than 20 or greater than " << LOG2_MAX_MEM << ". Got: " \
+                 << cut_off_ << ".";
+    }
+    if (reserve_ < 0 || reserve_ >= 100) {
+      LOG(FATAL) << "MXNET_CPU_MEM_POOL_RESERVE must be in [0, 100). Got: " << reserve_ << ".";
+    }
+    high_water_mark_ = PhysicalMemorySize() / 100 * (100 - reserve_);
+    memory_pool_ = std::vector<std::vector<void*>>((1ul << (LOG2_MAX_MEM - cut_off_)) + cut_off_);
+  }
+  /*!
+   * \brief Default destructor.
+   */
+  ~CPUPooledRoundedStorageManager() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ReleaseAll();
+  }
+
+  void Alloc(Storage::Handle* handle) override;
+  void Free(Storage::Handle handle) override;
+
+  void DirectFree(Storage::Handle handle) override {
+    if (handle.size > MaxPooledSize()) {
+      CPUDeviceStorage::Free(handle);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    DirectFreeNoLock(handle);
+  }
+
+ private:
+  /*!
+   * \brief Chunks cached by a single thread. Only the owning thread pushes and pops,
+   *  the lock is taken by other threads only when the shared pool is released.
+   */
+  struct ThreadCache {
+    std::mutex mutex;
+    size_t cached_bytes = 0;
+    std::unordered_map<int, std::vector<void*>> chunks;
+  };
+
+  static size_t NextId() {
+    static std::atomic<size_t> counter{0};
+    return counter++;
+  }
+  static size_t PhysicalMemorySize() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    const int64_t pages = sysconf(_SC_PHYS_PAGES);
+    const int64_t page = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page > 0) return static_cast<size_t>(pages) * static_cast<size_t>(page);
+#endif
+    return std::numeric_limits<size_t>::max();
+  }
+
+  inline int div_pow2_round_up(size_t s, int divisor_log2) {
+    size_t result = s >> divisor_log2;
+    return static_cast<int>(result + (s > (result << divisor_log2) ? 1 : 0));
+  }
+  inline int get_bucket(size_t s) {
+    if (s <= (1ul << page_size_)) return static_cast<int>(page_size_);
+    int log_size = common::ilog2ul(s - 1);
+    if (log_size > static_cast<int>(cut_off_))
+      return div_pow2_round_up(s, cut_off_) - 1 + cut_off_;
+    else
+      return std::max(log_size, static_cast<int>(page_size_));
+  }
+  inline size_t get_size(int bucket) {
+    if (bucket <= static_cast<int>(cut_off_))
+      return 1ul << bucket;
+    else
+      return (bucket - cut_off_ + 1) * (1ul << cut_off_);
+  }
+  inline size_t MaxPooledSize() const {
+    return 1ul << LOG2_MAX_MEM;
+  }
+
+  /*! \brief Get the cache of the calling thread, creating it on first use. */
+  ThreadCache* GetThreadCache() {
+    // indexed by manager id, ids are never reused so a stale slot is never revisited
+    static thread_local std::vector<ThreadCache*> caches;
+    if (caches.size() <= id_) caches.resize(id_ + 1, nullptr);
+    if (caches[id_] == nullptr) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      thread_caches_.emplace_back(new ThreadCache());
+      caches[id_] = thread_caches_.back().get();
+    }
+    return caches[id_];
+  }
+
+  void* AllocNoLock(size_t size, Context ctx) {
+    if (used_memory_ + size > high_water_mark_) ReleaseAll();
+    Storage::Handle handle;
+    handle.size = size;
+    handle.ctx = ctx;
+    void* ret = nullptr;
+    try {
+      ret = CPUDeviceStorage::Alloc(&handle);
+    } catch (const dmlc::Error&) {
+      // retry once after giving all cached memory back to the system
+      ReleaseAll();
+      ret = CPUDeviceStorage::Alloc(&handle);
+    }
+    used_memory_ += size;
+    return ret;
+  }
+
+  void DirectFreeNoLock(Storage::Handle handle) {
+    size_t size = get_size(get_bucket(handle.size));
+    CPUDeviceStorage::Free(handle);
+    used_memory_ -= size;
+  }
+
+ private:
+  void ReleaseAll();
+  // log2 of maximum pooled size. 16GB
+  const size_t LOG2_MAX_MEM = 34;
+  // unique id of this manager, used to index the thread local caches
+  const size_t id_;
+  // used memory
+  size_t used_memory_ = 0;
+  // memory in use above which all cached chunks are released
+  size_t high_water_mark_;
+  // page size
+  size_t page_size_;
+  // log2 of memory size before switching to exponential mode to linear mode
+  size_t cut_off_;
+  // percentage of physical memory to leave outside of the pool
+  int reserve_;
+  // maximum number of bytes cached by each thread
+  size_t thread_cache_size_;
+  // guards memory_pool_, thread_caches_ and used_memory_
+  std::mutex mutex_;
+  // shared memory pool
+  std::vector<std::vector<void*>> memory_pool_;
+  // all per-thread caches created by this manager
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_;
+  DISALLOW_COPY_AND_ASSIGN(CPUPooledRoundedStorageManager);
+};  // class CPUPooledRoundedStorageManager
+
+inline void CPUPooledRoundedStorageManager::Alloc(Storage::Handle* handle) {
+  if (handle->size > MaxPooledSize()) {
+    handle->dptr = CPUDeviceStorage::Alloc(handle);
+    return;
+  }
+  int bucket = get_bucket(handle->size);
+  size_t size = get_size(bucket);
+  if (thread_cache_size_ > 0 && size <= thread_cache_size_) {
+    ThreadCache* cache = GetThreadCache();
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto it = cache->chunks.find(bucket);
+    if (it != cache->chunks.end() && !it->second.empty()) {
+      handle->dptr = it->second.back();
+      it->second.pop_back();
+      cache->cached_bytes -= size;
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto&& reuse_pool = memory_pool_[bucket];
+  if (reuse_pool.size() == 0) {
+    handle->dptr = AllocNoLock(size, handle->ctx);
+  } else {
+    handle->dptr = reuse_pool.back();
+    reuse_pool.pop_back();
+  }
+}
+
+inline void CPUPooledRoundedStorageManager::Free(Storage::Handle handle) {
+  if (handle.size > MaxPooledSize()) {
+    CPUDeviceStorage::Free(handle);
+    return;
+  }
+  int bucket = get_bucket(handle.size);
+  size_t size = get_size(bucket);
+  if (thread_cache_size_ > 0 && size <= thread_cache_size_) {
+    ThreadCache* cache = GetThreadCache();
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    if (cache->cached_bytes + size <= thread_cache_size_) {
+      cache->chunks[bucket].push_back(handle.dptr);
+      cache->cached_bytes += size;
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  memory_pool_[bucket].push_back(handle.dptr);
+}
+
+inline void CPUPooledRoundedStorageManager::ReleaseAll() {
+  for (auto&& cache : thread_caches_) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    for (auto&& i : cache->chunks) {
+      for (auto&& j : i.second) memory_pool_[i.first].push_back(j);
+      i.second.clear();
+    }
+    cache->cached_bytes = 0;
+  }
+  for (size_t i = 0; i < memory_pool_.size(); i++) {
+    size_t size = get_size(i);
+    for (auto& j : memory_pool_[i]) {
+      Storage::Handle handle;
+      handle.size = size;
+      handle.dptr = j;
+      DirectFreeNoLock(handle);
+    }
+    memory_pool_[i].clear();
+  }
+}
+
 }  // namespace storage
 }  // namespace mxnet
 
@@ -21,6 +21,7 @@
  * Copyright (c) 2015 by Contributors
  */
 #include <mxnet/storage.h>
+#include <string>
 #include "./storage_manager.h"
 #include "./naive_storage_manager.h"
 #include "./pooled_storage_manager.h"
@@ -32,6 +33,28 @@
 
 namespace mxnet {
 
+namespace storage {
+/*!
+ * \brief Create the storage manager for plain host memory according to
+ *  MXNET_CPU_MEM_POOL_TYPE.
+ */
+static StorageManager* CreateCPUStorageManager() {
+  const char *type = getenv("MXNET_CPU_MEM_POOL_TYPE");
+  const bool default_pool = (type == nullptr);
+  if (default_pool) type = "Naive";
+  std::string strategy = type;
+
+  if (strategy == "Round") {
+    LOG(INFO) << "Using CPUPooledRoundedStorageManager.";
+    return new CPUPooledRoundedStorageManager();
+  }
+  if (strategy != "Naive") {
+    LOG(FATAL) << "Unknown memory pool strategy specified: " << strategy << ".";
+  }
+  return new NaiveStorageManager<CPUDeviceStorage>();
+}
+}  // namespace storage
+
 // consider change storage as a pure abstract class
 class StorageImpl : public Storage {
  public:
@@ -65,7 +88,7 @@ void StorageImpl::Alloc(Storage::Handle* handle) {
         storage::StorageManager *ptr = nullptr;
         switch (handle->ctx.dev_type) {
           case Context::kCPU: {
-            ptr = new storage::NaiveStorageManager<storage::CPUDeviceStorage>();
+            ptr = storage::CreateCPUStorageManager();
             break;
           }
           case Context::kCPUShared: {
@@ -86,10 +109,10 @@ void StorageImpl::Alloc(Storage::Handle* handle) {
             if (num_gpu_device > 0) {
               ptr = new storage::NaiveStorageManager<storage::PinnedMemoryStorage>();
             } else {
-              ptr = new storage::NaiveStorageManager<storage::CPUDeviceStorage>();
+              ptr = storage::CreateCPUStorageManager();
             }
 #else
-            ptr = new storage::NaiveStorageManager<storage::CPUDeviceStorage>();
+            ptr = storage::CreateCPUStorageManager();
 #endif  // MXNET_USE_CUDA
             break;
           }
@@ -118,7 +141,7 @@ void StorageImpl::Alloc(Storage::Handle* handle) {
             break;
           }
           case Context::kNNP: {
-            ptr = new storage::NaiveStorageManager<storage::CPUDeviceStorage>();
+            ptr = storage::CreateCPUStorageManager();
             break;
           }
           default: LOG(FATAL) <<  "Unimplemented device " << handle->ctx.dev_type;
@@ -29,12 +29,15 @@
 #include <gtest/gtest.h>
 #include <mxnet/engine.h>
 #include <dmlc/timer.h>
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <thread>
 #include <chrono>
 #include <vector>
 
 #include "../src/engine/engine_impl.h"
+#include "../src/engine/work_stealing_deque.h"
 #include "../include/test_util.h"
 
 /**
@@ -122,12 +125,14 @@ double EvaluateWorloads(const std::vector<Workload>& workloads,
 }
 
 TEST(Engine, start_stop) {
-  const int num_engine = 3;
+  const int num_engine = 4;
   std::vector<mxnet::Engine*> engine(num_engine);
   engine[0] = mxnet::engine::CreateNaiveEngine();
   engine[1] = mxnet::engine::CreateThreadedEnginePooled();
   engine[2] = mxnet::engine::CreateThreadedEnginePerDevice();
-  std::string type_names[3] = {"NaiveEngine", "ThreadedEnginePooled", "ThreadedEnginePerDevice"};
+  engine[3] = mxnet::engine::CreateThreadedEngineWorkStealing();
+  std::string type_names[4] = {"NaiveEngine", "ThreadedEnginePooled", "ThreadedEnginePerDevice",
+                               "ThreadedEngineWorkStealing"};
 
   for (int i = 0; i < num_engine; ++i) {
     LOG(INFO) << "Stopping: " << type_names[i];
@@ -141,7 +146,7 @@ TEST(Engine, start_stop) {
 TEST(Engine, RandSumExpr) {
   std::vector<Workload> workloads;
   int num_repeat = 5;
-  const int num_engine = 4;
+  const int num_engine = 5;
 
   std::vector<double> t(num_engine, 0.0);
   std::vector<mxnet::Engine*> engine(num_engine);
@@ -150,6 +155,7 @@ TEST(Engine, RandSumExpr) {
   engine[1] = mxnet::engine::CreateNaiveEngine();
   engine[2] = mxnet::engine::CreateThreadedEnginePooled();
   engine[3] = mxnet::engine::CreateThreadedEnginePerDevice();
+  engine[4] = mxnet::engine::CreateThreadedEngineWorkStealing();
 
   for (int repeat = 0; repeat < num_repeat; ++repeat) {
     srand(time(NULL) + repeat);
@@ -172,6 +178,106 @@ TEST(Engine, RandSumExpr) {
   LOG(INFO) << "NaiveEngine\t\t"  << t[1] << " sec";
   LOG(INFO) << "ThreadedEnginePooled\t" << t[2] << " sec";
   LOG(INFO) << "ThreadedEnginePerDevice\t" << t[3] << " sec";
+  LOG(INFO) << "ThreadedEngineWorkStealing\t" << t[4] << " sec";
+}
+
+// Microbenchmark of the engine overhead: several threads push many empty operations,
+// mostly reading shared variables as imperative code does, and the rate at which they
+// are pushed and completed is reported.
+TEST(Engine, PushThroughput) {
+  const int num_pushers = 4;
+  const int num_ops = 50000;
+  const int num_shared = 8;
+  const int write_every = 16;
+  const int num_engine = 3;
+  std::vector<mxnet::Engine*> engine(num_engine);
+  engine[0] = mxnet::engine::CreateThreadedEnginePooled();
+  engine[1] = mxnet::engine::CreateThreadedEnginePerDevice();
+  engine[2] = mxnet::engine::CreateThreadedEngineWorkStealing();
+  std::string type_names[3] = {"ThreadedEnginePooled", "ThreadedEnginePerDevice",
+                               "ThreadedEngineWorkStealing"};
+
+  for (int i = 0; i < num_engine; ++i) {
+    std::vector<mxnet::Engine::VarHandle> shared_vars, own_vars;
+    for (int j = 0; j < num_shared; ++j) shared_vars.push_back(engine[i]->NewVariable());
+    for (int j = 0; j < num_pushers; ++j) own_vars.push_back(engine[i]->NewVariable());
+    // only touched by operations writing the corresponding variable
+    std::vector<int> shared_count(num_shared, 0), own_count(num_pushers, 0);
+
+    std::vector<double> push_time(num_pushers);
+    const double start = dmlc::GetTime();
+    std::vector<std::thread> pushers;
+    for (int t = 0; t < num_pushers; ++t) {
+      pushers.emplace_back([&, t]() {
+        const double push_start = dmlc::GetTime();
+        for (int k = 0; k < num_ops; ++k) {
+          const int s = (k + t) % num_shared;
+          if (k % write_every == 0) {
+            int* count = &shared_count[s];
+            engine[i]->PushSync([count](mxnet::RunContext) { ++*count; },
+                                mxnet::Context{}, {}, {shared_vars[s]});
+          } else {
+            int* count = &own_count[t];
+            engine[i]->PushSync([count](mxnet::RunContext) { ++*count; },
+                                mxnet::Context{}, {shared_vars[s]}, {own_vars[t]});
+          }
+        }
+        push_time[t] = dmlc::GetTime() - push_start;
+      });
+    }
+    for (auto& p : pushers) p.join();
+    engine[i]->WaitForAll();
+    const double total_time = dmlc::GetTime() - start;
+    const double max_push_time = *std::max_element(push_time.begin(), push_time.end());
+
+    int num_writes = 0;
+    for (int c : shared_count) num_writes += c;
+    for (int t = 0; t < num_pushers; ++t) {
+      EXPECT_EQ(own_count[t], num_ops - (num_ops + write_every - 1) / write_every);
+    }
+    EXPECT_EQ(num_writes, num_pushers * ((num_ops + write_every - 1) / write_every));
+
+    const double total_ops = static_cast<double>(num_pushers) * num_ops;
+    LOG(INFO) << type_names[i] << "\tpushed " << total_ops / max_push_time << " ops/sec, "
+              << "completed " << total_ops / total_time << " ops/sec";
+    for (auto var : shared_vars) {
+      engine[i]->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context{}, var);
+    }
+    for (auto var : own_vars) {
+      engine[i]->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context{}, var);
+    }
+    engine[i]->WaitForAll();
+  }
+}
+
+TEST(Engine, WorkStealingDeque) {
+  const int num_items = 100000;
+  const int num_thieves = 4;
+  mxnet::engine::WorkStealingDeque<int> deque(2);
+  std::vector<std::atomic<int>> seen(num_items);
+  for (auto &s : seen) s = 0;
+  std::atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < num_thieves; ++i) {
+    thieves.emplace_back([&]() {
+      int item;
+      while (!done || deque.size() > 0) {
+        if (deque.Steal(&item)) ++seen[item];
+      }
+    });
+  }
+  // the owner interleaves pushes and pops so that both ends race, and the deque grows
+  int item;
+  for (int i = 0; i < num_items; ++i) {
+    deque.PushBottom(i);
+    if (i % 3 == 0 && deque.PopBottom(&item)) ++seen[item];
+  }
+  while (deque.PopBottom(&item)) ++seen[item];
+  done = true;
+  for (auto &t : thieves) t.join();
+  for (int i = 0; i < num_items; ++i) {
+    EXPECT_EQ(seen[i], 1) << "item " << i;
+  }
 }
 
 void Foo(mxnet::RunContext, int i) { printf("The fox says %d\n", i); }
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * Copyright (c) 2019 by Contributors
+ * \file numa_test.cc
+ * \brief NUMA topology helper tests
+ */
+#include <gtest/gtest.h>
+#include <vector>
+#include "../../src/common/numa.h"
+
+using mxnet::common::numa::NUMATopology;
+using mxnet::common::numa::ParseCPUList;
+
+TEST(NUMA, ParseCPUList) {
+  EXPECT_EQ(ParseCPUList("0"), std::vector<int>({0}));
+  EXPECT_EQ(ParseCPUList("0-3"), std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(ParseCPUList("0-1,4-5"), std::vector<int>({0, 1, 4, 5}));
+  EXPECT_EQ(ParseCPUList("2,7,9-10"), std::vector<int>({2, 7, 9, 10}));
+  // sysfs lines may keep their trailing newline
+  EXPECT_EQ(ParseCPUList("0-1,\n"), std::vector<int>({0, 1}));
+  EXPECT_TRUE(ParseCPUList("").empty());
+}
+
+TEST(NUMA, NodeOfDevice) {
+  const NUMATopology* numa = NUMATopology::Get();
+  const int num_nodes = numa->num_nodes();
+  ASSERT_GE(num_nodes, 1);
+  EXPECT_EQ(numa->NodeOfDevice(-1), 0);
+  for (int dev_id = 0; dev_id < 4 * num_nodes; ++dev_id) {
+    EXPECT_EQ(numa->NodeOfDevice(dev_id), dev_id % num_nodes);
+  }
+  EXPECT_EQ(numa->NodeOfDevice(num_nodes), 0);
+}
+
+TEST(NUMA, RoundToPage) {
+  const NUMATopology* numa = NUMATopology::Get();
+  const size_t page = numa->page_size();
+  EXPECT_EQ(numa->RoundToPage(0), 0U);
+  EXPECT_EQ(numa->RoundToPage(1), page);
+  EXPECT_EQ(numa->RoundToPage(page), page);
+  EXPECT_EQ(numa->RoundToPage(page + 1), 2 * page);
+}
@@ -33,6 +33,7 @@
 #include "mxnet/imperative.h"
 #include "../../src/operator/nn/mkldnn/mkldnn_ops-inl.h"
 #include "../../src/operator/nn/mkldnn/mkldnn_base-inl.h"
+#include "../../src/operator/nn/mkldnn/mkldnn_primitive_cache-inl.h"
 #include "../include/test_mkldnn.h"
 
 using namespace mxnet;
@@ -51,6 +52,58 @@ bool test_mem_align(void *mem, size_t size, size_t alignment, size_t space) {
 }
 #endif
 
+TEST(MKLDNN_UTIL_FUNC, PrimitiveCache) {
+  mxnet::op::MKLDNNPrimitiveCache<int, std::vector<int>, std::hash<int>> cache("test");
+  int created = 0;
+  auto create = [&created]() {
+    ++created;
+    return std::vector<int>(1, created);
+  };
+  {
+    auto a = cache.Get(1, create);
+    // the first instance is still checked out, so a second one is created
+    auto b = cache.Get(1, create);
+    EXPECT_NE(a.get(), b.get());
+    EXPECT_EQ(created, 2);
+    EXPECT_EQ(cache.misses(), 2U);
+  }
+  // both instances are back in the cache and get reused
+  auto c = cache.Get(1, create);
+  EXPECT_EQ(created, 2);
+  EXPECT_EQ(cache.hits(), 1U);
+  auto d = cache.Get(2, create);
+  EXPECT_EQ(created, 3);
+  EXPECT_EQ(cache.size(), 3U);
+}
+
+TEST(MKLDNN_UTIL_FUNC, PrimitiveCacheEviction) {
+  mxnet::op::MKLDNNPrimitiveCache<int, std::vector<int>, std::hash<int>> cache("test", 2);
+  int created = 0;
+  auto create = [&created]() {
+    ++created;
+    return std::vector<int>(1, created);
+  };
+  cache.Get(1, create);
+  cache.Get(2, create);
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.evictions(), 0U);
+  {
+    // the idle instance of the least recently used signature 1 is dropped
+    auto c = cache.Get(3, create);
+    EXPECT_EQ(cache.evictions(), 1U);
+    EXPECT_EQ(cache.size(), 2U);
+    auto d = cache.Get(2, create);
+    EXPECT_EQ(cache.hits(), 1U);
+    auto e = cache.Get(1, create);
+    EXPECT_EQ(created, 4);
+    // checked out instances are never evicted, so the cache may exceed its capacity
+    EXPECT_EQ(cache.size(), 3U);
+  }
+  // back under the capacity once the instances are returned
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.evictions(), 2U);
+}
+
 TEST(MKLDNN_UTIL_FUNC, AlignMem) {
 #if __GNUC__ >= 5
   size_t alignment = 4096;
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ *  \file vectorized_kernel_perf.cc
+ *  \brief Timing of the packet (MapVec) clones of CPU elementwise kernels against the
+ *   per-element Map() path. Run with --perf for larger sizes and more repetitions.
+ */
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/test_util.h"
+#include "operator/mshadow_op.h"
+#include "operator/mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace {
+
+const char *ISAName(const KernelISA isa) {
+  switch (isa) {
+    case KernelISA::kNone: return "Map";
+    case KernelISA::kGeneric: return "generic";
+    case KernelISA::kAVX2: return "AVX2";
+    case KernelISA::kAVX512: return "AVX-512";
+  }
+  return "";
+}
+
+/*! \brief microseconds per call of f, best of several repetitions */
+template<typename F>
+double TimeUs(const int reps, F f) {
+  double best = 0;
+  for (int r = 0; r < reps; ++r) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const double us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+    if (r == 0 || us < best) best = us;
+  }
+  return best;
+}
+
+template<typename OP, typename ...Args>
+void TimeOp(const std::string &name, const index_t n, const int reps, Args... args) {
+  std::vector<KernelISA> isas = {KernelISA::kNone, KernelISA::kGeneric};
+  const KernelISA best = GetKernelISA();
+  if (best == KernelISA::kAVX2 || best == KernelISA::kAVX512) isas.push_back(KernelISA::kAVX2);
+  if (best == KernelISA::kAVX512) isas.push_back(KernelISA::kAVX512);
+  double base = 0;
+  for (const KernelISA isa : isas) {
+    const double us = TimeUs(reps, [&]() {
+      mxnet_op::Kernel<OP, cpu>::template MapRange<float>(isa, 0, n, args...);
+    });
+    if (isa == KernelISA::kNone) base = us;
+    std::cout << std::setw(20) << name << std::setw(10) << n << std::setw(10) << ISAName(isa)
+              << std::setw(12) << std::fixed << std::setprecision(1) << us << " us"
+              << std::setw(8) << std::setprecision(2) << base / us << "x" << std::endl;
+  }
+}
+
+}  // namespace
+
+TEST(VECTORIZED_KERNEL_PERF, TimingCPU) {
+  using mxnet_op::op_with_req;
+  std::vector<index_t> sizes;
+  int reps;
+  if (test::performance_run) {
+    sizes = {1 << 12, 1 << 16, 1 << 20, 1 << 24};
+    reps = 20;
+  } else {
+    sizes = {1 << 12, 1 << 16};
+    reps = 3;
+  }
+  for (const index_t n : sizes) {
+    std::vector<float> a(n, 0.25f), b(n, -1.5f), out(n, 1.f);
+    // activations
+    TimeOp<op_with_req<mshadow_op::relu, kWriteTo>>("relu", n, reps, out.data(), b.data());
+    TimeOp<op_with_req<mshadow_op::sigmoid, kWriteTo>>("sigmoid", n, reps,
+                                                        out.data(), b.data());
+    // binary elementwise
+    TimeOp<op_with_req<mshadow_op::plus, kWriteTo>>("plus", n, reps,
+                                                     out.data(), a.data(), b.data());
+    // an SGD-like step, out += grad * -lr
+    TimeOp<op_with_req<mshadow_op::mul, kAddTo>>("mul_scalar addto", n, reps,
+                                                  out.data(), b.data(), -0.01f);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ *  \file vectorized_kernel_test.cc
+ *  \brief Test the packet (MapVec) form of CPU elementwise kernels against Map()
+ */
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "operator/mshadow_op.h"
+#include "operator/mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace {
+
+const std::vector<index_t> kSizes = {1, 3, 15, 16, 17, 255, 1000, 100003};
+
+std::vector<KernelISA> SupportedISAs() {
+  std::vector<KernelISA> isas = {KernelISA::kNone, KernelISA::kGeneric};
+  const KernelISA best = GetKernelISA();
+  if (best == KernelISA::kAVX2 || best == KernelISA::kAVX512) isas.push_back(KernelISA::kAVX2);
+  if (best == KernelISA::kAVX512) isas.push_back(KernelISA::kAVX512);
+  return isas;
+}
+
+template<typename DType>
+std::vector<DType> RandomVector(const index_t n, std::mt19937 *rng) {
+  std::uniform_real_distribution<double> dist(-4, 4);
+  std::vector<DType> v(n);
+  for (auto &x : v) x = static_cast<DType>(dist(*rng));
+  return v;
+}
+
+template<typename DType>
+void CheckBinary() {
+  using mxnet_op::Kernel;
+  using mxnet_op::op_with_req;
+  std::mt19937 rng(0);
+  for (const index_t n : kSizes) {
+    const auto lhs = RandomVector<DType>(n, &rng);
+    const auto rhs = RandomVector<DType>(n, &rng);
+    const auto init = RandomVector<DType>(n, &rng);
+    for (const KernelISA isa : SupportedISAs()) {
+      std::vector<DType> out(init);
+      Kernel<op_with_req<mshadow_op::mul, kWriteTo>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), lhs.data(), rhs.data());
+      for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], lhs[i] * rhs[i]);
+
+      out = init;
+      Kernel<op_with_req<mshadow_op::plus, kAddTo>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), lhs.data(), rhs.data());
+      for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], init[i] + (lhs[i] + rhs[i]));
+
+      // out + lhs * rhs could be contracted into an FMA, which rounds differently;
+      // every clone must match the per-element path bit for bit
+      std::vector<DType> expected(init);
+      Kernel<op_with_req<mshadow_op::mul, kAddTo>, cpu>::MapRange<DType>(
+          KernelISA::kNone, 0, n, expected.data(), lhs.data(), rhs.data());
+      out = init;
+      Kernel<op_with_req<mshadow_op::mul, kAddTo>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), lhs.data(), rhs.data());
+      for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], expected[i]);
+
+      // in-place, the output is the lhs
+      out = lhs;
+      Kernel<op_with_req<mshadow_op::minus, kWriteInplace>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), out.data(), rhs.data());
+      for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], lhs[i] - rhs[i]);
+    }
+  }
+}
+
+template<typename DType>
+void CheckUnaryAndScalar() {
+  using mxnet_op::Kernel;
+  using mxnet_op::op_with_req;
+  std::mt19937 rng(1);
+  for (const index_t n : kSizes) {
+    const auto in = RandomVector<DType>(n, &rng);
+    const auto init = RandomVector<DType>(n, &rng);
+    // an unaligned start exercises the loop peeling of the vectorized clones
+    const index_t begin = n > 1 ? 1 : 0;
+    for (const KernelISA isa : SupportedISAs()) {
+      std::vector<DType> out(init);
+      Kernel<op_with_req<mshadow_op::relu, kWriteTo>, cpu>::MapRange<DType>(
+          isa, begin, n - begin, out.data(), in.data());
+      for (index_t i = 0; i < n; ++i) {
+        ASSERT_EQ(out[i], i < begin ? init[i] : mshadow_op::relu::Map(in[i]));
+      }
+
+      // a scalar that is not a power of two, so that a contracted FMA would round differently
+      std::vector<DType> expected(init);
+      Kernel<op_with_req<mshadow_op::mul, kAddTo>, cpu>::MapRange<DType>(
+          KernelISA::kNone, 0, n, expected.data(), in.data(), DType(0.3));
+      out = init;
+      Kernel<op_with_req<mshadow_op::mul, kAddTo>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), in.data(), DType(0.3));
+      for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], expected[i]);
+
+      out = init;
+      Kernel<op_with_req<mshadow_op::sigmoid, kWriteTo>, cpu>::MapRange<DType>(
+          isa, 0, n, out.data(), in.data());
+      for (index_t i = 0; i < n; ++i) {
+        ASSERT_NEAR(out[i], mshadow_op::sigmoid::Map(in[i]), 1e-6);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(VectorizedKernel, Binary) {
+  CheckBinary<float>();
+  CheckBinary<double>();
+  CheckBinary<int32_t>();
+}
+
+TEST(VectorizedKernel, UnaryAndScalar) {
+  CheckUnaryAndScalar<float>();
+  CheckUnaryAndScalar<double>();
+}
+
+TEST(VectorizedKernel, Launch) {
+  using mxnet_op::Kernel;
+  using mxnet_op::op_with_req;
+  const index_t n = 1 << 20;
+  std::mt19937 rng(2);
+  const auto lhs = RandomVector<float>(n, &rng);
+  const auto rhs = RandomVector<float>(n, &rng);
+  std::vector<float> out(n);
+  Kernel<op_with_req<mshadow_op::plus, kWriteTo>, cpu>::Launch(
+      nullptr, n, out.data(), lhs.data(), rhs.data());
+  for (index_t i = 0; i < n; ++i) ASSERT_EQ(out[i], lhs[i] + rhs[i]);
+}
+
+}  // namespace op
+}  // namespace mxnet
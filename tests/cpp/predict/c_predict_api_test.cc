@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * Copyright (c) 2019 by Contributors
+ * \file c_predict_api_test.cc
+ * \brief tests of the thread-safe predict API
+ */
+#include <gtest/gtest.h>
+#include <dmlc/memory_io.h>
+#include <mxnet/c_predict_api.h>
+#include <mxnet/ndarray.h>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kNumHidden = 4;
+const int kNumInput = 6;
+
+// tanh(FullyConnected(data, num_hidden=4))
+const char kSymbolJSON[] =
+  "{\"nodes\": ["
+  "{\"op\": \"null\", \"name\": \"data\", \"inputs\": []},"
+  "{\"op\": \"null\", \"name\": \"fc_weight\", \"inputs\": []},"
+  "{\"op\": \"null\", \"name\": \"fc_bias\", \"inputs\": []},"
+  "{\"op\": \"FullyConnected\", \"name\": \"fc\", \"attrs\": {\"num_hidden\": \"4\"},"
+  " \"inputs\": [[0, 0, 0], [1, 0, 0], [2, 0, 0]]},"
+  "{\"op\": \"Activation\", \"name\": \"act\", \"attrs\": {\"act_type\": \"tanh\"},"
+  " \"inputs\": [[3, 0, 0]]}],"
+  "\"arg_nodes\": [0, 1, 2],"
+  "\"node_row_ptr\": [0, 1, 2, 3, 4, 5],"
+  "\"heads\": [[4, 0, 0]],"
+  "\"attrs\": {\"mxnet_version\": [\"int\", 10400]}}";
+
+// parameter file of the network above, in the format MXNDArraySave writes
+std::string MakeParams() {
+  std::vector<mx_float> weight(kNumHidden * kNumInput), bias(kNumHidden);
+  for (size_t i = 0; i < weight.size(); ++i) weight[i] = 0.1f * (static_cast<int>(i % 7) - 3);
+  for (size_t i = 0; i < bias.size(); ++i) bias[i] = 0.05f * i;
+  mxnet::NDArray w(mxnet::TShape({kNumHidden, kNumInput}), mxnet::Context::CPU());
+  mxnet::NDArray b(mxnet::TShape({kNumHidden}), mxnet::Context::CPU());
+  w.SyncCopyFromCPU(weight.data(), weight.size());
+  b.SyncCopyFromCPU(bias.data(), bias.size());
+  std::string params;
+  dmlc::MemoryStringStream strm(&params);
+  mxnet::NDArray::Save(&strm, {w, b}, {"arg:fc_weight", "arg:fc_bias"});
+  return params;
+}
+
+// input of the i-th sample
+std::vector<mx_float> MakeSample(int i) {
+  std::vector<mx_float> sample(kNumInput);
+  for (int j = 0; j < kNumInput; ++j) sample[j] = std::sin(0.3f * i + j);
+  return sample;
+}
+
+// outputs of a plain single-threaded predictor, one sample at a time
+std::vector<std::vector<mx_float>> Reference(const std::string& params, int num_samples) {
+  const char* keys[] = {"data"};
+  const mx_uint indptr[] = {0, 2};
+  const mx_uint shape[] = {1, kNumInput};
+  PredictorHandle pred;
+  EXPECT_EQ(MXPredCreate(kSymbolJSON, params.data(), params.size(), 1, 0,
+                         1, keys, indptr, shape, &pred), 0) << MXGetLastError();
+  std::vector<std::vector<mx_float>> ret;
+  for (int i = 0; i < num_samples; ++i) {
+    const std::vector<mx_float> sample = MakeSample(i);
+    std::vector<mx_float> out(kNumHidden);
+    EXPECT_EQ(MXPredSetInput(pred, "data", sample.data(), sample.size()), 0);
+    EXPECT_EQ(MXPredForward(pred), 0);
+    EXPECT_EQ(MXPredGetOutput(pred, 0, out.data(), out.size()), 0);
+    ret.push_back(out);
+  }
+  MXPredFree(pred);
+  return ret;
+}
+
+}  // namespace
+
+TEST(PredictAPI, PoolMatchesPredictor) {
+  const int kNumThreads = 4;
+  const int kSamplesPerThread = 16;
+  const std::string params = MakeParams();
+  const auto expected = Reference(params, kNumThreads * kSamplesPerThread);
+
+  const char* keys[] = {"data"};
+  const mx_uint indptr[] = {0, 2};
+  const mx_uint shape[] = {1, kNumInput};
+  PredictorPoolHandle pool;
+  // fewer predictors than threads, so that callers also wait for a free one
+  ASSERT_EQ(MXPredPoolCreate(kSymbolJSON, params.data(), params.size(), 1, 0,
+                             1, keys, indptr, shape, 2, &pool), 0) << MXGetLastError();
+  mx_uint* out_shape;
+  mx_uint out_ndim;
+  ASSERT_EQ(MXPredPoolGetOutputShape(pool, 0, &out_shape, &out_ndim), 0);
+  ASSERT_EQ(out_ndim, 2U);
+  EXPECT_EQ(out_shape[0], 1U);
+  EXPECT_EQ(out_shape[1], static_cast<mx_uint>(kNumHidden));
+
+  std::vector<std::vector<mx_float>> outputs(expected.size());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int s = 0; s < kSamplesPerThread; ++s) {
+        const int i = t * kSamplesPerThread + s;
+        const std::vector<mx_float> sample = MakeSample(i);
+        outputs[i].resize(kNumHidden);
+        const mx_float* input_data[] = {sample.data()};
+        const mx_uint input_sizes[] = {static_cast<mx_uint>(sample.size())};
+        mx_float* output_data[] = {outputs[i].data()};
+        const mx_uint output_sizes[] = {static_cast<mx_uint>(kNumHidden)};
+        EXPECT_EQ(MXPredPoolPredict(pool, input_data, input_sizes,
+                                    1, output_data, output_sizes), 0) << MXGetLastError();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    for (int j = 0; j < kNumHidden; ++j) {
+      EXPECT_NEAR(outputs[i][j], expected[i][j], 1e-6) << "sample " << i;
+    }
+  }
+  EXPECT_EQ(MXPredPoolFree(pool), 0);
+}
+
+namespace {
+
+// value of a "  name: value" line of the batcher statistics
+uint64_t BatcherStat(const std::string& stats, const std::string& name) {
+  const size_t pos = stats.find("  " + name + ":");
+  if (pos == std::string::npos) return 0;
+  return std::stoull(stats.substr(pos + name.size() + 3));
+}
+
+// sum of size * count over the batch size histogram of the batcher statistics
+uint64_t BatchedRequests(const std::string& stats) {
+  std::istringstream is(stats.substr(stats.find("batch size histogram:"),
+                                     stats.find("queue depth histogram:") -
+                                     stats.find("batch size histogram:")));
+  std::string line;
+  std::getline(is, line);
+  uint64_t total = 0;
+  while (std::getline(is, line)) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    total += std::stoull(line.substr(0, colon)) * std::stoull(line.substr(colon + 1));
+  }
+  return total;
+}
+
+PredictorBatcherHandle CreateBatcher(const std::string& params, mx_uint max_batch_size,
+                                     mx_uint max_delay_us, mx_uint num_workers) {
+  const char* keys[] = {"data"};
+  const mx_uint indptr[] = {0, 1};
+  // shape of one sample, without the batch dimension
+  const mx_uint shape[] = {kNumInput};
+  PredictorBatcherHandle batcher = nullptr;
+  EXPECT_EQ(MXPredBatcherCreate(kSymbolJSON, params.data(), params.size(), 1, 0,
+                                1, keys, indptr, shape, max_batch_size, max_delay_us,
+                                num_workers, &batcher), 0) << MXGetLastError();
+  return batcher;
+}
+
+int BatcherPredict(PredictorBatcherHandle batcher, int i, std::vector<mx_float>* out) {
+  const std::vector<mx_float> sample = MakeSample(i);
+  out->resize(kNumHidden);
+  const mx_float* input_data[] = {sample.data()};
+  const mx_uint input_sizes[] = {static_cast<mx_uint>(sample.size())};
+  mx_float* output_data[] = {out->data()};
+  const mx_uint output_sizes[] = {static_cast<mx_uint>(kNumHidden)};
+  return MXPredBatcherPredict(batcher, input_data, input_sizes, 1, output_data, output_sizes);
+}
+
+}  // namespace
+
+TEST(PredictAPI, BatcherMatchesPredictor) {
+  const int kNumThreads = 16;
+  const int kSamplesPerThread = 4;
+  const mx_uint kMaxBatchSize = 8;
+  const std::string params = MakeParams();
+  const auto expected = Reference(params, kNumThreads * kSamplesPerThread);
+  // a long delay, so that batches are flushed because they are full
+  PredictorBatcherHandle batcher = CreateBatcher(params, kMaxBatchSize, 200000, 2);
+  ASSERT_NE(batcher, nullptr);
+  mx_uint* out_shape;
+  mx_uint out_ndim;
+  ASSERT_EQ(MXPredBatcherGetOutputShape(batcher, 0, &out_shape, &out_ndim), 0);
+  ASSERT_EQ(out_ndim, 1U);
+  EXPECT_EQ(out_shape[0], static_cast<mx_uint>(kNumHidden));
+
+  std::vector<std::vector<mx_float>> outputs(expected.size());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int s = 0; s < kSamplesPerThread; ++s) {
+        const int i = t * kSamplesPerThread + s;
+        EXPECT_EQ(BatcherPredict(batcher, i, &outputs[i]), 0) << MXGetLastError();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (size_t i = 0; i < expected.size(); ++i) {
+    for (int j = 0; j < kNumHidden; ++j) {
+      EXPECT_NEAR(outputs[i][j], expected[i][j], 1e-6) << "sample " << i;
+    }
+  }
+
+  const char* out_str;
+  ASSERT_EQ(MXPredBatcherGetStats(batcher, &out_str), 0);
+  const std::string stats(out_str);
+  const uint64_t requests = BatcherStat(stats, "requests");
+  const uint64_t batches = BatcherStat(stats, "batches");
+  EXPECT_EQ(requests, expected.size()) << stats;
+  EXPECT_EQ(BatchedRequests(stats), requests) << stats;
+  EXPECT_GE(batches, (requests + kMaxBatchSize - 1) / kMaxBatchSize) << stats;
+  // sixteen callers wait on a 200ms delay, so requests must have been coalesced
+  EXPECT_LT(batches, requests) << stats;
+  EXPECT_EQ(MXPredBatcherFree(batcher), 0);
+}
+
+TEST(PredictAPI, BatcherFlushesOnTimeout) {
+  const std::string params = MakeParams();
+  const auto expected = Reference(params, 1);
+  PredictorBatcherHandle batcher = CreateBatcher(params, 8, 1000, 1);
+  ASSERT_NE(batcher, nullptr);
+  // a lone request never fills its batch and runs once its delay has passed
+  std::vector<mx_float> out;
+  ASSERT_EQ(BatcherPredict(batcher, 0, &out), 0) << MXGetLastError();
+  for (int j = 0; j < kNumHidden; ++j) EXPECT_NEAR(out[j], expected[0][j], 1e-6);
+
+  const char* out_str;
+  ASSERT_EQ(MXPredBatcherGetStats(batcher, &out_str), 0);
+  const std::string stats(out_str);
+  EXPECT_EQ(BatcherStat(stats, "requests"), 1U) << stats;
+  EXPECT_EQ(BatcherStat(stats, "batches"), 1U) << stats;
+  EXPECT_NE(stats.find("    1: 1"), std::string::npos) << stats;
+  EXPECT_EQ(MXPredBatcherFree(batcher), 0);
+}
@@ -26,7 +26,9 @@
 #include <dmlc/logging.h>
 #include <mxnet/storage.h>
 #include <cstdio>
+#include <thread>
 #include "test_util.h"
+#include "../../src/storage/pooled_storage_manager.h"
 
 TEST(Storage, Basic_CPU) {
   constexpr size_t kSize = 1024;
@@ -42,6 +44,65 @@ TEST(Storage, Basic_CPU) {
   storage->Free(handle);
 }
 
+TEST(Storage, Round_CPU) {
+  mxnet::Context context_cpu{};
+  {
+    // shared pool only
+    setenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE", "0", 1);
+    mxnet::storage::CPUPooledRoundedStorageManager manager;
+    mxnet::Storage::Handle handle, handle2;
+    handle.size = 100;
+    handle.ctx = context_cpu;
+    handle2.size = 2097153;
+    handle2.ctx = context_cpu;
+    manager.Alloc(&handle);
+    manager.Alloc(&handle2);
+    auto ptr = handle.dptr;
+    auto ptr2 = handle2.dptr;
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 16, 0U);
+    manager.Free(handle);
+    manager.Free(handle2);
+
+    handle.size = 128;
+    manager.Alloc(&handle);
+    EXPECT_EQ(handle.dptr, ptr);
+    handle2.size = 3145728;
+    manager.Alloc(&handle2);
+    EXPECT_EQ(handle2.dptr, ptr2);
+    manager.Free(handle);
+    manager.DirectFree(handle2);
+    unsetenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE");
+  }
+  {
+    // thread cache in front of the shared pool
+    setenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE", "4096", 1);
+    mxnet::storage::CPUPooledRoundedStorageManager manager;
+    mxnet::Storage::Handle small, large;
+    small.size = 1000;
+    small.ctx = context_cpu;
+    large.size = 8192;
+    large.ctx = context_cpu;
+    manager.Alloc(&small);
+    manager.Alloc(&large);
+    auto small_ptr = small.dptr;
+    auto large_ptr = large.dptr;
+    manager.Free(small);
+    manager.Free(large);
+    small.size = 1024;
+    manager.Alloc(&small);
+    EXPECT_EQ(small.dptr, small_ptr);
+    manager.Alloc(&large);
+    EXPECT_EQ(large.dptr, large_ptr);
+    // chunks freed on another thread are still reused through the shared pool
+    std::thread([&manager, large]() { manager.Free(large); }).join();
+    manager.Alloc(&large);
+    EXPECT_NE(large.dptr, nullptr);
+    manager.Free(small);
+    manager.Free(large);
+    unsetenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE");
+  }
+}
+
 #if MXNET_USE_CUDA
 TEST(Storage_GPU, Basic_GPU) {
   if (mxnet::test::unitTestsWithCuda) {
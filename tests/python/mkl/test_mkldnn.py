@@ -20,17 +20,18 @@ MKL-DNN related test cases
 """
 import sys
 import os
+import json
 import numpy as np
 import mxnet as mx
 import unittest
 from mxnet.test_utils import rand_ndarray, assert_almost_equal
-from mxnet import gluon
+from mxnet import gluon, profiler
 from mxnet.gluon import nn
 from mxnet.test_utils import *
 import test_mkldnn_install as install
 curr_path = os.path.dirname(os.path.abspath(os.path.expanduser(__file__)))
 sys.path.append(os.path.join(curr_path, '../unittest/'))
-from common import with_seed
+from common import with_seed, TemporaryDirectory
 
 
 def test_mkldnn_model():
@@ -474,5 +475,36 @@ def test_non_mkldnn_fcomputeex():
     exec1.forward()[0].wait_to_read()
 
 
+@with_seed()
+def test_prewarm_primitive_cache():
+    data = mx.sym.Variable('data')
+    conv = mx.sym.Convolution(data, num_filter=8, kernel=(3, 3), name='conv')
+    net = mx.sym.Activation(conv, act_type='relu')
+    # shapes no other test uses, so that prewarming misses
+    shapes = [{'data': (1, 3, 17, 19)}, {'data': (4, 3, 17, 19)}]
+    arg_params = {'conv_weight': mx.nd.random.uniform(shape=(8, 3, 3, 3)),
+                  'conv_bias': mx.nd.zeros((8,))}
+    with TemporaryDirectory() as tmpdir:
+        trace = os.path.join(tmpdir, 'prewarm.json')
+        profiler.set_config(filename=trace)
+        profiler.set_state('run')
+        mx.contrib.mkldnn.prewarm_primitive_cache(net, shapes, arg_params)
+        exe = net.simple_bind(mx.cpu(), grad_req='null', data=(4, 3, 17, 19))
+        exe.copy_params_from(arg_params)
+        exe.forward(is_train=False, data=mx.nd.ones((4, 3, 17, 19)))
+        exe.outputs[0].wait_to_read()
+        profiler.set_state('stop')
+        profiler.dump()
+        with open(trace) as f:
+            events = json.load(f)['traceEvents']
+    # every hit or miss while profiling emits one counter event
+    def counter_events(name):
+        return [e for e in events if e.get('name') == name and 'args' in e]
+    misses = counter_events('Convolution forward misses')
+    hits = counter_events('Convolution forward hits')
+    # one primitive is created per prewarmed shape, the forward pass afterwards reuses one
+    assert len(misses) == len(shapes), misses
+    assert len(hits) == 1, hits
+
 if __name__ == '__main__':
     install.test_mkldnn_install()
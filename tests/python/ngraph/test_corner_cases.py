@@ -15,6 +15,7 @@
 #*******************************************************************************
 
 from __future__ import print_function
+import os
 import numpy as np
 import mxnet as mx
 
@@ -365,6 +366,132 @@ def test_stop_gradient():
     assert np.isclose(executor.grad_arrays[0].asnumpy(), [0,0]).all()
     assert np.isclose(executor.grad_arrays[1].asnumpy(), [1,1]).all()
 
+def _compile_cache_stat(name):
+    import os
+    import tempfile
+    fd, path = tempfile.mkstemp()
+    os.close(fd)
+    try:
+        mx.profiler.dump_ngraph(path)
+        with open(path) as f:
+            for line in f:
+                if line.strip().startswith(name + ':'):
+                    return int(line.split(':')[1])
+    finally:
+        os.remove(path)
+    return None
+
+def test_compile_cache_reuses_identical_subgraph():
+    x = mx.sym.Variable('x')
+    y = mx.sym.Variable('y')
+    z = mx.sym.tanh(x * y + x)
+    hits = _compile_cache_stat('hits')
+    ex1 = z.simple_bind(ctx=mx.cpu(), x=(3, 4), y=(3, 4), grad_req='null')
+    ex2 = z.simple_bind(ctx=mx.cpu(), x=(3, 4), y=(3, 4), grad_req='null')
+    assert _compile_cache_stat('hits') > hits
+    x_npy = np.random.uniform(size=(3, 4)).astype(np.float32)
+    y_npy = np.random.uniform(size=(3, 4)).astype(np.float32)
+    out1 = ex1.forward(x=x_npy, y=y_npy)[0].asnumpy()
+    out2 = ex2.forward(x=x_npy, y=y_npy)[0].asnumpy()
+    assert np.isclose(out1, np.tanh(x_npy * y_npy + x_npy), atol=1e-6).all()
+    assert np.isclose(out1, out2).all()
+
+def test_compile_cache_zero_grad():
+    # the zero_grad flag is set at compile time and must hold for the
+    # gradient pass of every executor
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    loss = mx.sym.MakeLoss(mx.sym.stop_gradient(3 * b) + a)
+    v1 = mx.nd.array([[1, 2]])
+    v2 = mx.nd.array([[0, 1]])
+    for _ in range(2):
+        executor = loss.simple_bind(ctx=mx.cpu(), a=(1, 2), b=(1, 2))
+        executor.forward(is_train=True, a=v1, b=v2)
+        executor.backward()
+        assert np.isclose(executor.grad_dict['a'].asnumpy(), [1, 1]).all()
+        assert np.isclose(executor.grad_dict['b'].asnumpy(), [0, 0]).all()
+
+def test_compile_cache_training_not_shared():
+    # graphs bound with gradients keep forward state for their backward pass,
+    # so interleaved executors must not share them
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    loss = mx.sym.MakeLoss(mx.sym.sum(mx.sym.tanh(x * w)))
+    hits = _compile_cache_stat('hits')
+    ex1 = loss.simple_bind(ctx=mx.cpu(), x=(3, 4), w=(3, 4))
+    ex2 = loss.simple_bind(ctx=mx.cpu(), x=(3, 4), w=(3, 4))
+    assert _compile_cache_stat('hits') == hits
+    w_npy = np.random.uniform(size=(3, 4)).astype(np.float32)
+    x1 = np.random.uniform(size=(3, 4)).astype(np.float32)
+    x2 = np.random.uniform(size=(3, 4)).astype(np.float32)
+    ex1.forward(is_train=True, x=x1, w=w_npy)
+    ex2.forward(is_train=True, x=x2, w=w_npy)
+    ex1.backward()
+    ex2.backward()
+    for ex, x_npy in ((ex1, x1), (ex2, x2)):
+        expected = x_npy * (1 - np.tanh(x_npy * w_npy) ** 2)
+        assert np.isclose(ex.grad_dict['w'].asnumpy(), expected, atol=1e-5).all()
+
+def test_shape_cache_alternating_batch_sizes():
+    data = mx.sym.Variable('data')
+    weight = mx.sym.Variable('weight')
+    out = mx.sym.tanh(mx.sym.FullyConnected(data, weight=weight, num_hidden=4,
+                                            no_bias=True))
+    w_npy = np.random.uniform(size=(4, 6)).astype(np.float32)
+    ex = out.simple_bind(ctx=mx.cpu(), data=(1, 6), grad_req='null')
+    ex.arg_dict['weight'][:] = w_npy
+    misses = None
+    for i in range(3):
+        for batch in (1, 8, 32):
+            ex = ex.reshape(allow_up_sizing=True, data=(batch, 6))
+            x_npy = np.random.uniform(size=(batch, 6)).astype(np.float32)
+            y = ex.forward(data=x_npy)[0].asnumpy()
+            assert y.shape == (batch, 4)
+            assert np.isclose(y, np.tanh(x_npy.dot(w_npy.T)), atol=1e-5).all()
+        if i == 0:
+            misses = _compile_cache_stat('misses')
+    assert _compile_cache_stat('misses') == misses
+
+def _forward_batch_sizes(sym, batches, buckets):
+    # runs sym on the same data for each batch size with the given
+    # MXNET_NGRAPH_BATCH_BUCKETS, returns the outputs and the compile cache
+    # misses after the first batch size
+    os.environ['MXNET_NGRAPH_BATCH_BUCKETS'] = buckets
+    try:
+        ex = sym.simple_bind(ctx=mx.cpu(), data=(1, 5), grad_req='null')
+        outs = []
+        misses = None
+        for batch in batches:
+            ex = ex.reshape(allow_up_sizing=True, data=(batch, 5))
+            x_npy = np.linspace(-2, 1, batch * 5).reshape(batch, 5)
+            outs.append(ex.forward(data=x_npy)[0].asnumpy())
+            if misses is None:
+                misses = _compile_cache_stat('misses')
+        return outs, _compile_cache_stat('misses') - misses
+    finally:
+        del os.environ['MXNET_NGRAPH_BATCH_BUCKETS']
+
+def test_batch_buckets_match_unbucketed():
+    data = mx.sym.Variable('data')
+    independent = mx.sym.tanh(data * 2 + 1)
+    # zero rows padded up to the bucket would enter the mean and the softmax
+    # over the batch axis, so these must not be bucketed
+    mean = mx.sym.mean(data * 2 + 1, axis=0)
+    softmax = mx.sym.softmax(data * 2 + 1, axis=0)
+    batches = (3, 4)
+    for sym in (independent, mean, softmax):
+        bucketed, misses = _forward_batch_sizes(sym, batches, 'pow2')
+        unbucketed, _ = _forward_batch_sizes(sym, batches, '')
+        for batch, b, u in zip(batches, bucketed, unbucketed):
+            assert b.shape == ((5,) if sym is mean else (batch, 5))
+            assert np.isclose(b, u, atol=1e-6).all()
+        # batch size 4 runs the graph compiled for the bucket of batch size 3
+        # only if the subgraph was bucketed
+        assert misses == (0 if sym is independent else 1)
+        if sym is independent:
+            expected = np.tanh(np.linspace(-2, 1, 15).reshape(3, 5) * 2 + 1)
+            assert np.isclose(bucketed[0], expected, atol=1e-6).all()
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
@@ -27,6 +27,7 @@ from mxnet.module import Module
 from mxnet.io import NDArrayIter
 import unittest
 import operator
+import json
 
 def is_test_for_gpu():
     return mx.current_context().device_type == 'gpu'
@@ -382,6 +383,134 @@ def test_quantized_flatten():
         check_quantized_flatten((10, 15, 18), qdtype)
         check_quantized_flatten((3, 4, 23, 23), qdtype)
 
+def dequantize_np(qdata, min_range, max_range):
+    if qdata.dtype == np.uint8:
+        return min_range + qdata.astype(np.float64) * (max_range - min_range) / 255.0
+    elif qdata.dtype == np.int8:
+        return qdata.astype(np.float64) * max(abs(min_range), abs(max_range)) / 127.0
+    return qdata.astype(np.float64) * max(abs(min_range), abs(max_range)) / 2147483647.0
+
+def rand_quantized(shape, qdtype):
+    if qdtype == 'uint8':
+        return mx.nd.random.uniform(low=0, high=255, shape=shape).astype(qdtype)
+    return mx.nd.random.uniform(low=-127, high=127, shape=shape).astype(qdtype)
+
+@with_seed()
+def test_quantized_act():
+    def check_quantized_act(shape, qdtype, min_range, max_range):
+        qdata = rand_quantized(shape, qdtype)
+        min_data = mx.nd.array([min_range], dtype='float32')
+        max_data = mx.nd.array([max_range], dtype='float32')
+        qoutput, min_output, max_output = mx.nd.contrib.quantized_act(qdata, min_data, max_data,
+                                                                      act_type='relu')
+        assert qoutput.dtype == qdata.dtype
+        assert same(min_data.asnumpy(), min_output.asnumpy())
+        assert same(max_data.asnumpy(), max_output.asnumpy())
+        expected = np.maximum(dequantize_np(qdata.asnumpy(), min_range, max_range), 0)
+        output = dequantize_np(qoutput.asnumpy(), min_range, max_range)
+        # the zero of uint8 data may lie between two levels
+        level = (max_range - min_range) / 255.0
+        assert_almost_equal(output, expected, atol=level)
+
+    for qdtype in ['int8', 'uint8']:
+        check_quantized_act((10,), qdtype, -1023.343, 2343.324275)
+        check_quantized_act((3, 4, 23, 23), qdtype, -1023.343, 2343.324275)
+        check_quantized_act((3, 4, 23, 23), qdtype, 0.0, 6.0)
+
+@with_seed()
+def test_quantized_elemwise_add():
+    def check_quantized_elemwise_add(shape, lhs_qdtype, rhs_qdtype):
+        lhs, rhs = rand_quantized(shape, lhs_qdtype), rand_quantized(shape, rhs_qdtype)
+        lhs_range = (-3.5, 2.0) if lhs_qdtype == 'int8' else (0.0, 6.0)
+        rhs_range = (-0.5, 10.0) if rhs_qdtype == 'int8' else (-1.0, 4.0)
+        ranges = [mx.nd.array([v], dtype='float32') for v in lhs_range + rhs_range]
+        qoutput, min_output, max_output = mx.nd.contrib.quantized_elemwise_add(lhs, rhs, *ranges)
+        assert qoutput.dtype == np.int32
+        expected = dequantize_np(lhs.asnumpy(), *lhs_range) + dequantize_np(rhs.asnumpy(), *rhs_range)
+        output = dequantize_np(qoutput.asnumpy(), min_output.asscalar(), max_output.asscalar())
+        assert_almost_equal(output, expected, rtol=1e-5, atol=1e-5)
+
+    for lhs_qdtype in ['int8', 'uint8']:
+        for rhs_qdtype in ['int8', 'uint8']:
+            check_quantized_elemwise_add((10,), lhs_qdtype, rhs_qdtype)
+            check_quantized_elemwise_add((3, 4, 23, 23), lhs_qdtype, rhs_qdtype)
+
+@with_seed()
+def test_quantized_batch_dot():
+    def check_quantized_batch_dot(batch_size, m, k, n, transpose_a, transpose_b, qdtype):
+        lhs_shape = (batch_size, k, m) if transpose_a else (batch_size, m, k)
+        rhs_shape = (batch_size, n, k) if transpose_b else (batch_size, k, n)
+        lhs, rhs = rand_quantized(lhs_shape, qdtype), rand_quantized(rhs_shape, 'int8')
+        # one quantized level is one real unit, so that the result is exact
+        lhs_range = (0.0, 255.0) if qdtype == 'uint8' else (-127.0, 127.0)
+        ranges = [mx.nd.array([v], dtype='float32') for v in lhs_range + (-127.0, 127.0)]
+        qoutput, min_output, max_output = mx.nd.contrib.quantized_batch_dot(
+            lhs, rhs, *ranges, transpose_a=transpose_a, transpose_b=transpose_b)
+        assert qoutput.dtype == np.int32
+        expected = mx.nd.batch_dot(lhs.astype('float32'), rhs.astype('float32'),
+                                   transpose_a=transpose_a, transpose_b=transpose_b)
+        assert same(qoutput.asnumpy(), expected.asnumpy().astype(np.int32))
+        assert_almost_equal(max_output.asnumpy(), np.array([2147483647.0]))
+        assert_almost_equal(min_output.asnumpy(), np.array([-2147483647.0]))
+
+    def check_quantized_batch_dot_zero(batch_size, m, k, n, transpose_a, transpose_b):
+        # a uint8 range far from zero has a quantized zero of 51000, which neither fits into
+        # int16 nor, times 127 for k products, into int32 for large k
+        lhs_shape = (batch_size, k, m) if transpose_a else (batch_size, m, k)
+        rhs_shape = (batch_size, n, k) if transpose_b else (batch_size, k, n)
+        lhs, rhs = rand_quantized(lhs_shape, 'uint8'), rand_quantized(rhs_shape, 'int8')
+        lhs_range, rhs_range = (200.0, 201.0), (-127.0, 127.0)
+        ranges = [mx.nd.array([v], dtype='float32') for v in lhs_range + rhs_range]
+        qoutput, min_output, max_output = mx.nd.contrib.quantized_batch_dot(
+            lhs, rhs, *ranges, transpose_a=transpose_a, transpose_b=transpose_b)
+        assert qoutput.dtype == np.int32
+        lhs_np = dequantize_np(lhs.asnumpy(), *lhs_range)
+        rhs_np = dequantize_np(rhs.asnumpy(), *rhs_range)
+        if transpose_a:
+            lhs_np = lhs_np.transpose(0, 2, 1)
+        if transpose_b:
+            rhs_np = rhs_np.transpose(0, 2, 1)
+        expected = np.matmul(lhs_np, rhs_np)
+        min_range, max_range = min_output.asscalar(), max_output.asscalar()
+        output = dequantize_np(qoutput.asnumpy(), min_range, max_range)
+        level = max_range / 2147483647.0
+        assert_almost_equal(output, expected, rtol=1e-5, atol=2 * level)
+
+    for qdtype in ['int8', 'uint8']:
+        for transpose_a in [False, True]:
+            for transpose_b in [False, True]:
+                check_quantized_batch_dot(2, 5, 33, 7, transpose_a, transpose_b, qdtype)
+                check_quantized_batch_dot(8, 64, 64, 64, transpose_a, transpose_b, qdtype)
+    for transpose_a in [False, True]:
+        for transpose_b in [False, True]:
+            check_quantized_batch_dot_zero(2, 5, 33, 7, transpose_a, transpose_b)
+            # 512 products of (q + 51000) and 127 exceed int32, so the output level doubles
+            check_quantized_batch_dot_zero(2, 3, 512, 4, transpose_a, transpose_b)
+
+@with_seed()
+def test_quantize_residual_and_attention_sym():
+    data = mx.sym.Variable('data')
+    fc = mx.sym.FullyConnected(data, num_hidden=16, name='fc')
+    relu = mx.sym.Activation(fc, act_type='relu', name='relu')
+    add = mx.sym.elemwise_add(relu, fc, name='add')
+    att = mx.sym.batch_dot(mx.sym.reshape(add, shape=(0, 4, 4)),
+                           mx.sym.reshape(add, shape=(0, 4, 4)), transpose_b=True, name='att')
+    sym = mx.sym.Activation(att, act_type='sigmoid', name='sigmoid')
+    offline_params = [name for name in sym.list_arguments() if name != 'data']
+    qsym = mx.contrib.quant._quantize_symbol(sym, offline_params=offline_params)
+    nodes = json.loads(qsym.tojson())['nodes']
+    ops = [node['op'] for node in nodes]
+    assert '_contrib_quantized_act' in ops
+    assert '_contrib_quantized_elemwise_add' in ops
+    assert '_contrib_quantized_batch_dot' in ops
+    # the residual block stays quantized, only reshape and sigmoid read dequantized data
+    names = [node['name'] for node in nodes]
+    assert 'fc_dequantize' not in names
+    assert 'relu_dequantize' not in names
+    assert 'add_dequantize' in names
+    assert 'att_dequantize' in names
+    assert ops.count('Activation') == 1
+
 
 @with_seed()
 def test_quantize_params():
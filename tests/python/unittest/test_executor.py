@@ -165,6 +165,38 @@ def test_reshape():
     assert np.all(new_exe.arg_arrays[1].asnumpy() == 1)
 
 
+@with_seed()
+def test_shared_pool_arena():
+    data = mx.sym.Variable('data')
+    net = mx.sym.FullyConnected(data, num_hidden=16, name='fc1')
+    net = mx.sym.Activation(net, act_type='relu')
+    net = mx.sym.FullyConnected(net, num_hidden=8, name='fc2')
+    net = mx.sym.Activation(net, act_type='tanh')
+    shapes = [(2, 4), (7, 4), (5, 4)]
+    inputs = [mx.nd.random.uniform(shape=s) for s in shapes]
+    params = {'fc1_weight': mx.nd.random.uniform(shape=(16, 4)),
+              'fc1_bias': mx.nd.random.uniform(shape=(16,)),
+              'fc2_weight': mx.nd.random.uniform(shape=(8, 16)),
+              'fc2_bias': mx.nd.random.uniform(shape=(8,))}
+
+    def bind(shape, shared_exec=None):
+        exe = net.simple_bind(mx.cpu(), data=shape, grad_req='null', shared_exec=shared_exec)
+        exe.copy_params_from(params)
+        return exe
+
+    expected = [bind(s).forward(is_train=False, data=x)[0].asnumpy()
+                for s, x in zip(shapes, inputs)]
+    prev_val = mx.test_utils.set_env_var("MXNET_EXEC_SHARED_POOL_ARENA", "1", "0")
+    execs = [bind(shapes[0])]
+    for s in shapes[1:]:
+        execs.append(bind(s, shared_exec=execs[0]))
+    mx.test_utils.set_env_var("MXNET_EXEC_SHARED_POOL_ARENA", prev_val)
+    # the executors run one after another in the same arena
+    for _ in range(2):
+        for exe, x, y in zip(execs, inputs, expected):
+            assert_almost_equal(exe.forward(is_train=False, data=x)[0].asnumpy(), y)
+
+
 if __name__ == "__main__":
     import nose
     nose.runmodule()
@@ -1268,6 +1268,50 @@ def test_hybrid_static_memory_switching():
     check_hybrid_static_memory_switching(static_alloc=True)
     check_hybrid_static_memory_switching(static_alloc=True, static_shape=True)
 
+@with_seed()
+def test_hybrid_plan_cache():
+    def check(expected_hits, expected_misses, expected_evictions, **kwargs):
+        net = nn.HybridSequential()
+        with net.name_scope():
+            net.add(nn.Dense(8, flatten=False, in_units=3, activation='relu'))
+            net.add(nn.Dense(4, flatten=False, in_units=8))
+        net.initialize()
+        net.hybridize(**kwargs)
+        ref = nn.HybridSequential()
+        with ref.name_scope():
+            ref.add(nn.Dense(8, flatten=False, in_units=3, activation='relu'))
+            ref.add(nn.Dense(4, flatten=False, in_units=8))
+        ref.initialize()
+        for p, q in zip(net.collect_params().values(), ref.collect_params().values()):
+            q.set_data(p.data())
+
+        # sequence lengths switching between buckets
+        for seq_len in [5, 7, 5, 7, 9, 5]:
+            x = mx.nd.random.uniform(shape=(2, seq_len, 3))
+            assert_almost_equal(net(x).asnumpy(), ref(x).asnumpy(), rtol=1e-5, atol=1e-6)
+        assert net._cached_op.plan_stats() == (expected_hits, expected_misses,
+                                               expected_evictions)
+
+        x = mx.nd.random.uniform(shape=(2, 7, 3))
+        with mx.autograd.record():
+            y = net(x)
+        y.backward()
+        with mx.autograd.record():
+            y_ref = ref(x)
+        y_ref.backward()
+        assert_almost_equal(y.asnumpy(), y_ref.asnumpy(), rtol=1e-5, atol=1e-6)
+        for p, q in zip(net.collect_params().values(), ref.collect_params().values()):
+            assert_almost_equal(p.grad().asnumpy(), q.grad().asnumpy(), rtol=1e-5, atol=1e-6)
+
+    check(3, 3, 0)
+    check(3, 3, 0, static_alloc=True)
+    check(3, 3, 0, static_alloc=True, static_shape=True)
+    # without a cache the current plan is replanned in place, nothing is evicted
+    check(0, 6, 0, static_alloc=True, plan_cache_size=0)
+    # with a single cached plan next to the current one, 9 evicts 5,
+    # and the last 5 plans again and evicts 7
+    check(2, 4, 2, static_alloc=True, static_shape=True, plan_cache_size=1)
+
 @with_seed()
 def test_hook():
     global hook_call_count
@@ -385,8 +385,43 @@ def test_LibSVMIter():
         for batch in iter(data_train):
             data_train.get_data().asnumpy()
 
+    def check_libSVMIter_parallel():
+        cwd = os.getcwd()
+        data_path = os.path.join(cwd, 'data.t')
+        cache_path = os.path.join(cwd, 'data.t.cache')
+        rng = np.random.RandomState(0)
+        with open(data_path, 'w') as fout:
+            for i in range(1000):
+                cols = sorted(rng.choice(50, rng.randint(0, 6), replace=False))
+                fout.write(' '.join([str(i % 7)] + ['%d:%g' % (c, rng.uniform()) for c in cols]))
+                fout.write('\n')
+        if os.path.exists(cache_path):
+            os.remove(cache_path)
+
+        def read(**kwargs):
+            data_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(50, ),
+                                         batch_size=64, **kwargs)
+            batches = []
+            for epoch in range(2):
+                data_iter.reset()
+                batches += [(b.data[0].asnumpy(), b.label[0].asnumpy()) for b in data_iter]
+            return batches
+
+        expected = read()
+        # the second run reads the cache written by the first one
+        for kwargs in [{'parse_threads': 3}, {'cache_file': cache_path},
+                       {'parse_threads': 2, 'cache_file': cache_path}]:
+            batches = read(**kwargs)
+            assert len(batches) == len(expected)
+            for (data, label), (expected_data, expected_label) in zip(batches, expected):
+                assert_almost_equal(data, expected_data)
+                assert_almost_equal(label, expected_label)
+        assert os.path.exists(cache_path)
+        os.remove(cache_path)
+
     check_libSVMIter_synthetic()
     check_libSVMIter_news_data()
+    check_libSVMIter_parallel()
     assertRaises(MXNetError, check_libSVMIter_exception)
 
 
@@ -428,8 +463,83 @@ def test_CSVIter():
             assert_almost_equal(data_batch.asnumpy(), expected.asnumpy())
             assert data_batch.asnumpy().dtype == expected.asnumpy().dtype
 
+    def check_CSVIter_parallel(dtype='float32'):
+        cwd = os.getcwd()
+        data_path = os.path.join(cwd, 'data.csv')
+        label_path = os.path.join(cwd, 'label.csv')
+        cache_path = os.path.join(cwd, 'data.csv.cache')
+        data = np.random.randint(-1000, 1000, size=(1000, 6)).astype(dtype)
+        if dtype == 'float32':
+            data /= 8
+        np.savetxt(data_path, data, delimiter=',', fmt='%g')
+        np.savetxt(label_path, np.arange(1000), fmt='%d')
+        for path in [cache_path, cache_path + '.label']:
+            if os.path.exists(path):
+                os.remove(path)
+        for kwargs in [{'parse_threads': 4}, {'cache_file': cache_path},
+                       {'cache_file': cache_path}]:
+            data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(2, 3), label_csv=label_path,
+                                      batch_size=100, round_batch=False, dtype=dtype, **kwargs)
+            for epoch in range(2):
+                data_iter.reset()
+                num_batches = 0
+                for i, batch in enumerate(data_iter):
+                    assert_almost_equal(batch.data[0].asnumpy(),
+                                        data[i * 100:(i + 1) * 100].reshape((100, 2, 3)))
+                    assert_almost_equal(batch.label[0].asnumpy(), np.arange(i * 100, (i + 1) * 100))
+                    num_batches += 1
+                assert num_batches == 10
+        os.remove(cache_path)
+        os.remove(cache_path + '.label')
+
     for dtype in ['int32', 'int64', 'float32']:
         check_CSVIter_synthetic(dtype=dtype)
+        check_CSVIter_parallel(dtype=dtype)
+
+def test_prefetcher_recycle():
+    cwd = os.getcwd()
+    data_path = os.path.join(cwd, 'data.csv')
+    data = np.arange(1000 * 4, dtype='float32').reshape((1000, 4))
+    np.savetxt(data_path, data, delimiter=',', fmt='%g')
+
+    def counter_range(stats, name):
+        for line in stats.splitlines():
+            if line.startswith(name):
+                # count, total, min, max and average follow the name, counter values
+                # are printed divided by 1000
+                values = line[len(name):].split()
+                return round(float(values[2]) * 1000), round(float(values[3]) * 1000)
+        assert False, name + ' not found in the profiler stats'
+
+    # the queue depth stays at max_prefetch_buffer unless it is adaptive, in which case
+    # it starts at prefetch_buffer and only grows up to max_prefetch_buffer
+    for kwargs, depths in [({'prefetch_buffer': 1, 'max_prefetch_buffer': 1}, (1, 1)),
+                           ({'prefetch_buffer': 2, 'max_prefetch_buffer': 4}, (4, 4)),
+                           ({'prefetch_buffer': 2, 'max_prefetch_buffer': 8,
+                             'adaptive_prefetch': True}, (2, 8))]:
+        mx.profiler.set_config(aggregate_stats=True, filename='test_prefetcher_recycle.json')
+        mx.profiler.dumps(reset=True)
+        mx.profiler.set_state('run')
+        data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(4,), batch_size=10,
+                                  round_batch=False, **kwargs)
+        # a reset in the middle of an epoch starts over from the first batch
+        for i, batch in enumerate(data_iter):
+            assert_almost_equal(batch.data[0].asnumpy(), data[i * 10:(i + 1) * 10])
+            if i == 5:
+                break
+        for epoch in range(3):
+            data_iter.reset()
+            batches = [batch.data[0].copy() for batch in data_iter]
+            assert len(batches) == 100
+            # the batches are written into recycled arrays, the copies must stay intact
+            for i, batch in enumerate(batches):
+                assert_almost_equal(batch.asnumpy(), data[i * 10:(i + 1) * 10])
+            # the iterator stays exhausted until it is reset
+            assert not data_iter.iter_next()
+        mx.profiler.set_state('stop')
+        low, high = counter_range(mx.profiler.dumps(reset=True), 'Prefetcher queue depth')
+        assert depths[0] <= low <= high <= depths[1], (kwargs, low, high)
+
 
 def test_ImageRecordIter_seed_augmentation():
     get_cifar10()
@@ -918,6 +918,46 @@ def test_bucket_module_grad_req():
     assert(mod._curr_module._exec_group.execs[0].grad_dict['a'].asscalar() == 2 * batch_size)
 
 
+@with_seed()
+def test_bucket_module_shared_arena():
+    batch_size = 64
+    def sym_gen(seq_len):
+        data = mx.sym.Variable('data')
+        net = mx.sym.FullyConnected(data, num_hidden=256, flatten=False, name='fc1')
+        net = mx.sym.Activation(net, act_type='relu')
+        net = mx.sym.FullyConnected(net, num_hidden=8, flatten=False, name='fc2')
+        net = mx.sym.sum(net, axis=1)
+        return net, ('data',), None
+
+    def forward(mod, key, x):
+        mod.forward(mx.io.DataBatch(data=[x], label=None, bucket_key=key,
+                                    provide_data=[mx.io.DataDesc('data', x.shape)]),
+                    is_train=False)
+        return mod.get_outputs()[0].copy()
+
+    prev_val = mx.test_utils.set_env_var("MXNET_EXEC_SHARED_POOL_ARENA", "1", "0")
+    try:
+        # the default bucket is the smallest, so larger buckets grow the arena
+        mod = mx.mod.BucketingModule(sym_gen=sym_gen, default_bucket_key=2)
+        mod.bind(data_shapes=[('data', (batch_size, 2, 16))], for_training=False)
+        mod.init_params()
+        keys = [2, 16, 32, 2, 32, 16]
+        inputs = [mx.nd.random.uniform(shape=(batch_size, key, 16)) for key in keys]
+        # no output is waited for, so each larger bucket binds and enlarges the
+        # arena while the batch of the previous one may still be running
+        outputs = [forward(mod, key, x) for key, x in zip(keys, inputs)]
+    finally:
+        mx.test_utils.set_env_var("MXNET_EXEC_SHARED_POOL_ARENA", prev_val)
+
+    arg_params, _ = mod.get_params()
+    for x, y in zip(inputs, outputs):
+        h = mx.nd.FullyConnected(x, arg_params['fc1_weight'], arg_params['fc1_bias'],
+                                 num_hidden=256, flatten=False)
+        h = mx.nd.FullyConnected(mx.nd.relu(h), arg_params['fc2_weight'],
+                                 arg_params['fc2_bias'], num_hidden=8, flatten=False)
+        assert_almost_equal(y.asnumpy(), mx.nd.sum(h, axis=1).asnumpy(), rtol=1e-4, atol=1e-4)
+
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
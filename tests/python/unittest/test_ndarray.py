@@ -314,6 +314,34 @@ def test_ndarray_legacy_load():
         assert same(data[i].asnumpy(), legacy_data[i].asnumpy())
 
 
+@with_seed()
+def test_ndarray_save_aligned_load_mmap():
+    with TemporaryDirectory(prefix='test_ndarray_mmap_') as tmpdir:
+        fname = os.path.join(tmpdir, 'aligned.params')
+        dmap = {'w%d' % i: random_ndarray(np.random.randint(1, 5)) for i in range(10)}
+        dmap['int'] = mx.nd.arange(7, dtype='int32')
+        dmap['sparse'] = mx.nd.array(np.eye(4)).tostype('row_sparse')
+        mx.nd.save(fname, dmap, aligned=True)
+        for mmap in [False, True]:
+            dmap2 = mx.nd.load(fname, mmap=mmap)
+            assert len(dmap2) == len(dmap)
+            for k, x in dmap.items():
+                assert dmap2[k].stype == x.stype
+                assert dmap2[k].dtype == x.dtype
+                assert same(x.asnumpy(), dmap2[k].asnumpy())
+        # mapped arrays are copy-on-write, the file is not modified
+        dmap2 = mx.nd.load(fname, mmap=True)
+        dmap2['w0'][:] = 0
+        del dmap2
+        dmap3 = mx.nd.load(fname, mmap=True)
+        assert same(dmap['w0'].asnumpy(), dmap3['w0'].asnumpy())
+        # files in the default format can be mapped too
+        mx.nd.save(fname, dmap)
+        dmap4 = mx.nd.load(fname, mmap=True)
+        for k, x in dmap.items():
+            assert same(x.asnumpy(), dmap4[k].asnumpy())
+
+
 @with_seed()
 def test_buffer_load():
     nrepeat = 10
@@ -2336,6 +2336,35 @@ def test_reduce():
                           mx.symbol.norm, test_exclude=False, test_none_axis=test_none)
 
 
+@with_seed()
+def test_reduce_large():
+    # large reduced spaces exercise the split and contiguous paths of the CPU reduction
+    def check(shape, axis, nan_prob=0):
+        data = np.random.uniform(-1, 1, shape).astype(np.float32)
+        if nan_prob > 0:
+            data[np.random.uniform(size=shape) < nan_prob] = np.nan
+        x = mx.nd.array(data)
+        data64 = data.astype(np.float64)
+        if nan_prob > 0:
+            assert_almost_equal(mx.nd.nansum(x, axis=axis).asnumpy(),
+                                np.nansum(data64, axis=axis), rtol=1e-4, atol=1e-3)
+            return
+        assert_almost_equal(mx.nd.sum(x, axis=axis).asnumpy(),
+                            np.sum(data64, axis=axis), rtol=1e-4, atol=1e-3)
+        assert_almost_equal(mx.nd.max(x, axis=axis).asnumpy(), np.max(data, axis=axis))
+        assert_almost_equal(mx.nd.min(x, axis=axis).asnumpy(), np.min(data, axis=axis))
+        assert_almost_equal(mx.nd.norm(x, axis=axis).asnumpy(),
+                            np.sqrt(np.sum(data64 * data64, axis=axis)), rtol=1e-4, atol=1e-3)
+
+    check((1 << 20,), None)
+    check((1 << 20,), None, nan_prob=0.1)
+    check((3, 100003), 1)
+    check((3, 100003), 1, nan_prob=0.1)
+    check((100003, 3), 0)
+    check((2, 70001, 3), (0, 1))
+    check((7, 13), 1)
+
+
 @with_seed()
 def test_broadcast():
     sample_num = 200
@@ -3241,7 +3270,7 @@ def test_norm():
 def test_layer_norm():
     for dtype, forward_check_eps in zip([np.float16, np.float32, np.float64],
                                         [1E-2, 1E-3, 1E-4]):
-        for in_shape in [(10, 6, 5), (10, 10)]:
+        for in_shape in [(10, 6, 5), (10, 10), (4, 37)]:
             for axis in range(-len(in_shape), len(in_shape)):
                 for eps in [1E-2, 1E-3]:
                     check_layer_normalization(in_shape, axis, eps, dtype=dtype,
@@ -4887,6 +4916,55 @@ def test_div_sqrt_dim():
     check_symbolic_forward(test, [data_tmp], [data_tmp / np.sqrt(data_tmp.shape[-1])])
 
 
+@with_seed()
+def test_fused_attention():
+    def attention_np(query, key, value, mask, heads, scale):
+        def split_heads(x):
+            return x.reshape(x.shape[0], x.shape[1], heads, -1).transpose(0, 2, 1, 3)
+        q, k, v = split_heads(query), split_heads(key), split_heads(value)
+        score = np.matmul(q, k.transpose(0, 1, 3, 2)) * scale
+        if mask is not None:
+            score = np.where(mask[:, np.newaxis] != 0, score, -np.inf)
+        score = np.exp(score - score.max(axis=-1, keepdims=True))
+        score /= score.sum(axis=-1, keepdims=True)
+        out = np.matmul(score, v).transpose(0, 2, 1, 3)
+        return out.reshape(out.shape[0], out.shape[1], -1)
+
+    # the operator only has a CPU implementation
+    ctx = mx.cpu()
+    batch, heads, dim, value_dim = 2, 3, 8, 5
+    # lengths below and above the key block size
+    for qlen, klen in [(1, 3), (40, 150), (70, 300)]:
+        for use_mask in [False, True]:
+            for dtype in [np.float32, np.float64]:
+                query = np.random.normal(0, 1, (batch, qlen, heads * dim)).astype(dtype)
+                key = np.random.normal(0, 1, (batch, klen, heads * dim)).astype(dtype)
+                value = np.random.normal(0, 1, (batch, klen, heads * value_dim)).astype(dtype)
+                inputs = [query, key, value]
+                mask = None
+                if use_mask:
+                    valid_length = np.random.randint(1, klen + 1, size=(batch,))
+                    mask = (np.arange(klen)[np.newaxis, np.newaxis, :] <
+                            valid_length[:, np.newaxis, np.newaxis])
+                    mask = np.broadcast_to(mask, (batch, qlen, klen)).astype(dtype)
+                    inputs.append(mask)
+                expected = attention_np(query, key, value, mask, heads, 1.0 / np.sqrt(dim))
+                out = mx.nd.contrib.fused_attention(*[mx.nd.array(x, ctx=ctx, dtype=dtype)
+                                                      for x in inputs],
+                                                    heads=heads, use_mask=use_mask)
+                assert_almost_equal(out.asnumpy(), expected, rtol=1e-4, atol=1e-5)
+    # a query with every key masked out attends to nothing
+    query = np.random.normal(0, 1, (1, 2, 4))
+    key = np.random.normal(0, 1, (1, 3, 4))
+    value = np.random.normal(0, 1, (1, 3, 4))
+    mask = np.array([[[1, 0, 1], [0, 0, 0]]])
+    inputs = [mx.nd.array(x, ctx=ctx) for x in [query, key, value, mask]]
+    out = mx.nd.contrib.fused_attention(*inputs, heads=2, scale=0.5, use_mask=True)
+    expected = attention_np(query, key, value, mask[:, :1], 2, 0.5)
+    assert_almost_equal(out.asnumpy()[:, :1], expected, rtol=1e-4, atol=1e-5)
+    assert_almost_equal(out.asnumpy()[:, 1:], np.zeros((1, 1, 4)))
+
+
 @with_seed()
 def test_reciprocal_op():
     eps = 2**(-11)
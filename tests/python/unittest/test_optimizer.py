@@ -991,6 +991,125 @@ def test_rms():
                                 if (default_context() == mx.cpu()):
                                     compare_optimizer(opt1(**kwarg), opt2(**kwarg), shape, dtype, g_stype='row_sparse', rtol=rtol, atol=atol)
 
+@with_seed()
+def test_multi_adaptive_update():
+    shapes = [(3, 4, 5), (7,), (1, 1), (20, 31)]
+    kwargs = {'rescale_grad': 0.7, 'clip_gradient': 0.5}
+    lrs = [0.01 * (i + 1) for i in range(len(shapes))]
+    wds = [0.001 * i for i in range(len(shapes))]
+
+    def rand(shape, dtype=np.float32):
+        return mx.nd.random.uniform(-1, 1, shape=shape).astype(dtype)
+
+    for clip_global_norm in [None, 0.5, 1e3]:
+        multi_kwargs = dict(kwargs)
+        grads = [rand(s) for s in shapes]
+        # the single-tensor operators see the gradients scaled by the global norm,
+        # which also covers gradients of the model that are not part of the call
+        ref_grads = [g.copy() for g in grads]
+        norm_inputs = []
+        if clip_global_norm is not None:
+            multi_kwargs['clip_global_norm'] = clip_global_norm
+            other_grads = [np.random.uniform(-1, 1, size=(50,)) for _ in range(2)]
+            norm_sq = sum((g.asnumpy().astype(np.float64) ** 2).sum() for g in grads)
+            norm_sq += sum((g ** 2).sum() for g in other_grads)
+            norm_inputs = [mx.nd.array([norm_sq])]
+            norm = kwargs['rescale_grad'] * math.sqrt(norm_sq)
+            if norm > clip_global_norm:
+                ref_grads = [g * (clip_global_norm / norm) for g in grads]
+
+        # Adam
+        weights = [rand(s) for s in shapes]
+        means = [rand(s) for s in shapes]
+        variances = [mx.nd.abs(rand(s)) for s in shapes]
+        ref = [(w.copy(), m.copy(), v.copy()) for w, m, v in zip(weights, means, variances)]
+        mx.nd.multi_adam_update(*([a for t in zip(weights, grads, means, variances) for a in t] +
+                                  norm_inputs),
+                                out=weights, num_weights=len(shapes), lrs=lrs, wds=wds,
+                                **multi_kwargs)
+        for (w, m, v), g, lr, wd in zip(ref, ref_grads, lrs, wds):
+            mx.nd.adam_update(w, g, m, v, out=w, lr=lr, wd=wd, **kwargs)
+        for w, m, v, (rw, rm, rv) in zip(weights, means, variances, ref):
+            assert_almost_equal(w.asnumpy(), rw.asnumpy(), rtol=1e-5, atol=1e-6)
+            assert_almost_equal(m.asnumpy(), rm.asnumpy(), rtol=1e-5, atol=1e-6)
+            assert_almost_equal(v.asnumpy(), rv.asnumpy(), rtol=1e-5, atol=1e-6)
+
+        # multi-precision Adam
+        weights32 = [rand(s) for s in shapes]
+        weights = [w.astype(np.float16) for w in weights32]
+        grads16 = [g.astype(np.float16) for g in grads]
+        means = [mx.nd.zeros(s) for s in shapes]
+        variances = [mx.nd.zeros(s) for s in shapes]
+        ref = [(w.copy(), m.copy(), v.copy()) for w, m, v in zip(weights32, means, variances)]
+        mx.nd.multi_mp_adam_update(*[a for t in zip(weights, grads16, means, variances, weights32)
+                                     for a in t],
+                                   out=weights, num_weights=len(shapes), lrs=lrs, wds=wds,
+                                   **kwargs)
+        for (w, m, v), g, lr, wd in zip(ref, grads16, lrs, wds):
+            mx.nd.adam_update(w, g.astype(np.float32), m, v, out=w, lr=lr, wd=wd, **kwargs)
+        for w, w32, (rw, _, _) in zip(weights, weights32, ref):
+            assert_almost_equal(w32.asnumpy(), rw.asnumpy(), rtol=1e-5, atol=1e-6)
+            assert_almost_equal(w.asnumpy(), rw.asnumpy().astype(np.float16), rtol=1e-3, atol=1e-3)
+
+        # RMSProp
+        weights = [rand(s) for s in shapes]
+        ns = [mx.nd.abs(rand(s)) for s in shapes]
+        ref = [(w.copy(), n.copy()) for w, n in zip(weights, ns)]
+        mx.nd.multi_rmsprop_update(*([a for t in zip(weights, grads, ns) for a in t] +
+                                     norm_inputs),
+                                   out=weights, num_weights=len(shapes), lrs=lrs, wds=wds,
+                                   clip_weights=0.9, **multi_kwargs)
+        for (w, n), g, lr, wd in zip(ref, ref_grads, lrs, wds):
+            mx.nd.rmsprop_update(w, g, n, out=w, lr=lr, wd=wd, clip_weights=0.9, **kwargs)
+        for w, n, (rw, rn) in zip(weights, ns, ref):
+            assert_almost_equal(w.asnumpy(), rw.asnumpy(), rtol=1e-5, atol=1e-6)
+            assert_almost_equal(n.asnumpy(), rn.asnumpy(), rtol=1e-5, atol=1e-6)
+
+    # aggregated updates through the optimizers match the per-weight ones
+    for opt_name, opt_kwargs in [('adam', {}), ('rmsprop', {'clip_weights': 0.5}),
+                                 ('adam', {'multi_precision': True})]:
+        dtype = np.float16 if opt_kwargs.get('multi_precision') else np.float32
+        weights = [rand(s, dtype) for s in shapes]
+        ref_weights = [w.copy() for w in weights]
+        grads = [rand(s, dtype) for s in shapes]
+        opt = mx.optimizer.create(opt_name, wd=0.01, **opt_kwargs)
+        ref_opt = mx.optimizer.create(opt_name, wd=0.01, **opt_kwargs)
+        states = [opt.create_state_multi_precision(i, w) for i, w in enumerate(weights)]
+        ref_states = [ref_opt.create_state_multi_precision(i, w)
+                      for i, w in enumerate(ref_weights)]
+        for _ in range(2):
+            opt.update_multi_precision(list(range(len(shapes))), weights, grads, states)
+            for i, (w, g, s) in enumerate(zip(ref_weights, grads, ref_states)):
+                ref_opt.update_multi_precision(i, w, g, s)
+        for w, rw in zip(weights, ref_weights):
+            assert_almost_equal(w.asnumpy(), rw.asnumpy(), rtol=1e-3, atol=1e-4)
+
+@with_seed()
+def test_optimizer_clip_global_norm():
+    shapes = [(3, 4, 5), (7,), (1, 1), (20, 31), (6, 2)]
+    clip_global_norm = 0.5
+    for opt_name, opt_kwargs in [('adam', {}), ('rmsprop', {'clip_weights': 0.5})]:
+        weights = [mx.nd.random.uniform(-1, 1, shape=s) for s in shapes]
+        ref_weights = [w.copy() for w in weights]
+        opt = mx.optimizer.create(opt_name, wd=0.01, rescale_grad=0.7,
+                                  clip_global_norm=clip_global_norm, **opt_kwargs)
+        # several aggregated calls per step, all of them scaled by the same global norm
+        opt.aggregate_num = 2
+        ref_opt = mx.optimizer.create(opt_name, wd=0.01, rescale_grad=0.7, **opt_kwargs)
+        updater = mx.optimizer.get_updater(opt)
+        ref_updater = mx.optimizer.get_updater(ref_opt)
+        for _ in range(3):
+            grads = [mx.nd.random.uniform(-1, 1, shape=s) for s in shapes]
+            np_grads = [g.asnumpy() for g in grads]
+            norm = 0.7 * np.sqrt(sum((g.astype(np.float64) ** 2).sum() for g in np_grads))
+            scale = clip_global_norm / max(norm, clip_global_norm)
+            assert scale < 1
+            updater(list(range(len(shapes))), grads, weights)
+            for i, (w, g) in enumerate(zip(ref_weights, np_grads)):
+                ref_updater(i, mx.nd.array(g * scale), w)
+        for w, rw in zip(weights, ref_weights):
+            assert_almost_equal(w.asnumpy(), rw.asnumpy(), rtol=1e-4, atol=1e-5)
+
 class PyFtrl(mx.optimizer.Optimizer):
     """The Ftrl optimizer.
 
@@ -233,6 +233,20 @@ def test_continuous_profile_and_instant_marker():
     profiler.set_state('stop')
 
 
+def test_aggregate_stats_in_bulk():
+    enable_profiler('test_aggregate_stats_in_bulk.json', True, False, True)
+    with mx.engine.bulk(10):
+        x = mx.nd.ones((10,))
+        for _ in range(20):
+            x += 1
+        x.wait_to_read()
+    profiler.set_state('stop')
+    # operators executed in bulk are still reported one by one
+    debug_str = profiler.dumps(reset=True)
+    assert 'ImperativeBulk' in debug_str
+    assert '_plus_scalar' in debug_str
+
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
@@ -1451,6 +1451,29 @@ def test_sparse_dot_determinism():
     check_dot_determinism('csr', 'default', 0.1, 1.0, True, False, 'default')
 
 
+@with_seed()
+def test_sparse_dot_transpose_cache():
+    def check_dot(lhs, rhs, forward_stype):
+        out = mx.nd.sparse.dot(lhs, rhs, transpose_a=True, forward_stype=forward_stype)
+        assert out.stype == forward_stype
+        expected = np.dot(lhs.asnumpy().T, rhs.asnumpy())
+        assert_almost_equal(out.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+
+    prev_val = mx.test_utils.set_env_var("MXNET_CACHE_CSR_TRANSPOSE", "1", "0")
+    try:
+        lhs = rand_ndarray((50, 200), 'csr', density=0.05)
+        rhs = rand_ndarray((50, 30), 'default')
+        for forward_stype in ['default', 'row_sparse']:
+            # the second dot reuses the transpose saved by the first
+            check_dot(lhs, rhs, forward_stype)
+            check_dot(lhs, rhs, forward_stype)
+            # writing to lhs invalidates the saved transpose
+            lhs[:] = rand_ndarray((50, 200), 'csr', density=0.05)
+            check_dot(lhs, rhs, forward_stype)
+    finally:
+        mx.test_utils.set_env_var("MXNET_CACHE_CSR_TRANSPOSE", prev_val)
+
+
 @with_seed()
 def test_sparse_slice():
     def check_csr_slice(shape, slice_input):
@@ -1907,6 +1930,46 @@ def test_sparse_embedding():
             check_sparse_embedding(in_dim, out_dim, batch, densities, sparse_grad, weight_stype)
             check_sparse_embedding(in_dim, out_dim, batch, densities, sparse_grad, weight_stype)
 
+
+@with_seed()
+def test_sparse_embedding_skewed_grad():
+    def check_embedding_grad(in_dim, out_dim, batch, dtype, out_dtype):
+        data = mx.sym.Variable('data')
+        weight = mx.sym.Variable('weight')
+        kwargs = {} if out_dtype is None else {'out_dtype': out_dtype}
+        embed = mx.sym.Embedding(data, weight, input_dim=in_dim, output_dim=out_dim,
+                                 dtype=dtype, sparse_grad=True, **kwargs)
+        exe = embed.simple_bind(mx.cpu(), data=(batch,),
+                                grad_req={'data': 'null', 'weight': 'write'},
+                                type_dict={'data': 'float32', 'weight': dtype})
+        # most lookups read a few hot rows
+        np_data = np.where(np.random.uniform(size=batch) < 0.7,
+                           np.random.randint(0, 3, size=batch),
+                           np.random.randint(0, in_dim, size=batch))
+        np_weight = np.random.uniform(-1, 1, (in_dim, out_dim)).astype(dtype)
+        np_ograd = np.random.uniform(-1, 1, (batch, out_dim)).astype(out_dtype or dtype)
+        exe.arg_dict['data'][:] = np_data
+        exe.arg_dict['weight'][:] = np_weight
+        exe.forward(is_train=True)
+        out = exe.outputs[0]
+        assert out.dtype == np.dtype(out_dtype or dtype)
+        assert_almost_equal(out.asnumpy(), np_weight[np_data].astype(out.dtype))
+        exe.backward([mx.nd.array(np_ograd, dtype=np_ograd.dtype)])
+        grad = exe.grad_dict['weight']
+        assert grad.stype == 'row_sparse'
+        assert grad.dtype == np.dtype(dtype)
+        expected = np.zeros((in_dim, out_dim), dtype=np.float64)
+        np.add.at(expected, np_data, np_ograd)
+        rtol, atol = (1e-2, 1e-2) if dtype == 'float16' else (1e-4, 1e-4)
+        assert_almost_equal(grad.asnumpy().astype(np.float64), expected, rtol=rtol, atol=atol)
+        assert np.array_equal(grad.indices.asnumpy(), np.unique(np_data))
+
+    for batch in [1, 100, 5000]:
+        check_embedding_grad(1000, 16, batch, 'float32', None)
+        check_embedding_grad(1000, 16, batch, 'float64', None)
+        check_embedding_grad(1000, 16, batch, 'float16', 'float32')
+
+
 @with_seed()
 def test_sparse_broadcast_add_sub():
     def check_broadcast_add(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
@@ -17,6 +17,8 @@
 
 import os
 import ctypes
+import json
+import math
 import mxnet as mx
 from mxnet.base import SymbolHandle, check_call, _LIB, mx_uint, c_str_array, c_str
 from mxnet.symbol import Symbol
@@ -232,6 +234,79 @@ def test_subgraph_exe():
     test_network_structure_7()
 
 
+def test_pointwise_fusion():
+    def check_pointwise_fusion(sym, shapes, num_fused):
+        """Check that the pointwise backend fuses the elementwise operators of sym into
+        num_fused nodes and that the fused graph computes the same outputs"""
+        fused_sym = sym.get_backend_symbol('pointwise')
+        ops = [node['op'] for node in json.loads(fused_sym.tojson())['nodes']]
+        assert ops.count('_sg_pointwise') == num_fused, ops
+        assert fused_sym.list_arguments() == sym.list_arguments()
+        args = {name: mx.nd.random.uniform(0.5, 1.5, shape=shape) for name, shape in shapes.items()}
+        exe = sym.bind(ctx=mx.cpu(), args=args, grad_req='null')
+        fused_exe = fused_sym.bind(ctx=mx.cpu(), args=args, grad_req='null')
+        exe.forward()
+        fused_exe.forward()
+        assert len(exe.outputs) == len(fused_exe.outputs)
+        for out, fused_out in zip(exe.outputs, fused_exe.outputs):
+            assert_almost_equal(out.asnumpy(), fused_out.asnumpy(), rtol=1e-5, atol=1e-6)
+
+    # tail of a layer normalization: per-row statistics and per-channel affine parameters
+    data = mx.sym.Variable('data')
+    mean = mx.sym.Variable('mean')
+    var = mx.sym.Variable('var')
+    gamma = mx.sym.Variable('gamma')
+    beta = mx.sym.Variable('beta')
+    norm = mx.sym.broadcast_div(mx.sym.broadcast_sub(data, mean), mx.sym.sqrt(var + 1e-5))
+    out = mx.sym.broadcast_add(mx.sym.broadcast_mul(norm, gamma), beta)
+    check_pointwise_fusion(out, {'data': (8, 33), 'mean': (8, 1), 'var': (8, 1),
+                                 'gamma': (33,), 'beta': (33,)}, 1)
+
+    # tanh approximation of GELU
+    x = mx.sym.Variable('x')
+    inner = (x + 0.044715 * x * x * x) * math.sqrt(2 / math.pi)
+    gelu = 0.5 * x * (1 + mx.sym.Activation(inner, act_type='tanh'))
+    check_pointwise_fusion(gelu, {'x': (3, 1000)}, 1)
+
+    # broadcast over a middle dimension and an intermediate result that is also an output
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    c = mx.sym.relu(mx.sym.broadcast_mul(a, b))
+    d = mx.sym.exp(-b)
+    fc = mx.sym.FullyConnected(mx.sym.sigmoid(c) - 1, num_hidden=4, name='fc')
+    out = mx.sym.Group([fc, c * 2, mx.sym.broadcast_add(c, d), d])
+    check_pointwise_fusion(out, {'a': (2, 5, 3), 'b': (2, 1, 3), 'fc_weight': (4, 15),
+                                 'fc_bias': (4,)}, 1)
+
+
+def test_pointwise_fusion_integer():
+    # the fused loop handles floating point types only
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    c = mx.sym.Variable('c')
+    out = mx.sym.broadcast_sub((a + b) * 3, c)
+    shapes = {'a': (4, 5), 'b': (4, 5), 'c': (1, 5)}
+    args = {name: mx.nd.array(np.random.randint(-10, 10, size=shape), dtype='int32')
+            for name, shape in shapes.items()}
+    expected = (args['a'] + args['b']) * 3 - args['c']
+    # partitioned without types, the fused node runs the integer operators one by one
+    fused_sym = out.get_backend_symbol('pointwise')
+    ops = [node['op'] for node in json.loads(fused_sym.tojson())['nodes']]
+    assert ops.count('_sg_pointwise') == 1, ops
+    fused_exe = fused_sym.bind(ctx=mx.cpu(), args=args, grad_req='null')
+    fused_exe.forward()
+    assert fused_exe.outputs[0].dtype == np.int32
+    assert (fused_exe.outputs[0].asnumpy() == expected.asnumpy()).all()
+    # partitioned at bind time with known types, the integer operators are not fused
+    os.environ['MXNET_SUBGRAPH_BACKEND'] = 'pointwise'
+    try:
+        exe = out.bind(ctx=mx.cpu(), args=args, grad_req='null')
+        exe.forward()
+        assert (exe.outputs[0].asnumpy() == expected.asnumpy()).all()
+    finally:
+        del os.environ['MXNET_SUBGRAPH_BACKEND']
+
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
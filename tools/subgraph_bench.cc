@@ -0,0 +1,304 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file subgraph_bench.cc
+ * \brief end-to-end inference benchmark of a model with and without subgraph backends
+ *
+ *  The model is bound through a predictor pool of the predict API once per
+ *  MXNET_SUBGRAPH_BACKEND value (none, ngraph, MKLDNN, ...), batch size and number of
+ *  concurrent requests. For each
+ *  run the compile time (bind, including graph partitioning), the latency of the first
+ *  forward pass, the p50/p99 steady-state latencies, the throughput and the peak RSS are
+ *  written as JSON.
+ */
+#include <mxnet/c_api.h>
+#include <mxnet/c_predict_api.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double ElapsedMs(const Clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void Check(int ret, const char *what) {
+  if (ret != 0) {
+    std::cerr << what << " failed: " << MXGetLastError() << std::endl;
+    std::exit(1);
+  }
+}
+
+std::vector<std::string> Split(const std::string &s, char delim) {
+  std::vector<std::string> ret;
+  std::istringstream is(s);
+  std::string item;
+  while (std::getline(is, item, delim)) {
+    if (!item.empty()) ret.push_back(item);
+  }
+  return ret;
+}
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.is_open()) {
+    std::cerr << "cannot open " << path << std::endl;
+    std::exit(1);
+  }
+  return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+// Resets the peak RSS of the process where the kernel supports it (Linux >= 4.0).
+void ResetPeakRSS() {
+  std::ofstream os("/proc/self/clear_refs");
+  if (os.is_open()) os << "5";
+}
+
+double PeakRSSMb() {
+  std::ifstream is("/proc/self/status");
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::atof(line.c_str() + 6) / 1024.0;
+    }
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0;
+}
+
+double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[std::min(idx, values.size() - 1)];
+}
+
+struct Config {
+  std::string symbol_json;
+  std::string params;
+  std::string input_name = "data";
+  std::vector<mx_uint> sample_shape;
+  int dev_type = 1;
+  int dev_id = 0;
+  int warmup = 5;
+  int iters = 100;
+};
+
+struct Result {
+  std::string backend;
+  int batch_size;
+  int threads;
+  double compile_ms;
+  double first_iter_ms;
+  double p50_ms;
+  double p99_ms;
+  double throughput;
+  double peak_rss_mb;
+};
+
+// Runs one request: copy the input in, forward, and copy the first output out.
+// Returns its latency in milliseconds.
+double RunOnce(PredictorPoolHandle pool, const std::vector<float> &input,
+               std::vector<float> *output) {
+  const auto start = Clock::now();
+  const mx_float *in_data[] = {input.data()};
+  const mx_uint in_sizes[] = {static_cast<mx_uint>(input.size())};
+  mx_float *out_data[] = {output->data()};
+  const mx_uint out_sizes[] = {static_cast<mx_uint>(output->size())};
+  Check(MXPredPoolPredict(pool, in_data, in_sizes, 1, out_data, out_sizes), "MXPredPoolPredict");
+  return ElapsedMs(start);
+}
+
+Result Run(const Config &cfg, const std::string &backend, int batch_size, int threads) {
+  if (backend == "none") {
+    unsetenv("MXNET_SUBGRAPH_BACKEND");
+  } else {
+    setenv("MXNET_SUBGRAPH_BACKEND", backend.c_str(), 1);
+  }
+  Result res;
+  res.backend = backend;
+  res.batch_size = batch_size;
+  res.threads = threads;
+  ResetPeakRSS();
+
+  std::vector<mx_uint> shape = {static_cast<mx_uint>(batch_size)};
+  shape.insert(shape.end(), cfg.sample_shape.begin(), cfg.sample_shape.end());
+  const mx_uint indptr[] = {0, static_cast<mx_uint>(shape.size())};
+  const char *keys[] = {cfg.input_name.c_str()};
+  PredictorPoolHandle pool = nullptr;
+  auto start = Clock::now();
+  Check(MXPredPoolCreate(cfg.symbol_json.c_str(), cfg.params.data(),
+                         static_cast<int>(cfg.params.size()), cfg.dev_type, cfg.dev_id,
+                         1, keys, indptr, shape.data(), threads, &pool),
+        "MXPredPoolCreate");
+  res.compile_ms = ElapsedMs(start);
+
+  mx_uint *out_shape = nullptr;
+  mx_uint out_ndim = 0;
+  Check(MXPredPoolGetOutputShape(pool, 0, &out_shape, &out_ndim), "MXPredPoolGetOutputShape");
+  size_t out_size = 1;
+  for (mx_uint i = 0; i < out_ndim; ++i) out_size *= out_shape[i];
+  size_t in_size = 1;
+  for (const mx_uint d : shape) in_size *= d;
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(0.f, 1.f);
+  std::vector<std::vector<float>> inputs(threads, std::vector<float>(in_size));
+  std::vector<std::vector<float>> outputs(threads, std::vector<float>(out_size));
+  for (auto &input : inputs) {
+    for (auto &v : input) v = dist(rng);
+  }
+
+  res.first_iter_ms = RunOnce(pool, inputs[0], &outputs[0]);
+
+  std::vector<std::vector<double>> latencies(threads);
+  auto run_all = [&](int iters, bool record) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t]() {
+        for (int i = 0; i < iters; ++i) {
+          const double ms = RunOnce(pool, inputs[t], &outputs[t]);
+          if (record) latencies[t].push_back(ms);
+        }
+      });
+    }
+    for (auto &w : workers) w.join();
+  };
+  run_all(cfg.warmup, false);
+  start = Clock::now();
+  run_all(cfg.iters, true);
+  const double wall_ms = ElapsedMs(start);
+
+  std::vector<double> all;
+  for (const auto &l : latencies) all.insert(all.end(), l.begin(), l.end());
+  res.p50_ms = Percentile(all, 0.50);
+  res.p99_ms = Percentile(all, 0.99);
+  res.throughput = wall_ms > 0 ?
+      1000.0 * threads * cfg.iters * batch_size / wall_ms : 0;
+  Check(MXPredPoolFree(pool), "MXPredPoolFree");
+  res.peak_rss_mb = PeakRSSMb();
+  return res;
+}
+
+void WriteJSON(std::ostream &os, const std::vector<Result> &results) {
+  os << "[";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    os << (i ? ",\n " : "\n ")
+       << "{\"backend\": \"" << r.backend << "\""
+       << ", \"batch_size\": " << r.batch_size
+       << ", \"threads\": " << r.threads
+       << ", \"compile_ms\": " << r.compile_ms
+       << ", \"first_iter_ms\": " << r.first_iter_ms
+       << ", \"p50_ms\": " << r.p50_ms
+       << ", \"p99_ms\": " << r.p99_ms
+       << ", \"throughput\": " << r.throughput
+       << ", \"peak_rss_mb\": " << r.peak_rss_mb << "}";
+  }
+  os << "\n]\n";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    printf("Usage: <model-symbol.json> <model.params> [additional parameters in form key=value]\n"\
+           "Possible additional parameters:\n"\
+           "\tinput=NAME[default=data] name of the input\n"\
+           "\tshape=DIMS[default=3,224,224] shape of one sample, without the batch dimension\n"\
+           "\tbatch_sizes=LIST[default=1,8,32] batch sizes to run\n"\
+           "\tthreads=LIST[default=1] numbers of requests running concurrently, one per thread\n"\
+           "\tbackends=LIST[default=none,ngraph,MKLDNN] values of MXNET_SUBGRAPH_BACKEND,"\
+           " none leaves it unset\n"\
+           "\tdev_type=DEV[default=1] device type, 1: cpu, 2: gpu\n"\
+           "\tdev_id=ID[default=0] device id\n"\
+           "\twarmup=N[default=5] iterations run before measuring\n"\
+           "\titers=N[default=100] measured iterations per predictor\n"\
+           "\toutput=FILE[default=stdout] file the JSON results are written to\n");
+    return 0;
+  }
+  Config cfg;
+  cfg.symbol_json = ReadFile(argv[1]);
+  cfg.params = ReadFile(argv[2]);
+  cfg.sample_shape = {3, 224, 224};
+  std::vector<int> batch_sizes = {1, 8, 32};
+  std::vector<int> thread_counts = {1};
+  std::vector<std::string> backends = {"none", "ngraph", "MKLDNN"};
+  std::string output;
+  for (int i = 3; i < argc; ++i) {
+    char key[128], val[1024];
+    if (sscanf(argv[i], "%127[^=]=%1023s", key, val) != 2) continue;
+    if (!strcmp(key, "input")) cfg.input_name = val;
+    if (!strcmp(key, "shape")) {
+      cfg.sample_shape.clear();
+      for (const auto &d : Split(val, ',')) cfg.sample_shape.push_back(std::stoul(d));
+    }
+    if (!strcmp(key, "batch_sizes")) {
+      batch_sizes.clear();
+      for (const auto &b : Split(val, ',')) batch_sizes.push_back(std::stoi(b));
+    }
+    if (!strcmp(key, "threads")) {
+      thread_counts.clear();
+      for (const auto &t : Split(val, ',')) thread_counts.push_back(std::stoi(t));
+    }
+    if (!strcmp(key, "backends")) backends = Split(val, ',');
+    if (!strcmp(key, "dev_type")) cfg.dev_type = atoi(val);
+    if (!strcmp(key, "dev_id")) cfg.dev_id = atoi(val);
+    if (!strcmp(key, "warmup")) cfg.warmup = atoi(val);
+    if (!strcmp(key, "iters")) cfg.iters = atoi(val);
+    if (!strcmp(key, "output")) output = val;
+  }
+
+  std::vector<Result> results;
+  for (const auto &backend : backends) {
+    for (const int batch_size : batch_sizes) {
+      for (const int threads : thread_counts) {
+        results.push_back(Run(cfg, backend, batch_size, threads));
+        const Result &r = results.back();
+        std::cerr << r.backend << " batch=" << r.batch_size << " threads=" << r.threads
+                  << " compile=" << r.compile_ms << "ms p50=" << r.p50_ms << "ms p99="
+                  << r.p99_ms << "ms " << r.throughput << " samples/s" << std::endl;
+      }
+    }
+  }
+  if (output.empty()) {
+    WriteJSON(std::cout, results);
+  } else {
+    std::ofstream os(output);
+    WriteJSON(os, results);
+  }
+  return 0;
+}